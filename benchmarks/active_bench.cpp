@@ -0,0 +1,119 @@
+/**
+ * @file active_bench.cpp
+ * @brief Scaling of active objects on work-stealing workers
+ */
+
+#include <thread>
+
+#include <bench.hpp>
+#include <benchmarks.hpp>
+#include <microhsm/microhsm.hpp>
+
+namespace microhsm_benchmarks
+{
+    static const unsigned int OBJECT_COUNT = 50000;
+    static const unsigned int EVENT_COUNT = 1000000;
+    /// Capacity of the mailbox of every object
+    static const unsigned int MAILBOX_SIZE = 32;
+    /// Iterations of busy work per event
+    static const unsigned int WORK = 200;
+
+    enum eActiveEvents : unsigned int {
+        eACTIVE_WORK = 1,
+    };
+
+    static void work(void* ctx)
+    {
+        unsigned int* state = static_cast<unsigned int*>(ctx);
+        unsigned int x = *state | 1u;
+        for (unsigned int i = 0; i < WORK; i++) {
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+        }
+        *state = x;
+    }
+
+    class WorkState : public microhsm::BaseState
+    {
+        public:
+            WorkState() : microhsm::BaseState(0, nullptr, nullptr) {};
+
+            bool match(unsigned int event, microhsm::sTransition* t, void* ctx) override
+            {
+                (void)ctx;
+                if (event == eACTIVE_WORK) return transitionInternal(t, work);
+                return noTransition();
+            }
+    };
+
+    class WorkHSM : public microhsm::BaseHSM
+    {
+        public:
+            /// Structure shared by all instances
+            static microhsm::HSMDefinition definition;
+
+            WorkHSM() : microhsm::BaseHSM(state, definition)
+            {
+                this->registerVertices({&state});
+            };
+
+            WorkState state;
+    };
+
+    microhsm::HSMDefinition WorkHSM::definition;
+
+    struct sBenchObject {
+        sBenchObject() : object(hsm, mailbox, &state) {};
+
+        WorkHSM hsm;
+        microhsm::MPSCEventQueue<MAILBOX_SIZE> mailbox;
+        unsigned int state = 1;
+        microhsm::ActiveObject object;
+    };
+
+    static sBenchObject objects[OBJECT_COUNT];
+
+    template <unsigned int WORKERS>
+    static void benchWorkers(const char* name)
+    {
+        static microhsm::ActiveRuntime<WORKERS, OBJECT_COUNT> runtime;
+        for (unsigned int i = 0; i < OBJECT_COUNT; i++) {
+            initHSM(objects[i].hsm, &objects[i].state);
+            runtime.add(objects[i].object);
+        }
+
+        std::atomic<bool> stop(false);
+        std::thread workers[WORKERS];
+        for (unsigned int w = 0; w < WORKERS; w++) {
+            workers[w] = std::thread([w, &stop]() {runtime.runWorker(w, stop);});
+        }
+
+        // Producer posts to objects in turn, workers run until all events are dispatched
+        Stopwatch sw;
+        for (unsigned int i = 0; i < EVENT_COUNT; i++) {
+            objects[i % OBJECT_COUNT].object.post(eACTIVE_WORK);
+        }
+        while (runtime.getTotalStats().dispatched < EVENT_COUNT) std::this_thread::yield();
+        double ns = sw.elapsedNs();
+
+        stop.store(true);
+        for (unsigned int w = 0; w < WORKERS; w++) workers[w].join();
+
+        microhsm::sWorkerStats stats = runtime.getTotalStats();
+        report("active", name, ns / EVENT_COUNT, "ns/event");
+        report("active", "  steals", static_cast<double>(stats.steals), "objects");
+        report("active", "  peak depth", static_cast<double>(stats.peakDepth), "objects");
+        report("active", "  mean scheduling latency", static_cast<double>(stats.latencyTotal) / static_cast<double>(stats.runs) / 1000.0, "us");
+    }
+
+    void run_active_benchmarks()
+    {
+        report("active", "object", sizeof(sBenchObject), "bytes");
+        benchWorkers<1>("1 worker");
+        benchWorkers<2>("2 workers");
+        benchWorkers<4>("4 workers");
+        benchWorkers<8>("8 workers");
+        benchWorkers<16>("16 workers");
+    }
+}
@@ -0,0 +1,87 @@
+/**
+ * @file bench.hpp
+ * @brief Helpers for benchmarks
+ */
+#ifndef _H_MICROHSM_BENCHMARKS_BENCH
+#define _H_MICROHSM_BENCHMARKS_BENCH
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include <microhsm/microhsm.hpp>
+
+namespace microhsm_benchmarks
+{
+    /// Prevent the compiler from optimizing away `value`
+    template <typename T>
+    inline void doNotOptimize(const T& value)
+    {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    /// Simple wall-clock stopwatch
+    class Stopwatch
+    {
+        public:
+            Stopwatch() : start_(std::chrono::steady_clock::now()) {};
+
+            /// Elapsed time in nanoseconds
+            double elapsedNs() const
+            {
+                std::chrono::duration<double, std::nano> d = std::chrono::steady_clock::now() - start_;
+                return d.count();
+            }
+
+        private:
+            std::chrono::steady_clock::time_point start_;
+    };
+
+    /// Deterministic pseudo-random generator (xorshift)
+    class Random
+    {
+        public:
+            explicit Random(unsigned int seed) : state_(seed == 0 ? 1u : seed) {};
+
+            unsigned int next()
+            {
+                state_ ^= state_ << 13;
+                state_ ^= state_ >> 17;
+                state_ ^= state_ << 5;
+                return state_;
+            }
+
+            /// Number in range [0, n)
+            unsigned int below(unsigned int n)
+            {
+                return next() % n;
+            }
+
+        private:
+            unsigned int state_;
+    };
+
+    /// Abort on failed initialization, results of an HSM that failed to initialize are meaningless
+    inline void checkInit(microhsm::eStatus status)
+    {
+        if (status != microhsm::eOK) {
+            std::fprintf(stderr, "HSM initialization failed, check MICROHSM_MAX_STATES and MICROHSM_MAX_DEPTH\n");
+            std::abort();
+        }
+    }
+
+    /// Initialize HSM, see `checkInit`
+    template <typename HSM>
+    inline void initHSM(HSM& hsm, void* ctx)
+    {
+        checkInit(hsm.init(ctx));
+    }
+
+    /// Print a benchmark result line
+    inline void report(const char* suite, const char* name, double value, const char* unit)
+    {
+        std::printf("%-12s %-48s %12.2f %s\n", suite, name, value, unit);
+    }
+}
+
+#endif
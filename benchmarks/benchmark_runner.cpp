@@ -0,0 +1,46 @@
+#include <benchmarks.hpp>
+
+#include <cstring>
+
+namespace microhsm_benchmarks
+{
+    typedef struct {
+        const char* name;
+        void (*run)(void);
+    } sSuite;
+
+    static const sSuite suites[] = {
+        {"dispatch", run_dispatch_benchmarks},
+        {"lca", run_lca_benchmarks},
+        {"queue", run_queue_benchmarks},
+        {"defer", run_defer_benchmarks},
+        {"event", run_event_benchmarks},
+        {"pool", run_pool_benchmarks},
+        {"bus", run_bus_benchmarks},
+        {"active", run_active_benchmarks},
+        {"scheduler", run_scheduler_benchmarks},
+        {"timer", run_timer_benchmarks},
+        {"flyweight", run_flyweight_benchmarks},
+        {"orthogonal", run_orthogonal_benchmarks},
+        {"branch", run_branch_benchmarks},
+        {"snapshot", run_snapshot_benchmarks},
+        {"store", run_store_benchmarks},
+        {"journal", run_journal_benchmarks},
+    };
+
+    // Main
+    int main(int argc, char** argv)
+    {
+        // Run all suites, or only the suites named on the command line
+        for (const sSuite& suite : suites) {
+            bool selected = (argc <= 1);
+            for (int i = 1; i < argc; i++) {
+                if (std::strcmp(argv[i], suite.name) == 0) selected = true;
+            }
+            if (selected) suite.run();
+        }
+        return 0;
+    }
+}
+
+int main(int argc, char** argv) {return microhsm_benchmarks::main(argc, argv);}
@@ -0,0 +1,28 @@
+/**
+ * @file benchmarks.hpp
+ * @brief Benchmark suites
+ */
+#ifndef _H_MICROHSM_BENCHMARKS
+#define _H_MICROHSM_BENCHMARKS
+
+namespace microhsm_benchmarks
+{
+    void run_dispatch_benchmarks();
+    void run_lca_benchmarks();
+    void run_queue_benchmarks();
+    void run_defer_benchmarks();
+    void run_event_benchmarks();
+    void run_pool_benchmarks();
+    void run_bus_benchmarks();
+    void run_active_benchmarks();
+    void run_scheduler_benchmarks();
+    void run_timer_benchmarks();
+    void run_flyweight_benchmarks();
+    void run_orthogonal_benchmarks();
+    void run_branch_benchmarks();
+    void run_snapshot_benchmarks();
+    void run_store_benchmarks();
+    void run_journal_benchmarks();
+}
+
+#endif
@@ -0,0 +1,188 @@
+/**
+ * @file branch_bench.cpp
+ * @brief Dynamic branching with choice/junction pseudostates versus transient states
+ */
+
+#include <stdio.h>
+
+#include <bench.hpp>
+#include <benchmarks.hpp>
+#include <microhsm/microhsm.hpp>
+
+namespace microhsm_benchmarks
+{
+    static const unsigned int EVENT_COUNT = 400000;
+    static const unsigned int REPETITIONS = 3;
+
+    /// Levels of composite states above the branching state
+    static const unsigned int WRAPPERS = 3;
+
+    static const unsigned int GO = 1;
+
+    /// IDs, wrappers use `0` up to `WRAPPERS - 1`
+    static const unsigned int ACTIVE = WRAPPERS;
+    static const unsigned int LOW = WRAPPERS + 1;
+    static const unsigned int HIGH = WRAPPERS + 2;
+    static const unsigned int BRANCH = WRAPPERS + 3;
+
+    typedef struct {
+        bool high;              ///< Guard of the branch
+        unsigned long calls;    ///< Entry and exit calls
+    } sBranchCTX;
+
+    /// Composite state without transitions
+    class WrapperState : public microhsm::BaseState
+    {
+        public:
+            WrapperState(unsigned int id, microhsm::BaseState* parentState, microhsm::BaseState* initialState) :
+                microhsm::BaseState(id, parentState, initialState) {};
+
+            bool match(unsigned int event, microhsm::sTransition* t, void* ctx) override
+            {
+                (void)event;
+                (void)t;
+                (void)ctx;
+                return noTransition();
+            }
+
+            microhsm::tEventMask handledEvents(void) override
+            {
+                return 0;
+            }
+
+            void entry(void* ctx) override
+            {
+                static_cast<sBranchCTX*>(ctx)->calls++;
+            }
+
+            void exit(void* ctx) override
+            {
+                static_cast<sBranchCTX*>(ctx)->calls++;
+            }
+    };
+
+    /// Leaf state branching on `GO`
+    class LeafState : public WrapperState
+    {
+        public:
+            LeafState(unsigned int id, microhsm::BaseState* parentState) :
+                WrapperState(id, parentState, nullptr) {};
+
+            bool match(unsigned int event, microhsm::sTransition* t, void* ctx) override
+            {
+                (void)ctx;
+                if (event == GO) return transitionExternal(BRANCH, t, nullptr);
+                return noTransition();
+            }
+
+            microhsm::tEventMask handledEvents(void) override
+            {
+                return microhsm::eventMask(GO);
+            }
+    };
+
+    /// Workaround: transient state leaving through anonymous transitions
+    class TransientBranch : public WrapperState
+    {
+        public:
+            explicit TransientBranch(microhsm::BaseState* parentState) :
+                WrapperState(BRANCH, parentState, nullptr) {};
+
+            bool match(unsigned int event, microhsm::sTransition* t, void* ctx) override
+            {
+                if (event != EVENT_ANONYMOUS) return noTransition();
+                return transitionExternal(static_cast<sBranchCTX*>(ctx)->high ? HIGH : LOW, t, nullptr);
+            }
+
+            microhsm::tEventMask handledEvents(void) override
+            {
+                return microhsm::eventMask(EVENT_ANONYMOUS);
+            }
+    };
+
+    class ChoiceBranch : public microhsm::Choice
+    {
+        public:
+            explicit ChoiceBranch(microhsm::BaseState* parentState) : microhsm::Choice(BRANCH, parentState) {};
+
+            bool select(microhsm::sTransition* t, void* ctx) override
+            {
+                return branch(static_cast<sBranchCTX*>(ctx)->high ? HIGH : LOW, t, nullptr);
+            }
+    };
+
+    class JunctionBranch : public microhsm::Junction
+    {
+        public:
+            // Junctions have no parent, the argument keeps `BranchHSM` uniform
+            explicit JunctionBranch(microhsm::BaseState* parentState) : microhsm::Junction(BRANCH) {(void)parentState;};
+
+            bool select(microhsm::sTransition* t, void* ctx) override
+            {
+                return branch(static_cast<sBranchCTX*>(ctx)->high ? HIGH : LOW, t, nullptr);
+            }
+    };
+
+    /// Wrappers containing `ACTIVE`, whose substates branch to each other
+    template <typename TBranch>
+    class BranchHSM : public microhsm::BaseHSM
+    {
+        public:
+            /// Structure shared by all instances
+            static microhsm::HSMDefinition definition;
+
+            BranchHSM() : microhsm::BaseHSM(wrappers[0], definition)
+            {
+                this->registerVertices({&wrappers[0], &wrappers[1], &wrappers[2], &active, &low, &high, &branch});
+            };
+
+            WrapperState wrappers[WRAPPERS] = {
+                WrapperState(0, nullptr, &wrappers[1]),
+                WrapperState(1, &wrappers[0], &wrappers[2]),
+                WrapperState(2, &wrappers[1], &active),
+            };
+            WrapperState active = WrapperState(ACTIVE, &wrappers[WRAPPERS - 1], &low);
+            LeafState low = LeafState(LOW, &active);
+            LeafState high = LeafState(HIGH, &active);
+            TBranch branch = TBranch(&active);
+    };
+
+    template <typename TBranch>
+    microhsm::HSMDefinition BranchHSM<TBranch>::definition;
+
+    template <typename TBranch>
+    static void benchBranch(const char* name)
+    {
+        static BranchHSM<TBranch> hsm;
+        sBranchCTX ctx = {false, 0};
+        initHSM(hsm, &ctx);
+
+        double best = 0;
+        unsigned long calls = 0;
+        for (unsigned int rep = 0; rep < REPETITIONS; rep++) {
+            Random random(5);
+            ctx.calls = 0;
+            Stopwatch sw;
+            for (unsigned int n = 0; n < EVENT_COUNT; n++) {
+                ctx.high = random.below(2) != 0;
+                doNotOptimize(hsm.dispatch(GO, &ctx));
+            }
+            double ns = sw.elapsedNs();
+            if (rep == 0 || ns < best) best = ns;
+            calls = ctx.calls;
+        }
+
+        char label[64];
+        snprintf(label, sizeof(label), "%s", name);
+        report("branch", label, best / EVENT_COUNT, "ns/event");
+        snprintf(label, sizeof(label), "%s, entry/exit calls", name);
+        report("branch", label, static_cast<double>(calls) / EVENT_COUNT, "calls/event");
+    }
+
+    void run_branch_benchmarks()
+    {
+        benchBranch<TransientBranch>("transient state + anonymous transition");
+        benchBranch<ChoiceBranch>("choice pseudostate");
+        benchBranch<JunctionBranch>("junction pseudostate");
+    }
+}
@@ -0,0 +1,142 @@
+/**
+ * @file bus_bench.cpp
+ * @brief Broadcast to many HSMs, dispatch to every HSM versus publishing on an event bus
+ */
+
+#include <bench.hpp>
+#include <benchmarks.hpp>
+#include <microhsm/microhsm.hpp>
+
+namespace microhsm_benchmarks
+{
+    static const unsigned int MAX_SUBSCRIBERS = 100000;
+    static const unsigned int EVENT_COUNT = 8;
+    /// Every `SUBSCRIBER_STRIDE`-th subscriber handles the published event
+    static const unsigned int SUBSCRIBER_STRIDE = 100;
+    static const unsigned int TARGET_DELIVERIES = 2000000;
+    static const unsigned int REPETITIONS = 3;
+
+    enum eBusEvents : unsigned int {
+        eBUS_TICK = 1,
+        eBUS_OTHER,
+    };
+
+    /// Handles ticks when `SUBSCRIBED`, declares its handled events
+    template <bool SUBSCRIBED>
+    class BusState : public microhsm::BaseState
+    {
+        public:
+            BusState() : microhsm::BaseState(0, nullptr, nullptr) {};
+
+            bool match(unsigned int event, microhsm::sTransition* t, void* ctx) override
+            {
+                (void)ctx;
+                if (event == eBUS_TICK && SUBSCRIBED) return transitionInternal(t, nullptr);
+                return noTransition();
+            }
+
+            microhsm::tEventMask handledEvents(void) override
+            {
+                return SUBSCRIBED ? microhsm::eventMask(eBUS_TICK) : microhsm::eventMask(eBUS_OTHER);
+            }
+    };
+
+    template <bool SUBSCRIBED>
+    class BusBenchHSM : public microhsm::BaseHSM
+    {
+        public:
+            /// Structure shared by all instances
+            static microhsm::HSMDefinition definition;
+
+            BusBenchHSM() : microhsm::BaseHSM(state, definition)
+            {
+                this->registerVertices({&state});
+            };
+
+            BusState<SUBSCRIBED> state;
+    };
+
+    template <bool SUBSCRIBED>
+    microhsm::HSMDefinition BusBenchHSM<SUBSCRIBED>::definition;
+
+    /// Subscribers handling ticks, subscriber `i * SUBSCRIBER_STRIDE`
+    static BusBenchHSM<true> handlers[MAX_SUBSCRIBERS / SUBSCRIBER_STRIDE];
+    /// Other subscribers, subscriber `i` (entries of handling subscribers are unused)
+    static BusBenchHSM<false> others[MAX_SUBSCRIBERS];
+    /// HSM of every subscriber
+    static microhsm::BaseHSM* subscriberHSMs[MAX_SUBSCRIBERS];
+    static microhsm::EventBus<MAX_SUBSCRIBERS, EVENT_COUNT> bus;
+    static microhsm::EventQueue<2> queues[MAX_SUBSCRIBERS];
+
+    static void initSubscribers(void)
+    {
+        for (unsigned int i = 0; i < MAX_SUBSCRIBERS; i++) {
+            if (i % SUBSCRIBER_STRIDE == 0) subscriberHSMs[i] = &handlers[i / SUBSCRIBER_STRIDE];
+            else subscriberHSMs[i] = &others[i];
+            initHSM(*subscriberHSMs[i], nullptr);
+        }
+        report("bus", "HSM instance", sizeof(BusBenchHSM<false>), "bytes");
+        report("bus", "definition, shared by all instances", sizeof(microhsm::HSMDefinition), "bytes");
+    }
+
+    static void benchDispatchAll(const char* name, unsigned int subscribers)
+    {
+        // Every HSM is offered every event
+        const unsigned int rounds = (TARGET_DELIVERIES / subscribers) + 1;
+
+        double best = 0;
+        for (unsigned int r = 0; r < REPETITIONS; r++) {
+            Stopwatch sw;
+            for (unsigned int n = 0; n < rounds; n++) {
+                for (unsigned int i = 0; i < subscribers; i++) {
+                    doNotOptimize(subscriberHSMs[i]->dispatch(eBUS_TICK, nullptr));
+                }
+            }
+            double ns = sw.elapsedNs();
+            if (r == 0 || ns < best) best = ns;
+        }
+
+        report("bus", name, best / rounds, "ns/publish");
+    }
+
+    static void benchPublish(const char* name, unsigned int subscribers)
+    {
+        // Bus only grows, attach missing subscribers
+        while (bus.getSubscriberCount() < subscribers) {
+            const unsigned int i = bus.getSubscriberCount();
+            bus.attach(&queues[i]);
+            if (i % SUBSCRIBER_STRIDE == 0) bus.subscribe(i, eBUS_TICK);
+            else bus.subscribe(i, eBUS_OTHER);
+        }
+        const unsigned int rounds = (TARGET_DELIVERIES / subscribers) + 1;
+
+        // Every subscribed HSM handles the event delivered to its queue
+        double best = 0;
+        for (unsigned int r = 0; r < REPETITIONS; r++) {
+            Stopwatch sw;
+            for (unsigned int n = 0; n < rounds; n++) {
+                bus.publish(eBUS_TICK);
+                unsigned int event;
+                for (unsigned int i = 0; i < subscribers; i += SUBSCRIBER_STRIDE) {
+                    while (queues[i].pop(event)) subscriberHSMs[i]->dispatch(event, nullptr);
+                }
+            }
+            double ns = sw.elapsedNs();
+            if (r == 0 || ns < best) best = ns;
+        }
+        doNotOptimize(bus.getFailed());
+
+        report("bus", name, best / rounds, "ns/publish");
+    }
+
+    void run_bus_benchmarks()
+    {
+        initSubscribers();
+        benchDispatchAll("10 HSMs, dispatch to every HSM", 10);
+        benchPublish("10 HSMs, publish to subscribers", 10);
+        benchDispatchAll("1k HSMs, dispatch to every HSM", 1000);
+        benchPublish("1k HSMs, publish to subscribers", 1000);
+        benchDispatchAll("100k HSMs, dispatch to every HSM", 100000);
+        benchPublish("100k HSMs, publish to subscribers", 100000);
+    }
+}
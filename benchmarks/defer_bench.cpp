@@ -0,0 +1,182 @@
+/**
+ * @file defer_bench.cpp
+ * @brief Deferred event benchmarks with a large backlog
+ */
+
+#include <vector>
+
+#include <bench.hpp>
+#include <benchmarks.hpp>
+#include <microhsm/microhsm.hpp>
+
+namespace microhsm_benchmarks
+{
+    static const unsigned int BACKLOG = 10000;
+    static const unsigned int TRANSITION_COUNT = 200000;
+    static const unsigned int NAIVE_TRANSITION_COUNT = 200;
+    static const unsigned int REPETITIONS = 3;
+
+    enum eDeferEvents : unsigned int {
+        eDEFER_START = 1,
+        eDEFER_DONE,
+        eDEFER_NEXT,
+        eDEFER_PING,
+    };
+
+    enum eDeferStates : unsigned int {
+        eDEFER_IDLE = 0,
+        eDEFER_BUSY,
+        eDEFER_BUSY_A,
+        eDEFER_BUSY_B,
+    };
+
+    /// State of the benchmark machine, transitions given as (event, target) pairs
+    class DeferState : public microhsm::BaseState
+    {
+        public:
+            DeferState(unsigned int id, microhsm::BaseState* parentState, microhsm::BaseState* initialState) :
+                microhsm::BaseState(id, parentState, initialState) {};
+
+            bool match(unsigned int event, microhsm::sTransition* t, void* ctx) override
+            {
+                (void)ctx;
+                for (unsigned int i = 0; i < transitionCount; i++) {
+                    if (events[i] == event) return transitionExternal(targets[i], t, nullptr);
+                }
+                if (event == eDEFER_PING && handlesPing) return transitionInternal(t, nullptr);
+                return noTransition();
+            }
+
+            microhsm::tEventMask deferredEvents(void) override {return deferred;}
+
+            unsigned int events[2] = {0, 0};
+            unsigned int targets[2] = {0, 0};
+            unsigned int transitionCount = 0;
+            bool handlesPing = false;
+            microhsm::tEventMask deferred = 0;
+    };
+
+    /**
+     * Idle handles pings and starts busy. Busy (A or B, toggled by next)
+     * returns to idle on done. With deferral busy defers pings.
+     */
+    class DeferBenchHSM : public microhsm::BaseHSM
+    {
+        public:
+            /// Structure shared by all instances deferring pings
+            static microhsm::HSMDefinition deferring;
+            /// Structure shared by all instances handling pings only when idle
+            static microhsm::HSMDefinition plain;
+
+            explicit DeferBenchHSM(bool defer) : microhsm::BaseHSM(idle, defer ? deferring : plain)
+            {
+                this->registerVertices({&idle, &busy, &busyA, &busyB});
+
+                idle.events[0] = eDEFER_START;
+                idle.targets[0] = eDEFER_BUSY;
+                idle.transitionCount = 1;
+                idle.handlesPing = true;
+
+                busy.events[0] = eDEFER_DONE;
+                busy.targets[0] = eDEFER_IDLE;
+                busy.transitionCount = 1;
+                busy.deferred = defer ? microhsm::eventMask(eDEFER_PING) : 0;
+
+                busyA.events[0] = eDEFER_NEXT;
+                busyA.targets[0] = eDEFER_BUSY_B;
+                busyA.transitionCount = 1;
+                busyB.events[0] = eDEFER_NEXT;
+                busyB.targets[0] = eDEFER_BUSY_A;
+                busyB.transitionCount = 1;
+            };
+
+            DeferState idle = DeferState(eDEFER_IDLE, nullptr, nullptr);
+            DeferState busy = DeferState(eDEFER_BUSY, nullptr, &busyA);
+            DeferState busyA = DeferState(eDEFER_BUSY_A, &busy, nullptr);
+            DeferState busyB = DeferState(eDEFER_BUSY_B, &busy, nullptr);
+    };
+
+    microhsm::HSMDefinition DeferBenchHSM::deferring;
+    microhsm::HSMDefinition DeferBenchHSM::plain;
+
+    /// Deferred events of the deferring instances, one at a time
+    static microhsm::DeferQueue queue;
+
+    static void benchTransitions(const char* name, unsigned int backlog)
+    {
+        DeferBenchHSM hsm(true);
+        hsm.attachDeferQueue(&queue);
+        initHSM(hsm, nullptr);
+        hsm.dispatch(eDEFER_START, nullptr);
+        for (unsigned int i = 0; i < backlog; i++) hsm.dispatch(eDEFER_PING, nullptr);
+
+        // Backlog stays deferred while toggling between busy substates
+        double best = 0;
+        for (unsigned int r = 0; r < REPETITIONS; r++) {
+            Stopwatch sw;
+            for (unsigned int i = 0; i < TRANSITION_COUNT; i++) hsm.dispatch(eDEFER_NEXT, nullptr);
+            double ns = sw.elapsedNs();
+            if (r == 0 || ns < best) best = ns;
+        }
+        doNotOptimize(hsm.getDeferredCount());
+
+        report("defer", name, best / TRANSITION_COUNT, "ns/transition");
+    }
+
+    static void benchNaive(const char* name, unsigned int backlog)
+    {
+        // Deferral emulated by buffering events and re-dispatching all of them after every transition
+        DeferBenchHSM hsm(false);
+        initHSM(hsm, nullptr);
+        hsm.dispatch(eDEFER_START, nullptr);
+        std::vector<unsigned int> buffer(backlog, static_cast<unsigned int>(eDEFER_PING));
+        std::vector<unsigned int> kept;
+
+        double best = 0;
+        for (unsigned int r = 0; r < REPETITIONS; r++) {
+            Stopwatch sw;
+            for (unsigned int i = 0; i < NAIVE_TRANSITION_COUNT; i++) {
+                hsm.dispatch(eDEFER_NEXT, nullptr);
+                kept.clear();
+                for (unsigned int e : buffer) {
+                    if (hsm.dispatch(e, nullptr) == microhsm::eEVENT_IGNORED) kept.push_back(e);
+                }
+                buffer.swap(kept);
+            }
+            double ns = sw.elapsedNs();
+            if (r == 0 || ns < best) best = ns;
+        }
+        doNotOptimize(buffer.size());
+
+        report("defer", name, best / NAIVE_TRANSITION_COUNT, "ns/transition");
+    }
+
+    static void benchRecall(const char* name, unsigned int backlog)
+    {
+        DeferBenchHSM hsm(true);
+        hsm.attachDeferQueue(&queue);
+        initHSM(hsm, nullptr);
+
+        // Time to recall (and handle) the complete backlog
+        double best = 0;
+        for (unsigned int r = 0; r < REPETITIONS; r++) {
+            hsm.dispatch(eDEFER_START, nullptr);
+            for (unsigned int i = 0; i < backlog; i++) hsm.dispatch(eDEFER_PING, nullptr);
+            Stopwatch sw;
+            hsm.dispatch(eDEFER_DONE, nullptr);
+            double ns = sw.elapsedNs();
+            if (r == 0 || ns < best) best = ns;
+        }
+        doNotOptimize(hsm.getDeferredCount());
+
+        report("defer", name, best / backlog, "ns/event");
+    }
+
+    void run_defer_benchmarks()
+    {
+        benchTransitions("transition, empty backlog", 0);
+        benchTransitions("transition, 10k deferred events", BACKLOG);
+        benchNaive("transition, 10k buffered events, re-dispatch all", BACKLOG);
+        benchRecall("recall 10k deferred events", BACKLOG);
+    }
+}
@@ -0,0 +1,137 @@
+/**
+ * @file dispatch_bench.cpp
+ * @brief Dispatch benchmarks on generated machines
+ */
+
+#include <bench.hpp>
+#include <benchmarks.hpp>
+#include <generated/GeneratedHSM.hpp>
+
+namespace microhsm_benchmarks
+{
+    static const unsigned int DISPATCH_COUNT = 2000000;
+    static const unsigned int SEQUENCE_LENGTH = 4096;
+    static const unsigned int REPETITIONS = 5;
+
+    template <typename HSM>
+    static void runDispatch(const char* name, const sGeneratorConfig& config, HSM& hsm)
+    {
+        initHSM(hsm, nullptr);
+
+        Random rnd(config.seed + 1);
+        std::vector<unsigned int> events(SEQUENCE_LENGTH);
+        for (unsigned int& e : events) e = 1 + rnd.below(config.eventCount - 1);
+
+        // Warm-up
+        for (unsigned int e : events) hsm.dispatch(e, nullptr);
+
+        // Report best repetition
+        double best = 0;
+        for (unsigned int r = 0; r < REPETITIONS; r++) {
+            unsigned int ignored = 0;
+            Stopwatch sw;
+            for (unsigned int i = 0; i < DISPATCH_COUNT; i++) {
+                ignored += (hsm.dispatch(events[i % SEQUENCE_LENGTH], nullptr) == microhsm::eEVENT_IGNORED);
+            }
+            double ns = sw.elapsedNs();
+            doNotOptimize(ignored);
+            if (r == 0 || ns < best) best = ns;
+        }
+
+        report("dispatch", name, best / DISPATCH_COUNT, "ns/event");
+    }
+
+    static void benchDispatch(const char* name, const sGeneratorConfig& config)
+    {
+        GeneratedMachine machine(config);
+        GeneratedHSM hsm(machine);
+        runDispatch(name, config, hsm);
+    }
+
+    static void benchDispatchRegistered(const char* name, const sGeneratorConfig& config)
+    {
+        RegisteredGeneratedHSM hsm(config);
+        runDispatch(name, config, hsm);
+    }
+
+    static void benchInState(const char* name, const sGeneratorConfig& config)
+    {
+        GeneratedMachine machine(config);
+        GeneratedHSM hsm(machine);
+        initHSM(hsm, nullptr);
+
+        Random rnd(config.seed + 2);
+        double best = 0;
+        for (unsigned int r = 0; r < REPETITIONS; r++) {
+            unsigned int hits = 0;
+            Stopwatch sw;
+            for (unsigned int i = 0; i < DISPATCH_COUNT; i++) {
+                if ((i & 0xFF) == 0) hsm.dispatch(1 + rnd.below(config.eventCount - 1), nullptr);
+                hits += hsm.inState(i % config.stateCount);
+            }
+            double ns = sw.elapsedNs();
+            doNotOptimize(hits);
+            if (r == 0 || ns < best) best = ns;
+        }
+
+        report("dispatch", name, best / DISPATCH_COUNT, "ns/query");
+    }
+
+    static void benchInAnyState(const char* name, const sGeneratorConfig& config)
+    {
+        GeneratedMachine machine(config);
+        GeneratedHSM hsm(machine);
+        initHSM(hsm, nullptr);
+
+        Random rnd(config.seed + 3);
+        const unsigned int ID_COUNT = 4;
+        double best = 0;
+        for (unsigned int r = 0; r < REPETITIONS; r++) {
+            unsigned int hits = 0;
+            unsigned int ids[ID_COUNT];
+            Stopwatch sw;
+            for (unsigned int i = 0; i < DISPATCH_COUNT; i++) {
+                if ((i & 0xFF) == 0) hsm.dispatch(1 + rnd.below(config.eventCount - 1), nullptr);
+                for (unsigned int k = 0; k < ID_COUNT; k++) ids[k] = (i + (k * 53)) % config.stateCount;
+                hits += hsm.inAnyState(ids, ID_COUNT);
+            }
+            double ns = sw.elapsedNs();
+            doNotOptimize(hits);
+            if (r == 0 || ns < best) best = ns;
+        }
+
+        report("dispatch", name, best / DISPATCH_COUNT, "ns/query");
+    }
+
+    void run_dispatch_benchmarks()
+    {
+        sGeneratorConfig config;
+        config.stateCount = 200;
+        config.maxDepth = 12;
+        config.eventCount = 60;
+        config.transitionsPerState = 3;
+        config.seed = 42;
+        config.chain = false;
+        config.scatter = false;
+        config.declareEvents = false;
+
+        benchDispatch("200 states, depth 12, 60 events", config);
+        benchDispatchRegistered("200 states, depth 12, 60 events, registry", config);
+        benchInState("200 states, depth 12, inState", config);
+        benchInAnyState("200 states, depth 12, inAnyState (4 IDs)", config);
+
+        config.scatter = true;
+        benchDispatch("200 scattered states, depth 12, 60 events", config);
+        benchInState("200 scattered states, depth 12, inState", config);
+
+        config.scatter = false;
+        config.maxDepth = 4;
+        benchDispatch("200 states, depth 4, 60 events", config);
+
+        config.declareEvents = true;
+        benchDispatch("200 states, depth 4, 60 events, event masks", config);
+
+        config.maxDepth = 12;
+        benchDispatch("200 states, depth 12, 60 events, event masks", config);
+    }
+}
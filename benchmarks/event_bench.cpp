@@ -0,0 +1,222 @@
+/**
+ * @file event_bench.cpp
+ * @brief Dispatch of events with payload versus dispatch by ID
+ */
+
+#include <bench.hpp>
+#include <benchmarks.hpp>
+#include <microhsm/microhsm.hpp>
+
+namespace microhsm_benchmarks
+{
+    static const unsigned int DISPATCH_COUNT = 1000000;
+    static const unsigned int REPETITIONS = 3;
+    static const unsigned int QUEUE_CAPACITY = 64;
+
+    enum eEventEvents : unsigned int {
+        eEVENT_SAMPLE = 1,
+    };
+
+    enum eEventStates : unsigned int {
+        eEVENT_LOW = 0,
+        eEVENT_HIGH,
+    };
+
+    /// Sample of 16 bytes, fits inline
+    typedef struct {
+        unsigned int channel;
+        int value;
+        unsigned long long timestamp;
+    } sSample;
+
+    /// Context of the ID-only machine, producer stores the sample before dispatching
+    typedef struct {
+        sSample pending;
+        long long sum;
+    } sSampleCTX;
+
+    static void sumPending(void* ctx)
+    {
+        sSampleCTX* c = static_cast<sSampleCTX*>(ctx);
+        c->sum += c->pending.value;
+    }
+
+    static void sumPayload(void* ctx, const microhsm::Event& event)
+    {
+        static_cast<sSampleCTX*>(ctx)->sum += event.get<sSample>()->value;
+    }
+
+    /// Toggles between low and high when the sign of a sample changes
+    class SampleState : public microhsm::BaseState
+    {
+        public:
+            SampleState(unsigned int id, bool payload) :
+                microhsm::BaseState(id, nullptr, nullptr), payload_(payload) {};
+
+            bool match(unsigned int event, microhsm::sTransition* t, void* ctx) override
+            {
+                if (event != eEVENT_SAMPLE) return noTransition();
+                const sSample* s = this->payload_ ? currentEvent()->get<sSample>() :
+                    &static_cast<sSampleCTX*>(ctx)->pending;
+                const bool high = (s->value >= 0);
+                const unsigned int target = high ? eEVENT_HIGH : eEVENT_LOW;
+                if (this->payload_) {
+                    if (target == ID) return transitionInternal(t, nullptr) && eventEffect(t, sumPayload);
+                    return transitionExternal(target, t, nullptr) && eventEffect(t, sumPayload);
+                }
+                if (target == ID) return transitionInternal(t, sumPending);
+                return transitionExternal(target, t, sumPending);
+            }
+
+        private:
+            bool payload_;
+    };
+
+    class SampleHSM : public microhsm::BaseHSM
+    {
+        public:
+            /// Structure shared by all instances
+            static microhsm::HSMDefinition definition;
+
+            explicit SampleHSM(bool payload) :
+                microhsm::BaseHSM(low, definition), low(eEVENT_LOW, payload), high(eEVENT_HIGH, payload)
+            {
+                this->registerVertices({&low, &high});
+            };
+
+            SampleState low;
+            SampleState high;
+    };
+
+    microhsm::HSMDefinition SampleHSM::definition;
+
+    static sSample makeSample(unsigned int i)
+    {
+        sSample s = {i & 3u, static_cast<int>(i & 0xFFu) - 100, i};
+        return s;
+    }
+
+    static void benchByID(const char* name)
+    {
+        SampleHSM hsm(false);
+        sSampleCTX ctx = {};
+        initHSM(hsm, &ctx);
+
+        double best = 0;
+        for (unsigned int r = 0; r < REPETITIONS; r++) {
+            Stopwatch sw;
+            for (unsigned int i = 0; i < DISPATCH_COUNT; i++) {
+                ctx.pending = makeSample(i);
+                hsm.dispatch(eEVENT_SAMPLE, &ctx);
+            }
+            double ns = sw.elapsedNs();
+            if (r == 0 || ns < best) best = ns;
+        }
+        doNotOptimize(ctx.sum);
+
+        report("event", name, best / DISPATCH_COUNT, "ns/dispatch");
+    }
+
+    static void benchInline(const char* name)
+    {
+        SampleHSM hsm(true);
+        sSampleCTX ctx = {};
+        initHSM(hsm, &ctx);
+
+        double best = 0;
+        for (unsigned int r = 0; r < REPETITIONS; r++) {
+            Stopwatch sw;
+            for (unsigned int i = 0; i < DISPATCH_COUNT; i++) {
+                hsm.dispatch(microhsm::Event(eEVENT_SAMPLE, makeSample(i)), &ctx);
+            }
+            double ns = sw.elapsedNs();
+            if (r == 0 || ns < best) best = ns;
+        }
+        doNotOptimize(ctx.sum);
+
+        report("event", name, best / DISPATCH_COUNT, "ns/dispatch");
+    }
+
+    static void benchExternal(const char* name)
+    {
+        SampleHSM hsm(true);
+        sSampleCTX ctx = {};
+        initHSM(hsm, &ctx);
+        sSample block;
+
+        double best = 0;
+        for (unsigned int r = 0; r < REPETITIONS; r++) {
+            Stopwatch sw;
+            for (unsigned int i = 0; i < DISPATCH_COUNT; i++) {
+                block = makeSample(i);
+                hsm.dispatch(microhsm::Event(eEVENT_SAMPLE, &block, sizeof(block), nullptr), &ctx);
+            }
+            double ns = sw.elapsedNs();
+            if (r == 0 || ns < best) best = ns;
+        }
+        doNotOptimize(ctx.sum);
+
+        report("event", name, best / DISPATCH_COUNT, "ns/dispatch");
+    }
+
+    static void benchIDQueue(const char* name)
+    {
+        // Samples are kept in a separate ring next to the queued IDs
+        SampleHSM hsm(false);
+        sSampleCTX ctx = {};
+        initHSM(hsm, &ctx);
+        microhsm::EventQueue<QUEUE_CAPACITY> queue;
+        sSample samples[QUEUE_CAPACITY];
+
+        double best = 0;
+        for (unsigned int r = 0; r < REPETITIONS; r++) {
+            Stopwatch sw;
+            unsigned int event;
+            for (unsigned int i = 0; i < DISPATCH_COUNT; i++) {
+                samples[i % QUEUE_CAPACITY] = makeSample(i);
+                queue.push(eEVENT_SAMPLE);
+                queue.pop(event);
+                ctx.pending = samples[i % QUEUE_CAPACITY];
+                hsm.dispatch(event, &ctx);
+            }
+            double ns = sw.elapsedNs();
+            if (r == 0 || ns < best) best = ns;
+        }
+        doNotOptimize(ctx.sum);
+
+        report("event", name, best / DISPATCH_COUNT, "ns/event");
+    }
+
+    static void benchPayloadQueue(const char* name)
+    {
+        SampleHSM hsm(true);
+        sSampleCTX ctx = {};
+        initHSM(hsm, &ctx);
+        microhsm::PayloadQueue<QUEUE_CAPACITY> queue;
+
+        double best = 0;
+        for (unsigned int r = 0; r < REPETITIONS; r++) {
+            Stopwatch sw;
+            microhsm::Event event;
+            for (unsigned int i = 0; i < DISPATCH_COUNT; i++) {
+                queue.push(microhsm::Event(eEVENT_SAMPLE, makeSample(i)));
+                queue.pop(event);
+                hsm.dispatch(event, &ctx);
+            }
+            double ns = sw.elapsedNs();
+            if (r == 0 || ns < best) best = ns;
+        }
+        doNotOptimize(ctx.sum);
+
+        report("event", name, best / DISPATCH_COUNT, "ns/event");
+    }
+
+    void run_event_benchmarks()
+    {
+        benchByID("dispatch ID, payload stored in context");
+        benchInline("dispatch event, inline payload");
+        benchExternal("dispatch event, external payload");
+        benchIDQueue("queue ID, payload stored next to queue");
+        benchPayloadQueue("queue event, inline payload moved");
+    }
+}
@@ -0,0 +1,166 @@
+/**
+ * @file flyweight_bench.cpp
+ * @brief Memory footprint of many instances of the same machine
+ */
+
+#include <bench.hpp>
+#include <benchmarks.hpp>
+#include <microhsm/microhsm.hpp>
+
+namespace microhsm_benchmarks
+{
+    static const unsigned int INSTANCE_COUNT = 1000000;
+    static const unsigned int EVENT_COUNT = 4000000;
+    static const unsigned int REPETITIONS = 3;
+
+    /// Valve: Idle, Running(Closed, Open) with shallow history of Running
+    enum eValveIDs : unsigned int {
+        eVALVE_IDLE = 0,
+        eVALVE_RUNNING,
+        eVALVE_CLOSED,
+        eVALVE_OPEN,
+        eVALVE_HISTORY,
+        eVALVE_COUNT
+    };
+
+    enum eValveEvents : unsigned int {
+        eVALVE_START = 1,
+        eVALVE_PAUSE,
+        eVALVE_TICK,
+        eVALVE_EVENT_COUNT
+    };
+
+    /* --- Valve built from `BaseState` objects --- */
+
+    class ValveIdle : public microhsm::BaseState
+    {
+        public:
+            ValveIdle() : microhsm::BaseState(eVALVE_IDLE, nullptr, nullptr) {};
+
+            bool match(unsigned int event, microhsm::sTransition* t, void* ctx) override
+            {
+                (void)ctx;
+                if (event == eVALVE_START) return transitionExternal(eVALVE_HISTORY, t, nullptr);
+                return noTransition();
+            }
+    };
+
+    class ValveRunning : public microhsm::BaseState
+    {
+        public:
+            ValveRunning(microhsm::BaseState* initialState, microhsm::ShallowHistory* history) :
+                microhsm::BaseState(eVALVE_RUNNING, nullptr, initialState, history, nullptr) {};
+
+            bool match(unsigned int event, microhsm::sTransition* t, void* ctx) override
+            {
+                (void)ctx;
+                if (event == eVALVE_PAUSE) return transitionExternal(eVALVE_IDLE, t, nullptr);
+                return noTransition();
+            }
+    };
+
+    class ValveLeaf : public microhsm::BaseState
+    {
+        public:
+            ValveLeaf(unsigned int id, microhsm::BaseState* parentState, unsigned int next) :
+                microhsm::BaseState(id, parentState, nullptr), next_(next) {};
+
+            bool match(unsigned int event, microhsm::sTransition* t, void* ctx) override
+            {
+                (void)ctx;
+                if (event == eVALVE_TICK) return transitionExternal(next_, t, nullptr);
+                return noTransition();
+            }
+
+        private:
+            const unsigned int next_;
+    };
+
+    class ValveHSM : public microhsm::BaseHSM
+    {
+        public:
+            /// Structure shared by all instances
+            static microhsm::HSMDefinition definition;
+
+            ValveHSM() : microhsm::BaseHSM(idle, definition)
+            {
+                this->registerVertices({&idle, &history, &running, &closed, &open});
+            };
+
+            ValveIdle idle;
+            microhsm::ShallowHistory history = microhsm::ShallowHistory(eVALVE_HISTORY);
+            ValveRunning running = ValveRunning(&closed, &history);
+            ValveLeaf closed = ValveLeaf(eVALVE_CLOSED, &running, eVALVE_OPEN);
+            ValveLeaf open = ValveLeaf(eVALVE_OPEN, &running, eVALVE_CLOSED);
+    };
+
+    microhsm::HSMDefinition ValveHSM::definition;
+
+    /* --- Valve declared as constant data --- */
+
+    static const microhsm::sStaticVertex valveVertices[eVALVE_COUNT] = {
+        microhsm::staticState(VERTEX_NONE, VERTEX_NONE),            // eVALVE_IDLE
+        microhsm::staticState(VERTEX_NONE, eVALVE_CLOSED),          // eVALVE_RUNNING
+        microhsm::staticState(eVALVE_RUNNING, VERTEX_NONE),         // eVALVE_CLOSED
+        microhsm::staticState(eVALVE_RUNNING, VERTEX_NONE),         // eVALVE_OPEN
+        microhsm::staticShallowHistory(eVALVE_RUNNING),             // eVALVE_HISTORY
+    };
+
+    static const microhsm::sStaticTransition valveTransitions[4] = {
+        microhsm::staticExternal(eVALVE_IDLE, eVALVE_START, eVALVE_HISTORY),
+        microhsm::staticExternal(eVALVE_RUNNING, eVALVE_PAUSE, eVALVE_IDLE),
+        microhsm::staticExternal(eVALVE_CLOSED, eVALVE_TICK, eVALVE_OPEN),
+        microhsm::staticExternal(eVALVE_OPEN, eVALVE_TICK, eVALVE_CLOSED),
+    };
+
+    typedef microhsm::StaticHSM<eVALVE_COUNT, eVALVE_EVENT_COUNT, 4> StaticValveHSM;
+    typedef microhsm::StaticInstance<1> ValveInstance;
+
+    static microhsm::StaticDefinition<eVALVE_COUNT, eVALVE_EVENT_COUNT, 4> valveDefinition(
+            valveVertices, valveTransitions, eVALVE_IDLE);
+    static ValveInstance valves[INSTANCE_COUNT];
+
+    static void reportFootprint(const char* name, double bytes)
+    {
+        report("flyweight", name, bytes * INSTANCE_COUNT / (1024.0 * 1024.0), "MiB");
+    }
+
+    static void benchDispatch(const char* name, unsigned int instances)
+    {
+        static const unsigned int events[] = {eVALVE_START, eVALVE_TICK, eVALVE_TICK, eVALVE_PAUSE};
+        for (unsigned int i = 0; i < instances; i++) {
+            valveDefinition.start(valves[i], nullptr);
+        }
+
+        double best = 0;
+        for (unsigned int r = 0; r < REPETITIONS; r++) {
+            Random random(7);
+            Stopwatch sw;
+            for (unsigned int n = 0; n < EVENT_COUNT; n++) {
+                const unsigned int i = random.below(instances);
+                doNotOptimize(valveDefinition.dispatch(valves[i], events[n & 3]));
+            }
+            double ns = sw.elapsedNs();
+            if (r == 0 || ns < best) best = ns;
+        }
+
+        report("flyweight", name, best / EVENT_COUNT, "ns/event");
+    }
+
+    void run_flyweight_benchmarks()
+    {
+        checkInit(valveDefinition.init());
+
+        report("flyweight", "BaseHSM valve (benchmark configuration)", sizeof(ValveHSM), "bytes/instance");
+        report("flyweight", "HSMDefinition valve (shared)", sizeof(ValveHSM::definition), "bytes");
+        report("flyweight", "StaticHSM valve", sizeof(StaticValveHSM), "bytes/instance");
+        report("flyweight", "StaticInstance valve", sizeof(ValveInstance), "bytes/instance");
+        report("flyweight", "StaticDefinition valve (shared)", sizeof(valveDefinition), "bytes");
+        reportFootprint("1M BaseHSM valves", sizeof(ValveHSM));
+        reportFootprint("1M StaticHSM valves", sizeof(StaticValveHSM));
+        reportFootprint("1M StaticInstance valves", sizeof(ValveInstance));
+
+        benchDispatch("1 instance, dispatch", 1);
+        benchDispatch("1M instances, dispatch to random instance", INSTANCE_COUNT);
+    }
+}
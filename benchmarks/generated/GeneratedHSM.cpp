@@ -0,0 +1,115 @@
+/**
+ * @file GeneratedHSM.cpp
+ * @brief Randomly generated HSMs used for benchmarking
+ */
+
+#include <generated/GeneratedHSM.hpp>
+#include <bench.hpp>
+
+#include <new>
+#include <utility>
+
+namespace microhsm_benchmarks
+{
+    /// Memory reserved for every state of a scattered machine
+    static const size_t SCATTER_SLOT_SIZE = 4096;
+
+    bool GeneratedState::match(unsigned int event, microhsm::sTransition* t, void* ctx)
+    {
+        (void)ctx;
+        for (const sGeneratedTransition& tr : transitions) {
+            if (tr.event == event) return transitionExternal(tr.target, t, nullptr);
+        }
+        return noTransition();
+    }
+
+    microhsm::tEventMask GeneratedState::handledEvents(void)
+    {
+        if (!declareEvents) return EVENT_MASK_ALL;
+        microhsm::tEventMask mask = 0;
+        for (const sGeneratedTransition& tr : transitions) {
+            mask |= microhsm::eventBit(tr.event);
+        }
+        return mask;
+    }
+
+    GeneratedMachine::GeneratedMachine(const sGeneratorConfig& config) :
+        config_(config)
+    {
+        const unsigned int n = config.stateCount;
+        const unsigned int none = n;
+        Random rnd(config.seed);
+
+        std::vector<unsigned int> depth(n, 0);
+        std::vector<unsigned int> initial(n, none);
+        parents.assign(n, none);
+
+        // Generate hierarchy, parents always have a lower ID than their children
+        for (unsigned int i = 1; i < n; i++) {
+            if (config.chain) {
+                // Spine of nested states, remaining states are leaves of the deepest spine state
+                parents[i] = (i + 1 < config.maxDepth) ? i - 1 : config.maxDepth - 2;
+            }
+            else if (rnd.below(8) != 0) {
+                unsigned int p = rnd.below(i);
+                while (depth[p] + 1 >= config.maxDepth) p = parents[p];
+                parents[i] = p;
+            }
+            if (parents[i] != none) {
+                depth[i] = depth[parents[i]] + 1;
+                if (initial[parents[i]] == none) initial[parents[i]] = i;
+            }
+            if (depth[i] + 1 > maxDepth_) maxDepth_ = depth[i] + 1;
+        }
+
+        // Reserve a slot for every state, scattered states get a page each
+        const size_t slot = config.scatter ? SCATTER_SLOT_SIZE : sizeof(GeneratedState);
+        storage_ = ::operator new(slot * n);
+        std::vector<unsigned int> order(n);
+        for (unsigned int i = 0; i < n; i++) order[i] = i;
+        if (config.scatter) {
+            for (unsigned int i = n - 1; i > 0; i--) std::swap(order[i], order[rnd.below(i + 1)]);
+        }
+        states_.resize(n);
+        for (unsigned int i = 0; i < n; i++) {
+            states_[i] = reinterpret_cast<GeneratedState*>(static_cast<char*>(storage_) + (slot * order[i]));
+        }
+
+        // Construct states in order, such that parents exist before their children
+        for (unsigned int i = 0; i < n; i++) {
+            GeneratedState* parent = (parents[i] == none) ? nullptr : states_[parents[i]];
+            GeneratedState* init = (initial[i] == none) ? nullptr : states_[initial[i]];
+            new (states_[i]) GeneratedState(i, parent, init);
+        }
+
+        // Generate transitions between arbitrary states
+        for (unsigned int i = 0; i < n; i++) {
+            states_[i]->declareEvents = config.declareEvents;
+            for (unsigned int k = 0; k < config.transitionsPerState; k++) {
+                sGeneratedTransition t;
+                t.event = 1 + rnd.below(config.eventCount - 1);
+                t.target = rnd.below(n);
+                states_[i]->transitions.push_back(t);
+            }
+        }
+    }
+
+    GeneratedMachine::~GeneratedMachine()
+    {
+        for (unsigned int i = 0; i < config_.stateCount; i++) {
+            states_[i]->~GeneratedState();
+        }
+        ::operator delete(storage_);
+    }
+
+    microhsm::Vertex* GeneratedHSM::getVertex(unsigned int ID)
+    {
+        if (ID >= machine_.stateCount()) return nullptr;
+        return machine_.state(ID);
+    }
+
+    unsigned int GeneratedHSM::getMaxID()
+    {
+        return machine_.stateCount() - 1;
+    }
+}
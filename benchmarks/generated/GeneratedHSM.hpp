@@ -0,0 +1,112 @@
+/**
+ * @file GeneratedHSM.hpp
+ * @brief Randomly generated HSMs used for benchmarking
+ */
+#ifndef _H_MICROHSM_BENCHMARKS_GENERATEDHSM
+#define _H_MICROHSM_BENCHMARKS_GENERATEDHSM
+
+#include <microhsm/microhsm.hpp>
+
+#include <vector>
+
+namespace microhsm_benchmarks
+{
+    /// Shape of a generated machine
+    typedef struct {
+        unsigned int stateCount;            ///< Number of states
+        unsigned int maxDepth;              ///< Maximum nesting level
+        unsigned int eventCount;            ///< Number of events (including anonymous)
+        unsigned int transitionsPerState;   ///< Number of transitions of every state
+        unsigned int seed;                  ///< Random seed
+        bool chain;                         ///< Generate a single chain of `maxDepth` states with leaves
+        bool scatter;                       ///< Place every state on its own page in random order
+        bool declareEvents;                 ///< States declare their handled events
+    } sGeneratorConfig;
+
+    /// Transition of a generated state
+    typedef struct {
+        unsigned int event;
+        unsigned int target;
+    } sGeneratedTransition;
+
+    /// State of a generated machine
+    class GeneratedState : public microhsm::BaseState
+    {
+        public:
+            GeneratedState(unsigned int id, microhsm::BaseState* parentState, microhsm::BaseState* initialState) :
+                microhsm::BaseState(id, parentState, initialState) {};
+
+            bool match(unsigned int event, microhsm::sTransition* t, void* ctx) override;
+            microhsm::tEventMask handledEvents(void) override;
+
+            std::vector<sGeneratedTransition> transitions;
+            bool declareEvents = false;
+    };
+
+    /// Generated hierarchy, states are owned by the machine
+    class GeneratedMachine
+    {
+        public:
+            explicit GeneratedMachine(const sGeneratorConfig& config);
+            ~GeneratedMachine();
+
+            GeneratedMachine(const GeneratedMachine&) = delete;
+            GeneratedMachine& operator=(const GeneratedMachine&) = delete;
+
+            GeneratedState* state(unsigned int id) {return states_[id];}
+            unsigned int stateCount() const {return config_.stateCount;}
+            unsigned int eventCount() const {return config_.eventCount;}
+            unsigned int maxDepth() const {return maxDepth_;}
+
+            /// Top-level initial state of the machine
+            GeneratedState& initial() {return *states_[0];}
+
+            /// Parent ID of every state (`stateCount` if top-level)
+            std::vector<unsigned int> parents;
+
+        private:
+            sGeneratorConfig config_;
+            void* storage_;
+            std::vector<GeneratedState*> states_;
+            unsigned int maxDepth_ = 0;
+    };
+
+    /**
+     * HSM running a generated machine. States of the machine live outside
+     * the HSM, such that every instance has its own definition.
+     */
+    class GeneratedHSM : public microhsm::BaseHSM
+    {
+        public:
+            explicit GeneratedHSM(GeneratedMachine& machine) :
+                microhsm::BaseHSM(machine.initial(), definition_), machine_(machine) {};
+
+            microhsm::Vertex* getVertex(unsigned int ID) override;
+            unsigned int getMaxID(void) override;
+
+        private:
+            GeneratedMachine& machine_;
+            microhsm::HSMDefinition definition_;
+    };
+
+    /**
+     * HSM owning a generated machine. States are registered with the HSM,
+     * such that IDs are resolved without `getVertex`.
+     */
+    class RegisteredGeneratedHSM : private GeneratedMachine, public microhsm::BaseHSM
+    {
+        public:
+            explicit RegisteredGeneratedHSM(const sGeneratorConfig& config) :
+                GeneratedMachine(config), microhsm::BaseHSM(GeneratedMachine::initial(), definition_)
+            {
+                for (unsigned int i = 0; i < GeneratedMachine::stateCount(); i++) {
+                    this->registerVertex(GeneratedMachine::state(i));
+                }
+            };
+
+        private:
+            microhsm::HSMDefinition definition_;
+    };
+}
+
+#endif
@@ -0,0 +1,162 @@
+/**
+ * @file journal_bench.cpp
+ * @brief Event journal and deterministic replay on generated machines
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <bench.hpp>
+#include <benchmarks.hpp>
+#include <generated/GeneratedHSM.hpp>
+#include <microhsm/microhsm.hpp>
+
+namespace microhsm_benchmarks
+{
+    static const unsigned int INSTANCE_COUNT = 4;
+    static const unsigned int EVENT_COUNT = 4000000;
+    static const unsigned int REPETITIONS = 3;
+    static const unsigned int JOURNAL_BUFFER_SIZE = 64 * 1024;
+
+    /// Journal file kept in memory, written by the commit callback
+    typedef struct {
+        uint8_t data[(EVENT_COUNT + INSTANCE_COUNT) * (JOURNAL_RECORD_HEADER_SIZE + 8u)];
+        unsigned long length;
+    } sJournalFile;
+
+    static sJournalFile file;
+
+    static bool writeFile(void* ctx, const uint8_t* data, unsigned int size)
+    {
+        sJournalFile* f = static_cast<sJournalFile*>(ctx);
+        if (f->length + size > sizeof(f->data)) return false;
+        memcpy(f->data + f->length, data, size);
+        f->length += size;
+        return true;
+    }
+
+    /// Instances of a generated machine, every instance owns its states
+    class Instances
+    {
+        public:
+            explicit Instances(const sGeneratorConfig& config)
+            {
+                for (unsigned int i = 0; i < INSTANCE_COUNT; i++) {
+                    machines_[i] = new GeneratedMachine(config);
+                    hsms_[i] = new GeneratedHSM(*machines_[i]);
+                }
+            }
+
+            ~Instances()
+            {
+                for (unsigned int i = 0; i < INSTANCE_COUNT; i++) {
+                    delete hsms_[i];
+                    delete machines_[i];
+                }
+            }
+
+            void init()
+            {
+                for (unsigned int i = 0; i < INSTANCE_COUNT; i++) initHSM(*hsms_[i], nullptr);
+            }
+
+            microhsm::BaseHSM* const* hsms() const {return hsms_;}
+            microhsm::BaseHSM& operator[](unsigned int i) {return *hsms_[i];}
+
+        private:
+            GeneratedMachine* machines_[INSTANCE_COUNT];
+            microhsm::BaseHSM* hsms_[INSTANCE_COUNT];
+    };
+
+    static void benchJournal(const char* name, const sGeneratorConfig& config)
+    {
+        Instances source(config);
+        Instances target(config);
+
+        Random rnd(config.seed + 1);
+        std::vector<unsigned int> instances(EVENT_COUNT);
+        std::vector<unsigned int> events(EVENT_COUNT);
+        for (unsigned int i = 0; i < EVENT_COUNT; i++) {
+            instances[i] = rnd.below(INSTANCE_COUNT);
+            events[i] = 1 + rnd.below(config.eventCount - 1);
+        }
+
+        // Dispatch without journal
+        double plain = 0;
+        for (unsigned int r = 0; r < REPETITIONS; r++) {
+            source.init();
+            Stopwatch sw;
+            for (unsigned int i = 0; i < EVENT_COUNT; i++) {
+                source[instances[i]].dispatch(events[i], nullptr);
+            }
+            double ns = sw.elapsedNs();
+            if (r == 0 || ns < plain) plain = ns;
+        }
+
+        // Dispatch with journal, group commits into the in-memory file
+        double journaled = 0;
+        for (unsigned int r = 0; r < REPETITIONS; r++) {
+            microhsm::EventJournal<JOURNAL_BUFFER_SIZE> journal(writeFile, &file);
+            file.length = 0;
+            source.init();
+            for (unsigned int i = 0; i < INSTANCE_COUNT; i++) source[i].attachJournal(&journal, i);
+
+            Stopwatch sw;
+            for (unsigned int i = 0; i < EVENT_COUNT; i++) {
+                source[instances[i]].dispatch(events[i], nullptr);
+            }
+            journal.commit();
+            double ns = sw.elapsedNs();
+            if (r == 0 || ns < journaled) journaled = ns;
+
+            // Final configuration of every instance is verified by replay
+            for (unsigned int i = 0; i < INSTANCE_COUNT; i++) {
+                journal.checkpoint(i, source[i]);
+                source[i].attachJournal(nullptr, 0);
+            }
+            journal.commit();
+        }
+        report("journal", name, plain / EVENT_COUNT, "ns/event, no journal");
+        report("journal", name, journaled / EVENT_COUNT, "ns/event, journaled");
+        report("journal", name, static_cast<double>(file.length) / EVENT_COUNT, "bytes/event");
+
+        for (unsigned int suppress = 0; suppress < 2; suppress++) {
+            double best = 0;
+            microhsm::eReplayStatus status = microhsm::eREPLAY_OK;
+            for (unsigned int r = 0; r < REPETITIONS; r++) {
+                target.init();
+                microhsm::JournalReplay replay(target.hsms(), nullptr, INSTANCE_COUNT);
+                replay.suppressBehavior(suppress != 0);
+
+                Stopwatch sw;
+                status = replay.replay(file.data, file.length);
+                double ns = sw.elapsedNs();
+                if (replay.getCheckpoints() != INSTANCE_COUNT) status = microhsm::eREPLAY_MISMATCH;
+                if (r == 0 || ns < best) best = ns;
+            }
+            report("journal", name, EVENT_COUNT * 1e3 / best,
+                    (suppress != 0) ? "M events/s, replay without behavior" : "M events/s, replay");
+            report("journal", name, (status == microhsm::eREPLAY_OK) ? 1 : 0, "verified");
+        }
+    }
+
+    void run_journal_benchmarks()
+    {
+        sGeneratorConfig config;
+        config.stateCount = 200;
+        config.maxDepth = 4;
+        config.eventCount = 60;
+        config.transitionsPerState = 3;
+        config.seed = 42;
+        config.chain = false;
+        config.scatter = false;
+        config.declareEvents = true;
+        benchJournal("4x 200 states, depth 4", config);
+
+        config.stateCount = 16;
+        config.maxDepth = 3;
+        config.eventCount = 8;
+        config.transitionsPerState = 2;
+        benchJournal("4x 16 states, depth 3", config);
+    }
+}
@@ -0,0 +1,80 @@
+/**
+ * @file lca_bench.cpp
+ * @brief Least common ancestor lookup for increasing hierarchy depths
+ */
+
+#include <bench.hpp>
+#include <benchmarks.hpp>
+#include <generated/GeneratedHSM.hpp>
+
+#include <cstdio>
+
+namespace microhsm_benchmarks
+{
+    static const unsigned int QUERY_COUNT = 2000000;
+    static const unsigned int PAIR_COUNT = 4096;
+    static const unsigned int REPETITIONS = 5;
+    static const unsigned int STATE_COUNT = 128;
+
+    typedef struct {
+        microhsm::eLCAStrategy strategy;
+        const char* name;
+    } sStrategy;
+
+    static const sStrategy strategies[] = {
+        {microhsm::eLCA_WALK, "walk"},
+        {microhsm::eLCA_MATRIX, "matrix"},
+        {microhsm::eLCA_LIFTING, "lifting"},
+    };
+
+    static double benchLookup(GeneratedHSM& hsm, const std::vector<unsigned int>& pairs)
+    {
+        double best = 0;
+        for (unsigned int r = 0; r < REPETITIONS; r++) {
+            unsigned int found = 0;
+            Stopwatch sw;
+            for (unsigned int i = 0; i < QUERY_COUNT; i++) {
+                unsigned int p = (i % PAIR_COUNT) * 2;
+                found += (hsm.getCommonAncestor(pairs[p], pairs[p + 1]) != nullptr);
+            }
+            double ns = sw.elapsedNs();
+            doNotOptimize(found);
+            if (r == 0 || ns < best) best = ns;
+        }
+        return best / QUERY_COUNT;
+    }
+
+    void run_lca_benchmarks()
+    {
+        sGeneratorConfig config;
+        config.stateCount = STATE_COUNT;
+        config.eventCount = 8;
+        config.transitionsPerState = 1;
+        config.seed = 7;
+        config.chain = true;
+        config.scatter = false;
+        config.declareEvents = false;
+
+        for (unsigned int depth = 2; depth <= 64; depth *= 2) {
+            config.maxDepth = depth;
+            GeneratedMachine machine(config);
+            GeneratedHSM hsm(machine);
+            initHSM(hsm, nullptr);
+
+            // Pairs of states, half of them on the spine of the hierarchy
+            Random rnd(config.seed);
+            const unsigned int spine = depth - 1;
+            std::vector<unsigned int> pairs(PAIR_COUNT * 2);
+            for (unsigned int& id : pairs) {
+                id = rnd.below(2) ? rnd.below(spine) : spine + rnd.below(STATE_COUNT - spine);
+            }
+
+            for (const sStrategy& s : strategies) {
+                hsm.setLCAStrategy(s.strategy);
+                char name[64];
+                std::snprintf(name, sizeof(name), "%u states, depth %u, %s", STATE_COUNT, depth, s.name);
+                report("lca", name, benchLookup(hsm, pairs), "ns/query");
+            }
+        }
+    }
+}
@@ -0,0 +1,33 @@
+#ifndef MICROHSM_BENCHMARKS_CUSTOM_CONFIG
+#define MICROHSM_BENCHMARKS_CUSTOM_CONFIG
+
+/*
+ * Configuration used for benchmarking.
+ * Assertions and tracing are disabled, tables are sized
+ * to fit the generated machines.
+ */
+
+#define MICROHSM_ASSERTIONS 0
+#define MICROHSM_TRACING 0
+
+#define MICROHSM_MAX_STATES 256
+#define MICROHSM_MAX_DEPTH 64
+
+#define MICROHSM_LCA_ACCELERATION 1
+#define MICROHSM_LCA_MATRIX_SIZE 128
+
+// Room for a backlog of 10k deferred events
+#define MICROHSM_DEFER_QUEUE_SIZE 16384
+// Every benchmark HSM shares a definition and attaches its own defer queue
+#define MICROHSM_INSTANCE_STORAGE 0
+
+// Producers of full queues yield to the consumer
+#include <thread>
+#define MICROHSM_QUEUE_WAIT() std::this_thread::yield()
+
+// Scheduling latency of active objects in nanoseconds
+#include <chrono>
+#define MICROHSM_RUNTIME_CLOCK() static_cast<unsigned long>(std::chrono::duration_cast<std::chrono::nanoseconds>( \
+    std::chrono::steady_clock::now().time_since_epoch()).count())
+
+#endif
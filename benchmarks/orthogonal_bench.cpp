@@ -0,0 +1,251 @@
+/**
+ * @file orthogonal_bench.cpp
+ * @brief Event dispatching to orthogonal regions
+ */
+
+#include <stdio.h>
+#include <atomic>
+#include <thread>
+
+#include <bench.hpp>
+#include <benchmarks.hpp>
+#include <microhsm/microhsm.hpp>
+
+namespace microhsm_benchmarks
+{
+    static const unsigned int MAX_REGIONS = 32;
+    static const unsigned int EVENT_COUNT = 400000;
+    static const unsigned int REPETITIONS = 3;
+
+    /// Event handled by every region, region `r` handles its own event `r + 1`
+    static const unsigned int BROADCAST = MAX_REGIONS + 1;
+    /// Event handled by every region with an expensive effect
+    static const unsigned int EVALUATE = MAX_REGIONS + 2;
+
+    /// Regions and events of the parallel dispatch benchmark
+    static const unsigned int PARALLEL_REGIONS = 4;
+    static const unsigned int PARALLEL_EVENTS = 2000;
+    /// Iterations of the effect of `EVALUATE` (in the order of 10 us)
+    static const unsigned int EVALUATE_ITERATIONS = 20000;
+
+    /// Stands in for a model evaluation inside a transition effect
+    static void evaluate(void* ctx)
+    {
+        (void)ctx;
+        uint32_t x = 1;
+        for (unsigned int i = 0; i < EVALUATE_ITERATIONS; i++) {
+            x = (x * 1664525u) + 1013904223u;
+            doNotOptimize(x);
+        }
+    }
+
+    /// Toggles between its two states on its own event, counts broadcasts
+    class ToggleState : public microhsm::BaseState
+    {
+        public:
+            ToggleState(unsigned int id, unsigned int target) :
+                microhsm::BaseState(id, nullptr, nullptr), target_(target), event_(0) {};
+
+            bool match(unsigned int event, microhsm::sTransition* t, void* ctx) override
+            {
+                (void)ctx;
+                if (event == this->event_) return transitionExternal(this->target_, t, nullptr);
+                if (event == BROADCAST) return transitionInternal(t, nullptr);
+                if (event == EVALUATE) return transitionInternal(t, evaluate);
+                return noTransition();
+            }
+
+            microhsm::tEventMask handledEvents(void) override
+            {
+                return microhsm::eventMask(this->event_, BROADCAST, EVALUATE);
+            }
+
+            /// Event of the region the state belongs to
+            void setEvent(unsigned int event)
+            {
+                this->event_ = event;
+            }
+
+        private:
+            const unsigned int target_;
+            unsigned int event_;
+    };
+
+    /// Every region handles its own event, such that every region has its own definition
+    class ToggleHSM : public microhsm::BaseHSM
+    {
+        public:
+            ToggleHSM() : microhsm::BaseHSM(first, definition_)
+            {
+                this->registerVertices({&first, &second});
+            };
+
+            void setEvent(unsigned int event)
+            {
+                this->first.setEvent(event);
+                this->second.setEvent(event);
+            }
+
+            ToggleState first = ToggleState(0, 1);
+            ToggleState second = ToggleState(1, 0);
+
+        private:
+            microhsm::HSMDefinition definition_;
+    };
+
+    template <unsigned int REGIONS>
+    class RegionsState : public microhsm::OrthogonalState<REGIONS>
+    {
+        public:
+            explicit RegionsState(microhsm::BaseHSM* const (&regions)[REGIONS]) :
+                microhsm::OrthogonalState<REGIONS>(0, nullptr, regions) {};
+
+            bool match(unsigned int event, microhsm::sTransition* t, void* ctx) override
+            {
+                (void)event;
+                (void)t;
+                (void)ctx;
+                return this->noTransition();
+            }
+
+            microhsm::tEventMask handledEvents(void) override
+            {
+                return 0;
+            }
+    };
+
+    template <unsigned int REGIONS>
+    class RegionsHSM : public microhsm::BaseHSM
+    {
+        public:
+            /// Structure shared by all instances
+            static microhsm::HSMDefinition definition;
+
+            explicit RegionsHSM(microhsm::BaseHSM* const (&regions)[REGIONS]) :
+                microhsm::BaseHSM(state, definition), state(regions)
+            {
+                this->registerVertices({&state});
+            };
+
+            RegionsState<REGIONS> state;
+    };
+
+    template <unsigned int REGIONS>
+    microhsm::HSMDefinition RegionsHSM<REGIONS>::definition;
+
+    // Regions are constructed before the HSMs owning them (`HSMDefinition` is large with the benchmark configuration)
+    static ToggleHSM regions[MAX_REGIONS];
+    static ToggleHSM parallelRegions[PARALLEL_REGIONS];
+
+    template <unsigned int REGIONS>
+    static void benchRegions(void)
+    {
+        microhsm::BaseHSM* list[REGIONS];
+        for (unsigned int r = 0; r < REGIONS; r++) {
+            regions[r].setEvent(r + 1);
+            list[r] = &regions[r];
+        }
+        static RegionsHSM<REGIONS> hsm(list);
+        initHSM(hsm, nullptr);
+
+        char name[64];
+        double targeted = 0;
+        double broadcast = 0;
+        double separate = 0;
+        for (unsigned int rep = 0; rep < REPETITIONS; rep++) {
+            Random random(3);
+
+            // Orthogonal state, event handled by a single region
+            Stopwatch targetedSw;
+            for (unsigned int n = 0; n < EVENT_COUNT; n++) {
+                doNotOptimize(hsm.dispatch(random.below(REGIONS) + 1, nullptr));
+            }
+            double ns = targetedSw.elapsedNs();
+            if (rep == 0 || ns < targeted) targeted = ns;
+
+            // Orthogonal state, event handled by every region
+            Stopwatch broadcastSw;
+            for (unsigned int n = 0; n < EVENT_COUNT; n++) {
+                doNotOptimize(hsm.dispatch(BROADCAST, nullptr));
+            }
+            ns = broadcastSw.elapsedNs();
+            if (rep == 0 || ns < broadcast) broadcast = ns;
+
+            // Separate machines, every event is routed to all of them
+            Stopwatch separateSw;
+            for (unsigned int n = 0; n < EVENT_COUNT; n++) {
+                const unsigned int event = random.below(REGIONS) + 1;
+                for (unsigned int r = 0; r < REGIONS; r++) {
+                    doNotOptimize(regions[r].dispatch(event, nullptr));
+                }
+            }
+            ns = separateSw.elapsedNs();
+            if (rep == 0 || ns < separate) separate = ns;
+        }
+
+        snprintf(name, sizeof(name), "%u regions, event of one region", REGIONS);
+        report("orthogonal", name, targeted / EVENT_COUNT, "ns/event");
+        snprintf(name, sizeof(name), "%u regions, event of all regions", REGIONS);
+        report("orthogonal", name, broadcast / EVENT_COUNT, "ns/event");
+        snprintf(name, sizeof(name), "%u separate HSMs, event routed to all", REGIONS);
+        report("orthogonal", name, separate / EVENT_COUNT, "ns/event");
+    }
+
+    static double benchEvaluate(microhsm::BaseHSM& hsm)
+    {
+        double best = 0;
+        for (unsigned int rep = 0; rep < REPETITIONS; rep++) {
+            Stopwatch sw;
+            for (unsigned int n = 0; n < PARALLEL_EVENTS; n++) {
+                doNotOptimize(hsm.dispatch(EVALUATE, nullptr));
+            }
+            double ns = sw.elapsedNs();
+            if (rep == 0 || ns < best) best = ns;
+        }
+        return best / PARALLEL_EVENTS;
+    }
+
+    static void benchParallel(void)
+    {
+        microhsm::BaseHSM* list[PARALLEL_REGIONS];
+        for (unsigned int r = 0; r < PARALLEL_REGIONS; r++) {
+            parallelRegions[r].setEvent(r + 1);
+            list[r] = &parallelRegions[r];
+        }
+        static RegionsHSM<PARALLEL_REGIONS> hsm(list);
+        initHSM(hsm, nullptr);
+
+        const double sequential = benchEvaluate(hsm);
+
+        // Dispatching thread takes part, one worker less than there are cores (at least one)
+        const unsigned int cores = std::thread::hardware_concurrency();
+        const unsigned int workers = (cores > PARALLEL_REGIONS) ? PARALLEL_REGIONS - 1 : ((cores > 1) ? cores - 1 : 1);
+        microhsm::RegionExecutor executor;
+        std::atomic<bool> stop(false);
+        std::thread threads[PARALLEL_REGIONS];
+        for (unsigned int w = 0; w < workers; w++) {
+            threads[w] = std::thread([&executor, &stop]() {executor.runWorker(stop);});
+        }
+        hsm.state.setExecutor(&executor, (1u << PARALLEL_REGIONS) - 1u);
+        const double parallel = benchEvaluate(hsm);
+        stop.store(true);
+        for (unsigned int w = 0; w < workers; w++) {
+            threads[w].join();
+        }
+        hsm.state.setExecutor(nullptr, 0);
+
+        char name[64];
+        report("orthogonal", "4 regions, expensive effects, sequential", sequential, "ns/event");
+        snprintf(name, sizeof(name), "4 regions, expensive effects, %u workers", workers);
+        report("orthogonal", name, parallel, "ns/event");
+        report("orthogonal", "parallel speedup", sequential / parallel, "x");
+    }
+
+    void run_orthogonal_benchmarks()
+    {
+        benchRegions<2>();
+        benchRegions<8>();
+        benchRegions<32>();
+        benchParallel();
+    }
+}
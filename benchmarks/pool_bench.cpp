@@ -0,0 +1,169 @@
+/**
+ * @file pool_bench.cpp
+ * @brief Fan-out of large events to many HSMs, copied versus reference-counted
+ */
+
+#include <cstdlib>
+#include <cstring>
+
+#include <bench.hpp>
+#include <benchmarks.hpp>
+#include <microhsm/microhsm.hpp>
+
+namespace microhsm_benchmarks
+{
+    static const unsigned int FRAME_SIZE = 2048;
+    static const unsigned int CONSUMERS = 32;
+    static const unsigned int FRAME_COUNT = 5000;
+    static const unsigned int ALLOCATION_COUNT = 1000000;
+    static const unsigned int REPETITIONS = 3;
+
+    enum ePoolEvents : unsigned int {
+        ePOOL_FRAME = 1,
+    };
+
+    /// Sums the first word of every received frame
+    static void sumFrame(void* ctx, const microhsm::Event& event)
+    {
+        *static_cast<unsigned long*>(ctx) += *static_cast<const unsigned int*>(event.data());
+    }
+
+    class FrameState : public microhsm::BaseState
+    {
+        public:
+            FrameState() : microhsm::BaseState(0, nullptr, nullptr) {};
+
+            bool match(unsigned int event, microhsm::sTransition* t, void* ctx) override
+            {
+                (void)ctx;
+                if (event != ePOOL_FRAME) return noTransition();
+                return transitionInternal(t, nullptr) && eventEffect(t, sumFrame);
+            }
+    };
+
+    class FrameHSM : public microhsm::BaseHSM
+    {
+        public:
+            /// Structure shared by all instances
+            static microhsm::HSMDefinition definition;
+
+            FrameHSM() : microhsm::BaseHSM(state, definition)
+            {
+                this->registerVertices({&state});
+            };
+
+            FrameState state;
+    };
+
+    microhsm::HSMDefinition FrameHSM::definition;
+
+    /// Consumers with their own payload queue
+    typedef struct {
+        FrameHSM hsm;
+        microhsm::PayloadQueue<4> queue;
+        unsigned char copy[4][FRAME_SIZE];
+    } sConsumer;
+
+    static sConsumer consumers[CONSUMERS];
+    static microhsm::EventPool<FRAME_SIZE, 4> framePool;
+    static microhsm::EventPool<FRAME_SIZE, CONSUMERS * 4> copyPool;
+
+    static void fillFrame(void* frame, unsigned int i)
+    {
+        memset(frame, static_cast<int>(i & 0xFFu), FRAME_SIZE);
+        *static_cast<unsigned int*>(frame) = i;
+    }
+
+    static void benchCopy(const char* name)
+    {
+        // Every consumer receives its own copy of the frame, allocated from a pool
+        unsigned long sum = 0;
+        unsigned char frame[FRAME_SIZE];
+        for (unsigned int c = 0; c < CONSUMERS; c++) {
+            initHSM(consumers[c].hsm, &sum);
+            consumers[c].hsm.attachPayloadQueue(&consumers[c].queue);
+        }
+
+        double best = 0;
+        for (unsigned int r = 0; r < REPETITIONS; r++) {
+            Stopwatch sw;
+            for (unsigned int i = 0; i < FRAME_COUNT; i++) {
+                fillFrame(frame, i);
+                for (unsigned int c = 0; c < CONSUMERS; c++) {
+                    microhsm::Event event;
+                    void* copy = copyPool.makeEvent(ePOOL_FRAME, FRAME_SIZE, event);
+                    memcpy(copy, frame, FRAME_SIZE);
+                    consumers[c].hsm.post(static_cast<microhsm::Event&&>(event));
+                }
+                for (unsigned int c = 0; c < CONSUMERS; c++) consumers[c].hsm.runUntilEmpty(&sum);
+            }
+            double ns = sw.elapsedNs();
+            if (r == 0 || ns < best) best = ns;
+        }
+        doNotOptimize(sum);
+
+        report("pool", name, best / FRAME_COUNT, "ns/frame");
+    }
+
+    static void benchShared(const char* name)
+    {
+        // Single frame shared by all consumers
+        unsigned long sum = 0;
+        for (unsigned int c = 0; c < CONSUMERS; c++) {
+            initHSM(consumers[c].hsm, &sum);
+            consumers[c].hsm.attachPayloadQueue(&consumers[c].queue);
+        }
+
+        double best = 0;
+        for (unsigned int r = 0; r < REPETITIONS; r++) {
+            Stopwatch sw;
+            for (unsigned int i = 0; i < FRAME_COUNT; i++) {
+                microhsm::Event event;
+                void* frame = framePool.makeEvent(ePOOL_FRAME, FRAME_SIZE, event);
+                fillFrame(frame, i);
+                for (unsigned int c = 0; c < CONSUMERS; c++) {
+                    consumers[c].hsm.post(microhsm::BaseEventPool::share(event));
+                }
+                event.reset();
+                for (unsigned int c = 0; c < CONSUMERS; c++) consumers[c].hsm.runUntilEmpty(&sum);
+            }
+            double ns = sw.elapsedNs();
+            if (r == 0 || ns < best) best = ns;
+        }
+        doNotOptimize(sum);
+
+        report("pool", name, best / FRAME_COUNT, "ns/frame");
+    }
+
+    static void benchAllocate(const char* name, bool heap)
+    {
+        double best = 0;
+        for (unsigned int r = 0; r < REPETITIONS; r++) {
+            Stopwatch sw;
+            for (unsigned int i = 0; i < ALLOCATION_COUNT; i++) {
+                if (heap) {
+                    void* p = malloc(FRAME_SIZE);
+                    doNotOptimize(p);
+                    free(p);
+                }
+                else {
+                    void* p = framePool.allocate();
+                    doNotOptimize(p);
+                    microhsm::BaseEventPool::release(p);
+                }
+            }
+            double ns = sw.elapsedNs();
+            if (r == 0 || ns < best) best = ns;
+        }
+
+        report("pool", name, best / ALLOCATION_COUNT, "ns/block");
+    }
+
+    void run_pool_benchmarks()
+    {
+        benchCopy("2 KB frame to 32 HSMs, copy per HSM");
+        benchShared("2 KB frame to 32 HSMs, shared reference");
+        benchAllocate("allocate and release, malloc/free", true);
+        benchAllocate("allocate and release, event pool", false);
+    }
+}
@@ -0,0 +1,233 @@
+/**
+ * @file queue_bench.cpp
+ * @brief Event queue benchmarks, producer thread posting to a consumer running the HSM
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <bench.hpp>
+#include <benchmarks.hpp>
+#include <generated/GeneratedHSM.hpp>
+
+namespace microhsm_benchmarks
+{
+    static const unsigned int QUEUE_EVENT_COUNT = 2000000;
+    static const unsigned int LATENCY_EVENT_COUNT = 200000;
+    static const unsigned int SEQUENCE_LENGTH = 4096;
+    static const unsigned int REPETITIONS = 3;
+    static const unsigned int QUEUE_CAPACITY = 1024;
+    static const unsigned int PRODUCER_COUNT = 4;
+    static const unsigned int PRODUCER_BATCH = 16;
+
+    /// Time since an arbitrary epoch in nanoseconds
+    static long long nowNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static std::vector<unsigned int> makeEvents(const sGeneratorConfig& config)
+    {
+        Random rnd(config.seed + 1);
+        std::vector<unsigned int> events(SEQUENCE_LENGTH);
+        for (unsigned int& e : events) e = 1 + rnd.below(config.eventCount - 1);
+        return events;
+    }
+
+    static void benchPostRun(const char* name, const sGeneratorConfig& config)
+    {
+        GeneratedMachine machine(config);
+        GeneratedHSM hsm(machine);
+        microhsm::EventQueue<QUEUE_CAPACITY> queue;
+        initHSM(hsm, nullptr);
+        hsm.attachQueue(&queue);
+        std::vector<unsigned int> events = makeEvents(config);
+
+        // Post a batch, then drain it on the same thread
+        double best = 0;
+        for (unsigned int r = 0; r < REPETITIONS; r++) {
+            unsigned int dispatched = 0;
+            Stopwatch sw;
+            for (unsigned int i = 0; i < QUEUE_EVENT_COUNT; i += QUEUE_CAPACITY) {
+                for (unsigned int j = 0; j < QUEUE_CAPACITY; j++) {
+                    hsm.post(events[(i + j) % SEQUENCE_LENGTH]);
+                }
+                dispatched += hsm.runUntilEmpty(nullptr);
+            }
+            double ns = sw.elapsedNs();
+            doNotOptimize(dispatched);
+            if (r == 0 || ns < best) best = ns;
+        }
+
+        report("queue", name, best / QUEUE_EVENT_COUNT, "ns/event");
+    }
+
+    static void benchThroughput(const char* name, const sGeneratorConfig& config)
+    {
+        GeneratedMachine machine(config);
+        GeneratedHSM hsm(machine);
+        microhsm::EventQueue<QUEUE_CAPACITY> queue;
+        initHSM(hsm, nullptr);
+        hsm.attachQueue(&queue);
+        std::vector<unsigned int> events = makeEvents(config);
+
+        double best = 0;
+        for (unsigned int r = 0; r < REPETITIONS; r++) {
+            Stopwatch sw;
+            std::thread producer([&]() {
+                for (unsigned int i = 0; i < QUEUE_EVENT_COUNT; i++) {
+                    while (!hsm.post(events[i % SEQUENCE_LENGTH])) std::this_thread::yield();
+                }
+            });
+
+            unsigned int dispatched = 0;
+            while (dispatched < QUEUE_EVENT_COUNT) {
+                unsigned int n = hsm.runUntilEmpty(nullptr);
+                if (n == 0) std::this_thread::yield();
+                dispatched += n;
+            }
+            producer.join();
+            double ns = sw.elapsedNs();
+            if (r == 0 || ns < best) best = ns;
+        }
+
+        report("queue", name, QUEUE_EVENT_COUNT / (best / 1e9) / 1e6, "M events/s");
+    }
+
+    static void benchLatency(const char* name, const sGeneratorConfig& config, unsigned int intervalNs)
+    {
+        GeneratedMachine machine(config);
+        GeneratedHSM hsm(machine);
+        microhsm::EventQueue<QUEUE_CAPACITY> queue;
+        initHSM(hsm, nullptr);
+        hsm.attachQueue(&queue);
+        std::vector<unsigned int> events = makeEvents(config);
+
+        // Post time of every event, published to the consumer by the queue
+        std::vector<long long> posted(LATENCY_EVENT_COUNT);
+        std::vector<long long> latency(LATENCY_EVENT_COUNT);
+
+        // Producer posts at a fixed rate
+        std::thread producer([&]() {
+            long long next = nowNs();
+            for (unsigned int i = 0; i < LATENCY_EVENT_COUNT; i++) {
+                while (nowNs() < next) std::this_thread::yield();
+                next += intervalNs;
+                posted[i] = nowNs();
+                while (!hsm.post(events[i % SEQUENCE_LENGTH])) std::this_thread::yield();
+            }
+        });
+
+        // Latency from post until the run-to-completion step has finished
+        unsigned int dispatched = 0;
+        while (dispatched < LATENCY_EVENT_COUNT) {
+            if (hsm.runOnce(nullptr)) {
+                latency[dispatched] = nowNs() - posted[dispatched];
+                dispatched++;
+            }
+            else {
+                std::this_thread::yield();
+            }
+        }
+        producer.join();
+
+        std::sort(latency.begin(), latency.end());
+        char line[64];
+        std::snprintf(line, sizeof(line), "%s, p50", name);
+        report("queue", line, static_cast<double>(latency[LATENCY_EVENT_COUNT / 2]), "ns");
+        std::snprintf(line, sizeof(line), "%s, p99", name);
+        report("queue", line, static_cast<double>(latency[(LATENCY_EVENT_COUNT * 99) / 100]), "ns");
+    }
+
+    static void benchMutex(const char* name, const sGeneratorConfig& config)
+    {
+        GeneratedMachine machine(config);
+        GeneratedHSM hsm(machine);
+        initHSM(hsm, nullptr);
+        std::vector<unsigned int> events = makeEvents(config);
+        std::mutex mutex;
+
+        // Every producer dispatches its own events while holding the lock
+        double best = 0;
+        for (unsigned int r = 0; r < REPETITIONS; r++) {
+            Stopwatch sw;
+            std::thread producers[PRODUCER_COUNT];
+            for (unsigned int p = 0; p < PRODUCER_COUNT; p++) {
+                producers[p] = std::thread([&, p]() {
+                    for (unsigned int i = p; i < QUEUE_EVENT_COUNT; i += PRODUCER_COUNT) {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        hsm.dispatch(events[i % SEQUENCE_LENGTH], nullptr);
+                    }
+                });
+            }
+            for (std::thread& t : producers) t.join();
+            double ns = sw.elapsedNs();
+            if (r == 0 || ns < best) best = ns;
+        }
+
+        report("queue", name, QUEUE_EVENT_COUNT / (best / 1e9) / 1e6, "M events/s");
+    }
+
+    static void benchMPSC(const char* name, const sGeneratorConfig& config, unsigned int batch)
+    {
+        GeneratedMachine machine(config);
+        GeneratedHSM hsm(machine);
+        microhsm::MPSCEventQueue<QUEUE_CAPACITY> queue(microhsm::eQUEUE_BLOCK);
+        initHSM(hsm, nullptr);
+        hsm.attachQueue(&queue);
+        std::vector<unsigned int> events = makeEvents(config);
+
+        double best = 0;
+        for (unsigned int r = 0; r < REPETITIONS; r++) {
+            Stopwatch sw;
+            std::thread producers[PRODUCER_COUNT];
+            for (unsigned int p = 0; p < PRODUCER_COUNT; p++) {
+                producers[p] = std::thread([&, p]() {
+                    const unsigned int count = QUEUE_EVENT_COUNT / PRODUCER_COUNT;
+                    const unsigned int offset = (p * count) % SEQUENCE_LENGTH;
+                    for (unsigned int i = 0; i < count; i += batch) {
+                        const unsigned int first = (offset + i) % (SEQUENCE_LENGTH - batch);
+                        if (batch == 1) hsm.post(events[first]);
+                        else hsm.postBatch(&events[first], batch);
+                    }
+                });
+            }
+
+            unsigned int dispatched = 0;
+            while (dispatched < QUEUE_EVENT_COUNT) {
+                unsigned int n = hsm.runUntilEmpty(nullptr);
+                if (n == 0) std::this_thread::yield();
+                dispatched += n;
+            }
+            for (std::thread& t : producers) t.join();
+            double ns = sw.elapsedNs();
+            if (r == 0 || ns < best) best = ns;
+        }
+
+        report("queue", name, QUEUE_EVENT_COUNT / (best / 1e9) / 1e6, "M events/s");
+    }
+
+    void run_queue_benchmarks()
+    {
+        sGeneratorConfig config;
+        config.stateCount = 200;
+        config.maxDepth = 12;
+        config.eventCount = 60;
+        config.transitionsPerState = 3;
+        config.seed = 42;
+        config.chain = false;
+        config.scatter = false;
+        config.declareEvents = true;
+
+        benchPostRun("200 states, post + runUntilEmpty, single thread", config);
+        benchThroughput("200 states, producer thread, throughput", config);
+        benchLatency("200 states, 1M events/s, latency", config, 1000);
+        benchMutex("200 states, 4 producers, mutex around dispatch", config);
+        benchMPSC("200 states, 4 producers, MPSC queue", config, 1);
+        benchMPSC("200 states, 4 producers, MPSC queue, batches of 16", config, PRODUCER_BATCH);
+    }
+}
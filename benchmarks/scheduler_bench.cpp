@@ -0,0 +1,169 @@
+/**
+ * @file scheduler_bench.cpp
+ * @brief Scheduling overhead of the cooperative priority scheduler
+ */
+
+#include <bench.hpp>
+#include <benchmarks.hpp>
+#include <microhsm/microhsm.hpp>
+
+namespace microhsm_benchmarks
+{
+    /// HSMs
+    static const unsigned int SCHEDULER_HSMS = 16;
+    static const unsigned int SCHEDULER_PRIORITIES = 64;
+    /// Events posted before the machines are run
+    static const unsigned int BURST = 64;
+    static const unsigned int BURSTS = 20000;
+    static const unsigned int REPETITIONS = 3;
+
+    enum eSchedulerEvents : unsigned int {
+        eSCHEDULER_TICK = 1,
+    };
+
+    static void count(void* ctx)
+    {
+        (*static_cast<unsigned int*>(ctx))++;
+    }
+
+    class CountState : public microhsm::BaseState
+    {
+        public:
+            CountState() : microhsm::BaseState(0, nullptr, nullptr) {};
+
+            bool match(unsigned int event, microhsm::sTransition* t, void* ctx) override
+            {
+                (void)ctx;
+                if (event == eSCHEDULER_TICK) return transitionInternal(t, count);
+                return noTransition();
+            }
+    };
+
+    class CountHSM : public microhsm::BaseHSM
+    {
+        public:
+            /// Structure shared by all instances
+            static microhsm::HSMDefinition definition;
+
+            CountHSM() : microhsm::BaseHSM(state, definition)
+            {
+                this->registerVertices({&state});
+            };
+
+            CountState state;
+    };
+
+    microhsm::HSMDefinition CountHSM::definition;
+
+    static CountHSM schedulerHSMs[SCHEDULER_HSMS];
+    static microhsm::EventQueue<BURST> schedulerQueues[SCHEDULER_HSMS];
+    static unsigned int schedulerCounts[SCHEDULER_HSMS];
+
+    /// Target HSM of the n-th event of a burst, spreads events over all HSMs
+    static unsigned int target(unsigned int n)
+    {
+        return (n * 7u) % SCHEDULER_HSMS;
+    }
+
+    /// Priorities spread over both words of the ready bitmap
+    static unsigned int priority(unsigned int hsm)
+    {
+        return (hsm * 4u) + 1u;
+    }
+
+    static void initHSMs(void)
+    {
+        for (unsigned int i = 0; i < SCHEDULER_HSMS; i++) {
+            schedulerCounts[i] = 0;
+            schedulerHSMs[i].attachQueue(nullptr);
+            initHSM(schedulerHSMs[i], &schedulerCounts[i]);
+        }
+    }
+
+    static void benchDirect(void)
+    {
+        initHSMs();
+
+        double best = 0;
+        for (unsigned int r = 0; r < REPETITIONS; r++) {
+            Stopwatch sw;
+            for (unsigned int b = 0; b < BURSTS; b++) {
+                for (unsigned int n = 0; n < BURST; n++) {
+                    const unsigned int i = target(n);
+                    schedulerHSMs[i].dispatch(eSCHEDULER_TICK, &schedulerCounts[i]);
+                }
+            }
+            double ns = sw.elapsedNs();
+            if (r == 0 || ns < best) best = ns;
+        }
+        doNotOptimize(schedulerCounts[0]);
+
+        report("scheduler", "direct dispatch", best / (BURSTS * BURST), "ns/event");
+    }
+
+    static void benchPolling(void)
+    {
+        initHSMs();
+        for (unsigned int i = 0; i < SCHEDULER_HSMS; i++) {
+            schedulerHSMs[i].attachQueue(&schedulerQueues[i]);
+        }
+
+        double best = 0;
+        for (unsigned int r = 0; r < REPETITIONS; r++) {
+            Stopwatch sw;
+            for (unsigned int b = 0; b < BURSTS; b++) {
+                for (unsigned int n = 0; n < BURST; n++) {
+                    schedulerQueues[target(n)].push(eSCHEDULER_TICK);
+                }
+                // Poll all machines in priority order until every queue is empty
+                bool busy = true;
+                while (busy) {
+                    busy = false;
+                    for (unsigned int i = SCHEDULER_HSMS; i-- > 0;) {
+                        if (schedulerHSMs[i].runOnce(&schedulerCounts[i])) {
+                            busy = true;
+                            break;
+                        }
+                    }
+                }
+            }
+            double ns = sw.elapsedNs();
+            if (r == 0 || ns < best) best = ns;
+        }
+        doNotOptimize(schedulerCounts[0]);
+
+        report("scheduler", "queue, poll machines by priority", best / (BURSTS * BURST), "ns/event");
+    }
+
+    static void benchScheduler(void)
+    {
+        initHSMs();
+        static microhsm::Scheduler<SCHEDULER_PRIORITIES> scheduler;
+        for (unsigned int i = 0; i < SCHEDULER_HSMS; i++) {
+            scheduler.add(schedulerHSMs[i], schedulerQueues[i], &schedulerCounts[i], priority(i));
+        }
+
+        double best = 0;
+        for (unsigned int r = 0; r < REPETITIONS; r++) {
+            Stopwatch sw;
+            for (unsigned int b = 0; b < BURSTS; b++) {
+                for (unsigned int n = 0; n < BURST; n++) {
+                    scheduler.post(priority(target(n)), eSCHEDULER_TICK);
+                }
+                scheduler.runUntilIdle();
+            }
+            double ns = sw.elapsedNs();
+            if (r == 0 || ns < best) best = ns;
+        }
+        doNotOptimize(schedulerCounts[0]);
+
+        report("scheduler", "scheduler, bitmap selection", best / (BURSTS * BURST), "ns/event");
+    }
+
+    void run_scheduler_benchmarks()
+    {
+        benchDirect();
+        benchPolling();
+        benchScheduler();
+    }
+}
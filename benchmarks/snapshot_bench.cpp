@@ -0,0 +1,196 @@
+/**
+ * @file snapshot_bench.cpp
+ * @brief Binary snapshot and restore of active states and histories
+ */
+
+#include <stdint.h>
+
+#include <bench.hpp>
+#include <benchmarks.hpp>
+#include <microhsm/microhsm.hpp>
+
+namespace microhsm_benchmarks
+{
+    static const unsigned int INSTANCE_COUNT = 1000000;
+    static const unsigned int SNAPSHOT_COUNT = 1000000;
+    static const unsigned int REPETITIONS = 3;
+
+    /// Pump: Off, On(Idle, Active(Slow, Fast)) with shallow and deep history of On
+    enum ePumpIDs : unsigned int {
+        ePUMP_OFF = 0,
+        ePUMP_ON,
+        ePUMP_IDLE,
+        ePUMP_ACTIVE,
+        ePUMP_SLOW,
+        ePUMP_FAST,
+        ePUMP_SHALLOW,
+        ePUMP_DEEP,
+        ePUMP_COUNT
+    };
+
+    enum ePumpEvents : unsigned int {
+        ePUMP_POWER = 1,
+        ePUMP_RESUME,
+        ePUMP_RUN,
+        ePUMP_TOGGLE,
+        ePUMP_EVENT_COUNT
+    };
+
+    /* --- Pump built from `BaseState` objects --- */
+
+    class PumpState : public microhsm::BaseState
+    {
+        public:
+            PumpState(unsigned int id, microhsm::BaseState* parentState, microhsm::BaseState* initialState,
+                    unsigned int event, unsigned int target,
+                    microhsm::ShallowHistory* shallow = nullptr, microhsm::DeepHistory* deep = nullptr) :
+                microhsm::BaseState(id, parentState, initialState, shallow, deep), event_(event), target_(target) {};
+
+            bool match(unsigned int event, microhsm::sTransition* t, void* ctx) override
+            {
+                (void)ctx;
+                if (event == event_) return transitionExternal(target_, t, nullptr);
+                if (ID == ePUMP_OFF && event == ePUMP_RESUME) return transitionExternal(ePUMP_DEEP, t, nullptr);
+                return noTransition();
+            }
+
+        private:
+            const unsigned int event_;
+            const unsigned int target_;
+    };
+
+    class PumpHSM : public microhsm::BaseHSM
+    {
+        public:
+            /// Structure shared by all instances
+            static microhsm::HSMDefinition definition;
+
+            PumpHSM() : microhsm::BaseHSM(off, definition)
+            {
+                this->registerVertices({&off, &shallow, &deep, &on, &idle, &active, &slow, &fast});
+            };
+
+            PumpState off = PumpState(ePUMP_OFF, nullptr, nullptr, ePUMP_POWER, ePUMP_SHALLOW);
+            microhsm::ShallowHistory shallow = microhsm::ShallowHistory(ePUMP_SHALLOW);
+            microhsm::DeepHistory deep = microhsm::DeepHistory(ePUMP_DEEP);
+            PumpState on = PumpState(ePUMP_ON, nullptr, &idle, ePUMP_POWER, ePUMP_OFF, &shallow, &deep);
+            PumpState idle = PumpState(ePUMP_IDLE, &on, nullptr, ePUMP_RUN, ePUMP_ACTIVE);
+            PumpState active = PumpState(ePUMP_ACTIVE, &on, &slow, ePUMP_RUN, ePUMP_IDLE);
+            PumpState slow = PumpState(ePUMP_SLOW, &active, nullptr, ePUMP_TOGGLE, ePUMP_FAST);
+            PumpState fast = PumpState(ePUMP_FAST, &active, nullptr, ePUMP_TOGGLE, ePUMP_SLOW);
+    };
+
+    microhsm::HSMDefinition PumpHSM::definition;
+
+    /* --- Pump declared as constant data --- */
+
+    static const microhsm::sStaticVertex pumpVertices[ePUMP_COUNT] = {
+        microhsm::staticState(VERTEX_NONE, VERTEX_NONE),            // ePUMP_OFF
+        microhsm::staticState(VERTEX_NONE, ePUMP_IDLE),             // ePUMP_ON
+        microhsm::staticState(ePUMP_ON, VERTEX_NONE),               // ePUMP_IDLE
+        microhsm::staticState(ePUMP_ON, ePUMP_SLOW),                // ePUMP_ACTIVE
+        microhsm::staticState(ePUMP_ACTIVE, VERTEX_NONE),           // ePUMP_SLOW
+        microhsm::staticState(ePUMP_ACTIVE, VERTEX_NONE),           // ePUMP_FAST
+        microhsm::staticShallowHistory(ePUMP_ON),                   // ePUMP_SHALLOW
+        microhsm::staticDeepHistory(ePUMP_ON),                      // ePUMP_DEEP
+    };
+
+    static const microhsm::sStaticTransition pumpTransitions[7] = {
+        microhsm::staticExternal(ePUMP_OFF, ePUMP_POWER, ePUMP_SHALLOW),
+        microhsm::staticExternal(ePUMP_OFF, ePUMP_RESUME, ePUMP_DEEP),
+        microhsm::staticExternal(ePUMP_ON, ePUMP_POWER, ePUMP_OFF),
+        microhsm::staticExternal(ePUMP_IDLE, ePUMP_RUN, ePUMP_ACTIVE),
+        microhsm::staticExternal(ePUMP_ACTIVE, ePUMP_RUN, ePUMP_IDLE),
+        microhsm::staticExternal(ePUMP_SLOW, ePUMP_TOGGLE, ePUMP_FAST),
+        microhsm::staticExternal(ePUMP_FAST, ePUMP_TOGGLE, ePUMP_SLOW),
+    };
+
+    typedef microhsm::StaticInstance<2> PumpInstance;
+
+    static microhsm::StaticDefinition<ePUMP_COUNT, ePUMP_EVENT_COUNT, 7> pumpDefinition(
+            pumpVertices, pumpTransitions, ePUMP_OFF);
+    static PumpInstance pumps[INSTANCE_COUNT];
+    static PumpInstance restored[INSTANCE_COUNT];
+    static uint8_t buffer[STATIC_SNAPSHOT_HEADER_SIZE + (INSTANCE_COUNT * 3u * sizeof(microhsm::tStaticIndex))];
+
+    static void reportRate(const char* name, double ns, unsigned int machines)
+    {
+        report("snapshot", name, machines * 1e3 / ns, "M machines/s");
+    }
+
+    static void benchStatic()
+    {
+        // Scatter instances over all states and histories
+        Random random(11);
+        for (unsigned int i = 0; i < INSTANCE_COUNT; i++) {
+            pumpDefinition.start(pumps[i], nullptr);
+            pumpDefinition.start(restored[i], nullptr);
+            for (unsigned int e = random.below(8); e > 0; e--) {
+                pumpDefinition.dispatch(pumps[i], 1u + random.below(ePUMP_EVENT_COUNT - 1u));
+            }
+        }
+
+        const unsigned long size = pumpDefinition.getSnapshotSize(INSTANCE_COUNT);
+        report("snapshot", "StaticInstance pump", static_cast<double>(size - STATIC_SNAPSHOT_HEADER_SIZE) / INSTANCE_COUNT,
+                "bytes/machine");
+
+        double best = 0;
+        for (unsigned int r = 0; r < REPETITIONS; r++) {
+            Stopwatch sw;
+            doNotOptimize(pumpDefinition.snapshot(pumps, INSTANCE_COUNT, buffer, sizeof(buffer)));
+            double ns = sw.elapsedNs();
+            if (r == 0 || ns < best) best = ns;
+        }
+        reportRate("1M StaticInstance, snapshot", best, INSTANCE_COUNT);
+
+        for (unsigned int r = 0; r < REPETITIONS; r++) {
+            Stopwatch sw;
+            doNotOptimize(pumpDefinition.restore(restored, INSTANCE_COUNT, buffer, size));
+            double ns = sw.elapsedNs();
+            if (r == 0 || ns < best) best = ns;
+        }
+        reportRate("1M StaticInstance, verify + restore", best, INSTANCE_COUNT);
+    }
+
+    static void benchDynamic()
+    {
+        static PumpHSM pump;
+        initHSM(pump, nullptr);
+        const unsigned int events[] = {ePUMP_POWER, ePUMP_RUN, ePUMP_TOGGLE, ePUMP_POWER};
+        for (unsigned int e = 0; e < 4; e++) {
+            pump.dispatch(events[e], nullptr);
+        }
+
+        uint8_t state[64];
+        const unsigned int size = pump.getSnapshotSize();
+        report("snapshot", "BaseHSM pump", size, "bytes/machine");
+
+        double best = 0;
+        for (unsigned int r = 0; r < REPETITIONS; r++) {
+            Stopwatch sw;
+            for (unsigned int n = 0; n < SNAPSHOT_COUNT; n++) {
+                doNotOptimize(pump.snapshot(state, sizeof(state)));
+            }
+            double ns = sw.elapsedNs();
+            if (r == 0 || ns < best) best = ns;
+        }
+        reportRate("BaseHSM, snapshot", best, SNAPSHOT_COUNT);
+
+        for (unsigned int r = 0; r < REPETITIONS; r++) {
+            Stopwatch sw;
+            for (unsigned int n = 0; n < SNAPSHOT_COUNT; n++) {
+                doNotOptimize(pump.restore(state, size));
+            }
+            double ns = sw.elapsedNs();
+            if (r == 0 || ns < best) best = ns;
+        }
+        reportRate("BaseHSM, verify + restore", best, SNAPSHOT_COUNT);
+    }
+
+    void run_snapshot_benchmarks()
+    {
+        checkInit(pumpDefinition.init());
+        benchStatic();
+        benchDynamic();
+    }
+}
@@ -0,0 +1,188 @@
+/**
+ * @file store_bench.cpp
+ * @brief Warm restart from a memory-mapped instance store versus replaying events
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <bench.hpp>
+#include <benchmarks.hpp>
+#include <microhsm/microhsm.hpp>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define STORE_BENCH_MMAP 1
+#endif
+
+namespace microhsm_benchmarks
+{
+#if STORE_BENCH_MMAP == 1
+    static const unsigned int INSTANCE_COUNT = 10000000;
+    /// Events replayed per instance to rebuild its configuration
+    static const unsigned int REPLAY_EVENTS = 8;
+    static const unsigned int REPETITIONS = 3;
+
+    /// Pump: Off, On(Idle, Active(Slow, Fast)) with shallow and deep history of On
+    enum ePumpIDs : unsigned int {
+        ePUMP_OFF = 0,
+        ePUMP_ON,
+        ePUMP_IDLE,
+        ePUMP_ACTIVE,
+        ePUMP_SLOW,
+        ePUMP_FAST,
+        ePUMP_SHALLOW,
+        ePUMP_DEEP,
+        ePUMP_COUNT
+    };
+
+    enum ePumpEvents : unsigned int {
+        ePUMP_POWER = 1,
+        ePUMP_RESUME,
+        ePUMP_RUN,
+        ePUMP_TOGGLE,
+        ePUMP_EVENT_COUNT
+    };
+
+    /// User data of every pump
+    typedef struct {
+        uint32_t switches;      ///< Number of speed changes
+    } sPumpData;
+
+    static void countSwitch(void* ctx)
+    {
+        static_cast<sPumpData*>(ctx)->switches++;
+    }
+
+    static const microhsm::sStaticVertex pumpVertices[ePUMP_COUNT] = {
+        microhsm::staticState(VERTEX_NONE, VERTEX_NONE),            // ePUMP_OFF
+        microhsm::staticState(VERTEX_NONE, ePUMP_IDLE),             // ePUMP_ON
+        microhsm::staticState(ePUMP_ON, VERTEX_NONE),               // ePUMP_IDLE
+        microhsm::staticState(ePUMP_ON, ePUMP_SLOW),                // ePUMP_ACTIVE
+        microhsm::staticState(ePUMP_ACTIVE, VERTEX_NONE),           // ePUMP_SLOW
+        microhsm::staticState(ePUMP_ACTIVE, VERTEX_NONE),           // ePUMP_FAST
+        microhsm::staticShallowHistory(ePUMP_ON),                   // ePUMP_SHALLOW
+        microhsm::staticDeepHistory(ePUMP_ON),                      // ePUMP_DEEP
+    };
+
+    static const microhsm::sStaticTransition pumpTransitions[7] = {
+        microhsm::staticExternal(ePUMP_OFF, ePUMP_POWER, ePUMP_SHALLOW),
+        microhsm::staticExternal(ePUMP_OFF, ePUMP_RESUME, ePUMP_DEEP),
+        microhsm::staticExternal(ePUMP_ON, ePUMP_POWER, ePUMP_OFF),
+        microhsm::staticExternal(ePUMP_IDLE, ePUMP_RUN, ePUMP_ACTIVE),
+        microhsm::staticExternal(ePUMP_ACTIVE, ePUMP_RUN, ePUMP_IDLE),
+        microhsm::staticExternal(ePUMP_SLOW, ePUMP_TOGGLE, ePUMP_FAST, countSwitch),
+        microhsm::staticExternal(ePUMP_FAST, ePUMP_TOGGLE, ePUMP_SLOW, countSwitch),
+    };
+
+    typedef microhsm::InstanceStore<2, sPumpData> PumpStore;
+
+    static microhsm::StaticDefinition<ePUMP_COUNT, ePUMP_EVENT_COUNT, 7> pumpDefinition(
+            pumpVertices, pumpTransitions, ePUMP_OFF);
+
+    /// Next event of the deterministic event history
+    static unsigned int pumpEvent(Random& random)
+    {
+        return 1u + random.below(ePUMP_EVENT_COUNT - 1u);
+    }
+
+    /// Rebuild every instance by starting it and replaying its events
+    static double benchReplay()
+    {
+        struct sPump {
+            microhsm::StaticInstance<2> instance;
+            sPumpData data;
+        };
+        sPump* pumps = static_cast<sPump*>(malloc(sizeof(sPump) * INSTANCE_COUNT));
+
+        double best = 0;
+        for (unsigned int r = 0; r < REPETITIONS; r++) {
+            Random random(13);
+            Stopwatch sw;
+            for (unsigned int i = 0; i < INSTANCE_COUNT; i++) {
+                pumps[i].data.switches = 0;
+                pumpDefinition.start(pumps[i].instance, &pumps[i].data);
+                for (unsigned int e = 0; e < REPLAY_EVENTS; e++) {
+                    doNotOptimize(pumpDefinition.dispatch(pumps[i].instance, pumpEvent(random)));
+                }
+            }
+            double ns = sw.elapsedNs();
+            if (r == 0 || ns < best) best = ns;
+        }
+
+        free(pumps);
+        return best;
+    }
+
+    /// Write store file holding the same configurations as the replay
+    static bool writeStore(const char* path, PumpStore& store, unsigned long size)
+    {
+        int fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+        if (fd < 0 || ftruncate(fd, static_cast<off_t>(size)) != 0) return false;
+        void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (memory == MAP_FAILED) return false;
+
+        Random random(13);
+        store.format(memory, size, INSTANCE_COUNT);
+        for (unsigned int i = 0; i < INSTANCE_COUNT; i++) {
+            for (unsigned int e = 0; e < REPLAY_EVENTS; e++) {
+                store.dispatch(i, pumpEvent(random));
+            }
+        }
+
+        // Records reach the file before the clean header
+        msync(memory, size, MS_SYNC);
+        store.close();
+        msync(memory, STORE_HEADER_SIZE, MS_SYNC);
+        munmap(memory, size);
+        return true;
+    }
+
+    /// Map store file and validate it, as after a process restart (without `close` if `recover`)
+    static double benchRestart(const char* path, PumpStore& store, unsigned long size, bool recover)
+    {
+        double best = 0;
+        for (unsigned int r = 0; r <= REPETITIONS; r++) {
+            Stopwatch sw;
+            int fd = ::open(path, O_RDWR);
+            void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            ::close(fd);
+            const microhsm::eStoreStatus status = store.open(memory, size, recover);
+            double ns = sw.elapsedNs();
+            if (status != microhsm::eSTORE_OK) printf("store: open failed (%d)\n", static_cast<int>(status));
+
+            // First run warms the page cache, without `close` the store stays dirty for recovery
+            if (!recover) store.close();
+            munmap(memory, size);
+            if (r == 0) continue;
+            if (r == 1 || ns < best) best = ns;
+        }
+        return best;
+    }
+#endif
+
+    void run_store_benchmarks()
+    {
+#if STORE_BENCH_MMAP == 1
+        checkInit(pumpDefinition.init());
+        PumpStore store(pumpDefinition);
+        const unsigned long size = store.getRequiredSize(INSTANCE_COUNT);
+        char path[] = "/tmp/microhsm_storeXXXXXX";
+        int fd = mkstemp(path);
+        if (fd < 0) return;
+        ::close(fd);
+
+        report("store", "record size", sizeof(PumpStore::sRecord), "bytes/instance");
+        report("store", "10M instances, file size", static_cast<double>(size) / (1024.0 * 1024.0), "MiB");
+        if (writeStore(path, store, size)) {
+            report("store", "10M instances, replay 8 events each", benchReplay() / 1e6, "ms");
+            report("store", "10M instances, mmap + checksum + validation", benchRestart(path, store, size, false) / 1e6, "ms");
+            report("store", "10M instances, mmap + validation of dirty store", benchRestart(path, store, size, true) / 1e6, "ms");
+        }
+        unlink(path);
+#endif
+    }
+}
@@ -0,0 +1,201 @@
+/**
+ * @file timer_bench.cpp
+ * @brief Timers on a hierarchical timing wheel versus an ordered multimap
+ */
+
+#include <map>
+#include <vector>
+
+#include <bench.hpp>
+#include <benchmarks.hpp>
+#include <microhsm/microhsm.hpp>
+
+namespace microhsm_benchmarks
+{
+    static const uint32_t TIMER_COUNT = 1u << 20;
+    /// Delays are spread over this many ticks
+    static const uint32_t TIMER_SPREAD = 1u << 20;
+    static const unsigned int REPETITIONS = 3;
+
+    enum eTimerEvents : unsigned int {
+        eTIMER_TIMEOUT = 1,
+    };
+
+    class TimeoutState : public microhsm::BaseState
+    {
+        public:
+            TimeoutState() : microhsm::BaseState(0, nullptr, nullptr) {};
+
+            bool match(unsigned int event, microhsm::sTransition* t, void* ctx) override
+            {
+                (void)ctx;
+                if (event == eTIMER_TIMEOUT) return transitionInternal(t, nullptr);
+                return noTransition();
+            }
+    };
+
+    class TimeoutHSM : public microhsm::BaseHSM
+    {
+        public:
+            /// Structure shared by all instances
+            static microhsm::HSMDefinition definition;
+
+            TimeoutHSM() : microhsm::BaseHSM(state, definition)
+            {
+                this->registerVertices({&state});
+            };
+
+            TimeoutState state;
+    };
+
+    microhsm::HSMDefinition TimeoutHSM::definition;
+
+    /// Timer of the multimap baseline
+    typedef struct {
+        microhsm::BaseHSM* hsm;
+        unsigned int event;
+    } sMapTimer;
+
+    typedef std::multimap<uint32_t, sMapTimer> tTimerMap;
+
+    static TimeoutHSM timeoutHSM;
+    static microhsm::EventQueue<1024> timeoutQueue;
+    static microhsm::TimerService<TIMER_COUNT> wheel;
+    static microhsm::tTimerHandle handles[TIMER_COUNT];
+    static uint32_t delays[TIMER_COUNT];
+
+    /// Dispatch posted timeout events
+    static void drain(void)
+    {
+        unsigned int event;
+        while (timeoutQueue.pop(event)) timeoutHSM.dispatch(event, nullptr);
+    }
+
+    /// Timers are disarmed in a scattered order
+    static uint32_t scattered(uint32_t i)
+    {
+        return (i * 7919u) & (TIMER_COUNT - 1);
+    }
+
+    static void benchWheel(void)
+    {
+        double arm = 0;
+        double rearm = 0;
+        double disarm = 0;
+        double expire = 0;
+        for (unsigned int r = 0; r < REPETITIONS; r++) {
+            Stopwatch swArm;
+            for (uint32_t i = 0; i < TIMER_COUNT; i++) {
+                handles[i] = wheel.arm(timeoutHSM, eTIMER_TIMEOUT, delays[i]);
+            }
+            double ns = swArm.elapsedNs();
+            if (r == 0 || ns < arm) arm = ns;
+
+            // Timeouts are typically cancelled and restarted before they expire
+            Stopwatch swRearm;
+            for (uint32_t i = 0; i < TIMER_COUNT; i++) {
+                const uint32_t j = scattered(i);
+                wheel.disarm(handles[j]);
+                handles[j] = wheel.arm(timeoutHSM, eTIMER_TIMEOUT, delays[i]);
+            }
+            ns = swRearm.elapsedNs();
+            if (r == 0 || ns < rearm) rearm = ns;
+
+            Stopwatch swDisarm;
+            for (uint32_t i = 0; i < TIMER_COUNT; i++) {
+                wheel.disarm(handles[scattered(i)]);
+            }
+            ns = swDisarm.elapsedNs();
+            if (r == 0 || ns < disarm) disarm = ns;
+
+            for (uint32_t i = 0; i < TIMER_COUNT; i++) {
+                wheel.arm(timeoutHSM, eTIMER_TIMEOUT, delays[i]);
+            }
+            Stopwatch swExpire;
+            while (wheel.getArmedCount() > 0) {
+                wheel.tick();
+                drain();
+            }
+            ns = swExpire.elapsedNs();
+            if (r == 0 || ns < expire) expire = ns;
+        }
+        doNotOptimize(wheel.getFailed());
+
+        report("timer", "1M timers, wheel arm", arm / TIMER_COUNT, "ns/timer");
+        report("timer", "1M timers, wheel disarm and rearm", rearm / TIMER_COUNT, "ns/timer");
+        report("timer", "1M timers, wheel disarm", disarm / TIMER_COUNT, "ns/timer");
+        report("timer", "1M timers, wheel tick until expired", expire / TIMER_COUNT, "ns/timer");
+    }
+
+    static void benchMap(void)
+    {
+        static std::vector<tTimerMap::iterator> iterators(TIMER_COUNT);
+        tTimerMap timers;
+        uint32_t now = 0;
+
+        double arm = 0;
+        double rearm = 0;
+        double disarm = 0;
+        double expire = 0;
+        for (unsigned int r = 0; r < REPETITIONS; r++) {
+            Stopwatch swArm;
+            for (uint32_t i = 0; i < TIMER_COUNT; i++) {
+                sMapTimer timer = {&timeoutHSM, eTIMER_TIMEOUT};
+                iterators[i] = timers.insert(std::make_pair(now + delays[i], timer));
+            }
+            double ns = swArm.elapsedNs();
+            if (r == 0 || ns < arm) arm = ns;
+
+            Stopwatch swRearm;
+            for (uint32_t i = 0; i < TIMER_COUNT; i++) {
+                const uint32_t j = scattered(i);
+                timers.erase(iterators[j]);
+                sMapTimer timer = {&timeoutHSM, eTIMER_TIMEOUT};
+                iterators[j] = timers.insert(std::make_pair(now + delays[i], timer));
+            }
+            ns = swRearm.elapsedNs();
+            if (r == 0 || ns < rearm) rearm = ns;
+
+            Stopwatch swDisarm;
+            for (uint32_t i = 0; i < TIMER_COUNT; i++) {
+                timers.erase(iterators[scattered(i)]);
+            }
+            ns = swDisarm.elapsedNs();
+            if (r == 0 || ns < disarm) disarm = ns;
+
+            for (uint32_t i = 0; i < TIMER_COUNT; i++) {
+                sMapTimer timer = {&timeoutHSM, eTIMER_TIMEOUT};
+                timers.insert(std::make_pair(now + delays[i], timer));
+            }
+            Stopwatch swExpire;
+            while (!timers.empty()) {
+                now++;
+                while (!timers.empty() && timers.begin()->first == now) {
+                    timers.begin()->second.hsm->post(timers.begin()->second.event);
+                    timers.erase(timers.begin());
+                }
+                drain();
+            }
+            ns = swExpire.elapsedNs();
+            if (r == 0 || ns < expire) expire = ns;
+        }
+
+        report("timer", "1M timers, multimap arm", arm / TIMER_COUNT, "ns/timer");
+        report("timer", "1M timers, multimap disarm and rearm", rearm / TIMER_COUNT, "ns/timer");
+        report("timer", "1M timers, multimap disarm", disarm / TIMER_COUNT, "ns/timer");
+        report("timer", "1M timers, multimap tick until expired", expire / TIMER_COUNT, "ns/timer");
+    }
+
+    void run_timer_benchmarks()
+    {
+        Random random(29);
+        for (uint32_t i = 0; i < TIMER_COUNT; i++) {
+            delays[i] = 1 + random.below(TIMER_SPREAD);
+        }
+        timeoutHSM.attachQueue(&timeoutQueue);
+        initHSM(timeoutHSM, nullptr);
+
+        benchWheel();
+        benchMap();
+    }
+}
@@ -61,6 +61,10 @@ namespace microhsm_examples
     int runExample()
     {
         std::cout << "Running Example: Basic" << std::endl;
+        if (hsm.init(static_cast<void*>(&valve)) != microhsm::eOK) {
+            std::cout << "Failed to initialize ValveHSM" << std::endl;
+            return 1;
+        }
         printState();
 
         const unsigned int sleepTimeMs = 750;
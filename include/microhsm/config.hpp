@@ -68,6 +68,223 @@
     #ifndef MICROHSM_TRACE_DISPATCH_MATCHED
         #error Tracing enabled, but no MICROHSM_TRACE_DISPATCH_MATCHED hook provided
     #endif
+
+    /*
+     * Optional hook:
+     * `MICROHSM_TRACE_INIT_ERROR(reason)` - Called with a string describing why `BaseHSM::init` failed
+     */
+    #ifndef MICROHSM_TRACE_INIT_ERROR
+        #define MICROHSM_TRACE_INIT_ERROR(reason)
+    #endif
+#endif
+
+/* Unused results */
+#ifndef MICROHSM_NODISCARD
+    /*
+     * Marks functions whose result must not be ignored, such as `BaseHSM::init`.
+     * C++11 has no `[[nodiscard]]`, the compiler specific attribute is used where available.
+     */
+    #if defined(__GNUC__)
+        #define MICROHSM_NODISCARD __attribute__((warn_unused_result))
+    #else
+        #define MICROHSM_NODISCARD
+    #endif
+#endif
+
+/* Vertex IDs */
+#ifndef MICROHSM_INDEX_TYPE
+    /*
+     * Unsigned integer type of vertex and event IDs.
+     *
+     * Used for `Vertex::ID`, the source and target of transitions, the
+     * depth of states and the enumerations of `HSM_CREATE_VERTEX_LIST`
+     * and `HSM_CREATE_EVENT_LIST`. Use `uint8_t` or `uint16_t` to pack
+     * the state of small machines into fewer bytes. IDs that do not fit
+     * into the type are rejected at compile time by the enumerations, and
+     * otherwise by `BaseHSM::init` (`eTRANSITION_ERROR`).
+     */
+    #define MICROHSM_INDEX_TYPE unsigned int
+#endif
+
+/* Hierarchy depth */
+#ifndef MICROHSM_MAX_DEPTH
+    /*
+     * Maximum number of nesting levels of a state machine.
+     * A top-level state is at nesting level 1. Used for sizing
+     * internal buffers that store paths through the hierarchy.
+     */
+    #define MICROHSM_MAX_DEPTH 8
+#endif
+
+/* State table */
+#ifndef MICROHSM_MAX_STATES
+    /*
+     * Maximum number of states of a single HSM.
+     * During initialization `BaseHSM` flattens the hierarchy into
+     * a table of this size, kept in the `HSMDefinition` shared by all
+     * instances. Every entry costs an offset, an ID and four bytes of
+     * hierarchy information. `init` of larger machines fails with
+     * `eTRANSITION_ERROR` (traced by `MICROHSM_TRACE_INIT_ERROR`).
+     */
+    #define MICROHSM_MAX_STATES 32
+#endif
+
+/* Vertex registry */
+#ifndef MICROHSM_MAX_VERTICES
+    /*
+     * Maximum number of vertices (states and pseudostates) of a single HSM.
+     * Vertices are registered with their HSM, such that `BaseHSM` can
+     * resolve IDs without calling `getVertex`.
+     * Every entry of the `HSMDefinition` costs an offset.
+     */
+    #define MICROHSM_MAX_VERTICES (MICROHSM_MAX_STATES + 8)
+#endif
+
+/* Instance storage */
+#ifndef MICROHSM_INSTANCE_STORAGE
+    /*
+     * Embed a definition and a defer queue in every `BaseHSM`.
+     *
+     * Used by HSMs constructed without a shared `HSMDefinition`
+     * (`BaseHSM(BaseState&)`), which keep their structure per instance and
+     * defer events without calling `attachDeferQueue`. Set to `0` when every
+     * HSM is given a shared definition, such that instances only hold their
+     * dynamic state. The single-argument constructor is unavailable then.
+     */
+    #define MICROHSM_INSTANCE_STORAGE 1
+#endif
+
+/* Compound transitions */
+#ifndef MICROHSM_MAX_BRANCHES
+    /*
+     * Maximum number of chained junction and choice pseudostates
+     * a single transition passes through. Used for sizing the buffer
+     * holding the selected branches during a transition.
+     */
+    #define MICROHSM_MAX_BRANCHES 4
+#endif
+
+/* Event payloads */
+#ifndef MICROHSM_EVENT_PAYLOAD_SIZE
+    /*
+     * Number of bytes of payload stored inside an `Event`.
+     * Larger payloads are referenced by pointer.
+     */
+    #define MICROHSM_EVENT_PAYLOAD_SIZE 16
+#endif
+
+/* Event queues */
+#ifndef MICROHSM_CACHE_LINE_SIZE
+    /*
+     * Cache line size in bytes of the target.
+     * The producer and consumer indices of event queues are placed
+     * on separate cache lines. Set to `4` on targets without a
+     * data cache to avoid padding.
+     */
+    #define MICROHSM_CACHE_LINE_SIZE 64
+#endif
+
+#ifndef MICROHSM_QUEUE_BATCH_SIZE
+    /*
+     * Number of events `BaseHSM::runUntilEmpty` pops from a queue at once.
+     * Costs a buffer of this many events on the stack.
+     */
+    #define MICROHSM_QUEUE_BATCH_SIZE 8
+#endif
+
+#ifndef MICROHSM_QUEUE_WAIT
+    /*
+     * Hook called by producers waiting for a slot of a full
+     * multi-producer queue (policy `eQUEUE_BLOCK`), e.g. to yield
+     * to other threads. Busy-waits by default.
+     */
+    #define MICROHSM_QUEUE_WAIT() do {} while (0)
+#endif
+
+/* Active objects */
+#ifndef MICROHSM_RUNTIME_CLOCK
+    /*
+     * Clock used to measure the scheduling latency of active objects,
+     * returns an `unsigned long` timestamp in arbitrary ticks.
+     * Latencies are not measured by default.
+     */
+    #define MICROHSM_RUNTIME_CLOCK() 0ul
+#endif
+
+/* Event masks */
+#ifndef MICROHSM_EVENT_MASKS
+    /*
+     * Enable handled-event masks (default).
+     *
+     * States can declare which events they handle. During initialization
+     * `BaseHSM` combines these declarations per state and its ancestors,
+     * such that events which are not handled by the active configuration
+     * are ignored without calling any `match` function.
+     * Every state costs two masks of `MICROHSM_EVENT_MASK_TYPE`.
+     */
+    #define MICROHSM_EVENT_MASKS 1
+#endif
+
+#ifndef MICROHSM_EVENT_MASK_TYPE
+    /*
+     * Unsigned integer type used for event masks.
+     * Events that do not fit into this type share the most
+     * significant bit, and are matched against every state
+     * that handles any of them.
+     */
+    #define MICROHSM_EVENT_MASK_TYPE uint64_t
+#endif
+
+/* Least common ancestor lookup */
+#ifndef MICROHSM_LCA_ACCELERATION
+    /*
+     * Enable constant/logarithmic time lookup of least common ancestors.
+     *
+     * During initialization `BaseHSM` builds (once per `HSMDefinition`) a lookup matrix for machines
+     * with at most `MICROHSM_LCA_MATRIX_SIZE` states, and a binary lifting
+     * table (`log2(MICROHSM_MAX_DEPTH)` ancestors per state) for larger,
+     * deep machines.
+     * Without acceleration least common ancestors are found by walking
+     * the hierarchy (default).
+     */
+    #define MICROHSM_LCA_ACCELERATION 0
+#endif
+
+#ifndef MICROHSM_LCA_MATRIX_SIZE
+    /*
+     * Maximum number of states for which a least common ancestor
+     * matrix is used. Costs `MICROHSM_LCA_MATRIX_SIZE^2` state indices.
+     */
+    #define MICROHSM_LCA_MATRIX_SIZE 16
+#endif
+
+/* Deferred events */
+#ifndef MICROHSM_DEFER_QUEUE_SIZE
+    /*
+     * Maximum number of deferred events of a single HSM.
+     *
+     * States can declare events they defer. Such events are stored in the
+     * `DeferQueue` attached to the HSM and recalled once the active configuration
+     * no longer defers them. Every entry costs an event, a sequence number and an index.
+     *
+     * Set to `0` to disable deferred events (default).
+     */
+    #define MICROHSM_DEFER_QUEUE_SIZE 0
+#endif
+
+/* Transition cache */
+#ifndef MICROHSM_TRANSITION_CACHE_SIZE
+    /*
+     * Number of entries of the per-HSM transition path cache.
+     *
+     * The cache stores the resolved exit and entry paths of
+     * external/local transitions, so that repeated transitions
+     * can be replayed without recomputing the least common ancestor.
+     * Every entry costs roughly `2 * MICROHSM_MAX_DEPTH` state indices.
+     *
+     * Set to `0` to disable the cache (default).
+     */
+    #define MICROHSM_TRANSITION_CACHE_SIZE 0
 #endif
 
 #endif /* _H_MICROHSM_CONFIG */
@@ -15,11 +15,12 @@
 
 /**
  * @brief Create event enumeration
+ * Events are of type `microhsm::tEventID`, events that do not fit are rejected by the compiler
  * @param enum_name Name of enum
  * @param ... list of event names
  */
 #define HSM_CREATE_EVENT_LIST(enum_name, ...)                       \
-    enum enum_name: unsigned int {                                  \
+    enum enum_name: microhsm::tEventID {                            \
         enum_name##_ANONYMOUS = 0,                                  \
         ##__VA_ARGS__                                               \
     };
@@ -28,11 +29,12 @@
  * @brief Create vertex ID list
  * Will create an enumeration for all vertex IDs
  * Every state and pseudostate should have an unique ID associated to it
+ * IDs are of type `microhsm::tVertexID`, IDs that do not fit are rejected by the compiler
  * @param enum_name Enum type identifier
  * @param ... Other id identifiers
  */
 #define HSM_CREATE_VERTEX_LIST(enum_name, ...)                      \
-    enum enum_name: unsigned int {                                  \
+    enum enum_name: microhsm::tVertexID {                           \
         __VA_ARGS__                                                 \
     };
 
@@ -48,6 +50,28 @@
 #define HSM_DECLARE_STATE_INIT()                                    \
             void init_(void* ctx) override;
 
+/**
+ * @brief Declare events handled by state
+ * Events that are not listed will never be matched against the state.
+ * @param ... List of event IDs
+ */
+#define HSM_DECLARE_HANDLED_EVENTS(...)                             \
+            microhsm::tEventMask handledEvents(void) override       \
+            {return microhsm::eventMask(__VA_ARGS__);}
+
+/**
+ * @brief Declare events deferred by state
+ * Listed events are postponed while the state is active.
+ * Event IDs must be below `EVENT_MASK_BITS - 1`.
+ * @param ... List of event IDs
+ */
+#define HSM_DECLARE_DEFERRED_EVENTS(...)                            \
+            static_assert((microhsm::eventMask(__VA_ARGS__) &       \
+                        EVENT_MASK_SHARED) == 0,                    \
+                    "Event ID too high to be deferred");            \
+            microhsm::tEventMask deferredEvents(void) override      \
+            {return microhsm::eventMask(__VA_ARGS__);}
+
 /// @brief Declare arbitrary state member variable or function
 #define HSM_DECLARE_MEMBER(member)                                  \
             member;
@@ -56,7 +80,7 @@
  * @brief Declare a top-level state
  * @note A top-level state is a state with no parents
  * @param class_name Class name of state
- * @param id Unique Identifier of state (`unsigned int`)
+ * @param id Unique Identifier of state (`microhsm::tVertexID`)
  */
 #define HSM_DECLARE_STATE_TOP_LEVEL(class_name, id, ...)                                                    \
     class class_name : public microhsm::BaseState {                                                         \
@@ -85,7 +109,7 @@
 /**
  * @brief Declare a state
  * @param class_name Class name of state
- * @param id Unique Identifier of state (`unsigned int`)
+ * @param id Unique Identifier of state (`microhsm::tVertexID`)
  * @param parent_state_class Class name of parent state
  */
 #define HSM_DECLARE_STATE(class_name, id, parent_state_class, ...)                                          \
@@ -12,7 +12,19 @@
 #include <microhsm/config.hpp>
 #include <microhsm/objects/BaseHSM.hpp>
 #include <microhsm/objects/BaseState.hpp>
+#include <microhsm/objects/OrthogonalState.hpp>
 #include <microhsm/objects/Vertex.hpp>
 #include <microhsm/objects/History.hpp>
+#include <microhsm/objects/Branch.hpp>
+#include <microhsm/objects/StaticHSM.hpp>
+#include <microhsm/objects/InstanceStore.hpp>
+#include <microhsm/objects/EventJournal.hpp>
+#include <microhsm/objects/EventQueue.hpp>
+#include <microhsm/objects/Event.hpp>
+#include <microhsm/objects/EventPool.hpp>
+#include <microhsm/objects/EventBus.hpp>
+#include <microhsm/objects/ActiveObject.hpp>
+#include <microhsm/objects/Scheduler.hpp>
+#include <microhsm/objects/TimerService.hpp>
 
 #endif
@@ -0,0 +1,382 @@
+/**
+ * @file ActiveObject.hpp
+ * @brief Active objects scheduled on work-stealing workers
+ *
+ * Contains declarations for:
+ *  - BaseWorkStealingDeque
+ *  - WorkStealingDeque
+ *  - ActiveObject
+ *  - BaseActiveRuntime
+ *  - ActiveRuntime
+ *
+ * @author Jelle Meijer
+ * @date 2025-05-23
+ */
+
+#ifndef _H_MICROHSM_ACTIVE_OBJECT
+#define _H_MICROHSM_ACTIVE_OBJECT
+
+#include <atomic>
+
+#include <microhsm/config.hpp>
+#include <microhsm/objects/EventQueue.hpp>
+#include <microhsm/objects/TimerService.hpp>
+
+namespace microhsm
+{
+    class BaseHSM;
+    class BaseActiveRuntime;
+
+    /// Smallest power of two (at least two) that is not less than `n`
+    constexpr unsigned int powerOfTwoAtLeast(unsigned int n, unsigned int p = 2)
+    {
+        return (p >= n) ? p : powerOfTwoAtLeast(n, p * 2);
+    }
+
+    /**
+     * @class BaseWorkStealingDeque
+     * @brief Bounded lock-free work-stealing deque (Chase-Lev)
+     *
+     * The owner pushes and pops at the bottom, any other thread can steal
+     * from the top. Used by `BaseActiveRuntime` to hold runnable objects.
+     *
+     * Use `WorkStealingDeque` to provide the storage.
+     */
+    class BaseWorkStealingDeque
+    {
+        public:
+
+            /**
+             * @brief Work-stealing deque constructor.
+             * @param buffer Storage for entries
+             * @param capacity Number of entries in `buffer`, must be a power of two
+             */
+            BaseWorkStealingDeque(std::atomic<unsigned int>* buffer, unsigned int capacity);
+
+            /**
+             * @brief Push entry at the bottom (owner only).
+             * @param value Entry to push
+             * @retval `true` Entry pushed
+             * @retval `false` Deque is full
+             */
+            bool push(unsigned int value);
+
+            /**
+             * @brief Pop newest entry from the bottom (owner only).
+             * @param value Receives the popped entry
+             * @retval `true` Entry popped
+             * @retval `false` Deque is empty or last entry was stolen
+             */
+            bool pop(unsigned int& value);
+
+            /**
+             * @brief Steal oldest entry from the top (any thread).
+             * @param value Receives the stolen entry
+             * @retval `true` Entry stolen
+             * @retval `false` Deque is empty or another thread took the entry
+             */
+            bool steal(unsigned int& value);
+
+            /**
+             * @brief Get number of entries.
+             * Only exact when no entries are pushed, popped or stolen concurrently.
+             * @return Number of entries
+             */
+            unsigned int size(void) const;
+
+        private:
+
+            /* --- Thieves --- */
+            alignas(MICROHSM_CACHE_LINE_SIZE) std::atomic<unsigned int> top_;       ///< Oldest entry
+
+            /* --- Owner --- */
+            alignas(MICROHSM_CACHE_LINE_SIZE) std::atomic<unsigned int> bottom_;    ///< Next free entry
+
+            /* --- Shared, read-only --- */
+            alignas(MICROHSM_CACHE_LINE_SIZE) std::atomic<unsigned int>* const buffer_; ///< Entries
+            const unsigned int mask_;                                               ///< `capacity - 1`
+    };
+
+    /**
+     * @class WorkStealingDeque
+     * @brief Bounded lock-free work-stealing deque (Chase-Lev)
+     *
+     * Provides the storage for `BaseWorkStealingDeque`.
+     *
+     * @tparam CAPACITY Number of entries, must be a power of two
+     */
+    template <unsigned int CAPACITY>
+    class WorkStealingDeque : public BaseWorkStealingDeque
+    {
+        static_assert(CAPACITY >= 2 && (CAPACITY & (CAPACITY - 1)) == 0, "Capacity must be a power of two");
+
+        public:
+
+            /**
+             * @brief Work-stealing deque constructor.
+             */
+            WorkStealingDeque() : BaseWorkStealingDeque(buffer_, CAPACITY) {};
+
+        private:
+
+            /// Entry storage
+            std::atomic<unsigned int> buffer_[CAPACITY];
+    };
+
+    /**
+     * @class ActiveObject
+     * @brief HSM with its own mailbox, executed by the workers of a runtime
+     *
+     * Events posted to an active object are stored in its mailbox. The first
+     * event posted to an idle object makes it runnable, after which one worker
+     * of the runtime dispatches its events. An object is owned by at most one
+     * worker at a time, such that run-to-completion steps never overlap.
+     *
+     * Adding the object to a runtime attaches the mailbox to the HSM, such that
+     * events posted to the HSM itself (by its behavior or by timers scoped to
+     * its states) schedule the object as well. Events with payload posted to the
+     * payload queue of the HSM (`BaseHSM::attachPayloadQueue`) are dispatched
+     * after the events of the mailbox. Timers can target the object directly (see `TimerTarget`).
+     *
+     * The HSM must be initialized before events are posted.
+     */
+    class ActiveObject : public TimerTarget
+    {
+        public:
+
+            /**
+             * @brief Active object constructor.
+             * @param hsm HSM executed by the object
+             * @param mailbox Queue of the object, use a multi-producer queue when several threads post
+             * @param ctx Context object passed to `dispatch`
+             */
+            ActiveObject(BaseHSM& hsm, AbstractEventQueue& mailbox, void* ctx);
+
+            /**
+             * @brief Post event to mailbox and schedule the object when it is idle.
+             * Can be called from any thread and from within run-to-completion steps.
+             * @param event Event to post
+             * @retval `true` Event queued
+             * @retval `false` Mailbox full or object not added to a runtime
+             */
+            bool post(unsigned int event);
+
+            /**
+             * @brief Deliver timeout event by posting it to the mailbox.
+             * @param event Timeout event
+             * @return See `post`
+             */
+            bool deliverTimeout(unsigned int event) override;
+
+            /**
+             * @brief Get HSM executed by the object.
+             * @return HSM
+             */
+            BaseHSM& getHSM(void);
+
+        private:
+
+            friend class BaseActiveRuntime;
+
+            /// Schedule object when it is idle, installed as post notification of the HSM
+            static void notify_(void* arg);
+
+            BaseHSM& hsm_;                          ///< HSM executed by the object
+            AbstractEventQueue& mailbox_;           ///< Queued events
+            void* const ctx_;                       ///< Context object of `hsm_`
+            BaseActiveRuntime* runtime_;            ///< Runtime executing the object
+            unsigned int index_;                    ///< Index of object in the runtime
+            unsigned int home_;                     ///< Worker receiving the object when it becomes runnable
+            std::atomic<bool> scheduled_;           ///< Object is runnable or running
+            unsigned long scheduledAt_;             ///< Time the object became runnable (`MICROHSM_RUNTIME_CLOCK`)
+    };
+
+    /**
+     * @brief Statistics of a worker of an active object runtime.
+     */
+    typedef struct {
+        unsigned long runs;             ///< Number of times an object was run
+        unsigned long dispatched;       ///< Number of dispatched events
+        unsigned long steals;           ///< Number of objects stolen from other workers
+        unsigned long stealAttempts;    ///< Number of attempts to steal from another worker
+        unsigned int depth;             ///< Number of runnable objects of the worker
+        unsigned int peakDepth;         ///< Highest number of runnable objects of the worker
+        unsigned long latencyTotal;     ///< Sum of scheduling latencies (`MICROHSM_RUNTIME_CLOCK` ticks)
+        unsigned long latencyMax;       ///< Highest scheduling latency
+    } sWorkerStats;
+
+    /**
+     * @brief Worker of an active object runtime.
+     */
+    typedef struct alignas(MICROHSM_CACHE_LINE_SIZE) {
+        BaseWorkStealingDeque* deque;               ///< Runnable objects, stolen by other workers
+        BaseMPSCEventQueue* inbox;                  ///< Objects made runnable by other threads
+        unsigned int random;                        ///< State of victim selection
+        std::atomic<unsigned long> runs;            ///< See `sWorkerStats`
+        std::atomic<unsigned long> dispatched;      ///< See `sWorkerStats`
+        std::atomic<unsigned long> steals;          ///< See `sWorkerStats`
+        std::atomic<unsigned long> stealAttempts;   ///< See `sWorkerStats`
+        std::atomic<unsigned int> peakDepth;        ///< See `sWorkerStats`
+        std::atomic<unsigned long> latencyTotal;    ///< See `sWorkerStats`
+        std::atomic<unsigned long> latencyMax;      ///< See `sWorkerStats`
+    } sWorker;
+
+    /**
+     * @class BaseActiveRuntime
+     * @brief Executes active objects on a fixed number of work-stealing workers
+     *
+     * The runtime does not create threads. Every worker is driven by calling
+     * `runWorker` (or `runOnce`) from its own thread or task.
+     *
+     * A runnable object is placed in the inbox of its home worker, which moves
+     * it to its deque. Workers run objects from their own deque and steal from
+     * the deques of other workers when they run out of work. A run dispatches up
+     * to `MICROHSM_QUEUE_BATCH_SIZE` events, after which an object with queued
+     * events goes back to the deque of the worker that ran it.
+     *
+     * Use `ActiveRuntime` to provide the storage.
+     */
+    class BaseActiveRuntime
+    {
+        public:
+
+            /**
+             * @brief Active object runtime constructor.
+             * @param objects Storage for `maxObjects` objects
+             * @param workers Workers, every deque and inbox must hold `maxObjects` entries
+             * @param workerCount Number of workers
+             * @param maxObjects Maximum number of objects
+             */
+            BaseActiveRuntime(ActiveObject** objects, sWorker* workers, unsigned int workerCount, unsigned int maxObjects);
+
+            /**
+             * @brief Add active object.
+             * Attaches the mailbox to the HSM and installs its post notification
+             * (see `BaseHSM::setPostNotify`). Must not be called while workers are running.
+             * @param object Object to add
+             * @retval `true` Object added
+             * @retval `false` Runtime is full
+             */
+            bool add(ActiveObject& object);
+
+            /**
+             * @brief Run a single runnable object.
+             * @param worker Index of the calling worker
+             * @retval `true` An object was run
+             * @retval `false` No runnable object found
+             */
+            bool runOnce(unsigned int worker);
+
+            /**
+             * @brief Run objects until `stop` is set.
+             * Calls `MICROHSM_QUEUE_WAIT()` when no runnable object is found.
+             * @param worker Index of the calling worker
+             * @param stop Flag ending the loop
+             */
+            void runWorker(unsigned int worker, const std::atomic<bool>& stop);
+
+            /**
+             * @brief Get statistics of a worker.
+             * @param worker Index of worker
+             * @return Statistics
+             */
+            sWorkerStats getStats(unsigned int worker) const;
+
+            /**
+             * @brief Get statistics of all workers combined.
+             * `depth` and `peakDepth` are summed, `latencyMax` is the highest of all workers.
+             * @return Statistics
+             */
+            sWorkerStats getTotalStats(void) const;
+
+            /**
+             * @brief Get number of workers.
+             * @return Number of workers
+             */
+            unsigned int getWorkerCount(void) const;
+
+            /**
+             * @brief Get number of objects.
+             * @return Number of added objects
+             */
+            unsigned int getObjectCount(void) const;
+
+        protected:
+
+            /**
+             * @brief Make object runnable, called by `ActiveObject::post`
+             * @param object Object to schedule
+             */
+            void schedule_(ActiveObject& object);
+
+            friend class ActiveObject;
+
+        private:
+
+            /**
+             * @brief Find runnable object
+             * @param worker Index of calling worker
+             * @param index Receives index of object
+             * @return Whether an object was found
+             */
+            bool findWork_(unsigned int worker, unsigned int& index);
+
+            /**
+             * @brief Dispatch events of object and release or requeue it
+             * @param w Calling worker
+             * @param object Object to run
+             */
+            void run_(sWorker& w, ActiveObject& object);
+
+            ActiveObject** const objects_;      ///< Added objects
+            sWorker* const workers_;            ///< Workers
+            const unsigned int workerCount_;    ///< Number of workers
+            const unsigned int maxObjects_;     ///< Capacity
+            unsigned int objectCount_;          ///< Added objects
+    };
+
+    /**
+     * @class ActiveRuntime
+     * @brief Executes active objects on a fixed number of work-stealing workers
+     *
+     * Provides the storage for `BaseActiveRuntime`.
+     * Every worker costs a deque and an inbox of `MAX_OBJECTS` entries (rounded up to a power of two).
+     *
+     * @tparam WORKERS Number of workers
+     * @tparam MAX_OBJECTS Maximum number of objects
+     */
+    template <unsigned int WORKERS, unsigned int MAX_OBJECTS>
+    class ActiveRuntime : public BaseActiveRuntime
+    {
+        static_assert(WORKERS > 0 && MAX_OBJECTS > 0, "Runtime needs workers and objects");
+
+        public:
+
+            /**
+             * @brief Active object runtime constructor.
+             */
+            ActiveRuntime() : BaseActiveRuntime(objects_, workers_, WORKERS, MAX_OBJECTS)
+            {
+                for (unsigned int i = 0; i < WORKERS; i++) {
+                    this->workers_[i].deque = &this->deques_[i];
+                    this->workers_[i].inbox = &this->inboxes_[i];
+                }
+            };
+
+        private:
+
+            /// Capacity of deques and inboxes
+            static constexpr unsigned int CAPACITY = powerOfTwoAtLeast(MAX_OBJECTS);
+
+            /// Added objects
+            ActiveObject* objects_[MAX_OBJECTS];
+            /// Workers
+            sWorker workers_[WORKERS];
+            /// Runnable objects of every worker
+            WorkStealingDeque<CAPACITY> deques_[WORKERS];
+            /// Objects made runnable by other threads, for every worker
+            MPSCEventQueue<CAPACITY> inboxes_[WORKERS];
+    };
+}
+
+#endif /* _H_MICROHSM_ACTIVE_OBJECT */
@@ -9,12 +9,29 @@
 #ifndef _H_MICROHSM_HSM
 #define _H_MICROHSM_HSM
 
+#include <stdint.h>
+#include <initializer_list>
+
+#include <microhsm/config.hpp>
 #include <microhsm/objects/BaseState.hpp>
+#include <microhsm/objects/Event.hpp>
+#include <microhsm/objects/TimerService.hpp>
 
 namespace microhsm
 {
+    class AbstractEventQueue;
+    class BasePayloadQueue;
+    class BaseEventJournal;
+    class Choice;
+
     #define EVENT_ANONYMOUS 0
 
+    /// Function called after events were posted to the queue of an HSM
+    typedef void (*fPostNotify)(void* arg);
+
+    /// Version of the binary format written by `BaseHSM::snapshot` and `BaseStaticDefinition::snapshot`
+    #define SNAPSHOT_VERSION 1u
+
     /**
      * @enum eStatus
      * @brief Dispatch return status
@@ -23,6 +40,252 @@ namespace microhsm
         eOK = 0,            ///< Event consumed
         eEVENT_IGNORED,     ///< Event ignored
         eTRANSITION_ERROR,  ///< A critical error occurred
+        eEVENT_DEFERRED,    ///< Event deferred by active configuration
+        eEVENT_NOT_DEFERRED,///< Event deferred by active configuration, but dropped as its payload cannot be kept
+    };
+
+    /**
+     * @enum eLCAStrategy
+     * @brief Method used for finding least common ancestors
+     */
+    enum eLCAStrategy {
+        eLCA_WALK = 0,      ///< Walk up the hierarchy
+        eLCA_MATRIX,        ///< Lookup in matrix of all state pairs
+        eLCA_LIFTING,       ///< Binary lifting over ancestors
+    };
+
+#if MICROHSM_DEFER_QUEUE_SIZE > 0
+    /// Index used to indicate the end of a list of deferred events
+    #define DEFER_INDEX_NONE 0xFFFFFFFFu
+
+    /**
+     * @brief Deferred event.
+     * Deferred events sharing an event mask bit form a list in order of deferral.
+     */
+    typedef struct {
+        unsigned int event;     ///< Deferred event
+        unsigned long order;    ///< Order of deferral
+        unsigned int next;      ///< Next deferred event of list (`DEFER_INDEX_NONE` if last)
+    } sDeferredEvent;
+
+    /**
+     * @class DeferQueue
+     * @brief Storage of the events deferred by a single HSM
+     *
+     * Holds up to `MICROHSM_DEFER_QUEUE_SIZE` deferred events. Only HSMs whose
+     * states defer events need a queue, see `BaseHSM::attachDeferQueue`.
+     */
+    class DeferQueue
+    {
+        friend class BaseHSM;
+
+        public:
+
+            /**
+             * @brief Defer queue constructor.
+             */
+            DeferQueue();
+
+            /**
+             * @brief Get number of deferred events.
+             * @return Number of events waiting to be recalled
+             */
+            unsigned int getCount(void) const;
+
+        private:
+
+            /**
+             * @brief Discard all deferred events
+             */
+            void clear_(void);
+
+            /// Storage of deferred events
+            sDeferredEvent deferred_[MICROHSM_DEFER_QUEUE_SIZE];
+            /// Oldest deferred event of every event mask bit
+            unsigned int head_[EVENT_MASK_BITS];
+            /// Newest deferred event of every event mask bit
+            unsigned int tail_[EVENT_MASK_BITS];
+            /// First unused entry of `deferred_`
+            unsigned int free_;
+            /// Number of deferred events
+            unsigned int count_;
+            /// Mask of event bits with deferred events
+            tEventMask pending_;
+            /// Order of next deferred event
+            unsigned long order_;
+    };
+#endif
+
+#if MICROHSM_TRANSITION_CACHE_SIZE > 0
+    /**
+     * @brief Cached transition path.
+     *
+     * Stores the resolved path of an external/local transition.
+     * The path is uniquely determined by the active leaf state, the
+     * source and (resolved) target state and the transition kind.
+     * `exits` holds the states in order of exit, `entries` holds the
+     * states in order of entry, including the initial state descent.
+     */
+    typedef struct {
+        tStateIndex leaf;                       ///< Active leaf state (`STATE_INDEX_NONE` if entry is unused)
+        tStateIndex source;                     ///< Source state of transition
+        tStateIndex target;                     ///< Resolved target state of transition
+        eTransitionKind kind;                   ///< Kind of transition
+        uint8_t exitCount;                      ///< Number of states in `exits`
+        uint8_t entryCount;                     ///< Number of states in `entries`
+        tStateIndex exits[MICROHSM_MAX_DEPTH];  ///< States to exit
+        tStateIndex entries[MICROHSM_MAX_DEPTH];///< States to enter
+    } sTransitionPath;
+#endif
+
+    /**
+     * @class HSMDefinition
+     * @brief Structure of an HSM shared by all of its instances
+     *
+     * Holds the tables that follow from the hierarchy of an HSM: the vertex
+     * registry, parents, initial states, depths, flags, numbering, event masks
+     * and least common ancestor lookup tables. Vertices are stored by their
+     * position relative to the HSM, such that every instance of an HSM class
+     * resolves its own vertices and only keeps its dynamic state.
+     *
+     * The first successful `BaseHSM::init` of any instance builds the
+     * definition. Every later `init` checks the instance against it. Instances
+     * sharing a definition must have the same vertices at the same position
+     * (e.g. members of the same class) and handle and defer the same events.
+     * Vertices outside of the HSM object (e.g. globals) cannot be shared, as
+     * their offset differs per instance.
+     *
+     * Building the definition is not synchronized. The first `init` must return
+     * before instances sharing the definition are initialized from other threads.
+     *
+     * Usually a static member of the HSM class, passed to the `BaseHSM` constructor.
+     * HSMs constructed without a definition use one of their own.
+     */
+    class HSMDefinition
+    {
+        friend class BaseHSM;
+
+        public:
+
+            /**
+             * @brief Definition constructor.
+             * Constant initialized, such that definitions with static storage duration
+             * are valid before HSMs constructed during static initialization use them.
+             */
+            constexpr HSMDefinition() :
+                registry_(),
+                registryCount_(0),
+                registryMaxID_(0),
+                registryBase_(0),
+                registrySlots_(0),
+                registryModulus_(0),
+                registryBuilt_(false),
+                registryInvalidID_(false),
+                built_(false),
+                stateCount_(0),
+                historyCount_(0),
+                parent_(),
+                initial_(),
+                depth_(),
+                flags_(),
+                ids_(),
+                pre_(),
+                end_(),
+                states_(),
+#if MICROHSM_EVENT_MASKS == 1
+                mask_(),
+                chainMask_(),
+#endif
+#if MICROHSM_LCA_ACCELERATION == 1
+                lcaMatrix_(),
+                lcaUp_(),
+#endif
+#if MICROHSM_DEFER_QUEUE_SIZE > 0
+                deferMask_(),
+                chainDefer_(),
+#endif
+                lcaStrategy_(eLCA_WALK)
+            {}
+
+            /**
+             * @brief Check whether the definition is built.
+             * @return Whether an instance has been initialized
+             */
+            bool isBuilt(void) const;
+
+        private:
+
+            /* --- Vertex registry --- */
+
+            /// Position of registered vertices relative to the HSM (`0` for empty slots), placed by ID once built
+            intptr_t registry_[MICROHSM_MAX_VERTICES];
+            /// Number of registered vertices (can exceed `MICROHSM_MAX_VERTICES`)
+            unsigned int registryCount_;
+            /// Highest registered ID
+            unsigned int registryMaxID_;
+            /// Lowest registered ID
+            unsigned int registryBase_;
+            /// Number of used slots
+            unsigned int registrySlots_;
+            /// Modulus of perfect hash (`0` if IDs are used directly)
+            unsigned int registryModulus_;
+            /// Whether registered vertices are placed by ID
+            bool registryBuilt_;
+            /// Whether a vertex with an ID exceeding `VERTEX_ID_MAX` was registered
+            bool registryInvalidID_;
+
+            /* --- State table --- */
+
+            /// Whether the state table is built
+            bool built_;
+            /// Number of states in state table
+            tStateIndex stateCount_;
+            /// Number of history pseudostates of all states
+            unsigned int historyCount_;
+            /// Parent of every state (`STATE_INDEX_NONE` for top-level states)
+            tStateIndex parent_[MICROHSM_MAX_STATES];
+            /// Initial state of every state (`STATE_INDEX_NONE` for leaf states)
+            tStateIndex initial_[MICROHSM_MAX_STATES];
+            /// Depth of every state
+            uint8_t depth_[MICROHSM_MAX_STATES];
+            /// Flags of every state (`BaseHSM::eStateFlag`)
+            uint8_t flags_[MICROHSM_MAX_STATES];
+            /// ID of every state
+            tVertexID ids_[MICROHSM_MAX_STATES];
+            /// Depth-first pre-order number of every state
+            tStateIndex pre_[MICROHSM_MAX_STATES];
+            /// Highest pre-order number of the descendants of every state
+            tStateIndex end_[MICROHSM_MAX_STATES];
+            /// Position of the state object of every state relative to the HSM
+            intptr_t states_[MICROHSM_MAX_STATES];
+#if MICROHSM_EVENT_MASKS == 1
+            /// Events handled by every state
+            tEventMask mask_[MICROHSM_MAX_STATES];
+            /// Events handled by every state or one of its ancestors
+            tEventMask chainMask_[MICROHSM_MAX_STATES];
+#endif
+
+#if MICROHSM_LCA_ACCELERATION == 1
+            /// Number of binary lifting levels, such that `2^LCA_LEVELS >= MICROHSM_MAX_DEPTH`
+            static constexpr unsigned int LCA_LEVELS = (MICROHSM_MAX_DEPTH <= 2) ? 1 :
+                (MICROHSM_MAX_DEPTH <= 4) ? 2 : (MICROHSM_MAX_DEPTH <= 8) ? 3 :
+                (MICROHSM_MAX_DEPTH <= 16) ? 4 : (MICROHSM_MAX_DEPTH <= 32) ? 5 :
+                (MICROHSM_MAX_DEPTH <= 64) ? 6 : (MICROHSM_MAX_DEPTH <= 128) ? 7 : 8;
+            /// Least common ancestor of every pair of states (`a * stateCount_ + b`)
+            tStateIndex lcaMatrix_[MICROHSM_LCA_MATRIX_SIZE * MICROHSM_LCA_MATRIX_SIZE];
+            /// Ancestor `2^k` levels up of every state
+            tStateIndex lcaUp_[LCA_LEVELS][MICROHSM_MAX_STATES];
+#endif
+
+#if MICROHSM_DEFER_QUEUE_SIZE > 0
+            /// Events deferred by every state
+            tEventMask deferMask_[MICROHSM_MAX_STATES];
+            /// Events deferred by every state or one of its ancestors
+            tEventMask chainDefer_[MICROHSM_MAX_STATES];
+#endif
+
+            /// Method for finding least common ancestors selected for the hierarchy
+            eLCAStrategy lcaStrategy_;
     };
 
     /**
@@ -33,7 +296,17 @@ namespace microhsm
      * Its function is to hold the states (and other vertices). It tracks the
      * active state and is responsible for dispatching events accordingly.
      *
-     * Derived classes must implement two functions:
+     * The structure of the HSM (the state table and the vertex registry) is
+     * kept in an `HSMDefinition` shared by all instances of the HSM class, every
+     * instance only holds its dynamic state.
+     *
+     * The constructor of the derived class registers the vertices (states and
+     * pseudostates) of the HSM with `registerVertices`. During initialization
+     * the registered vertices are placed into a table indexed by ID (or by a
+     * perfect hash for sparse IDs), such that transition targets are resolved
+     * without virtual calls.
+     *
+     * Instead of registering its vertices, a derived class can override two functions:
      *  - `Vertex* getVertex(unsigned int ID)`
      *  - `unsigned int getMaxID(void)`
      *
@@ -44,16 +317,43 @@ namespace microhsm
      *  `getMaxID` is used to obtain the highest possible ID. This is used
      *  by `BaseHSM` to iterate over all possible state. Mainly used during
      *  initialization.
+     *
+     *  When overridden, the vertices provided by `getVertex` are registered
+     *  during the first initialization, and the table is used as well.
      */
-    class BaseHSM
+    class BaseHSM : public TimerTarget
     {
+        // Provide states with access to the state table and current event
+        friend class BaseState;
+        // Provide timer service with access to the scoped timers
+        friend class BaseTimerService;
+        // Provide orthogonal states with access to the configuration of their regions
+        friend class BaseOrthogonalState;
+        // Provide journal replay with access to the snapshot comparison
+        friend class JournalReplay;
+        // Provide active runtime with access to the events with payload
+        friend class BaseActiveRuntime;
+
         public:
 
+#if MICROHSM_INSTANCE_STORAGE == 1
             /**
              * @brief HSM constructor.
+             * The structure of the HSM is kept in a definition of its own, and the
+             * embedded defer queue is attached (`MICROHSM_INSTANCE_STORAGE`).
              * @param initState Initial state of HSM
              */
             explicit BaseHSM(BaseState& initial);
+#endif
+
+            /**
+             * @brief HSM constructor sharing the structure of the HSM class.
+             * Vertices must be members of the HSM (see `HSMDefinition`). Without
+             * `MICROHSM_INSTANCE_STORAGE` no defer queue is attached.
+             * @param initState Initial state of HSM
+             * @param definition Structure shared by all instances of the HSM class
+             */
+            BaseHSM(BaseState& initial, HSMDefinition& definition);
 
             /**
              * @brief Destructor.
@@ -62,26 +362,55 @@ namespace microhsm
 
             /**
              * @brief Get state.
+             * Default implementation looks up the registered vertices.
              * @param ID Unique Identifier of state
              * @retval `State*` associated to provided ID
              * @retval `nullptr` If state doesn't exist
              */
-            virtual Vertex* getVertex(unsigned int ID) = 0;
+            virtual Vertex* getVertex(unsigned int ID);
 
             /**
              * @brief Return state ID with highest value.
              * This is used by `HSM` to iterate over all states together
              * with help of the `getVertex(ID)` function.
-             * @return Number of states
+             * Default implementation returns the highest registered ID.
+             * @return Highest ID
              */
-            virtual unsigned int getMaxID(void) = 0;
+            virtual unsigned int getMaxID(void);
+
+            /**
+             * @brief Register vertices of the HSM.
+             * Called by the constructor of the derived class with every state and
+             * pseudostate of the HSM, unless `getVertex` and `getMaxID` are overridden.
+             * @param vertices States and pseudostates
+             */
+            void registerVertices(std::initializer_list<Vertex*> vertices);
+
+            /**
+             * @brief Register a single vertex of the HSM.
+             * See `registerVertices`.
+             * @param v State or pseudostate
+             */
+            void registerVertex(Vertex* v);
+
+            /**
+             * @brief Check whether IDs are resolved using registered vertices.
+             * Determined during initialization.
+             * @retval `true` Registered vertices are used
+             * @retval `false` `getVertex` is used
+             */
+            bool usesVertexRegistry(void);
 
             /**
              * @brief Initialize HSM.
              * @param Context object
              * Set the hsm to the underlying states
+             * @retval eOK HSM entered its initial configuration
+             * @retval eTRANSITION_ERROR Hierarchy exceeds `MICROHSM_MAX_STATES` or `MICROHSM_MAX_DEPTH`,
+             *  the initial state or the parent of a choice is not part of the HSM, or the HSM does not
+             *  match its (built) definition; the HSM has no active state and ignores all events
              */
-            void init(void* ctx);
+            MICROHSM_NODISCARD eStatus init(void* ctx);
 
             /**
              * @brief Dispatch event to HSM.
@@ -89,10 +418,132 @@ namespace microhsm
              * @param ctx Pointer to context object
              * @retval eOK Event matched a transition
              * @retval eDISPATCH_EVENT_IGNORED Event didn't match a transition
+             * @retval eEVENT_DEFERRED Event deferred by the active configuration
              * @retval eTRANSITION_ERROR Error occurred during dispatch
+             *
+             * After a transition, deferred events that are no longer deferred by
+             * the new active configuration are recalled in order of deferral.
              */
             eStatus dispatch(unsigned int event, void* ctx);
 
+            /**
+             * @brief Dispatch event carrying a payload to HSM.
+             * The event is not copied, `match` functions can access it through
+             * `BaseState::currentEvent` and transitions can pass it to an
+             * `fEventEffect`. Deferred events are stored by ID: an event without
+             * payload is deferred, an event with payload is dropped instead.
+             * @param event Event to dispatch
+             * @param ctx Pointer to context object
+             * @retval eEVENT_NOT_DEFERRED Event with payload deferred by the active configuration, dropped
+             * @return Otherwise see `dispatch(unsigned int, void*)`
+             */
+            eStatus dispatch(const Event& event, void* ctx);
+
+            /**
+             * @brief Get event that is being dispatched.
+             * @return Event, `nullptr` if no event is being dispatched or it was dispatched by ID only
+             */
+            const Event* getCurrentEvent(void);
+
+            /**
+             * @brief Attach event queue.
+             * Events posted with `post` are stored in the queue until
+             * they are dispatched by `runOnce` or `runUntilEmpty`.
+             * @param queue Event queue, `nullptr` to detach the current queue
+             */
+            void attachQueue(AbstractEventQueue* queue);
+
+            /**
+             * @brief Post event to the attached queue.
+             * Can be called concurrently with `runOnce`/`runUntilEmpty` by the
+             * producer(s) of the queue. Wait-free for single-producer queues.
+             * @param event Event to post
+             * @retval `true` Event queued
+             * @retval `false` No queue attached or queue full (see policy of queue)
+             */
+            bool post(unsigned int event);
+
+            /**
+             * @brief Post several events to the attached queue at once.
+             * @param events Events to post, in order
+             * @param count Number of events in `events`
+             * @return Number of queued events
+             */
+            unsigned int postBatch(const unsigned int* events, unsigned int count);
+
+            /**
+             * @brief Deliver timeout event by posting it to the attached queue.
+             * @param event Timeout event
+             * @return See `post`
+             */
+            bool deliverTimeout(unsigned int event) override;
+
+            /**
+             * @brief Set function called after events were posted to the attached queues.
+             * Installed by the scheduler or runtime executing the HSM, such that
+             * events posted to the HSM itself (by its behavior, other HSMs or
+             * timers) make it ready. Called from the thread posting the event.
+             * @param notify Function to call, `nullptr` to remove the current function
+             * @param arg Argument passed to `notify`
+             */
+            void setPostNotify(fPostNotify notify, void* arg);
+
+            /**
+             * @brief Attach queue of events with payload.
+             * Events posted with `post(Event&&)` are dispatched by `runOnce` and
+             * `runUntilEmpty` after the events of the queue attached with `attachQueue`.
+             * Each event is released after its run-to-completion step.
+             * @param queue Payload queue, `nullptr` to detach the current queue
+             */
+            void attachPayloadQueue(BasePayloadQueue* queue);
+
+            /**
+             * @brief Attach timer service.
+             * Used by `BaseState::startTimer` to arm timers scoped to a state.
+             * Scoped timers are disarmed when their state is exited.
+             * Timeout events are posted to the queue attached with `attachQueue`.
+             * @param service Timer service, `nullptr` to detach the current service
+             */
+            void attachTimerService(BaseTimerService* service);
+
+            /**
+             * @brief Post event with payload to the attached payload queue.
+             * Must only be called by the producer of the queue. Calls the
+             * function installed with `setPostNotify`.
+             * @param event Event to move into the queue
+             * @retval `true` Event queued
+             * @retval `false` No payload queue attached or queue full, `event` keeps its payload
+             */
+            bool post(Event&& event);
+
+            /**
+             * @brief Check whether events are waiting to be dispatched.
+             * Only exact when no events are posted or dispatched concurrently.
+             * @retval `true` The attached queue or payload queue holds events
+             * @retval `false` Both queues are empty or detached
+             */
+            bool hasQueuedEvents(void) const;
+
+            /**
+             * @brief Dispatch a single event from the attached queue.
+             * Must only be called by the consumer of the queue.
+             * @param ctx Pointer to context object
+             * @retval `true` An event was dispatched
+             * @retval `false` No event was queued
+             */
+            bool runOnce(void* ctx);
+
+            /**
+             * @brief Dispatch events from the attached queue until it is empty.
+             * Events are popped in batches of `MICROHSM_QUEUE_BATCH_SIZE` and
+             * dispatched one at a time. Events posted during the run are
+             * dispatched as well.
+             * Must only be called by the consumer of the queue.
+             * @param ctx Pointer to context object
+             * @return Number of dispatched events
+             */
+            unsigned int runUntilEmpty(void* ctx);
+
             /**
              * @brief Get current state of HSM.
              * @return Current state of HSM
@@ -106,6 +557,171 @@ namespace microhsm
              */
             bool inState(unsigned int ID);
 
+            /**
+             * @brief Check whether HSM is in any of the states.
+             * @param IDs Array of state IDs
+             * @param count Number of IDs in `IDs`
+             * @return Whether the current state or one of its parents has one of the IDs
+             */
+            bool inAnyState(const unsigned int* IDs, unsigned int count);
+
+            /**
+             * @brief Get number of avoided anonymous transition sweeps.
+             *
+             * After every transition the new active state and its ancestors are matched
+             * against `EVENT_ANONYMOUS`. This sweep is skipped when none of these states
+             * can handle anonymous events (see `BaseState::handledEvents`).
+             *
+             * @return Number of skipped sweeps since initialization
+             */
+            unsigned long getSkippedAnonymousSweeps(void);
+
+            /**
+             * @brief Get events handled or deferred by any state.
+             * Combines `BaseState::handledEvents` and `BaseState::deferredEvents`
+             * of all states, e.g. to subscribe the HSM to an `EventBus`.
+             * Only valid after `init`.
+             * @return Mask of events the HSM can react to
+             */
+            tEventMask getHandledEvents(void);
+
+            /**
+             * @brief Get least common ancestor of two states.
+             * @param ID1 ID of first state
+             * @param ID2 ID of second state
+             * @return Deepest state that is (an ancestor of) both states, `nullptr` if no such state exists
+             */
+            BaseState* getCommonAncestor(unsigned int ID1, unsigned int ID2);
+
+            /**
+             * @brief Get method used for finding least common ancestors.
+             * Selected during initialization based upon the number of states
+             * and the depth of the hierarchy.
+             * @return Strategy
+             */
+            eLCAStrategy getLCAStrategy(void);
+
+            /**
+             * @brief Override method used for finding least common ancestors.
+             * Must be called after initialization.
+             * @param strategy Strategy to use
+             * @retval `true` Strategy selected
+             * @retval `false` Strategy not available for this HSM
+             */
+            bool setLCAStrategy(eLCAStrategy strategy);
+
+            /**
+             * @brief Get size of a snapshot.
+             * Only valid after `init`.
+             * @return Number of bytes written by `snapshot`
+             */
+            unsigned int getSnapshotSize(void);
+
+            /**
+             * @brief Write the active configuration to a buffer.
+             * Stores the active leaf state and the states stored by all history
+             * pseudostates as state indices in a versioned binary form. Deferred
+             * events, queued events and timers are not part of the snapshot.
+             * The configuration of the regions of orthogonal states follows the
+             * configuration of the HSM.
+             * @param buffer Buffer receiving the snapshot
+             * @param size Size of `buffer` in bytes
+             * @return Number of bytes written, `0` if `buffer` is too small
+             */
+            unsigned int snapshot(uint8_t* buffer, unsigned int size);
+
+            /**
+             * @brief Restore the active configuration from a snapshot.
+             * No entry or exit behavior is performed. Deferred events are discarded
+             * and timers scoped to states are disarmed. The snapshot must stem from
+             * an initialized HSM of the same structure. Regions of orthogonal states
+             * are restored along with the HSM.
+             * @param buffer Snapshot written by `snapshot`
+             * @param size Size of the snapshot in bytes
+             * @retval `true` Configuration restored
+             * @retval `false` Snapshot does not fit this HSM, configuration unchanged
+             */
+            bool restore(const uint8_t* buffer, unsigned int size);
+
+            /**
+             * @brief Attach event journal.
+             * Every event passed to `dispatch` (directly or from the attached queues)
+             * is appended to the journal before it is processed. Events dispatched
+             * during initialization and recalled deferred events are not journaled.
+             * Regions of orthogonal states take their events from this HSM and do
+             * not journal them again.
+             * @param journal Event journal, `nullptr` to detach the current journal
+             * @param instance ID of this HSM within the journal
+             */
+            void attachJournal(BaseEventJournal* journal, uint32_t instance);
+
+            /**
+             * @brief Enable or disable behavior.
+             * While disabled, entry and exit behavior, transition effects and tracing
+             * are skipped. Guards are still evaluated, and the active configuration
+             * and histories change as usual. Used to replay journals quickly.
+             * Regions of orthogonal states follow the setting of the HSM owning them.
+             * @param enabled Whether behavior is performed (default `true`)
+             */
+            void enableBehavior(bool enabled);
+
+#if MICROHSM_DEFER_QUEUE_SIZE > 0
+            /**
+             * @brief Attach queue storing deferred events.
+             * Required by HSMs whose states defer events, unless the embedded queue
+             * (`MICROHSM_INSTANCE_STORAGE`) is attached. Without a queue deferred
+             * events are dropped and counted by `getDeferOverflows`. Events deferred
+             * before are discarded. Must not be called while the HSM is dispatching.
+             * @param queue Defer queue, `nullptr` to detach the current queue
+             */
+            void attachDeferQueue(DeferQueue* queue);
+
+            /**
+             * @brief Get number of deferred events.
+             * @return Number of events waiting to be recalled
+             */
+            unsigned int getDeferredCount(void);
+
+            /**
+             * @brief Get number of events that could not be deferred.
+             * Events are ignored when no queue is attached or `MICROHSM_DEFER_QUEUE_SIZE`
+             * events are deferred already.
+             * @return Number of lost events since initialization
+             */
+            unsigned long getDeferOverflows(void);
+
+            /**
+             * @brief Discard all deferred events.
+             */
+            void clearDeferredEvents(void);
+#endif
+
+#if MICROHSM_TRANSITION_CACHE_SIZE > 0
+            /**
+             * @brief Enable or disable the transition path cache.
+             * The cache is enabled by default. Changing the setting clears the cache.
+             * @param enable Whether transitions should be looked up in the cache
+             */
+            void enableTransitionCache(bool enable);
+
+            /**
+             * @brief Clear transition path cache and its statistics.
+             */
+            void clearTransitionCache(void);
+
+            /**
+             * @brief Get number of transitions replayed from the cache.
+             * @return Number of cache hits
+             */
+            unsigned long getTransitionCacheHits(void);
+
+            /**
+             * @brief Get number of transitions that had to be resolved.
+             * @return Number of cache misses
+             */
+            unsigned long getTransitionCacheMisses(void);
+#endif
+
         protected:
 
             /**
@@ -117,80 +733,253 @@ namespace microhsm
             virtual void init_(void* ctx) {(void)ctx;};
 
             /// @brief Current active state (always a leaf state)
-            BaseState* curState; //TODO: Can be made a reference?
+            BaseState* curState;
 
             /// @brief Initial state
             BaseState& initState;
 
         private:
 
+            /**
+             * @enum eStateFlag
+             * @brief Flags stored in the state table
+             */
+            enum eStateFlag : uint8_t {
+                eFLAG_COMPOSITE = 0x01,         ///< State is a composite state
+                eFLAG_SHALLOW_HISTORY = 0x02,   ///< State has a shallow history pseudostate
+                eFLAG_DEEP_HISTORY = 0x04,      ///< State has a deep history pseudostate
+                eFLAG_ANONYMOUS = 0x08,         ///< State or one of its ancestors handles anonymous events
+                eFLAG_ORTHOGONAL = 0x10,        ///< State contains orthogonal regions
+            };
+
             /* --- Private Static Functions --- */
 
+#if MICROHSM_TRANSITION_CACHE_SIZE > 0
+            /**
+             * @brief Compute cache slot of a transition path
+             * @param leaf Active leaf state
+             * @param source Source state of transition
+             * @param target Resolved target state of transition
+             * @param kind Kind of transition
+             * @return Index into the transition cache
+             */
+            static unsigned int cacheIndex_(tStateIndex leaf, tStateIndex source,
+                    tStateIndex target, eTransitionKind kind);
+#endif
+
+            /* --- Private Member Functions --- */
+
+            /**
+             * @brief Dispatch a single event from the attached payload queue
+             * @param ctx Context object
+             * @return Whether an event was dispatched
+             */
+            bool runPayloadOnce_(void* ctx);
+
             /**
              * @brief Perform effect action
-             * @note Will ignore effect if t->effect is `nullptr`
+             * @note Will ignore effects that are `nullptr`
              * @param t Pointer to transition descriptor
              * @param ctx Context object
              */
-            static void performEffect_(const sTransition* t, void* ctx);
+            void performEffect_(const sTransition* t, void* ctx);
+
+            /**
+             * @brief Perform internal transition on current state
+             * @param t Pointer to transition description
+             * @param ctx Context object
+             * @return eStatus
+             */
+            eStatus performTransitionInternal_(const sTransition* t, void* ctx);
+
+            /**
+             * @brief Register the vertices provided by an overridden `getVertex`
+             */
+            void registerLookup_(void);
+
+            /**
+             * @brief Get position of a vertex relative to this HSM
+             * @param v Vertex
+             * @return Position stored in the definition
+             */
+            intptr_t offsetOf_(const Vertex* v);
+
+            /**
+             * @brief Get vertex of this HSM by its position
+             * @param offset Position stored in the definition (`0` for none)
+             * @return Vertex, `nullptr` if `offset` is `0`
+             */
+            Vertex* vertexAt_(intptr_t offset);
+
+            /**
+             * @brief Get state object of this HSM
+             * @param s Index of state
+             * @return State
+             */
+            BaseState* state_(tStateIndex s);
+
+            /**
+             * @brief Place registered vertices into lookup table
+             * Uses `ID - lowest ID` as slot when the IDs fit into the table,
+             * otherwise searches for a modulus that maps the IDs onto unique slots.
+             */
+            void buildRegistry_(void);
+
+            /**
+             * @brief Verify registered vertices against (overridden) `getVertex`
+             * @retval `true` Registry can be used to resolve IDs
+             * @retval `false` Registry does not agree with `getVertex`
+             */
+            bool verifyRegistry_(void);
+
+            /**
+             * @brief Find vertex among registered vertices
+             * @param ID ID of vertex
+             * @return Vertex, `nullptr` if no vertex was registered with `ID`
+             */
+            Vertex* findRegisteredVertex_(unsigned int ID);
+
+            /**
+             * @brief Resolve vertex ID
+             * Uses the registry if valid, otherwise `getVertex`.
+             * @param ID ID of vertex
+             * @return Vertex, `nullptr` if it does not exist
+             */
+            Vertex* lookupVertex_(unsigned int ID);
+
+            /**
+             * @brief Flatten the state hierarchy into the state table
+             * Assigns an index to every state and resolves parents, initial
+             * states, depths, flags and handled events into index based arrays.
+             * Once the definition is built, the hierarchy is compared with it instead.
+             * @return Whether the hierarchy fits the state table (and matches the definition),
+             *  the table of a definition that is being built is empty otherwise
+             */
+            bool buildStateTable_(void);
 
             /**
              * @brief Update the shallow and deep history of parent states
              * @param newState The state that has newly been activated
              */
-            static void updateHistories_(BaseState* newState);
+            void updateHistories_(tStateIndex newState);
 
             /**
-             * @brief Perform internal transition on current state
-             * @param t Pointer to transition description
+             * @brief Number states in depth-first order
+             * Every state gets a pre-order number and the highest pre-order
+             * number of its descendants, such that ancestry checks become
+             * two comparisons.
+             */
+            void numberStates_(void);
+
+            /**
+             * @brief Find index of state in the state table
+             * @param ID ID of state
+             * @return Index of state, `STATE_INDEX_NONE` if no state has `ID`
+             */
+            tStateIndex findStateIndex_(unsigned int ID);
+
+            /**
+             * @brief Check ancestry of states
+             * @param ancestor Possible ancestor
+             * @param s State
+             * @return Whether `ancestor` is `s` or one of its ancestors
+             */
+            bool isAncestorOrSelf_(tStateIndex ancestor, tStateIndex s);
+
+            /// Ways of reading a snapshot
+            enum eSnapshotRead {
+                eSNAPSHOT_VERIFY,   ///< Check that the snapshot fits this HSM
+                eSNAPSHOT_COMPARE,  ///< Check that the snapshot equals the active configuration
+                eSNAPSHOT_APPLY     ///< Restore a verified snapshot
+            };
+
+            /**
+             * @brief Read the part of a snapshot describing this HSM and its regions
+             * @param p Start of the part
+             * @param end End of the snapshot
+             * @param mode Way of reading the snapshot
+             * @return End of the part, `nullptr` if verification or comparison failed
+             */
+            const uint8_t* readSnapshot_(const uint8_t* p, const uint8_t* end, eSnapshotRead mode);
+
+            /**
+             * @brief Build the state table and initialize states, first part of `init`
              * @param ctx Context object
-             * @return eStatus
+             * @return Whether the hierarchy (including regions) fits the state table
              */
-            static eStatus performTransitionInternal_(const sTransition* t, void* ctx);
+            bool build_(void* ctx);
 
             /**
-             * @brief Find least common ancestor
-             * @note As side-effect creates a path from LCA to `b`
-             * @param a Pointer to first state
-             * @param b Pointer to second state
-             * @return Least common ancestor, `nullptr` if LCA doesn't exist
+             * @brief Enter the initial configuration, second part of `init`
+             * Also used by orthogonal states to enter their regions.
+             * @param ctx Context object
              */
-            static BaseState* findLCA_(BaseState* a, BaseState* b);
+            void start_(void* ctx);
 
-            /* --- Private Member Functions --- */
+            /**
+             * @brief Exit the active configuration, used by orthogonal states to exit their regions
+             * @param ctx Context object
+             */
+            void stop_(void* ctx);
+
+            /**
+             * @brief Get events handled or deferred by the active configuration
+             * @return Event mask, `EVENT_MASK_ALL` without event masks
+             */
+            tEventMask getActiveEvents_(void);
+
+            /**
+             * @brief Build least common ancestor lookup tables
+             */
+            void buildLCATables_(void);
+
+            /**
+             * @brief Find least common ancestor by walking up the hierarchy
+             * @param a First state
+             * @param b Second state
+             * @return Least common ancestor, `STATE_INDEX_NONE` if LCA doesn't exist
+             */
+            tStateIndex walkLCA_(tStateIndex a, tStateIndex b);
+
+            /**
+             * @brief Find least common ancestor
+             * @param a First state
+             * @param b Second state
+             * @return Least common ancestor, `STATE_INDEX_NONE` if LCA doesn't exist
+             */
+            tStateIndex findLCA_(tStateIndex a, tStateIndex b);
 
             /**
              * @brief Exits states until the `target` state is reached.
-             * @param start Pointer to state from where to start from
-             * @param target Pointer to target state
+             * @param start State from where to start from
+             * @param target Target state
              * @param ctx Context object
-             * @return Pointer to state if found, otherwise `nullptr`
+             * @return `target` if found, otherwise `STATE_INDEX_NONE`
              */
-            BaseState* exitUntilTarget_(BaseState* start, const BaseState* target, void* ctx);
+            tStateIndex exitUntilTarget_(tStateIndex start, tStateIndex target, void* ctx);
 
             /**
              * @brief Perform entry effects until `target` (including)
              * @note Does not perform entry behavior of `startState`
-             * @param startState State to start from (can be `nullptr`)
-             * @param targetState Final state to enter (cannot be `nullptr`)
-             * @param Context object
-             * @return `targetState` if successfull, `nullptr` otherwise. 
+             * @param startState State to start from (can be `STATE_INDEX_NONE`)
+             * @param targetState Final state to enter
+             * @param ctx Context object
              */
-            BaseState* enterUntilTarget_(const BaseState* startState, BaseState* targetState, void* ctx);
+            void enterUntilTarget_(tStateIndex startState, tStateIndex targetState, void* ctx);
 
             /**
-             * @brief Enter a statertementen geldt vaak een VvE-reglement waarin be
+             * @brief Enter a state
              * @param s State
              * @param ctx Context object
              */
-            void enterState_(BaseState* s, void* ctx);
+            void enterState_(tStateIndex s, void* ctx);
 
             /**
              * @brief Exit state
              * @param s State
              * @param ctx Context object
              */
-            void exitState_(BaseState* s, void* ctx);
+            void exitState_(tStateIndex s, void* ctx);
 
             /**
              * @brief Enter initial pseudostates
@@ -199,42 +988,246 @@ namespace microhsm
              * @param ctx Context object
              * @return Last state that was entered
              */
-            BaseState* enterInitialStates_(BaseState* s, void* ctx);
+            tStateIndex enterInitialStates_(tStateIndex s, void* ctx);
 
             /**
              * @brief Get target of transition
-             * Determines target by evaluating the `targetID` of transition
-             * There is the possibility that the `targetID` is of type:
+             * Determines target by evaluating the target vertex of transition
+             * There is the possibility that the vertex is of type:
              * `ePSEUDO_HISTORY` in which case the last set history state
              * will be returned as the transition target.
-             * @param targetID of target
+             * @param targetV Target vertex (state or history pseudostate, `nullptr` if unknown)
+             * @return Index of target state, `STATE_INDEX_NONE` if the target is not a state of this HSM
              */
-            BaseState* getTransitionTarget_(unsigned int targetID);
+            tStateIndex getTransitionTarget_(Vertex* targetV);
 
             /**
              * @brief Try to match event to State or one of its ancestors
              * @param event Event to match
              * @param t Pointer to transition object.
              * @param ctx Context object
-             * @retval `false` No match was found
-             * @retval `true` Match was found, `t` will contain transition description
+             * @param first First state to match
+             * @param last Last state to match, `STATE_INDEX_NONE` to match all ancestors
+             * @return Index of matching state, `STATE_INDEX_NONE` if no match was found.
+             * On a match `t` will contain the transition description.
+             */
+            tStateIndex matchStateOrAncestor_(unsigned int event, sTransition* t, void* ctx,
+                    tStateIndex first, tStateIndex last);
+
+            /**
+             * @brief Match event to the active configuration and perform the matched transition
+             * A state whose transition is not taken (no branch of a junction is
+             * enabled) passes the event on to its ancestors.
+             * @param event Event to match
+             * @param t Pointer to transition object
+             * @param ctx Context object
+             * @param last Last state to match, `STATE_INDEX_NONE` to match all ancestors
+             * @retval eOK Transition performed
+             * @retval eEVENT_IGNORED No transition taken
+             * @retval eTRANSITION_ERROR Error occurred during transition
+             */
+            eStatus takeTransition_(unsigned int event, sTransition* t, void* ctx, tStateIndex last);
+
+            /**
+             * @brief Dispatch event, without recalling deferred events
+             * @param event Event to dispatch
+             * @param ctx Pointer to context object
+             * @return eStatus
+             */
+            eStatus dispatchEvent_(unsigned int event, void* ctx);
+
+            /**
+             * @brief Dispatch event by ID and recall deferred events, without journaling
+             * @param event Event to dispatch
+             * @param ctx Pointer to context object
+             * @return eStatus
+             */
+            eStatus runToCompletion_(unsigned int event, void* ctx);
+
+            /**
+             * @brief Dispatch event and recall deferred events, without journaling
+             * @param event Event to dispatch
+             * @param ctx Pointer to context object
+             * @return eStatus
+             */
+            eStatus runToCompletion_(const Event& event, void* ctx);
+
+#if MICROHSM_DEFER_QUEUE_SIZE > 0
+            /**
+             * @brief Find innermost state of active configuration deferring event
+             * @param event Event
+             * @return Index of state, `STATE_INDEX_NONE` if event is not deferred
+             */
+            tStateIndex findDeferringState_(unsigned int event);
+
+            /**
+             * @brief Store deferred event
+             * @param event Event to defer
+             * @retval eEVENT_DEFERRED Event stored
+             * @retval eEVENT_IGNORED No space left, event lost
              */
-            bool matchStateOrAncestor_(unsigned int event, sTransition* t, void* ctx);
+            eStatus deferEvent_(unsigned int event);
+
+            /**
+             * @brief Dispatch deferred events no longer deferred by the active configuration
+             * @param ctx Context object
+             */
+            void recallDeferredEvents_(void* ctx);
+#endif
 
             /**
              * @brief Perform transition on current state
              * @param t Pointer to transition description
+             * @param source Index of source state of transition
              * @param ctx Context object
              * @return eStatus
              */
-            eStatus performTransition_(const sTransition* t, void* ctx);
+            eStatus performTransition_(const sTransition* t, tStateIndex source, void* ctx);
+
+            /**
+             * @brief Exit towards the LCA of source and target, perform effects and enter target
+             * @note Does not enter the initial states of `target`
+             * @param kind Kind of transition
+             * @param source Source state (`STATE_INDEX_NONE` for top-level choices)
+             * @param target Target state (`STATE_INDEX_NONE` for top-level choices)
+             * @param t Pointer to transition description
+             * @param branches Branches selected after `t`, their effects are performed after the effect of `t`
+             * @param count Number of branches
+             * @param ctx Context object
+             */
+            void traverse_(eTransitionKind kind, tStateIndex source, tStateIndex target,
+                    const sTransition* t, const sTransition* branches, unsigned int count, void* ctx);
+
+            /**
+             * @brief Perform transition targeting a choice pseudostate
+             * @param t Pointer to transition description
+             * @param branches Branches of junctions leading to the choice
+             * @param count Number of branches
+             * @param source Index of source state of transition
+             * @param choice Choice reached by the transition
+             * @param ctx Context object
+             * @return eStatus
+             */
+            eStatus performChoice_(const sTransition* t, const sTransition* branches, unsigned int count,
+                    tStateIndex source, Choice* choice, void* ctx);
+
+            /**
+             * @brief End a choice without enabled branch (or with an unknown target)
+             * Enters the default configuration of the state containing the choice,
+             * the initial configuration of the HSM for top-level choices.
+             * @param position Index of the state containing the choice (currently active)
+             * @param ctx Context object
+             * @return `eTRANSITION_ERROR`
+             */
+            eStatus abortChoice_(tStateIndex position, void* ctx);
+
+            /**
+             * @brief Set the current state
+             * @param s New current state (can be `STATE_INDEX_NONE`)
+             */
+            void setCurrentState_(tStateIndex s);
 
             /**
              * @brief Set the new active state of the HSM
              * @param newState New active state
              */
-            void setNewActiveState_(BaseState* newState);
+            void setNewActiveState_(tStateIndex newState);
+
+#if MICROHSM_TRANSITION_CACHE_SIZE > 0
+            /**
+             * @brief Replay a cached transition path
+             * @param path Cached transition path
+             * @param t Pointer to transition description
+             * @param branches Branches of junctions selected after `t`
+             * @param count Number of branches
+             * @param ctx Context object
+             * @return eStatus
+             */
+            eStatus replayTransitionPath_(const sTransitionPath* path, const sTransition* t,
+                    const sTransition* branches, unsigned int count, void* ctx);
+
+            /**
+             * @brief Stop recording the current transition path and invalidate it
+             * Used when a path does not fit into a cache entry.
+             */
+            void abortRecording_(void);
+#endif
+
+            /// Event being dispatched (`nullptr` if dispatched by ID)
+            const Event* event_ = nullptr;
+            /// ID of event being dispatched
+            unsigned int eventID_ = 0;
+
+            /// Attached event queue (`nullptr` if no queue is attached)
+            AbstractEventQueue* queue_ = nullptr;
+            /// Attached payload queue (`nullptr` if no queue is attached)
+            BasePayloadQueue* payloadQueue_ = nullptr;
+            /// Function called after events were posted (`nullptr` if not executed by a scheduler)
+            fPostNotify notify_ = nullptr;
+            /// Argument of `notify_`
+            void* notifyArg_ = nullptr;
+
+            /// Attached event journal (`nullptr` if no journal is attached)
+            BaseEventJournal* journal_ = nullptr;
+            /// ID of this HSM within the attached journal
+            uint32_t journalInstance_ = 0;
+            /// Whether behavior and tracing are performed
+            bool behavior_ = true;
+
+            /// Attached timer service (`nullptr` if no service is attached)
+            BaseTimerService* timerService_ = nullptr;
+            /// First armed timer scoped to a state (`TIMER_INDEX_NONE` if none)
+            uint32_t scopedTimers_ = TIMER_INDEX_NONE;
+
+            /* --- Structure --- */
+
+            /// Structure shared by all instances of the HSM class
+            HSMDefinition& definition_;
+            /// Whether registry is used to resolve IDs
+            bool registryValid_ = false;
+            /// Set by default `getVertex`, used to detect overrides
+            bool registryQueried_ = false;
+
+            /// Index of current state (`STATE_INDEX_NONE` if no state is active)
+            tStateIndex cur_ = STATE_INDEX_NONE;
+            /// Number of skipped anonymous transition sweeps
+            unsigned long skippedAnonymousSweeps_ = 0;
+
+            /// Method for finding least common ancestors
+            eLCAStrategy lcaStrategy_ = eLCA_WALK;
+#if MICROHSM_LCA_ACCELERATION == 1
+            /// Minimum depth of hierarchy for which binary lifting is selected
+            static constexpr uint8_t LCA_LIFTING_MIN_DEPTH = 12;
+#endif
+
+#if MICROHSM_DEFER_QUEUE_SIZE > 0
+            /// Attached defer queue (`nullptr` if no queue is attached)
+            DeferQueue* deferQueue_ = nullptr;
+            /// Number of events lost because no queue or no space was left
+            unsigned long deferOverflows_ = 0;
+#endif
+
+#if MICROHSM_TRANSITION_CACHE_SIZE > 0
+            /// Transition path cache
+            sTransitionPath cache_[MICROHSM_TRANSITION_CACHE_SIZE];
+            /// Cache entry that is being recorded (`nullptr` if not recording)
+            sTransitionPath* record_ = nullptr;
+            /// Whether the transition cache is used
+            bool cacheEnabled_ = true;
+            /// Number of cache hits
+            unsigned long cacheHits_ = 0;
+            /// Number of cache misses
+            unsigned long cacheMisses_ = 0;
+#endif
 
+#if MICROHSM_INSTANCE_STORAGE == 1
+            /// Definition used by HSMs constructed without a shared one
+            HSMDefinition ownDefinition_;
+#if MICROHSM_DEFER_QUEUE_SIZE > 0
+            /// Defer queue attached on construction
+            DeferQueue ownDeferQueue_;
+#endif
+#endif
     };
 }
 
@@ -8,15 +8,77 @@
 #ifndef _H_MICROHSM_STATE
 #define _H_MICROHSM_STATE
 
+#include <stdint.h>
+
+#include <microhsm/config.hpp>
 #include <microhsm/objects/Vertex.hpp>
+#include <microhsm/objects/TimerService.hpp>
 
 namespace microhsm
 {
 
-    // Forward declaration of history nodes
+#if MICROHSM_MAX_STATES < 255
+    /// Index of a state in the state table of a `BaseHSM`
+    typedef uint8_t tStateIndex;
+    /// State index used to indicate the absence of a state
+    #define STATE_INDEX_NONE 0xFFu
+#else
+    /// Index of a state in the state table of a `BaseHSM`
+    typedef uint16_t tStateIndex;
+    /// State index used to indicate the absence of a state
+    #define STATE_INDEX_NONE 0xFFFFu
+#endif
+
+    /// Mask of events, bit `n` represents the event with ID `n`
+    typedef MICROHSM_EVENT_MASK_TYPE tEventMask;
+
+    /// Event mask containing all events
+    #define EVENT_MASK_ALL (~static_cast<microhsm::tEventMask>(0))
+
+    /// Number of bits of an event mask
+    #define EVENT_MASK_BITS (sizeof(microhsm::tEventMask) * 8u)
+
+    /// Most significant bit of an event mask, shared by all events that do not fit below it
+    #define EVENT_MASK_SHARED (static_cast<microhsm::tEventMask>(1) << (EVENT_MASK_BITS - 1u))
+
+    /**
+     * @brief Get mask of a single event
+     * @note Events that do not fit into the mask share the most significant bit
+     * @param event Event ID
+     * @return Event mask
+     */
+    constexpr tEventMask eventBit(unsigned int event)
+    {
+        return static_cast<tEventMask>(1) << ((event < EVENT_MASK_BITS) ? event : (EVENT_MASK_BITS - 1u));
+    }
+
+    /**
+     * @brief Create empty event mask
+     * @return Event mask
+     */
+    constexpr tEventMask eventMask()
+    {
+        return 0;
+    }
+
+    /**
+     * @brief Create event mask of a list of events
+     * @param event First event ID
+     * @param events Remaining event IDs
+     * @return Event mask
+     */
+    template <typename... T>
+    constexpr tEventMask eventMask(unsigned int event, T... events)
+    {
+        return eventBit(event) | eventMask(events...);
+    }
+
+    // Forward declaration of history nodes and HSM
     // Not included to avoid recursive inclusion
     class ShallowHistory;
     class DeepHistory;
+    class BaseHSM;
+    class Event;
 
     /**
      * @enum eTransitionKind
@@ -48,6 +110,9 @@ namespace microhsm
     /// Function type of a transition effect
     typedef void (*fTransitionEffect)(void *ctx);
 
+    /// Function type of a transition effect receiving the dispatched event
+    typedef void (*fEventEffect)(void *ctx, const Event& event);
+
     /**
      * @brief Transition Struct.
      *
@@ -57,12 +122,14 @@ namespace microhsm
      * with the `kind` field. Finally, transitions can execute so called
      * effects, which will be triggered when the transition taken.
      * When no effect is desired, the `effect` field can be left as `nullptr`
+     * Effects that need the payload of the dispatched event use `eventEffect`.
      */
     typedef struct {
-        unsigned int sourceID;          ///< Source of transition (State)
-        unsigned int targetID;          ///< Target of transition (State/History)
+        tVertexID sourceID;             ///< Source of transition (State)
+        tVertexID targetID;             ///< Target of transition (State/History)
         eTransitionKind kind;           ///< Type of transition
         void (*effect) (void* ctx);     ///< Effect of transition
+        fEventEffect eventEffect;       ///< Effect of transition receiving the event (performed after `effect`)
     } sTransition;
 
     /**
@@ -83,11 +150,14 @@ namespace microhsm
      *  - `void entry(void* ctx)`: Optional entry function executed upon entering the state
      *  - `void exit(void* ctx)`: Optional exit function executed upon leaving the state
      *  - `void init_(void* ctx)`: Optional hook called after state initialization
+     *  - `tEventMask handledEvents(void)`: Optional declaration of events handled by `match`
+     *  - `tEventMask deferredEvents(void)`: Optional declaration of events deferred by the state
      */
     class BaseState : public Vertex
     {
         // Provide deep-coupling with `HSM` for dispatching purposes
         friend class BaseHSM;
+        friend class BaseOrthogonalState;
 
         public:
 
@@ -141,6 +211,35 @@ namespace microhsm
              */
             virtual bool match(unsigned int event, sTransition* t, void* ctx) = 0;
 
+            /**
+             * @brief Events handled by this state
+             *
+             * Override this function to declare the events for which `match` can
+             * return `true`, e.g. `return eventMask(eEVENT_A, eEVENT_B);`.
+             * Include `EVENT_ANONYMOUS` if the state has anonymous transitions.
+             * Called once during initialization of the HSM.
+             *
+             * @return Mask of handled events (all events by default)
+             */
+            virtual tEventMask handledEvents(void) {return EVENT_MASK_ALL;}
+
+            /**
+             * @brief Events deferred by this state
+             *
+             * Override this function to declare events that are postponed while
+             * this state is active, e.g. `return eventMask(eEVENT_START);`.
+             * A deferred event is kept by the HSM until the active configuration
+             * no longer defers it. Transitions of this state or its substates take
+             * precedence over the deferral. `EVENT_ANONYMOUS` cannot be deferred.
+             * Only events with IDs below `EVENT_MASK_BITS - 1` can be deferred: higher
+             * IDs share a single bit (`EVENT_MASK_SHARED`), which is ignored in this mask.
+             * Called once during initialization of the HSM.
+             * Requires `MICROHSM_DEFER_QUEUE_SIZE` to be non-zero.
+             *
+             * @return Mask of deferred events (no events by default)
+             */
+            virtual tEventMask deferredEvents(void) {return 0;}
+
             /**
              * @brief Perform state entry
              * @param ctx Context object
@@ -190,7 +289,7 @@ namespace microhsm
             /// Initial state (set to `nullptr` for non-composite states)
             BaseState* const initial;
             /// Depth of state
-            const unsigned int depth;
+            const tVertexID depth;
 
 
         protected:
@@ -251,22 +350,55 @@ namespace microhsm
              */
             bool transitionInternal(sTransition* t, fTransitionEffect effect);
 
-        private:
+            /**
+             * @brief Add effect receiving the dispatched event to a matched transition.
+             *
+             * Used after one of the transition functions, e.g.
+             * `return transitionInternal(t, nullptr) && eventEffect(t, storeSample);`
+             *
+             * @param t Pointer to transition object
+             * @param effect Effect to execute upon transition
+             * @return `true`
+             */
+            bool eventEffect(sTransition* t, fEventEffect effect);
 
             /**
-             * @brief Compute depth of state
-             * @return Depth of state
+             * @brief Get event that is being dispatched.
+             * Can be used by `match` to inspect the payload, e.g. when evaluating guards.
+             * @return Event, `nullptr` if the event was dispatched by ID only
              */
-            static unsigned int computeDepth_(BaseState* s);
+            const Event* currentEvent(void);
 
             /**
-             * @brief Temporary pointer used for internal purposes
+             * @brief Arm timer scoped to this state.
+             *
+             * Typically called from `entry`. The timer posts `event` to the HSM
+             * after `delay` ticks of the timer service attached with
+             * `BaseHSM::attachTimerService`, and is disarmed when the state is exited.
+             * Disarming does not withdraw a timeout event that was already posted:
+             * it is still dispatched after the state was exited, handle it only
+             * in the states that expect it.
              *
-             * This pointer is used to link states temporarily together.
-             * This is used by `HSM` during event dispatching to create
-             * paths that are traversed during the activation of transitions.
+             * @param delay Number of ticks until expiry
+             * @param event Timeout event
+             * @param period Ticks between repeated expiries (`0` for a one-shot timer)
+             * @return Handle of timer, `TIMER_HANDLE_NONE` if no service is attached or no timer is available
+             */
+            tTimerHandle startTimer(uint32_t delay, unsigned int event, uint32_t period = 0);
+
+        private:
+
+            /**
+             * @brief Compute depth of state
+             * @return Depth of state
              */
-            BaseState* tmp_ = nullptr;
+            static tVertexID computeDepth_(BaseState* s);
+
+            /// HSM which owns the state (assigned during initialization)
+            BaseHSM* hsm_ = nullptr;
+
+            /// Index of state in the state table of its `BaseHSM` (assigned during initialization)
+            tStateIndex index_ = STATE_INDEX_NONE;
 
             /// Shallow history pseudostate pointer
             ShallowHistory* shallowHistory_ = nullptr;
@@ -275,6 +407,8 @@ namespace microhsm
 
             /// Whether state is a composite state
             bool isComposite_ = false;
+            /// Whether state contains orthogonal regions (`BaseOrthogonalState`)
+            bool isOrthogonal_ = false;
     };
 }
 
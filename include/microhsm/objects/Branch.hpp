@@ -0,0 +1,136 @@
+/**
+ * @file Branch.hpp
+ * @brief Choice and junction pseudostates
+ *
+ * Contains class declarations for:
+ *  - BaseBranch
+ *  - Choice
+ *  - Junction
+ *
+ * @author Jelle Meijer
+ * @date 2025-05-23
+ */
+
+#ifndef _H_MICROHSM_BRANCH
+#define _H_MICROHSM_BRANCH
+
+#include <microhsm/objects/BaseState.hpp>
+
+namespace microhsm
+{
+    /**
+     * @class BaseBranch
+     * @brief Branch base class
+     *
+     * Base class for the `Choice` and `Junction` classes. A transition
+     * targeting a branch pseudostate continues with one of the outgoing
+     * branches of the pseudostate, selected by evaluating guards. The
+     * transition ends in the state targeted by the selected branch, the
+     * pseudostate itself is never active.
+     *
+     * Derived classes must implement the function:
+     *  - `bool select(sTransition* t, void* ctx)`:
+     *      This function encodes the branches of the pseudostate.
+     */
+    class BaseBranch : public Vertex
+    {
+        public:
+
+            /**
+             * @brief Branch constructor
+             * @param id Unique ID of branch pseudostate
+             * @param type Type of pseudostate (`ePSEUDO_CHOICE` or `ePSEUDO_JUNCTION`)
+             */
+            BaseBranch(unsigned int id, eType type);
+
+            /**
+             * @brief Destructor
+             */
+            virtual ~BaseBranch();
+
+            /**
+             * @brief Select outgoing branch
+             * @param t Pointer to transition struct
+             * @param ctx Context object
+             * @retval `true` A branch was selected
+             * @retval `false` No branch is enabled
+             *
+             * Override this function and implement the logic that inspects guards.
+             * Set the `t` parameter to represent the selected branch by returning
+             * the result of `branch`, or `noBranch` if no guard holds. Branches
+             * can target states, history pseudostates and other branch pseudostates.
+             */
+            virtual bool select(sTransition* t, void* ctx) = 0;
+
+        protected:
+
+            /**
+             * @brief Selected a branch
+             * @param target_ID Target of branch
+             * @param t Pointer to transition object
+             * @param effect Effect to execute upon taking the branch
+             * @return `true`
+             */
+            bool branch(unsigned int target_ID, sTransition* t, fTransitionEffect effect);
+
+            /**
+             * @brief No branch enabled
+             * @return `false`
+             */
+            bool noBranch(void);
+    };
+
+    /**
+     * @class Choice
+     * @brief Choice pseudostate
+     *
+     * A choice evaluates its guards dynamically: the transition reaching
+     * it first exits the states up to the parent of the choice and performs
+     * its effect, such that the guards see the results of the effect.
+     * The selected branch then continues from the parent of the choice.
+     * A choice must always have an enabled branch. Otherwise (or when the
+     * selected branch targets an unknown vertex) the transition ends with
+     * `eTRANSITION_ERROR` in the default configuration of the parent of the
+     * choice, or in the initial configuration of the HSM for a top-level choice.
+     * The parent must be a state of the same HSM, which is verified during
+     * initialization.
+     */
+    class Choice : public BaseBranch
+    {
+        public:
+
+            /**
+             * @brief Choice constructor
+             * @param id Unique ID of choice pseudostate
+             * @param parentState State containing the choice (`nullptr` for a top-level choice)
+             */
+            Choice(unsigned int id, BaseState* parentState);
+
+            /// State containing the choice (`nullptr` for a top-level choice)
+            BaseState* const parent;
+    };
+
+    /**
+     * @class Junction
+     * @brief Junction pseudostate
+     *
+     * A junction evaluates its guards statically: branches of chained
+     * junctions are selected before any state is exited, and the complete
+     * chain is taken as a single transition from the source state to the
+     * target of the last branch. Effects are performed in order along the chain.
+     * When no branch is enabled, the transition is not taken and the
+     * event is offered to the ancestors of the source state.
+     */
+    class Junction : public BaseBranch
+    {
+        public:
+
+            /**
+             * @brief Junction constructor
+             * @param id Unique ID of junction pseudostate
+             */
+            explicit Junction(unsigned int id);
+    };
+}
+
+#endif
@@ -0,0 +1,184 @@
+/**
+ * @file Event.hpp
+ * @brief Events carrying a payload
+ *
+ * @author Jelle Meijer
+ * @date 2025-05-23
+ */
+
+#ifndef _H_MICROHSM_EVENT
+#define _H_MICROHSM_EVENT
+
+#include <string.h>
+#include <type_traits>
+
+#include <microhsm/config.hpp>
+
+namespace microhsm
+{
+    /// Function releasing an external payload when its event is destroyed
+    typedef void (*fPayloadRelease)(void* payload);
+
+    /**
+     * @class Event
+     * @brief Event ID with an optional payload
+     *
+     * Small payloads (up to `MICROHSM_EVENT_PAYLOAD_SIZE` bytes) are stored
+     * inside the event. Larger payloads are referenced by pointer, e.g. to
+     * a block of a memory pool, and released by the event once it is destroyed.
+     *
+     * Events are passed to `BaseHSM::dispatch` by reference, such that the
+     * payload is not copied while the event is matched and transitions are
+     * performed. Events are move-only: moving an event into a queue transfers
+     * ownership of an external payload.
+     */
+    class Event
+    {
+        public:
+
+            /**
+             * @brief Event without payload
+             * @param id Event ID
+             */
+            explicit Event(unsigned int id = 0) :
+                id_(id), size_(0), external_(nullptr), release_(nullptr) {};
+
+            /**
+             * @brief Event with payload stored inside the event
+             * @tparam T Trivially copyable type of at most `MICROHSM_EVENT_PAYLOAD_SIZE` bytes
+             * @param id Event ID
+             * @param payload Payload to store
+             */
+            template <typename T>
+            Event(unsigned int id, const T& payload) :
+                id_(id), size_(sizeof(T)), external_(nullptr), release_(nullptr)
+            {
+                static_assert(sizeof(T) <= MICROHSM_EVENT_PAYLOAD_SIZE, "Payload does not fit, increase `MICROHSM_EVENT_PAYLOAD_SIZE`");
+                static_assert(std::is_trivially_copyable<T>::value, "Payload must be trivially copyable");
+                static_assert(alignof(T) <= alignof(sInlinePayload), "Payload alignment not supported");
+                memcpy(this->inline_.bytes, &payload, sizeof(T));
+            };
+
+            /**
+             * @brief Event with external payload
+             * @param id Event ID
+             * @param payload Pointer to payload, owned by the event
+             * @param size Size of payload in bytes
+             * @param release Called with `payload` when event is destroyed (`nullptr` if not owned)
+             */
+            Event(unsigned int id, void* payload, unsigned int size, fPayloadRelease release) :
+                id_(id), size_(size), external_(payload), release_(release) {};
+
+            Event(const Event&) = delete;
+            Event& operator=(const Event&) = delete;
+
+            /**
+             * @brief Move event, `other` is left without payload
+             * @param other Event to move
+             */
+            Event(Event&& other) :
+                id_(other.id_), size_(other.size_), external_(other.external_), release_(other.release_)
+            {
+                if (other.external_ == nullptr) memcpy(this->inline_.bytes, other.inline_.bytes, other.size_);
+                other.detach_();
+            };
+
+            /**
+             * @brief Move event, `other` is left without payload
+             * @param other Event to move
+             * @return This event
+             */
+            Event& operator=(Event&& other)
+            {
+                if (this != &other) {
+                    this->reset();
+                    this->id_ = other.id_;
+                    this->size_ = other.size_;
+                    this->external_ = other.external_;
+                    this->release_ = other.release_;
+                    if (other.external_ == nullptr) memcpy(this->inline_.bytes, other.inline_.bytes, other.size_);
+                    other.detach_();
+                }
+                return *this;
+            };
+
+            /**
+             * @brief Destructor, releases external payload
+             */
+            ~Event() {this->reset();};
+
+            /**
+             * @brief Get event ID
+             * @return Event ID
+             */
+            unsigned int getID(void) const {return this->id_;};
+
+            /**
+             * @brief Get size of payload
+             * @return Size of payload in bytes (`0` if event has no payload)
+             */
+            unsigned int size(void) const {return this->size_;};
+
+            /**
+             * @brief Check whether payload is stored outside the event
+             * @return Whether payload is external
+             */
+            bool isExternal(void) const {return this->external_ != nullptr;};
+
+            /**
+             * @brief Get payload
+             * @return Pointer to payload, `nullptr` if event has no payload
+             */
+            const void* data(void) const
+            {
+                if (this->external_ != nullptr) return this->external_;
+                return (this->size_ > 0) ? this->inline_.bytes : nullptr;
+            };
+
+            /**
+             * @brief Get typed payload
+             * @tparam T Type of payload
+             * @return Pointer to payload, `nullptr` if payload is smaller than `T`
+             */
+            template <typename T>
+            const T* get(void) const
+            {
+                return (this->size_ >= sizeof(T)) ? static_cast<const T*>(this->data()) : nullptr;
+            };
+
+            /**
+             * @brief Release payload, event keeps its ID
+             */
+            void reset(void)
+            {
+                if (this->release_ != nullptr) this->release_(this->external_);
+                this->detach_();
+            };
+
+        private:
+
+            /// Inline payload storage, aligned for any scalar type
+            typedef union {
+                unsigned char bytes[MICROHSM_EVENT_PAYLOAD_SIZE];
+                long long alignLong;
+                double alignDouble;
+                void* alignPointer;
+            } sInlinePayload;
+
+            /// Forget payload without releasing it
+            void detach_(void)
+            {
+                this->size_ = 0;
+                this->external_ = nullptr;
+                this->release_ = nullptr;
+            };
+
+            unsigned int id_;               ///< Event ID
+            unsigned int size_;             ///< Size of payload
+            void* external_;                ///< External payload (`nullptr` if inline or no payload)
+            fPayloadRelease release_;       ///< Release function of external payload
+            sInlinePayload inline_;         ///< Inline payload
+    };
+}
+
+#endif /* _H_MICROHSM_EVENT */
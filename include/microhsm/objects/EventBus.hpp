@@ -0,0 +1,175 @@
+/**
+ * @file EventBus.hpp
+ * @brief Publish/subscribe delivery of events to many HSMs
+ *
+ * Contains declarations for:
+ *  - BaseEventBus
+ *  - EventBus
+ *
+ * @author Jelle Meijer
+ * @date 2025-05-23
+ */
+
+#ifndef _H_MICROHSM_EVENT_BUS
+#define _H_MICROHSM_EVENT_BUS
+
+#include <stdint.h>
+#include <atomic>
+
+#include <microhsm/config.hpp>
+
+namespace microhsm
+{
+    class AbstractEventQueue;
+    class BaseHSM;
+
+    /// Subscribers per bitmap word
+    #define BUS_WORD_BITS 32u
+
+    /// Number of bitmap words holding `bits` bits
+    #define BUS_WORDS(bits) (((bits) + BUS_WORD_BITS - 1u) / BUS_WORD_BITS)
+
+    /**
+     * @class BaseEventBus
+     * @brief Delivers published events to the queues of subscribed HSMs
+     *
+     * Every event ID has a bitmap with one bit per subscriber, and a summary
+     * bitmap with one bit per non-empty word of that bitmap. Publishing an
+     * event only visits the words that contain subscribers, such that the
+     * cost depends on the number of subscribers of the event instead of the
+     * total number of subscribers.
+     *
+     * Subscriptions must not change while events are published. Events can be
+     * published from several threads if the queues of the subscribers support
+     * multiple producers.
+     *
+     * Use `EventBus` to provide the storage.
+     */
+    class BaseEventBus
+    {
+        public:
+
+            /**
+             * @brief Event bus constructor.
+             * @param queues Storage for `maxSubscribers` queues
+             * @param bitmap Storage for `eventCount * BUS_WORDS(maxSubscribers)` words
+             * @param summary Storage for `eventCount * BUS_WORDS(BUS_WORDS(maxSubscribers))` words
+             * @param maxSubscribers Maximum number of subscribers
+             * @param eventCount Number of event IDs, events `0` to `eventCount - 1` can be published
+             */
+            BaseEventBus(AbstractEventQueue** queues, uint32_t* bitmap, uint32_t* summary,
+                    unsigned int maxSubscribers, unsigned int eventCount);
+
+            /**
+             * @brief Add subscriber.
+             * @param queue Queue receiving the published events of the subscriber
+             * @return Subscriber index, `-1` if the bus is full
+             */
+            int attach(AbstractEventQueue* queue);
+
+            /**
+             * @brief Add HSM as subscriber of all events it handles.
+             * Attaches `queue` to `hsm` and subscribes it to the events of
+             * `BaseHSM::getHandledEvents`. `hsm` must be initialized.
+             * @param hsm Subscribing HSM
+             * @param queue Queue receiving the published events of `hsm`
+             * @return Subscriber index, `-1` if the bus is full
+             */
+            int attach(BaseHSM& hsm, AbstractEventQueue* queue);
+
+            /**
+             * @brief Subscribe to event.
+             * @param subscriber Subscriber index
+             * @param event Event ID
+             */
+            void subscribe(unsigned int subscriber, unsigned int event);
+
+            /**
+             * @brief Subscribe to all events handled or deferred by the states of `hsm`.
+             * Events that share the last bit of the event mask are all subscribed.
+             * @param subscriber Subscriber index
+             * @param hsm Initialized HSM
+             */
+            void subscribeHandled(unsigned int subscriber, BaseHSM& hsm);
+
+            /**
+             * @brief Unsubscribe from event.
+             * @param subscriber Subscriber index
+             * @param event Event ID
+             */
+            void unsubscribe(unsigned int subscriber, unsigned int event);
+
+            /**
+             * @brief Check subscription.
+             * @param subscriber Subscriber index
+             * @param event Event ID
+             * @return Whether `subscriber` is subscribed to `event`
+             */
+            bool isSubscribed(unsigned int subscriber, unsigned int event) const;
+
+            /**
+             * @brief Publish event to all subscribers.
+             * @param event Event ID
+             * @return Number of subscriber queues that accepted the event
+             */
+            unsigned int publish(unsigned int event);
+
+            /**
+             * @brief Get number of subscribers.
+             * @return Number of attached subscribers
+             */
+            unsigned int getSubscriberCount(void) const;
+
+            /**
+             * @brief Get number of deliveries rejected by full subscriber queues.
+             * @return Number of failed deliveries
+             */
+            unsigned long getFailed(void) const;
+
+        private:
+
+            AbstractEventQueue** const queues_;         ///< Queue of every subscriber
+            uint32_t* const bitmap_;                    ///< Subscribers of every event
+            uint32_t* const summary_;                   ///< Non-empty bitmap words of every event
+            const unsigned int maxSubscribers_;         ///< Capacity
+            const unsigned int eventCount_;             ///< Number of event IDs
+            const unsigned int words_;                  ///< Bitmap words per event
+            const unsigned int summaryWords_;           ///< Summary words per event
+            unsigned int subscriberCount_;              ///< Attached subscribers
+            std::atomic<unsigned long> failed_;         ///< Failed deliveries
+    };
+
+    /**
+     * @class EventBus
+     * @brief Delivers published events to the queues of subscribed HSMs
+     *
+     * Provides the storage for `BaseEventBus`.
+     * Costs a pointer per subscriber and `EVENT_COUNT` bits per subscriber.
+     *
+     * @tparam MAX_SUBSCRIBERS Maximum number of subscribers
+     * @tparam EVENT_COUNT Number of event IDs
+     */
+    template <unsigned int MAX_SUBSCRIBERS, unsigned int EVENT_COUNT>
+    class EventBus : public BaseEventBus
+    {
+        static_assert(MAX_SUBSCRIBERS > 0 && EVENT_COUNT > 0, "Event bus needs subscribers and events");
+
+        public:
+
+            /**
+             * @brief Event bus constructor.
+             */
+            EventBus() : BaseEventBus(queues_, bitmap_, summary_, MAX_SUBSCRIBERS, EVENT_COUNT) {};
+
+        private:
+
+            /// Queue of every subscriber
+            AbstractEventQueue* queues_[MAX_SUBSCRIBERS];
+            /// Subscribers of every event
+            uint32_t bitmap_[EVENT_COUNT * BUS_WORDS(MAX_SUBSCRIBERS)];
+            /// Non-empty bitmap words of every event
+            uint32_t summary_[EVENT_COUNT * BUS_WORDS(BUS_WORDS(MAX_SUBSCRIBERS))];
+    };
+}
+
+#endif /* _H_MICROHSM_EVENT_BUS */
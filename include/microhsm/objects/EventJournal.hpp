@@ -0,0 +1,308 @@
+/**
+ * @file EventJournal.hpp
+ * @brief Journal of dispatched events and deterministic replay
+ *
+ * Contains declarations for:
+ *  - BaseEventJournal
+ *  - EventJournal
+ *  - JournalReplay
+ *
+ * @author Jelle Meijer
+ * @date 2025-05-23
+ */
+
+#ifndef _H_MICROHSM_EVENT_JOURNAL
+#define _H_MICROHSM_EVENT_JOURNAL
+
+#include <stdint.h>
+
+#include <microhsm/config.hpp>
+#include <microhsm/objects/BaseHSM.hpp>
+
+namespace microhsm
+{
+    /// Size of the header of a journal record, the payload follows the header
+    #define JOURNAL_RECORD_HEADER_SIZE 12u
+
+    /// Event ID of records holding a snapshot of an instance
+    #define JOURNAL_CHECKPOINT 0xFFFFu
+
+    /// Largest payload of a journal record
+    #define JOURNAL_MAX_PAYLOAD_SIZE 0xFFFFu
+
+    /// Largest snapshot of a `BaseHSM` without orthogonal states
+    #define JOURNAL_MAX_SNAPSHOT_SIZE (2u + ((2u + (2u * MICROHSM_MAX_STATES)) * sizeof(microhsm::tStateIndex)))
+
+    /**
+     * @brief Write committed journal records to storage
+     * @param ctx Context passed to the journal constructor
+     * @param data Complete records
+     * @param size Size of `data` in bytes
+     * @return Whether the records were written
+     */
+    typedef bool (*fJournalCommit)(void* ctx, const uint8_t* data, unsigned int size);
+
+    /**
+     * @class BaseEventJournal
+     * @brief Append-only journal of the events dispatched to HSMs
+     *
+     * HSMs attached with `BaseHSM::attachJournal` append every dispatched event
+     * to the journal before processing it. Records are collected in a buffer
+     * and passed to the commit callback in groups: when the buffer cannot hold
+     * the next record, or when `commit` is called (e.g. once per iteration of
+     * the main loop). Records are little-endian and consist of:
+     *  - Sequence number (`uint32_t`), incremented for every record
+     *  - Instance ID (`uint32_t`), see `BaseHSM::attachJournal`
+     *  - Event ID (`uint16_t`), `JOURNAL_CHECKPOINT` for snapshots
+     *  - Size of payload (`uint16_t`)
+     *  - Payload of the event or snapshot
+     *
+     * Records that cannot be committed are dropped, but keep their sequence
+     * number such that a replay detects the gap. Events with an ID of
+     * `JOURNAL_CHECKPOINT` or higher do not fit a record and are dropped too.
+     *
+     * Use `EventJournal` to provide the buffer.
+     */
+    class BaseEventJournal
+    {
+        public:
+
+            /**
+             * @brief Event journal constructor.
+             * @param buffer Buffer collecting records until they are committed
+             * @param capacity Size of `buffer` in bytes
+             * @param callback Callback writing records to storage
+             * @param ctx Context passed to `callback`
+             */
+            BaseEventJournal(uint8_t* buffer, unsigned int capacity, fJournalCommit callback, void* ctx);
+
+            /**
+             * @brief Commit all pending records.
+             * @retval `true` No records pending
+             * @retval `false` Commit callback failed, records stay pending
+             */
+            bool commit(void);
+
+            /**
+             * @brief Append snapshot of an instance.
+             * Replay compares the snapshot with the configuration of the replayed instance.
+             * @param instance ID of instance
+             * @param hsm Initialized HSM of instance
+             * @retval `true` Snapshot appended
+             * @retval `false` Snapshot dropped
+             */
+            bool checkpoint(uint32_t instance, BaseHSM& hsm);
+
+            /**
+             * @brief Get sequence number of the next record.
+             * @return Sequence number
+             */
+            uint32_t getSequence(void) const;
+
+            /**
+             * @brief Get number of bytes waiting to be committed.
+             * @return Size of pending records
+             */
+            unsigned int getPending(void) const;
+
+            /**
+             * @brief Get number of successful commits.
+             * @return Number of commits
+             */
+            unsigned long getCommits(void) const;
+
+            /**
+             * @brief Get number of failed commits.
+             * @return Number of times the commit callback failed
+             */
+            unsigned long getFailedCommits(void) const;
+
+            /**
+             * @brief Get number of dropped records.
+             * @return Number of records that did not fit the buffer or could not be committed
+             */
+            unsigned long getDropped(void) const;
+
+        private:
+
+            friend class BaseHSM;
+
+            /**
+             * @brief Append event, called by `BaseHSM` before dispatching it
+             * @param instance ID of instance
+             * @param event Event ID
+             * @param data Payload (`nullptr` if event has no payload)
+             * @param size Size of payload in bytes
+             */
+            void append_(uint32_t instance, unsigned int event, const void* data, unsigned int size);
+
+            /**
+             * @brief Reserve a record, committing pending records if it does not fit
+             * @param instance ID of instance
+             * @param event Event ID
+             * @param size Size of payload in bytes
+             * @return Payload of record, `nullptr` if the record was dropped
+             */
+            uint8_t* reserve_(uint32_t instance, unsigned int event, unsigned int size);
+
+            uint8_t* const buffer_;             ///< Pending records
+            const unsigned int capacity_;       ///< Size of buffer
+            const fJournalCommit commit_;       ///< Commit callback
+            void* const ctx_;                   ///< Context of commit callback
+            unsigned int length_;               ///< Size of pending records
+            uint32_t sequence_;                 ///< Sequence number of next record
+            unsigned long commits_;             ///< Successful commits
+            unsigned long failedCommits_;       ///< Failed commits
+            unsigned long dropped_;             ///< Dropped records
+    };
+
+    /**
+     * @class EventJournal
+     * @brief Append-only journal of the events dispatched to HSMs
+     *
+     * Provides the buffer of `BaseEventJournal`.
+     *
+     * @tparam SIZE Size of buffer in bytes, the number of bytes committed at once
+     */
+    template <unsigned int SIZE>
+    class EventJournal : public BaseEventJournal
+    {
+        static_assert(SIZE >= JOURNAL_RECORD_HEADER_SIZE, "Buffer cannot hold a single record");
+
+        public:
+
+            /**
+             * @brief Event journal constructor.
+             * @param callback Callback writing records to storage
+             * @param ctx Context passed to `callback`
+             */
+            EventJournal(fJournalCommit callback, void* ctx) :
+                BaseEventJournal(buffer_, SIZE, callback, ctx)
+            {
+            };
+
+        private:
+
+            /// Pending records
+            uint8_t buffer_[SIZE];
+    };
+
+    /**
+     * @enum eReplayStatus
+     * @brief Result of replaying journal records
+     */
+    enum eReplayStatus {
+        eREPLAY_OK = 0,         ///< All records replayed
+        eREPLAY_TRUNCATED,      ///< Data ends within a record, see `getOffset`
+        eREPLAY_SEQUENCE,       ///< Record does not have the expected sequence number
+        eREPLAY_INSTANCE,       ///< Record refers to an unknown instance
+        eREPLAY_MISMATCH,       ///< Configuration of an instance differs from a checkpoint
+    };
+
+    /**
+     * @class JournalReplay
+     * @brief Deterministic replay of journal records
+     *
+     * Dispatches the events of a journal to the HSMs of the instances they
+     * were recorded for, and compares the configuration of an instance with
+     * every checkpoint. The HSMs must be in the configuration the recorded
+     * instances were in when the journal started (e.g. freshly initialized),
+     * and must not have a journal attached.
+     *
+     * The journal records events, not the context objects guards evaluate.
+     * Replay selects the recorded transitions only if every guard sees the data
+     * it saw when the event was recorded:
+     *  - With behavior, the context objects must be restored to their contents
+     *    at the start of the journal (or at the checkpoint replay starts from),
+     *    and may only be changed by behavior of the replayed HSMs.
+     *  - Behavior can be suppressed for speed, in which case only the
+     *    configurations and histories are replayed. Guards must then depend
+     *    only on the restored configuration and the event (e.g. its payload),
+     *    never on data changed by behavior.
+     *
+     * A guard that reads data from outside (time, hardware, other threads)
+     * cannot be replayed; a checkpoint mismatch reveals the divergence.
+     *
+     * Records can be replayed in chunks: a chunk ending within a record
+     * returns `eREPLAY_TRUNCATED`, and the next chunk continues at `getOffset`.
+     */
+    class JournalReplay
+    {
+        public:
+
+            /**
+             * @brief Journal replay constructor.
+             * @param hsms HSM of every instance ID (`nullptr` for unknown instances)
+             * @param contexts Context object of every instance ID (`nullptr` to pass no context objects)
+             * @param count Number of instance IDs
+             */
+            JournalReplay(BaseHSM* const* hsms, void* const* contexts, uint32_t count);
+
+            /**
+             * @brief Enable or disable suppression of behavior.
+             * See `BaseHSM::enableBehavior`, behavior is enabled again after every replay.
+             * @param suppress Whether behavior and tracing are skipped (default `false`)
+             */
+            void suppressBehavior(bool suppress);
+
+            /**
+             * @brief Set sequence number of the next record.
+             * @param sequence Sequence number, `0` for the start of a journal
+             */
+            void setSequence(uint32_t sequence);
+
+            /**
+             * @brief Replay records.
+             * @param data Complete records as written by the commit callback
+             * @param size Size of `data` in bytes
+             * @return eReplayStatus, records up to `getOffset` were replayed
+             */
+            eReplayStatus replay(const uint8_t* data, unsigned long size);
+
+            /**
+             * @brief Get sequence number of the next record.
+             * @return Sequence number
+             */
+            uint32_t getSequence(void) const;
+
+            /**
+             * @brief Get offset of the first record not replayed by the last `replay`.
+             * @return Offset in bytes
+             */
+            unsigned long getOffset(void) const;
+
+            /**
+             * @brief Get number of replayed events.
+             * @return Number of events
+             */
+            unsigned long getEvents(void) const;
+
+            /**
+             * @brief Get number of verified checkpoints.
+             * @return Number of checkpoints
+             */
+            unsigned long getCheckpoints(void) const;
+
+        private:
+
+            /**
+             * @brief Compare configuration of instance with checkpoint
+             * @param hsm HSM of instance
+             * @param snapshot Snapshot of checkpoint
+             * @param size Size of snapshot in bytes
+             * @return Whether configuration matches
+             */
+            static bool verify_(BaseHSM& hsm, const uint8_t* snapshot, unsigned int size);
+
+            BaseHSM* const* const hsms_;        ///< HSM of every instance
+            void* const* const contexts_;       ///< Context object of every instance
+            const uint32_t count_;              ///< Number of instances
+            bool suppress_;                     ///< Whether behavior is suppressed
+            uint32_t sequence_;                 ///< Sequence number of next record
+            unsigned long offset_;              ///< First record not replayed
+            unsigned long events_;              ///< Replayed events
+            unsigned long checkpoints_;         ///< Verified checkpoints
+    };
+}
+
+#endif /* _H_MICROHSM_EVENT_JOURNAL */
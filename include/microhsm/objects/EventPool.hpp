@@ -0,0 +1,242 @@
+/**
+ * @file EventPool.hpp
+ * @brief Fixed-block pools for reference-counted event payloads
+ *
+ * Contains declarations for:
+ *  - BaseEventPool
+ *  - EventPool
+ *  - EventPoolSet
+ *
+ * @author Jelle Meijer
+ * @date 2025-05-23
+ */
+
+#ifndef _H_MICROHSM_EVENT_POOL
+#define _H_MICROHSM_EVENT_POOL
+
+#include <atomic>
+
+#include <microhsm/config.hpp>
+#include <microhsm/objects/Event.hpp>
+
+namespace microhsm
+{
+    /// Alignment of pool blocks and their payloads
+    #define POOL_BLOCK_ALIGNMENT 8u
+
+    /// Round `size` up to the alignment of pool blocks
+    #define POOL_ALIGN(size) (((size) + POOL_BLOCK_ALIGNMENT - 1u) & ~(POOL_BLOCK_ALIGNMENT - 1u))
+
+    class BaseEventPool;
+
+    /**
+     * @brief Header preceding the payload of every pool block.
+     */
+    typedef struct {
+        std::atomic<unsigned int> refs;     ///< Number of events referencing the block (`0` if free)
+        std::atomic<unsigned int> next;     ///< Next free block
+        BaseEventPool* pool;                ///< Pool owning the block
+    } sPoolBlockHeader;
+
+    /// Bytes between the start of a block and its payload
+    #define POOL_HEADER_SIZE POOL_ALIGN(sizeof(microhsm::sPoolBlockHeader))
+
+    /// Bytes of a block with a payload of `size` bytes
+    #define POOL_BLOCK_STRIDE(size) (POOL_HEADER_SIZE + POOL_ALIGN(size))
+
+    /**
+     * @class BaseEventPool
+     * @brief Lock-free pool of fixed-size payload blocks with reference counts
+     *
+     * A block is allocated with a reference count of one and is returned
+     * to the pool once its last reference is released. Events referencing
+     * a block are created with `makeEvent` and can be shared with `share`,
+     * such that a single payload can be posted to many HSMs. The last HSM
+     * to finish its run-to-completion step returns the block to the pool.
+     *
+     * Allocation and release are lock-free and can be called from any thread.
+     * Pools hold at most `0xFFFF` blocks.
+     *
+     * Use `EventPool` to provide the storage.
+     */
+    class BaseEventPool
+    {
+        public:
+
+            /**
+             * @brief Event pool constructor.
+             * @param storage Storage of `count` blocks of `POOL_BLOCK_STRIDE(blockSize)` bytes, aligned to `POOL_BLOCK_ALIGNMENT`
+             * @param blockSize Payload size of every block in bytes
+             * @param count Number of blocks
+             */
+            BaseEventPool(unsigned char* storage, unsigned int blockSize, unsigned int count);
+
+            /**
+             * @brief Allocate block.
+             * @return Payload of block with one reference, `nullptr` if pool is exhausted
+             */
+            void* allocate(void);
+
+            /**
+             * @brief Allocate block and create event referencing it.
+             * @param id Event ID
+             * @param size Size of payload in bytes, at most the block size
+             * @param event Receives the event, untouched if pool is exhausted
+             * @return Payload to fill, `nullptr` if pool is exhausted
+             */
+            void* makeEvent(unsigned int id, unsigned int size, Event& event);
+
+            /**
+             * @brief Add reference to block.
+             * @param payload Payload of block returned by `allocate`
+             */
+            static void retain(void* payload);
+
+            /**
+             * @brief Release reference to block.
+             * Returns the block to its pool once the last reference is released.
+             * Used as `fPayloadRelease` of events referencing pool blocks.
+             * @param payload Payload of block returned by `allocate`
+             */
+            static void release(void* payload);
+
+            /**
+             * @brief Create another event referencing the payload of `event`.
+             * @param event Event with payload allocated from an event pool
+             * @return Event with same ID and payload, holding its own reference
+             */
+            static Event share(const Event& event);
+
+            /**
+             * @brief Get number of references to block.
+             * @param payload Payload of block returned by `allocate`
+             * @return Number of references
+             */
+            static unsigned int getReferences(const void* payload);
+
+            /**
+             * @brief Get payload size of blocks.
+             * @return Block size in bytes
+             */
+            unsigned int getBlockSize(void) const;
+
+            /**
+             * @brief Get number of blocks.
+             * @return Number of blocks
+             */
+            unsigned int getCapacity(void) const;
+
+            /**
+             * @brief Get number of allocated blocks.
+             * @return Number of blocks in use
+             */
+            unsigned int getInUse(void) const;
+
+            /**
+             * @brief Get highest number of blocks in use at once.
+             * @return Peak number of blocks in use
+             */
+            unsigned int getPeakInUse(void) const;
+
+            /**
+             * @brief Get number of allocations that failed because the pool was exhausted.
+             * @return Number of failed allocations
+             */
+            unsigned long getExhausted(void) const;
+
+        private:
+
+            /// Get header of block `index`
+            sPoolBlockHeader* header_(unsigned int index) const;
+
+            /// Push block `index` to the free list
+            void free_(unsigned int index);
+
+            /// Free list head, block index (lower 16 bits) and ABA tag (upper 16 bits)
+            std::atomic<unsigned int> freeHead_;
+            std::atomic<unsigned int> inUse_;           ///< Allocated blocks
+            std::atomic<unsigned int> peak_;            ///< Peak of allocated blocks
+            std::atomic<unsigned long> exhausted_;      ///< Failed allocations
+
+            unsigned char* const storage_;              ///< Block storage
+            const unsigned int blockSize_;              ///< Payload size of blocks
+            const unsigned int stride_;                 ///< Bytes per block, including header
+            const unsigned int count_;                  ///< Number of blocks
+    };
+
+    /**
+     * @class EventPool
+     * @brief Lock-free pool of fixed-size payload blocks with reference counts
+     *
+     * Provides the storage for `BaseEventPool`.
+     *
+     * @tparam BLOCK_SIZE Payload size of every block in bytes
+     * @tparam COUNT Number of blocks
+     */
+    template <unsigned int BLOCK_SIZE, unsigned int COUNT>
+    class EventPool : public BaseEventPool
+    {
+        static_assert(COUNT > 0 && COUNT < 0xFFFFu, "Pool must hold between 1 and 65534 blocks");
+
+        public:
+
+            /**
+             * @brief Event pool constructor.
+             */
+            EventPool() : BaseEventPool(storage_, BLOCK_SIZE, COUNT) {};
+
+        private:
+
+            /// Block storage
+            alignas(POOL_BLOCK_ALIGNMENT) unsigned char storage_[COUNT * POOL_BLOCK_STRIDE(BLOCK_SIZE)];
+    };
+
+    /**
+     * @class EventPoolSet
+     * @brief Event pools of several size classes
+     *
+     * Allocates from the smallest pool that fits the requested size.
+     * When that pool is exhausted, larger pools are tried.
+     */
+    class EventPoolSet
+    {
+        public:
+
+            /**
+             * @brief Event pool set constructor.
+             * @param pools Pools, sorted by ascending block size
+             * @param count Number of pools in `pools`
+             */
+            EventPoolSet(BaseEventPool* const* pools, unsigned int count);
+
+            /**
+             * @brief Allocate block of at least `size` bytes.
+             * @param size Size of payload in bytes
+             * @return Payload of block with one reference, `nullptr` if no pool can serve `size`
+             */
+            void* allocate(unsigned int size);
+
+            /**
+             * @brief Allocate block and create event referencing it.
+             * @param id Event ID
+             * @param size Size of payload in bytes
+             * @param event Receives the event, untouched if no pool can serve `size`
+             * @return Payload to fill, `nullptr` if no pool can serve `size`
+             */
+            void* makeEvent(unsigned int id, unsigned int size, Event& event);
+
+            /**
+             * @brief Get number of allocations that no pool could serve.
+             * @return Number of failed allocations
+             */
+            unsigned long getExhausted(void) const;
+
+        private:
+
+            BaseEventPool* const* pools_;               ///< Pools, by ascending block size
+            const unsigned int count_;                  ///< Number of pools
+            std::atomic<unsigned long> exhausted_;      ///< Failed allocations
+    };
+}
+
+#endif /* _H_MICROHSM_EVENT_POOL */
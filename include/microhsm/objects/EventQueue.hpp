@@ -0,0 +1,433 @@
+/**
+ * @file EventQueue.hpp
+ * @brief Bounded event queues
+ *
+ * @author Jelle Meijer
+ * @date 2025-05-23
+ */
+
+#ifndef _H_MICROHSM_EVENT_QUEUE
+#define _H_MICROHSM_EVENT_QUEUE
+
+#include <atomic>
+
+#include <microhsm/config.hpp>
+#include <microhsm/objects/Event.hpp>
+
+namespace microhsm
+{
+    /**
+     * @enum eQueuePolicy
+     * @brief Behavior of a multi-producer queue when it is full
+     */
+    enum eQueuePolicy {
+        eQUEUE_BLOCK = 0,       ///< Wait until the consumer frees a slot (`MICROHSM_QUEUE_WAIT`)
+        eQUEUE_DROP_NEWEST,     ///< Discard the pushed event
+        eQUEUE_DROP_OLDEST,     ///< Discard the oldest queued event to make room
+        eQUEUE_FAIL,            ///< Reject the pushed event, caller handles the failure
+    };
+
+    /**
+     * @class AbstractEventQueue
+     * @brief Interface of event queues that can be attached to a `BaseHSM`
+     */
+    class AbstractEventQueue
+    {
+        public:
+
+            virtual ~AbstractEventQueue() {};
+
+            /**
+             * @brief Push event.
+             * @param event Event to push
+             * @retval `true` Event queued
+             * @retval `false` Event not queued
+             */
+            virtual bool push(unsigned int event) = 0;
+
+            /**
+             * @brief Push several events at once.
+             * Events are queued in order.
+             * @param events Events to push
+             * @param count Number of events in `events`
+             * @return Number of queued events
+             */
+            virtual unsigned int pushBatch(const unsigned int* events, unsigned int count) = 0;
+
+            /**
+             * @brief Pop event (consumer only).
+             * @param event Receives the popped event
+             * @retval `true` Event popped
+             * @retval `false` Queue is empty
+             */
+            virtual bool pop(unsigned int& event) = 0;
+
+            /**
+             * @brief Pop several events at once (consumer only).
+             * @param events Receives the popped events
+             * @param max Maximum number of events to pop
+             * @return Number of popped events
+             */
+            virtual unsigned int popBatch(unsigned int* events, unsigned int max) = 0;
+
+            /**
+             * @brief Get number of queued events.
+             * Only exact when no events are pushed or popped concurrently.
+             * @return Number of queued events
+             */
+            virtual unsigned int size(void) const = 0;
+
+            /**
+             * @brief Get capacity of queue.
+             * @return Maximum number of queued events
+             */
+            virtual unsigned int capacity(void) const = 0;
+
+            /**
+             * @brief Check whether queue is empty.
+             * Only exact when no events are pushed or popped concurrently.
+             * @return Whether no events are queued
+             */
+            bool empty(void) const {return this->size() == 0;};
+    };
+
+    /**
+     * @class BaseEventQueue
+     * @brief Lock-free single-producer/single-consumer ring buffer of events
+     *
+     * Exactly one thread (or interrupt/signal handler) may `push` events and
+     * exactly one thread may `pop` events. Both operations are wait-free.
+     * The producer and consumer indices are placed on separate cache lines
+     * (`MICROHSM_CACHE_LINE_SIZE`), such that the producer and consumer
+     * do not invalidate each other's cache lines on every operation.
+     *
+     * Use `EventQueue` to provide the storage.
+     */
+    class BaseEventQueue : public AbstractEventQueue
+    {
+        public:
+
+            /**
+             * @brief Event queue constructor.
+             * @param buffer Storage for events
+             * @param capacity Number of entries in `buffer`, must be a power of two
+             */
+            BaseEventQueue(unsigned int* buffer, unsigned int capacity);
+
+            /**
+             * @brief Push event (producer only).
+             * @param event Event to push
+             * @retval `true` Event queued
+             * @retval `false` Queue is full, event is dropped
+             */
+            bool push(unsigned int event) override;
+
+            /**
+             * @brief Push several events at once (producer only).
+             * Events that do not fit are dropped.
+             * @param events Events to push
+             * @param count Number of events in `events`
+             * @return Number of queued events
+             */
+            unsigned int pushBatch(const unsigned int* events, unsigned int count) override;
+
+            bool pop(unsigned int& event) override;
+            unsigned int popBatch(unsigned int* events, unsigned int max) override;
+            unsigned int size(void) const override;
+            unsigned int capacity(void) const override;
+
+            /**
+             * @brief Get number of events dropped because the queue was full.
+             * @return Number of dropped events
+             */
+            unsigned long getDropped(void) const;
+
+        private:
+
+            /* --- Consumer side --- */
+            alignas(MICROHSM_CACHE_LINE_SIZE) std::atomic<unsigned int> head_;  ///< Next slot to pop
+            unsigned int tailCache_;                                            ///< Last observed `tail_`
+
+            /* --- Producer side --- */
+            alignas(MICROHSM_CACHE_LINE_SIZE) std::atomic<unsigned int> tail_;  ///< Next slot to push
+            unsigned int headCache_;                                            ///< Last observed `head_`
+            std::atomic<unsigned long> dropped_;                                ///< Dropped events
+
+            /* --- Shared, read-only --- */
+            alignas(MICROHSM_CACHE_LINE_SIZE) unsigned int* const buffer_;      ///< Event storage
+            const unsigned int mask_;                                           ///< `capacity - 1`
+    };
+
+    /**
+     * @brief Slot of a multi-producer queue.
+     * `sequence` tells whether the slot is free for a producer
+     * (`sequence == position`) or holds an event for the consumer
+     * (`sequence == position + 1`).
+     */
+    typedef struct {
+        std::atomic<unsigned int> sequence;     ///< Position the slot is ready for
+        unsigned int event;                     ///< Queued event
+    } sQueueSlot;
+
+    /**
+     * @class BaseMPSCEventQueue
+     * @brief Lock-free multi-producer/single-consumer ring buffer of events
+     *
+     * Any number of threads may `push` events, a single thread pops events
+     * and dispatches them, which preserves run-to-completion semantics.
+     * Producers claim slots with a single compare-and-swap, `pushBatch`
+     * claims consecutive slots for several events at once, such that a
+     * producer contends once per batch instead of once per event.
+     *
+     * When the queue is full, the `eQueuePolicy` of the queue decides
+     * what happens with the pushed event. Every policy has a counter.
+     *
+     * Use `MPSCEventQueue` to provide the storage.
+     */
+    class BaseMPSCEventQueue : public AbstractEventQueue
+    {
+        public:
+
+            /**
+             * @brief Multi-producer event queue constructor.
+             * @param slots Storage for events
+             * @param capacity Number of entries in `slots`, must be a power of two
+             * @param policy Behavior when queue is full
+             */
+            BaseMPSCEventQueue(sQueueSlot* slots, unsigned int capacity, eQueuePolicy policy);
+
+            /**
+             * @brief Push event (any producer).
+             * @param event Event to push
+             * @retval `true` Event queued
+             * @retval `false` Queue is full and policy is `eQUEUE_DROP_NEWEST` or `eQUEUE_FAIL`
+             */
+            bool push(unsigned int event) override;
+
+            /**
+             * @brief Push several events at once (any producer).
+             * Events of one batch are queued in order, but can be interleaved
+             * with events of other producers when the queue is almost full.
+             * @param events Events to push
+             * @param count Number of events in `events`
+             * @return Number of queued events
+             */
+            unsigned int pushBatch(const unsigned int* events, unsigned int count) override;
+
+            bool pop(unsigned int& event) override;
+            unsigned int popBatch(unsigned int* events, unsigned int max) override;
+            unsigned int size(void) const override;
+            unsigned int capacity(void) const override;
+
+            /**
+             * @brief Get policy applied when queue is full.
+             * @return Policy
+             */
+            eQueuePolicy getPolicy(void) const;
+
+            /**
+             * @brief Get number of times a producer had to wait (`eQUEUE_BLOCK`).
+             * @return Number of waits
+             */
+            unsigned long getBlocked(void) const;
+
+            /**
+             * @brief Get number of discarded pushed events (`eQUEUE_DROP_NEWEST`).
+             * @return Number of dropped events
+             */
+            unsigned long getDroppedNewest(void) const;
+
+            /**
+             * @brief Get number of discarded queued events (`eQUEUE_DROP_OLDEST`).
+             * @return Number of dropped events
+             */
+            unsigned long getDroppedOldest(void) const;
+
+            /**
+             * @brief Get number of rejected pushed events (`eQUEUE_FAIL`).
+             * @return Number of rejected events
+             */
+            unsigned long getFailed(void) const;
+
+        private:
+
+            /**
+             * @brief Claim up to `count` consecutive free slots
+             * @param count Number of slots to claim
+             * @param pos Receives the position of the first claimed slot
+             * @return Number of claimed slots, `0` if the queue is full
+             */
+            unsigned int claim_(unsigned int count, unsigned int& pos);
+
+            /**
+             * @brief Apply full-queue policy
+             * @param count Number of events that did not fit
+             * @retval `true` Retry pushing
+             * @retval `false` Events are discarded
+             */
+            bool handleFull_(unsigned int count);
+
+            /* --- Consumer side --- */
+            alignas(MICROHSM_CACHE_LINE_SIZE) std::atomic<unsigned int> head_;  ///< Next slot to pop
+
+            /* --- Producer side --- */
+            alignas(MICROHSM_CACHE_LINE_SIZE) std::atomic<unsigned int> tail_;  ///< Next slot to claim
+
+            /* --- Counters --- */
+            alignas(MICROHSM_CACHE_LINE_SIZE) std::atomic<unsigned long> blocked_;  ///< Waits
+            std::atomic<unsigned long> droppedNewest_;                              ///< Dropped pushed events
+            std::atomic<unsigned long> droppedOldest_;                              ///< Dropped queued events
+            std::atomic<unsigned long> failed_;                                     ///< Rejected pushed events
+
+            /* --- Shared, read-only --- */
+            sQueueSlot* const slots_;                                           ///< Event storage
+            const unsigned int mask_;                                           ///< `capacity - 1`
+            const eQueuePolicy policy_;                                         ///< Full-queue policy
+    };
+
+    /**
+     * @class BasePayloadQueue
+     * @brief Lock-free single-producer/single-consumer ring buffer of events with payload
+     *
+     * Same as `BaseEventQueue`, but stores `Event` objects. Events are moved into
+     * and out of the queue, such that external payloads change owner without copying.
+     * The consumer dispatches the events, e.g.
+     * `Event e; while (queue.pop(e)) hsm.dispatch(e, ctx);`
+     *
+     * Use `PayloadQueue` to provide the storage.
+     */
+    class BasePayloadQueue
+    {
+        public:
+
+            /**
+             * @brief Payload queue constructor.
+             * @param buffer Storage for events
+             * @param capacity Number of entries in `buffer`, must be a power of two
+             */
+            BasePayloadQueue(Event* buffer, unsigned int capacity);
+
+            /**
+             * @brief Push event (producer only).
+             * @param event Event to move into the queue, left without payload on success
+             * @retval `true` Event queued
+             * @retval `false` Queue is full, `event` is untouched
+             */
+            bool push(Event&& event);
+
+            /**
+             * @brief Pop event (consumer only).
+             * @param event Receives the popped event, its previous payload is released
+             * @retval `true` Event popped
+             * @retval `false` Queue is empty
+             */
+            bool pop(Event& event);
+
+            /**
+             * @brief Get number of queued events.
+             * Only exact when no events are pushed or popped concurrently.
+             * @return Number of queued events
+             */
+            unsigned int size(void) const;
+
+            /**
+             * @brief Get capacity of queue.
+             * @return Maximum number of queued events
+             */
+            unsigned int capacity(void) const;
+
+        private:
+
+            /* --- Consumer side --- */
+            alignas(MICROHSM_CACHE_LINE_SIZE) std::atomic<unsigned int> head_;  ///< Next slot to pop
+
+            /* --- Producer side --- */
+            alignas(MICROHSM_CACHE_LINE_SIZE) std::atomic<unsigned int> tail_;  ///< Next slot to push
+
+            /* --- Shared, read-only --- */
+            alignas(MICROHSM_CACHE_LINE_SIZE) Event* const buffer_;             ///< Event storage
+            const unsigned int mask_;                                           ///< `capacity - 1`
+    };
+
+    /**
+     * @class EventQueue
+     * @brief Lock-free single-producer/single-consumer event queue
+     *
+     * Provides the storage for `BaseEventQueue`.
+     *
+     * @tparam CAPACITY Number of events, must be a power of two
+     */
+    template <unsigned int CAPACITY>
+    class EventQueue : public BaseEventQueue
+    {
+        static_assert(CAPACITY >= 2 && (CAPACITY & (CAPACITY - 1)) == 0, "Capacity must be a power of two");
+
+        public:
+
+            /**
+             * @brief Event queue constructor.
+             */
+            EventQueue() : BaseEventQueue(buffer_, CAPACITY) {};
+
+        private:
+
+            /// Event storage
+            unsigned int buffer_[CAPACITY];
+    };
+
+    /**
+     * @class MPSCEventQueue
+     * @brief Lock-free multi-producer/single-consumer event queue
+     *
+     * Provides the storage for `BaseMPSCEventQueue`.
+     *
+     * @tparam CAPACITY Number of events, must be a power of two
+     */
+    template <unsigned int CAPACITY>
+    class MPSCEventQueue : public BaseMPSCEventQueue
+    {
+        static_assert(CAPACITY >= 2 && (CAPACITY & (CAPACITY - 1)) == 0, "Capacity must be a power of two");
+
+        public:
+
+            /**
+             * @brief Multi-producer event queue constructor.
+             * @param policy Behavior when queue is full
+             */
+            explicit MPSCEventQueue(eQueuePolicy policy = eQUEUE_BLOCK) :
+                BaseMPSCEventQueue(slots_, CAPACITY, policy) {};
+
+        private:
+
+            /// Event storage
+            sQueueSlot slots_[CAPACITY];
+    };
+
+    /**
+     * @class PayloadQueue
+     * @brief Lock-free single-producer/single-consumer queue of events with payload
+     *
+     * Provides the storage for `BasePayloadQueue`.
+     *
+     * @tparam CAPACITY Number of events, must be a power of two
+     */
+    template <unsigned int CAPACITY>
+    class PayloadQueue : public BasePayloadQueue
+    {
+        static_assert(CAPACITY >= 2 && (CAPACITY & (CAPACITY - 1)) == 0, "Capacity must be a power of two");
+
+        public:
+
+            /**
+             * @brief Payload queue constructor.
+             */
+            PayloadQueue() : BasePayloadQueue(buffer_, CAPACITY) {};
+
+        private:
+
+            /// Event storage
+            Event buffer_[CAPACITY];
+    };
+}
+
+#endif /* _H_MICROHSM_EVENT_QUEUE */
@@ -0,0 +1,283 @@
+/**
+ * @file InstanceStore.hpp
+ * @brief Persistent storage of table-driven HSM instances
+ *
+ * Contains declarations for:
+ *  - BaseInstanceStore
+ *  - InstanceStore
+ *
+ * @author Jelle Meijer
+ * @date 2025-05-23
+ */
+
+#ifndef _H_MICROHSM_INSTANCE_STORE
+#define _H_MICROHSM_INSTANCE_STORE
+
+#include <stdint.h>
+#include <type_traits>
+
+#include <microhsm/config.hpp>
+#include <microhsm/objects/StaticHSM.hpp>
+
+namespace microhsm
+{
+    /// Magic number at the start of an instance store ("MHSM")
+    #define STORE_MAGIC 0x4D53484Du
+
+    /// Version of the layout of an instance store
+    #define STORE_VERSION 1u
+
+    /// Size of the header of an instance store, records start at this offset
+    #define STORE_HEADER_SIZE 64u
+
+    /// Definitions up to this number of vertices validate records using masks of valid states
+    #define STORE_MASK_BITS 64u
+
+    /**
+     * @enum eStoreStatus
+     * @brief Result of formatting or opening an instance store
+     */
+    enum eStoreStatus {
+        eSTORE_OK = 0,          ///< Store is open
+        eSTORE_TOO_SMALL,       ///< Memory cannot hold the header and all records
+        eSTORE_LAYOUT,          ///< Magic, version or layout does not match the definition and record type
+        eSTORE_DIRTY,           ///< Store was not closed, records may be torn
+        eSTORE_CHECKSUM,        ///< Records do not match the checksum written by `close`
+        eSTORE_CORRUPT,         ///< A record holds an invalid state or history
+    };
+
+    /**
+     * @brief Header of an instance store.
+     * Multi-byte fields use the byte order of the target.
+     */
+    typedef struct {
+        uint32_t magic;             ///< `STORE_MAGIC`
+        uint16_t version;           ///< `STORE_VERSION`
+        uint8_t indexWidth;         ///< Size of a `tStaticIndex`
+        uint8_t dirty;              ///< Set while the store is open
+        uint32_t vertexCount;       ///< Number of vertices of the definition
+        uint32_t historyCount;      ///< Number of history pseudostates of the definition
+        uint32_t recordSize;        ///< Size of a record
+        uint32_t userOffset;        ///< Offset of the user data within a record
+        uint32_t count;             ///< Number of records
+        uint32_t headerCheck;       ///< Checksum of the fields above, except `dirty`
+        uint64_t checksum;          ///< Checksum of all records, written by `close`
+    } sStoreHeader;
+
+    static_assert(sizeof(sStoreHeader) <= STORE_HEADER_SIZE, "Header must fit into `STORE_HEADER_SIZE`");
+
+    /**
+     * @class BaseInstanceStore
+     * @brief Instances of a static definition kept in caller-provided memory
+     *
+     * Every record holds the active leaf state, the history slots and the
+     * user data of one instance in a fixed layout behind a header. Since
+     * records contain no pointers, the memory can be a memory-mapped file or
+     * retained RAM: after a restart `open` validates the header and records,
+     * which replaces replaying events to rebuild the configuration of every
+     * instance. The user data of an instance is its context object.
+     *
+     * The dirty flag of the header is set by `format` and `open`, and cleared
+     * by `close` after writing the checksum of all records. Clearing it is a
+     * single store, the header check does not cover it. A store that was
+     * not closed is rejected, unless opened with `recover`, in which case
+     * every record is still checked for valid states and histories.
+     *
+     * The store does not flush memory. For a file mapping, flush the records
+     * before `close` and the header afterwards (e.g. `msync`) such that a
+     * clean header never describes records that did not reach the file.
+     *
+     * Use `InstanceStore` to define the record type.
+     */
+    class BaseInstanceStore
+    {
+        public:
+
+            /**
+             * @brief Instance store constructor.
+             * @param definition Initialized definition of the instances
+             * @param slots Number of history slots of a record
+             * @param recordSize Size of a record
+             * @param userOffset Offset of the user data within a record
+             */
+            BaseInstanceStore(BaseStaticDefinition& definition, unsigned int slots,
+                    unsigned int recordSize, unsigned int userOffset);
+
+            /**
+             * @brief Get size of memory needed for a number of instances.
+             * @param count Number of instances
+             * @return Size in bytes
+             */
+            unsigned long getRequiredSize(uint32_t count) const;
+
+            /**
+             * @brief Write a new store and start every instance.
+             * User data is zeroed before the instances enter their initial state.
+             * The store is open afterwards.
+             * @param memory Memory of store, aligned to 8 bytes
+             * @param size Size of `memory` in bytes
+             * @param count Number of instances
+             * @retval `eSTORE_OK` Store formatted
+             * @retval `eSTORE_TOO_SMALL` See `getRequiredSize`
+             */
+            eStoreStatus format(void* memory, unsigned long size, uint32_t count);
+
+            /**
+             * @brief Open an existing store without performing any behavior.
+             * @param memory Memory holding a store written by `format`, aligned to 8 bytes
+             * @param size Size of `memory` in bytes
+             * @param recover Accept a store that was not closed, skipping the checksum
+             * @return eStoreStatus, the store is only open on `eSTORE_OK`
+             */
+            eStoreStatus open(void* memory, unsigned long size, bool recover = false);
+
+            /**
+             * @brief Write checksum and clear the dirty flag.
+             * Instances must not be dispatched after the store was closed.
+             */
+            void close(void);
+
+            /**
+             * @brief Check whether the store is open.
+             * @return Whether instances can be dispatched
+             */
+            bool isOpen(void) const;
+
+            /**
+             * @brief Get number of instances.
+             * @return Number of records of the open store
+             */
+            uint32_t getCount(void) const;
+
+            /**
+             * @brief Dispatch event to instance.
+             * @param index Index of instance
+             * @param event Event to dispatch
+             * @return See `BaseStaticHSM::dispatch`
+             */
+            eStatus dispatch(uint32_t index, unsigned int event);
+
+            /**
+             * @brief Get current state of instance.
+             * @param index Index of instance
+             * @return ID of current state (always a leaf state)
+             */
+            unsigned int getCurrentState(uint32_t index) const;
+
+            /**
+             * @brief Check whether instance is in state.
+             * @param index Index of instance
+             * @param ID ID of state
+             * @return Whether the current state or one of its parents has `ID`
+             */
+            bool inState(uint32_t index, unsigned int ID) const;
+
+            /**
+             * @brief Get the state stored by a history pseudostate of an instance
+             * @param index Index of instance
+             * @param ID ID of history pseudostate
+             * @return ID of stored state
+             */
+            unsigned int getHistoryState(uint32_t index, unsigned int ID) const;
+
+        protected:
+
+            /**
+             * @brief Get user data of instance
+             * @param index Index of instance
+             * @return User data
+             */
+            void* getUserData_(uint32_t index);
+
+        private:
+
+            /**
+             * @brief Get record of instance
+             * @param index Index of instance
+             * @return Active leaf state, followed by the history slots
+             */
+            tStaticIndex* getRecord_(uint32_t index) const;
+
+            /**
+             * @brief Fill in the fields of a header describing this store
+             * @param header Header to fill in
+             * @param count Number of records
+             */
+            void describe_(sStoreHeader& header, uint32_t count) const;
+
+            /**
+             * @brief Check that every record holds a leaf state and valid histories
+             * @return Whether all records are valid
+             */
+            bool verifyRecords_(void) const;
+
+            /**
+             * @brief Checksum of all records
+             * @return Checksum
+             */
+            uint64_t checksum_(void) const;
+
+            /// Definition of instances
+            BaseStaticDefinition& definition_;
+            /// Number of history slots of a record
+            const unsigned int slots_;
+            /// Size of a record
+            const unsigned int recordSize_;
+            /// Offset of the user data within a record
+            const unsigned int userOffset_;
+            /// Header of open store (`nullptr` if closed)
+            sStoreHeader* header_;
+            /// First record of open store
+            uint8_t* records_;
+            /// Number of records of open store
+            uint32_t count_;
+    };
+
+    /**
+     * @class InstanceStore
+     * @brief Instances of a static definition kept in caller-provided memory
+     *
+     * Defines the record type of `BaseInstanceStore`.
+     *
+     * @tparam HISTORY_COUNT Number of history pseudostates of the definition
+     * @tparam USER Trivially copyable user data of every instance, passed as context object
+     */
+    template <unsigned int HISTORY_COUNT, typename USER>
+    class InstanceStore : public BaseInstanceStore
+    {
+        static_assert(std::is_trivially_copyable<USER>::value, "User data must be trivially copyable");
+
+        public:
+
+            /// Record of a single instance
+            typedef struct {
+                tStaticIndex indices[1 + HISTORY_COUNT];    ///< Active leaf state and history slots
+                USER user;                                  ///< User data
+            } sRecord;
+
+            /// Offset of the user data within a record, first multiple of its alignment after the indices
+            static const unsigned int USER_OFFSET = static_cast<unsigned int>(
+                    ((sizeof(tStaticIndex) * (1 + HISTORY_COUNT)) + alignof(USER) - 1) / alignof(USER) * alignof(USER));
+
+            /**
+             * @brief Instance store constructor.
+             * @param definition Initialized definition of the instances
+             */
+            explicit InstanceStore(BaseStaticDefinition& definition) :
+                BaseInstanceStore(definition, HISTORY_COUNT, sizeof(sRecord), USER_OFFSET)
+            {
+            };
+
+            /**
+             * @brief Get user data of instance.
+             * @param index Index of instance
+             * @return User data
+             */
+            USER& getUserData(uint32_t index)
+            {
+                return *static_cast<USER*>(this->getUserData_(index));
+            };
+    };
+}
+
+#endif /* _H_MICROHSM_INSTANCE_STORE */
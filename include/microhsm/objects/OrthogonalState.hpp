@@ -0,0 +1,344 @@
+/**
+ * @file OrthogonalState.hpp
+ * @brief States with orthogonal regions
+ *
+ * Contains declarations for:
+ *  - RegionExecutor
+ *  - BaseOrthogonalState
+ *  - OrthogonalState
+ *
+ * @author Jelle Meijer
+ * @date 2025-05-23
+ */
+
+#ifndef _H_MICROHSM_ORTHOGONAL_STATE
+#define _H_MICROHSM_ORTHOGONAL_STATE
+
+#include <stdint.h>
+#include <atomic>
+
+#include <microhsm/config.hpp>
+#include <microhsm/objects/BaseHSM.hpp>
+
+namespace microhsm
+{
+    /// Mask of regions, bit `n` represents the region with index `n`
+    typedef uint32_t tRegionMask;
+
+    /// Maximum number of regions of an orthogonal state
+    #define REGION_MAX_COUNT (sizeof(microhsm::tRegionMask) * 8u)
+
+    class BaseOrthogonalState;
+
+    /**
+     * @class RegionExecutor
+     * @brief Dispatches independent regions of orthogonal states on several threads
+     *
+     * The executor does not create threads. Worker threads call `runWorker`
+     * (or `runOnce`) and pick up regions while an orthogonal state using the
+     * executor dispatches an event. The dispatching thread takes part as well
+     * and waits until all regions have finished, such that the run-to-completion
+     * step of the owning HSM ends after every region has processed the event.
+     *
+     * The executor serves one dispatch at a time. A dispatch that finds the
+     * executor busy (e.g. nested orthogonal states, or HSMs on other threads
+     * sharing the executor) dispatches its regions sequentially.
+     */
+    class RegionExecutor
+    {
+        public:
+
+            /**
+             * @brief Region executor constructor.
+             */
+            RegionExecutor();
+
+            /**
+             * @brief Dispatch a single pending region.
+             * @retval `true` A region was dispatched
+             * @retval `false` No region pending
+             */
+            bool runOnce(void);
+
+            /**
+             * @brief Dispatch pending regions until `stop` is set.
+             * Calls `MICROHSM_QUEUE_WAIT()` when no region is pending.
+             * @param stop Flag ending the loop
+             */
+            void runWorker(const std::atomic<bool>& stop);
+
+            /**
+             * @brief Get number of dispatches that ran regions in parallel.
+             * @return Number of parallel dispatches
+             */
+            unsigned long getParallelDispatches(void) const;
+
+            /**
+             * @brief Get number of regions dispatched by worker threads.
+             * @return Number of regions
+             */
+            unsigned long getWorkerRegions(void) const;
+
+        private:
+
+            friend class BaseOrthogonalState;
+
+            /**
+             * @brief Dispatch regions, called by the dispatching thread
+             * @param state Orthogonal state owning the regions
+             * @param regions Independent regions to dispatch in parallel
+             * @param sequential Regions to dispatch on the calling thread
+             * @param event Event ID
+             * @param payload Event being dispatched (`nullptr` if dispatched by ID)
+             * @param ctx Context object
+             * @param results Receives the status of every dispatched region
+             * @retval `true` Regions dispatched
+             * @retval `false` Executor is busy, nothing was dispatched
+             */
+            bool execute_(BaseOrthogonalState& state, tRegionMask regions, tRegionMask sequential,
+                    unsigned int event, const Event* payload, void* ctx, eStatus* results);
+
+            /**
+             * @brief Claim and dispatch a single pending region
+             * @return Whether a region was dispatched
+             */
+            bool runRegion_(void);
+
+            /* --- Job, written by the dispatching thread before `pending_` is published --- */
+            BaseOrthogonalState* state_;                    ///< Orthogonal state owning the regions
+            unsigned int event_;                            ///< Event ID
+            const Event* payload_;                          ///< Event being dispatched
+            void* ctx_;                                     ///< Context object
+            eStatus* results_;                              ///< Status of every region
+
+            /* --- Shared --- */
+            alignas(MICROHSM_CACHE_LINE_SIZE) std::atomic<tRegionMask> pending_;    ///< Regions not yet claimed
+            alignas(MICROHSM_CACHE_LINE_SIZE) std::atomic<unsigned int> remaining_; ///< Regions not yet finished
+            std::atomic<bool> busy_;                        ///< A dispatch is in progress
+            std::atomic<unsigned long> parallel_;           ///< Dispatches that ran regions in parallel
+            std::atomic<unsigned long> workerRegions_;      ///< Regions dispatched by worker threads
+    };
+
+    /**
+     * @class BaseOrthogonalState
+     * @brief State containing orthogonal regions
+     *
+     * Every region is a separate `BaseHSM`, such that the active configuration
+     * of an orthogonal state holds one leaf per region. Within the HSM owning
+     * it, an orthogonal state is a leaf state: it cannot have substates of its
+     * own and its regions are not part of the state table of the owner.
+     *
+     * Entering the state performs its entry behavior, after which the regions
+     * enter their initial configuration in region order. Exiting the state
+     * exits the active configuration of every region (innermost states first,
+     * regions in reverse order), after which the exit behavior of the state
+     * is performed. Regions always start in their initial configuration.
+     *
+     * Dispatched events are offered to the regions before the orthogonal state
+     * and its ancestors. An event consumed (or deferred) by any region is not
+     * matched against the orthogonal state. The state keeps track of which
+     * regions handle which events (see `HSM_DECLARE_HANDLED_EVENTS`), such that
+     * events are only offered to the regions that can take them.
+     *
+     * Region HSMs are constructed separately from the HSM owning the
+     * orthogonal state and register their own vertices. Query the state of a region through `getRegion`. Regions are part of
+     * the owner in every other respect: the owner's snapshots include them,
+     * events reach them through the owner's journal and they follow the
+     * owner's behavior setting. Dispatch events to the owner, not the regions.
+     * A region failing to process an event fails the dispatch of the owner.
+     * Regions share the context object of the owner unless given their own
+     * through `setRegionContext`.
+     *
+     * Regions are dispatched one after another by default. With a
+     * `RegionExecutor` regions declared independent are dispatched concurrently
+     * by the executor's worker threads (see `setExecutor`).
+     *
+     * Use `OrthogonalState` to provide the storage.
+     */
+    class BaseOrthogonalState : public BaseState
+    {
+        public:
+
+            /**
+             * @brief Orthogonal state constructor.
+             * @param id Unique ID of state
+             * @param parentState Parent state (`nullptr` for top-level states)
+             * @param regions Storage for `count` regions, filled with the region HSMs
+             * @param contexts Storage for `count` context objects
+             * @param handled Storage for `count` event masks
+             * @param routes Storage for `EVENT_MASK_BITS` region masks
+             * @param count Number of regions, at most `REGION_MAX_COUNT`
+             */
+            BaseOrthogonalState(unsigned int id, BaseState* parentState, BaseHSM** regions,
+                    void** contexts, tEventMask* handled, tRegionMask* routes, unsigned int count);
+
+            /**
+             * @brief Get region.
+             * @param index Index of region
+             * @return Region HSM, `nullptr` if `index` is out of range
+             */
+            BaseHSM* getRegion(unsigned int index);
+
+            /**
+             * @brief Get number of regions.
+             * @return Number of regions
+             */
+            unsigned int getRegionCount(void) const;
+
+            /**
+             * @brief Get regions whose active configuration handles an event.
+             * Only valid while the state is active.
+             * @param event Event ID
+             * @return Mask of regions
+             */
+            tRegionMask getRoutes(unsigned int event) const;
+
+            /**
+             * @brief Set context object of a region.
+             * Entry and exit behavior, guards and effects of the region receive
+             * this context object instead of the one passed to the owner. Must not
+             * be called while the state is dispatching.
+             * @param index Index of region
+             * @param ctx Context object of the region, `nullptr` to share the context of the owner
+             */
+            void setRegionContext(unsigned int index, void* ctx);
+
+            /**
+             * @brief Dispatch independent regions in parallel.
+             * Independent regions share no data with any other region, including
+             * the context object (see `setRegionContext`), queues and timer services,
+             * and their behavior does not depend on the order in which regions
+             * process an event. Other regions are dispatched by the dispatching
+             * thread. Tracing macros are called from worker threads as well and
+             * must be thread-safe. Must not be called while the state is dispatching.
+             * @param executor Executor running the regions, `nullptr` to dispatch sequentially
+             * @param independent Mask of regions that may run concurrently with all other regions
+             */
+            void setExecutor(RegionExecutor* executor, tRegionMask independent);
+
+        private:
+
+            friend class RegionExecutor;
+
+            friend class BaseHSM;
+
+            /**
+             * @brief Initialize regions, called by `BaseHSM` during initialization
+             * @param ctx Context object
+             * @return Whether the hierarchy of every region fits its state table
+             */
+            bool initRegions_(void* ctx);
+
+            /**
+             * @brief Enter initial configuration of regions, called by `BaseHSM` after entry
+             * @param ctx Context object
+             */
+            void enterRegions_(void* ctx);
+
+            /**
+             * @brief Exit active configuration of regions, called by `BaseHSM` before exit
+             * @param ctx Context object
+             */
+            void exitRegions_(void* ctx);
+
+            /**
+             * @brief Offer event to the regions handling it
+             * @param event Event ID
+             * @param payload Event being dispatched (`nullptr` if dispatched by ID)
+             * @param ctx Context object
+             * @retval `eTRANSITION_ERROR` A region failed to process the event
+             * @retval `eOK` Event consumed by at least one region
+             * @retval `eEVENT_DEFERRED` Event deferred by at least one region
+             * @retval `eEVENT_NOT_DEFERRED` Event with payload dropped by a region deferring it
+             * @retval `eEVENT_IGNORED` No region took the event
+             */
+            eStatus dispatchRegions_(unsigned int event, const Event* payload, void* ctx);
+
+            /**
+             * @brief Dispatch event to a single region
+             * @param r Index of region
+             * @param event Event ID
+             * @param payload Event being dispatched (`nullptr` if dispatched by ID)
+             * @param ctx Context object
+             * @return Status of region
+             */
+            eStatus dispatchRegion_(unsigned int r, unsigned int event, const Event* payload, void* ctx);
+
+            /**
+             * @brief Enable or disable behavior of regions, called by `BaseHSM::enableBehavior`
+             * @param enabled Whether behavior is performed
+             */
+            void enableBehavior_(bool enabled);
+
+            /**
+             * @brief Get context object of a region
+             * @param r Index of region
+             * @param ctx Context object of the owner
+             * @return Context object passed to the region
+             */
+            void* regionContext_(unsigned int r, void* ctx) const;
+
+            /**
+             * @brief Update routes after the active configuration of a region changed
+             * @param r Index of region
+             */
+            void updateRoutes_(unsigned int r);
+
+            /**
+             * @brief Update routes of all regions, called by `BaseHSM` after a restore
+             */
+            void refreshRoutes_(void);
+
+            BaseHSM** const regions_;           ///< Region HSMs
+            void** const contexts_;             ///< Context objects of regions (`nullptr` to share the owner's)
+            tEventMask* const handled_;         ///< Events handled by the active configuration of every region
+            tRegionMask* const routes_;         ///< Regions handling every event bit
+            const unsigned int count_;          ///< Number of regions
+            RegionExecutor* executor_;          ///< Executor of independent regions (`nullptr` if sequential)
+            tRegionMask independent_;           ///< Regions that may be dispatched concurrently
+    };
+
+    /**
+     * @class OrthogonalState
+     * @brief State containing orthogonal regions
+     *
+     * Provides the storage for `BaseOrthogonalState`. Derive from this class
+     * and implement `match` for the transitions of the state itself.
+     *
+     * @tparam REGIONS Number of regions
+     */
+    template <unsigned int REGIONS>
+    class OrthogonalState : public BaseOrthogonalState
+    {
+        static_assert(REGIONS > 0 && REGIONS <= REGION_MAX_COUNT, "Unsupported number of regions");
+
+        public:
+
+            /**
+             * @brief Orthogonal state constructor.
+             * @param id Unique ID of state
+             * @param parentState Parent state (`nullptr` for top-level states)
+             * @param regions Region HSMs in region order
+             */
+            OrthogonalState(unsigned int id, BaseState* parentState, BaseHSM* const (&regions)[REGIONS]) :
+                BaseOrthogonalState(id, parentState, regions_, contexts_, handled_, routes_, REGIONS)
+            {
+                for (unsigned int i = 0; i < REGIONS; i++) {
+                    this->regions_[i] = regions[i];
+                }
+            };
+
+        private:
+
+            /// Region HSMs
+            BaseHSM* regions_[REGIONS];
+            /// Context objects of regions
+            void* contexts_[REGIONS];
+            /// Events handled by the active configuration of every region
+            tEventMask handled_[REGIONS];
+            /// Regions handling every event bit
+            tRegionMask routes_[EVENT_MASK_BITS];
+    };
+}
+
+#endif /* _H_MICROHSM_ORTHOGONAL_STATE */
@@ -0,0 +1,189 @@
+/**
+ * @file Scheduler.hpp
+ * @brief Cooperative priority scheduler for run-to-completion steps
+ *
+ * Contains declarations for:
+ *  - BaseScheduler
+ *  - Scheduler
+ *
+ * @author Jelle Meijer
+ * @date 2025-05-23
+ */
+
+#ifndef _H_MICROHSM_SCHEDULER
+#define _H_MICROHSM_SCHEDULER
+
+#include <stdint.h>
+#include <atomic>
+
+#include <microhsm/config.hpp>
+
+namespace microhsm
+{
+    class AbstractEventQueue;
+    class BaseHSM;
+    class BaseScheduler;
+
+    /// Function called by the scheduler when no HSM is ready
+    typedef void (*fSchedulerIdle)(void* arg);
+
+    /// Priorities per ready bitmap word
+    #define SCHEDULER_WORD_BITS 32u
+
+    /// Maximum number of priorities of a scheduler
+    #define SCHEDULER_MAX_PRIORITIES (SCHEDULER_WORD_BITS * SCHEDULER_WORD_BITS)
+
+    /// Priority used to indicate the absence of a ready HSM
+    #define SCHEDULER_PRIORITY_NONE 0xFFFFFFFFu
+
+    /**
+     * @brief HSM owned by a scheduler.
+     */
+    typedef struct {
+        BaseHSM* hsm;                   ///< HSM (`nullptr` if priority is unused)
+        AbstractEventQueue* queue;      ///< Event queue of HSM
+        void* ctx;                      ///< Context object of HSM
+        BaseScheduler* scheduler;       ///< Scheduler owning the entry
+        unsigned int priority;          ///< Priority of HSM
+    } sSchedulerEntry;
+
+    /**
+     * @class BaseScheduler
+     * @brief Non-preemptive scheduler running the highest-priority ready HSM
+     *
+     * Every HSM has a unique priority and an event queue. An HSM is ready
+     * while its queue, or its payload queue (`BaseHSM::attachPayloadQueue`), holds events. `runOnce` performs a single run-to-completion
+     * step of the highest-priority ready HSM, which is found with two bitmap
+     * lookups: a word of ready groups and a word of ready priorities per group.
+     * Higher numbers are higher priorities.
+     *
+     * Events can be posted from interrupt/signal handlers if the queue of the
+     * HSM supports it (e.g. `EventQueue` with a single producer). Events posted
+     * with `BaseHSM::post` (e.g. by the HSM itself or by timers), with or
+     * without payload, make the HSM ready as well.
+     *
+     * Use `Scheduler` to provide the storage.
+     */
+    class BaseScheduler
+    {
+        public:
+
+            /**
+             * @brief Scheduler constructor.
+             * @param entries Storage for `priorities` entries
+             * @param ready Storage for `SCHEDULER_WORD_BITS` words
+             * @param priorities Number of priorities, at most `SCHEDULER_MAX_PRIORITIES`
+             */
+            BaseScheduler(sSchedulerEntry* entries, std::atomic<uint32_t>* ready, unsigned int priorities);
+
+            /**
+             * @brief Add HSM.
+             * Attaches `queue` to `hsm` and installs the post notification of `hsm`
+             * (see `BaseHSM::setPostNotify`). Events already in `queue` make the HSM ready.
+             * @param hsm Initialized HSM
+             * @param queue Event queue of HSM
+             * @param ctx Context object of HSM
+             * @param priority Unique priority of HSM
+             * @retval `true` HSM added
+             * @retval `false` Priority out of range or in use
+             */
+            bool add(BaseHSM& hsm, AbstractEventQueue& queue, void* ctx, unsigned int priority);
+
+            /**
+             * @brief Post event to HSM and mark it ready.
+             * @param priority Priority of HSM
+             * @param event Event to post
+             * @retval `true` Event queued
+             * @retval `false` Priority not in use or queue full
+             */
+            bool post(unsigned int priority, unsigned int event);
+
+            /**
+             * @brief Perform one run-to-completion step of the highest-priority ready HSM.
+             * @retval `true` An event was dispatched
+             * @retval `false` No HSM is ready
+             */
+            bool runOnce(void);
+
+            /**
+             * @brief Run until no HSM is ready.
+             * @return Number of dispatched events
+             */
+            unsigned int runUntilIdle(void);
+
+            /**
+             * @brief Run until `stop` is set, calling the idle hook when no HSM is ready.
+             * @param stop Flag ending the loop
+             */
+            void run(const std::atomic<bool>& stop);
+
+            /**
+             * @brief Set function called when no HSM is ready.
+             * The hook can put the processor to sleep until the next interrupt.
+             * @param hook Idle hook, `nullptr` to busy-wait
+             * @param arg Argument passed to `hook`
+             */
+            void setIdleHook(fSchedulerIdle hook, void* arg);
+
+            /**
+             * @brief Get highest priority of the ready HSMs.
+             * @return Priority, `SCHEDULER_PRIORITY_NONE` if no HSM is ready
+             */
+            unsigned int getReadyPriority(void) const;
+
+            /**
+             * @brief Get number of times the idle hook was called.
+             * @return Number of idle calls
+             */
+            unsigned long getIdleCalls(void) const;
+
+        private:
+
+            /// Mark priority ready
+            void setReady_(unsigned int priority);
+
+            /// Mark HSM of an entry ready, installed as post notification of the HSM
+            static void notifyReady_(void* arg);
+
+            /// Mark priority not ready, unless events arrived in the meantime
+            void clearReady_(unsigned int priority);
+
+            sSchedulerEntry* const entries_;        ///< HSM of every priority
+            std::atomic<uint32_t>* const ready_;    ///< Ready priorities of every group
+            std::atomic<uint32_t> groups_;          ///< Groups with ready priorities
+            const unsigned int priorities_;         ///< Number of priorities
+            fSchedulerIdle idle_;                   ///< Idle hook
+            void* idleArg_;                         ///< Argument of idle hook
+            unsigned long idleCalls_;               ///< Calls of idle hook
+    };
+
+    /**
+     * @class Scheduler
+     * @brief Non-preemptive scheduler running the highest-priority ready HSM
+     *
+     * Provides the storage for `BaseScheduler`.
+     *
+     * @tparam PRIORITIES Number of priorities, at most `SCHEDULER_MAX_PRIORITIES`
+     */
+    template <unsigned int PRIORITIES>
+    class Scheduler : public BaseScheduler
+    {
+        static_assert(PRIORITIES > 0 && PRIORITIES <= SCHEDULER_MAX_PRIORITIES, "Unsupported number of priorities");
+
+        public:
+
+            /**
+             * @brief Scheduler constructor.
+             */
+            Scheduler() : BaseScheduler(entries_, ready_, PRIORITIES) {};
+
+        private:
+
+            /// HSM of every priority
+            sSchedulerEntry entries_[PRIORITIES];
+            /// Ready priorities of every group
+            std::atomic<uint32_t> ready_[SCHEDULER_WORD_BITS];
+    };
+}
+
+#endif /* _H_MICROHSM_SCHEDULER */
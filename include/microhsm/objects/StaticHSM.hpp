@@ -0,0 +1,744 @@
+/**
+ * @file StaticHSM.hpp
+ * @brief Table-driven Hierarchical State Machines
+ *
+ * Contains declarations for:
+ *  - StaticInstance
+ *  - BaseStaticDefinition
+ *  - StaticDefinition
+ *  - BaseStaticHSM
+ *  - StaticHSM
+ *
+ * @author Jelle Meijer
+ * @date 2025-05-23
+ */
+
+#ifndef _H_MICROHSM_STATIC_HSM
+#define _H_MICROHSM_STATIC_HSM
+
+#include <limits>
+#include <type_traits>
+
+#include <microhsm/config.hpp>
+#include <microhsm/objects/BaseHSM.hpp>
+
+namespace microhsm
+{
+    /// Vertex ID used to indicate the absence of a vertex
+    #define VERTEX_NONE 0xFFFFFFFFu
+
+    /// Function type of a state action (entry/exit behavior)
+    typedef void (*fStateAction)(void* ctx);
+
+    /// Function type of a transition guard
+    typedef bool (*fTransitionGuard)(void* ctx);
+
+    /**
+     * @enum eStaticVertexType
+     * @brief Type of a statically declared vertex
+     */
+    enum eStaticVertexType {
+        eSTATIC_STATE,              ///< Vertex is a state
+        eSTATIC_SHALLOW_HISTORY,    ///< Vertex is a shallow history pseudostate
+        eSTATIC_DEEP_HISTORY,       ///< Vertex is a deep history pseudostate
+    };
+
+    /**
+     * @brief Statically declared vertex.
+     *
+     * The ID of a vertex is its index in the vertex array of the HSM.
+     *
+     * For states `parent` is the parent state and `initial` the initial substate.
+     * For history pseudostates `parent` is the composite state that the history
+     * belongs to and `initial` the (optional) default history state.
+     */
+    typedef struct {
+        eStaticVertexType type;     ///< Type of vertex
+        unsigned int parent;        ///< Parent state (`VERTEX_NONE` for top-level states)
+        unsigned int initial;       ///< Initial state/default history (`VERTEX_NONE` if absent)
+        fStateAction entry;         ///< Entry behavior (can be `nullptr`)
+        fStateAction exit;          ///< Exit behavior (can be `nullptr`)
+    } sStaticVertex;
+
+    /**
+     * @brief Statically declared transition.
+     *
+     * When multiple transitions of the same state match an event, the
+     * first declared transition whose guard succeeds is taken. Transitions
+     * of substates take priority over transitions of their ancestors.
+     */
+    typedef struct {
+        unsigned int source;        ///< Source state of transition
+        unsigned int event;         ///< Event triggering the transition
+        unsigned int target;        ///< Target vertex of transition (ignored for internal transitions)
+        eTransitionKind kind;       ///< Kind of transition
+        fTransitionGuard guard;     ///< Guard of transition (can be `nullptr`)
+        fTransitionEffect effect;   ///< Effect of transition (can be `nullptr`)
+    } sStaticTransition;
+
+    /// Index of a vertex within the state of a statically declared HSM, narrowed by `MICROHSM_INDEX_TYPE`
+    typedef std::conditional<(sizeof(tVertexID) < sizeof(uint16_t)), tVertexID, uint16_t>::type tStaticIndex;
+
+    /// Static index used to indicate the absence of a vertex
+    #define STATIC_INDEX_NONE (std::numeric_limits<microhsm::tStaticIndex>::max())
+
+    /// Size of the header of a snapshot of static instances
+    #define STATIC_SNAPSHOT_HEADER_SIZE 10u
+
+    /**
+     * @brief Runtime data of a vertex computed during initialization
+     */
+    typedef struct {
+        unsigned int depth;         ///< Depth of state
+        unsigned int shallow;       ///< Shallow history pseudostate of state (`VERTEX_NONE` if absent)
+        unsigned int deep;          ///< Deep history pseudostate of state (`VERTEX_NONE` if absent)
+        unsigned int slot;          ///< History slot of history pseudostate
+        unsigned int history;       ///< Default history state of history pseudostate
+    } sStaticVertexData;
+
+    /**
+     * @brief Declare a state
+     * @param parent Parent state (`VERTEX_NONE` for top-level states)
+     * @param initial Initial state (`VERTEX_NONE` for non-composite states)
+     * @param entry Entry behavior (can be `nullptr`)
+     * @param exit Exit behavior (can be `nullptr`)
+     */
+    constexpr sStaticVertex staticState(unsigned int parent, unsigned int initial,
+            fStateAction entry = nullptr, fStateAction exit = nullptr)
+    {
+        return sStaticVertex{eSTATIC_STATE, parent, initial, entry, exit};
+    }
+
+    /**
+     * @brief Declare a shallow history pseudostate
+     * @param parent Composite state the history belongs to
+     * @param defaultHistory Default history state (`VERTEX_NONE` to use initial state of `parent`)
+     */
+    constexpr sStaticVertex staticShallowHistory(unsigned int parent, unsigned int defaultHistory = VERTEX_NONE)
+    {
+        return sStaticVertex{eSTATIC_SHALLOW_HISTORY, parent, defaultHistory, nullptr, nullptr};
+    }
+
+    /**
+     * @brief Declare a deep history pseudostate
+     * @param parent Composite state the history belongs to
+     * @param defaultHistory Default history state (`VERTEX_NONE` to use initial state of `parent`)
+     */
+    constexpr sStaticVertex staticDeepHistory(unsigned int parent, unsigned int defaultHistory = VERTEX_NONE)
+    {
+        return sStaticVertex{eSTATIC_DEEP_HISTORY, parent, defaultHistory, nullptr, nullptr};
+    }
+
+    /**
+     * @brief Declare an external transition
+     * @param source Source state
+     * @param event Triggering event
+     * @param target Target vertex
+     * @param effect Transition effect (can be `nullptr`)
+     * @param guard Transition guard (can be `nullptr`)
+     */
+    constexpr sStaticTransition staticExternal(unsigned int source, unsigned int event, unsigned int target,
+            fTransitionEffect effect = nullptr, fTransitionGuard guard = nullptr)
+    {
+        return sStaticTransition{source, event, target, eKIND_EXTERNAL, guard, effect};
+    }
+
+    /**
+     * @brief Declare a local transition
+     * @param source Source state (must be composite)
+     * @param event Triggering event
+     * @param target Target vertex (must be substate of `source`)
+     * @param effect Transition effect (can be `nullptr`)
+     * @param guard Transition guard (can be `nullptr`)
+     */
+    constexpr sStaticTransition staticLocal(unsigned int source, unsigned int event, unsigned int target,
+            fTransitionEffect effect = nullptr, fTransitionGuard guard = nullptr)
+    {
+        return sStaticTransition{source, event, target, eKIND_LOCAL, guard, effect};
+    }
+
+    /**
+     * @brief Declare an internal transition
+     * @param source Source state
+     * @param event Triggering event
+     * @param effect Transition effect (can be `nullptr`)
+     * @param guard Transition guard (can be `nullptr`)
+     */
+    constexpr sStaticTransition staticInternal(unsigned int source, unsigned int event,
+            fTransitionEffect effect = nullptr, fTransitionGuard guard = nullptr)
+    {
+        return sStaticTransition{source, event, source, eKIND_INTERNAL, guard, effect};
+    }
+
+    /**
+     * @brief Instance of a statically declared HSM.
+     *
+     * Holds only the data that differs between instances of the same machine:
+     * the context object, the active leaf state and the states stored by the
+     * history pseudostates. The structure of the machine is shared through a
+     * `BaseStaticDefinition`. With up to three history pseudostates an instance
+     * takes 16 bytes on 64-bit targets.
+     *
+     * @tparam HISTORY_COUNT Number of history pseudostates of the definition
+     */
+    template <unsigned int HISTORY_COUNT>
+    struct StaticInstance {
+        void* ctx;                                                      ///< Context object
+        tStaticIndex state;                                             ///< Active leaf state
+        tStaticIndex history[(HISTORY_COUNT > 0) ? HISTORY_COUNT : 1];  ///< States stored by history pseudostates
+    };
+
+    /**
+     * @class BaseStaticDefinition
+     * @brief Structure of a table-driven HSM shared by many instances
+     *
+     * States, histories and transitions are declared as constant data. During
+     * `init()` the hierarchy is resolved into a dense (state x event) table,
+     * which holds for every state the first candidate transition of that state
+     * or its nearest ancestor. Candidates for the same event are chained, such
+     * that dispatching an event is a single table lookup followed by guard
+     * evaluation. The semantics are identical to those of `BaseHSM`.
+     *
+     * After `init()` the definition is not modified, such that instances can be
+     * dispatched by different threads, as long as every instance is dispatched
+     * by a single thread at a time.
+     *
+     * Use `StaticDefinition` to provide the storage for the tables.
+     */
+    class BaseStaticDefinition
+    {
+        public:
+
+            /**
+             * @brief Static definition constructor.
+             * @param vertices Vertex declarations
+             * @param vertexCount Number of vertices
+             * @param transitions Transition declarations
+             * @param transitionCount Number of transitions
+             * @param eventCount Number of events (including `EVENT_ANONYMOUS`)
+             * @param initial Initial state of HSM
+             * @param table Storage for dispatch table (`vertexCount * eventCount` entries)
+             * @param next Storage for transition chains (`transitionCount` entries)
+             * @param data Storage for vertex runtime data (`vertexCount` entries)
+             */
+            BaseStaticDefinition(const sStaticVertex* vertices, unsigned int vertexCount,
+                    const sStaticTransition* transitions, unsigned int transitionCount,
+                    unsigned int eventCount, unsigned int initial,
+                    unsigned int* table, unsigned int* next, sStaticVertexData* data);
+
+            /**
+             * @brief Resolve hierarchy and build dispatch table.
+             * Must be called once before instances are started.
+             * @retval eOK Definition is ready
+             * @retval eTRANSITION_ERROR Hierarchy exceeds `MICROHSM_MAX_DEPTH` (or is cyclic); instances
+             *  started with the definition have no active state and ignore all events
+             */
+            MICROHSM_NODISCARD eStatus init(void);
+
+            /**
+             * @brief Get number of history pseudostates.
+             * Only valid after `init`.
+             * @return Number of history slots an instance needs
+             */
+            unsigned int getHistoryCount(void) const;
+
+            /**
+             * @brief Start instance by entering the initial state.
+             * @param instance Instance to start
+             * @param ctx Context object of instance
+             */
+            template <unsigned int HISTORY_COUNT>
+            void start(StaticInstance<HISTORY_COUNT>& instance, void* ctx)
+            {
+                instance.ctx = ctx;
+                this->start_(instance.state, instance.history, HISTORY_COUNT, ctx);
+            };
+
+            /**
+             * @brief Dispatch event to instance.
+             * @param instance Started instance
+             * @param event Event to dispatch
+             * @return See `BaseStaticHSM::dispatch`
+             */
+            template <unsigned int HISTORY_COUNT>
+            eStatus dispatch(StaticInstance<HISTORY_COUNT>& instance, unsigned int event)
+            {
+                return this->dispatch_(instance.state, instance.history, event, instance.ctx);
+            };
+
+            /**
+             * @brief Get current state of instance.
+             * @param instance Started instance
+             * @return ID of current state (always a leaf state)
+             */
+            template <unsigned int HISTORY_COUNT>
+            unsigned int getCurrentState(const StaticInstance<HISTORY_COUNT>& instance) const
+            {
+                return this->toID_(instance.state);
+            };
+
+            /**
+             * @brief Check whether instance is in state.
+             * @param instance Started instance
+             * @param ID ID of state
+             * @return Whether the current state or one of its parents has `ID`
+             */
+            template <unsigned int HISTORY_COUNT>
+            bool inState(const StaticInstance<HISTORY_COUNT>& instance, unsigned int ID) const
+            {
+                return this->inState_(instance.state, ID);
+            };
+
+            /**
+             * @brief Get the state stored by a history pseudostate of an instance
+             * @param instance Started instance
+             * @param ID ID of history pseudostate
+             * @return ID of stored state
+             */
+            template <unsigned int HISTORY_COUNT>
+            unsigned int getHistoryState(const StaticInstance<HISTORY_COUNT>& instance, unsigned int ID) const
+            {
+                return this->getHistoryState_(instance.history, ID);
+            };
+
+            /**
+             * @brief Get size of a snapshot of instances.
+             * Only valid after `init`.
+             * @param count Number of instances
+             * @return Size of snapshot in bytes
+             */
+            unsigned long getSnapshotSize(unsigned int count) const;
+
+            /**
+             * @brief Write the active leaf states and histories of instances into a binary snapshot.
+             * Context objects are not part of the snapshot.
+             * @param instances Started instances
+             * @param count Number of instances
+             * @param buffer Buffer receiving the snapshot
+             * @param size Size of `buffer` in bytes
+             * @return Size of snapshot, `0` if `buffer` is too small
+             */
+            template <unsigned int HISTORY_COUNT>
+            unsigned long snapshot(const StaticInstance<HISTORY_COUNT>* instances, unsigned int count,
+                    uint8_t* buffer, unsigned long size) const
+            {
+                const unsigned long length = this->getSnapshotSize(count);
+                if (size < length || HISTORY_COUNT < historyCount_) return 0;
+
+                uint8_t* p = this->writeSnapshotHeader_(buffer, count);
+                for (unsigned int i = 0; i < count; i++) {
+                    p = this->writeInstance_(p, instances[i].state, instances[i].history);
+                }
+                return length;
+            };
+
+            /**
+             * @brief Restore the active leaf states and histories of instances from a binary snapshot.
+             * No entry or exit behavior is performed and context objects are kept.
+             * The complete snapshot is verified first, on failure no instance is modified.
+             * @param instances Instances to restore
+             * @param count Number of instances, must equal the number of instances in the snapshot
+             * @param buffer Snapshot written by `snapshot` of the same definition
+             * @param size Size of snapshot in bytes
+             * @retval `true` Instances restored
+             * @retval `false` Snapshot does not match this definition or is corrupt
+             */
+            template <unsigned int HISTORY_COUNT>
+            bool restore(StaticInstance<HISTORY_COUNT>* instances, unsigned int count,
+                    const uint8_t* buffer, unsigned long size) const
+            {
+                if (HISTORY_COUNT < historyCount_ || !this->verifySnapshot_(buffer, size, count)) return false;
+
+                const uint8_t* p = buffer + STATIC_SNAPSHOT_HEADER_SIZE;
+                for (unsigned int i = 0; i < count; i++) {
+                    p = this->readInstance_(p, instances[i].state, instances[i].history);
+                }
+                return true;
+            };
+
+        private:
+
+            friend class BaseStaticHSM;
+            friend class BaseInstanceStore;
+
+            /**
+             * @brief Convert static index to vertex ID
+             * @param s Static index
+             * @return Vertex ID, `VERTEX_NONE` if `s` is `STATIC_INDEX_NONE`
+             */
+            static unsigned int toID_(tStaticIndex s);
+
+            /**
+             * @brief Reset histories and enter initial state
+             * @param state Active leaf state of instance
+             * @param history History slots of instance
+             * @param slots Number of history slots
+             * @param ctx Context object
+             */
+            void start_(tStaticIndex& state, tStaticIndex* history, unsigned int slots, void* ctx);
+
+            /**
+             * @brief Dispatch event to instance
+             * @param state Active leaf state of instance
+             * @param history History slots of instance
+             * @param event Event to dispatch
+             * @param ctx Context object
+             * @return eStatus
+             */
+            eStatus dispatch_(tStaticIndex& state, tStaticIndex* history, unsigned int event, void* ctx);
+
+            /**
+             * @brief Check whether state is (an ancestor of) the active leaf state
+             * @param state Active leaf state of instance
+             * @param ID ID of state
+             * @return Whether instance is in state
+             */
+            bool inState_(tStaticIndex state, unsigned int ID) const;
+
+            /**
+             * @brief Get state stored by history pseudostate
+             * @param history History slots of instance
+             * @param ID ID of history pseudostate
+             * @return ID of stored state
+             */
+            unsigned int getHistoryState_(const tStaticIndex* history, unsigned int ID) const;
+
+            /**
+             * @brief Find first transition of `state` or its ancestors for `event`
+             * @param state State to start from
+             * @param event Event to match
+             * @param start Transition index to start searching from for `state`
+             * @return Index of transition, `VERTEX_NONE` if there is none
+             */
+            unsigned int findTransition_(unsigned int state, unsigned int event, unsigned int start);
+
+            /**
+             * @brief Match event to current state or one of its ancestors
+             * @param state Active leaf state
+             * @param event Event to match
+             * @param ctx Context object
+             * @return Index of transition, `VERTEX_NONE` if no transition matched
+             */
+            unsigned int match_(tStaticIndex state, unsigned int event, void* ctx) const;
+
+            /**
+             * @brief Get state targeted by vertex
+             * @param history History slots of instance
+             * @param ID Target vertex of transition
+             * @return Target state
+             */
+            unsigned int getTransitionTarget_(const tStaticIndex* history, unsigned int ID) const;
+
+            /**
+             * @brief Find least common ancestor
+             * @param a First state
+             * @param b Second state
+             * @return Least common ancestor, `VERTEX_NONE` if LCA doesn't exist
+             */
+            unsigned int findLCA_(unsigned int a, unsigned int b) const;
+
+            /**
+             * @brief Perform transition
+             * @param state Active leaf state of instance
+             * @param history History slots of instance
+             * @param t Transition to perform
+             * @param ctx Context object
+             * @return eStatus
+             */
+            eStatus performTransition_(tStaticIndex& state, tStaticIndex* history, const sStaticTransition* t, void* ctx) const;
+
+            /**
+             * @brief Exits states until `target` is reached
+             * @param state Active state of instance
+             * @param target State to stop at (not exited)
+             * @param ctx Context object
+             * @return `target` if reached, otherwise `VERTEX_NONE`
+             */
+            unsigned int exitUntilTarget_(tStaticIndex& state, unsigned int target, void* ctx) const;
+
+            /**
+             * @brief Enter states from `start` (excluding) until `target` (including)
+             * @param state Active state of instance
+             * @param start State to start from
+             * @param target State to enter
+             * @param ctx Context object
+             */
+            void enterUntilTarget_(tStaticIndex& state, unsigned int start, unsigned int target, void* ctx) const;
+
+            /**
+             * @brief Enter initial states until a leaf state is reached
+             * @param state Active state of instance
+             * @param ctx Context object
+             */
+            void enterInitialStates_(tStaticIndex& state, void* ctx) const;
+
+            /**
+             * @brief Enter state
+             * @param state Active state of instance
+             * @param s State to enter
+             * @param ctx Context object
+             */
+            void enterState_(tStaticIndex& state, unsigned int s, void* ctx) const;
+
+            /**
+             * @brief Exit active state
+             * @param state Active state of instance
+             * @param ctx Context object
+             */
+            void exitState_(tStaticIndex& state, void* ctx) const;
+
+            /**
+             * @brief Update histories of ancestors of a new active leaf state
+             * @param history History slots of instance
+             * @param s New leaf state
+             */
+            void updateHistories_(tStaticIndex* history, unsigned int s) const;
+
+            /**
+             * @brief Check whether a state can be the active leaf state of an instance
+             * @param s Vertex ID
+             * @return Whether `s` is a leaf state
+             */
+            bool isLeafState_(unsigned int s) const;
+
+            /**
+             * @brief Check whether a history pseudostate can store a state
+             * @param v History pseudostate
+             * @param s Vertex ID
+             * @return Whether `s` is a substate (shallow) or leaf state (deep) below the state of `v`
+             */
+            bool isHistoryState_(unsigned int v, unsigned int s) const;
+
+            /**
+             * @brief Write header of a snapshot
+             * @param buffer Buffer receiving the snapshot
+             * @param count Number of instances
+             * @return First byte after the header
+             */
+            uint8_t* writeSnapshotHeader_(uint8_t* buffer, unsigned int count) const;
+
+            /**
+             * @brief Verify header and records of a snapshot
+             * @param buffer Snapshot
+             * @param size Size of snapshot in bytes
+             * @param count Expected number of instances
+             * @return Whether every record can be restored
+             */
+            bool verifySnapshot_(const uint8_t* buffer, unsigned long size, unsigned int count) const;
+
+            /**
+             * @brief Write record of a single instance
+             * @param p Position in snapshot
+             * @param state Active leaf state of instance
+             * @param history History slots of instance
+             * @return First byte after the record
+             */
+            uint8_t* writeInstance_(uint8_t* p, tStaticIndex state, const tStaticIndex* history) const;
+
+            /**
+             * @brief Read record of a single instance
+             * @param p Position in snapshot
+             * @param state Active leaf state of instance
+             * @param history History slots of instance
+             * @return First byte after the record
+             */
+            const uint8_t* readInstance_(const uint8_t* p, tStaticIndex& state, tStaticIndex* history) const;
+
+            /// Vertex declarations
+            const sStaticVertex* const vertices_;
+            /// Transition declarations
+            const sStaticTransition* const transitions_;
+            /// Dispatch table (`vertexCount_ * eventCount_`)
+            unsigned int* const table_;
+            /// Next candidate transition per transition
+            unsigned int* const next_;
+            /// Runtime vertex data
+            sStaticVertexData* const data_;
+            /// Number of vertices
+            const unsigned int vertexCount_;
+            /// Number of transitions
+            const unsigned int transitionCount_;
+            /// Number of events
+            const unsigned int eventCount_;
+            /// Initial state
+            const unsigned int initial_;
+            /// Number of history pseudostates
+            unsigned int historyCount_;
+            /// Whether `init` accepted the definition
+            bool valid_;
+    };
+
+    /**
+     * @class StaticDefinition
+     * @brief Structure of a table-driven HSM shared by many instances
+     *
+     * Provides the storage for `BaseStaticDefinition`.
+     *
+     * @tparam VERTEX_COUNT Number of vertices
+     * @tparam EVENT_COUNT Number of events (including `EVENT_ANONYMOUS`)
+     * @tparam TRANSITION_COUNT Number of transitions
+     */
+    template <unsigned int VERTEX_COUNT, unsigned int EVENT_COUNT, unsigned int TRANSITION_COUNT>
+    class StaticDefinition : public BaseStaticDefinition
+    {
+        static_assert(VERTEX_COUNT < STATIC_INDEX_NONE, "Too many vertices for `MICROHSM_INDEX_TYPE`");
+        static_assert(EVENT_COUNT - 1 <= std::numeric_limits<tEventID>::max(), "Too many events for `MICROHSM_INDEX_TYPE`");
+
+        public:
+
+            /**
+             * @brief Static definition constructor.
+             * @param vertices Vertex declarations, vertex IDs are indices into this array
+             * @param transitions Transition declarations
+             * @param initial Initial state of HSM
+             */
+            StaticDefinition(const sStaticVertex (&vertices)[VERTEX_COUNT],
+                    const sStaticTransition (&transitions)[TRANSITION_COUNT],
+                    unsigned int initial) :
+                BaseStaticDefinition(vertices, VERTEX_COUNT, transitions, TRANSITION_COUNT, EVENT_COUNT,
+                        initial, table_, next_, data_)
+            {
+            };
+
+        private:
+
+            /// Dispatch table
+            unsigned int table_[VERTEX_COUNT * EVENT_COUNT];
+            /// Transition chains
+            unsigned int next_[TRANSITION_COUNT];
+            /// Runtime vertex data
+            sStaticVertexData data_[VERTEX_COUNT];
+    };
+
+    /**
+     * @class BaseStaticHSM
+     * @brief Table-driven hierarchical state machine engine
+     *
+     * Alternative to `BaseHSM` for machines whose structure is fully known at
+     * compile time. Combines a `BaseStaticDefinition` with the state of a
+     * single instance. Use `BaseStaticDefinition` and `StaticInstance` directly
+     * to share the definition between many instances.
+     *
+     * Use `StaticHSM` to provide the storage for the tables.
+     */
+    class BaseStaticHSM
+    {
+        public:
+
+            /**
+             * @brief Initialize HSM.
+             * Resolves the hierarchy and enters the initial state.
+             * @param ctx Context object
+             * @return See `BaseStaticDefinition::init`
+             */
+            MICROHSM_NODISCARD eStatus init(void* ctx);
+
+            /**
+             * @brief Dispatch event to HSM.
+             * @param event Event to dispatch
+             * @param ctx Pointer to context object
+             * @retval eOK Event matched a transition
+             * @retval eEVENT_IGNORED Event didn't match a transition
+             * @retval eTRANSITION_ERROR Error occurred during dispatch
+             */
+            eStatus dispatch(unsigned int event, void* ctx);
+
+            /**
+             * @brief Get current state of HSM.
+             * @return ID of current state (always a leaf state)
+             */
+            unsigned int getCurrentState(void);
+
+            /**
+             * @brief Check whether HSM is in state.
+             * @param ID ID of state
+             * @return Whether the current state or one of its parents has `ID`
+             */
+            bool inState(unsigned int ID);
+
+            /**
+             * @brief Get the state stored by a history pseudostate
+             * @param ID ID of history pseudostate
+             * @return ID of stored state
+             */
+            unsigned int getHistoryState(unsigned int ID);
+
+        protected:
+
+            /**
+             * @brief Static HSM constructor.
+             * @param vertices Vertex declarations
+             * @param vertexCount Number of vertices
+             * @param transitions Transition declarations
+             * @param transitionCount Number of transitions
+             * @param eventCount Number of events (including `EVENT_ANONYMOUS`)
+             * @param initial Initial state of HSM
+             * @param table Storage for dispatch table (`vertexCount * eventCount` entries)
+             * @param next Storage for transition chains (`transitionCount` entries)
+             * @param data Storage for vertex runtime data (`vertexCount` entries)
+             * @param history Storage for history slots (`vertexCount` entries)
+             */
+            BaseStaticHSM(const sStaticVertex* vertices, unsigned int vertexCount,
+                    const sStaticTransition* transitions, unsigned int transitionCount,
+                    unsigned int eventCount, unsigned int initial,
+                    unsigned int* table, unsigned int* next, sStaticVertexData* data,
+                    tStaticIndex* history);
+
+        private:
+
+            /// Structure of the HSM
+            BaseStaticDefinition definition_;
+            /// History slots
+            tStaticIndex* const history_;
+            /// Number of history slots
+            const unsigned int slots_;
+            /// Current state (`STATIC_INDEX_NONE` during a transition if no state is active)
+            tStaticIndex curState_;
+    };
+
+    /**
+     * @class StaticHSM
+     * @brief Table-driven hierarchical state machine
+     *
+     * Provides the storage for `BaseStaticHSM`.
+     *
+     * @tparam VERTEX_COUNT Number of vertices
+     * @tparam EVENT_COUNT Number of events (including `EVENT_ANONYMOUS`)
+     * @tparam TRANSITION_COUNT Number of transitions
+     */
+    template <unsigned int VERTEX_COUNT, unsigned int EVENT_COUNT, unsigned int TRANSITION_COUNT>
+    class StaticHSM : public BaseStaticHSM
+    {
+        static_assert(VERTEX_COUNT < STATIC_INDEX_NONE, "Too many vertices for `MICROHSM_INDEX_TYPE`");
+        static_assert(EVENT_COUNT - 1 <= std::numeric_limits<tEventID>::max(), "Too many events for `MICROHSM_INDEX_TYPE`");
+
+        public:
+
+            /**
+             * @brief Static HSM constructor.
+             * @param vertices Vertex declarations, vertex IDs are indices into this array
+             * @param transitions Transition declarations
+             * @param initial Initial state of HSM
+             */
+            StaticHSM(const sStaticVertex (&vertices)[VERTEX_COUNT],
+                    const sStaticTransition (&transitions)[TRANSITION_COUNT],
+                    unsigned int initial) :
+                BaseStaticHSM(vertices, VERTEX_COUNT, transitions, TRANSITION_COUNT, EVENT_COUNT,
+                        initial, table_, next_, data_, history_)
+            {
+            };
+
+        private:
+
+            /// Dispatch table
+            unsigned int table_[VERTEX_COUNT * EVENT_COUNT];
+            /// Transition chains
+            unsigned int next_[TRANSITION_COUNT];
+            /// Runtime vertex data
+            sStaticVertexData data_[VERTEX_COUNT];
+            /// History slots
+            tStaticIndex history_[VERTEX_COUNT];
+    };
+}
+
+#endif /* _H_MICROHSM_STATIC_HSM */
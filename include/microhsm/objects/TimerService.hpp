@@ -0,0 +1,289 @@
+/**
+ * @file TimerService.hpp
+ * @brief Time events on a hierarchical timing wheel
+ *
+ * Contains declarations for:
+ *  - TimerTarget
+ *  - BaseTimerService
+ *  - TimerService
+ *
+ * @author Jelle Meijer
+ * @date 2025-05-23
+ */
+
+#ifndef _H_MICROHSM_TIMER_SERVICE
+#define _H_MICROHSM_TIMER_SERVICE
+
+#include <stdint.h>
+
+#include <microhsm/config.hpp>
+
+namespace microhsm
+{
+    class BaseHSM;
+
+    /**
+     * @class TimerTarget
+     * @brief Receiver of timeout events
+     *
+     * Implemented by `BaseHSM` (posting to its queue) and `ActiveObject`
+     * (posting to its mailbox). Implement it to deliver timeout events
+     * elsewhere, e.g. to a scheduler priority or an event bus.
+     */
+    class TimerTarget
+    {
+        public:
+
+            virtual ~TimerTarget() {};
+
+            /**
+             * @brief Deliver timeout event, called by the timer service when a timer expires.
+             * @param event Timeout event
+             * @retval `true` Event delivered
+             * @retval `false` Event lost, counted by `BaseTimerService::getFailed`
+             */
+            virtual bool deliverTimeout(unsigned int event) = 0;
+    };
+
+    /// Handle of an armed timer
+    typedef uint32_t tTimerHandle;
+
+    /// Handle used to indicate the absence of a timer
+    #define TIMER_HANDLE_NONE 0xFFFFFFFFu
+
+    /// Timer index used to indicate the end of a list
+    #define TIMER_INDEX_NONE 0xFFFFFFFFu
+
+    /// State index of timers that are not scoped to a state
+    #define TIMER_STATE_NONE 0xFFFFu
+
+    /// Number of bits of a timer handle holding the index of the timer, the remaining bits hold its generation
+    #define TIMER_INDEX_BITS 24u
+
+    /// Maximum number of timers of a timer service
+    #define TIMER_MAX_COUNT ((1u << TIMER_INDEX_BITS) - 1u)
+
+    /// Number of bits of ticks covered by a wheel level
+    #define TIMER_WHEEL_BITS 6u
+
+    /// Number of slots of a wheel level
+    #define TIMER_WHEEL_SLOTS (1u << TIMER_WHEEL_BITS)
+
+    /// Number of wheel levels
+    #define TIMER_WHEEL_LEVELS 4u
+
+    static_assert(TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS <= 256, "Wheel slots must fit into `sTimer::slot`");
+
+    /// Longest delay placed directly, longer timers are re-placed when their slot is reached
+    #define TIMER_WHEEL_RANGE ((1ul << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS)) - 1ul)
+
+    /**
+     * @brief Timer of a timer service.
+     * Armed timers form a list per wheel slot, kept at 32 bytes on 64-bit targets such that a timer does not span two cache lines.
+     */
+    typedef struct {
+        uint32_t next;              ///< Next timer of slot (or of free list)
+        uint32_t prev;              ///< Previous timer of slot
+        uint32_t expiry;            ///< Tick at which the timer expires
+        uint32_t period;            ///< Period of timer (`0` for a one-shot timer)
+        TimerTarget* target;        ///< Receiver of the timeout event, the HSM of scoped timers (`nullptr` if timer is not armed)
+        unsigned int event;         ///< Timeout event
+        uint16_t state;             ///< Index of state the timer is scoped to (`TIMER_STATE_NONE` if not scoped)
+        uint8_t generation;         ///< Incremented whenever the timer is released
+        uint8_t slot;               ///< Wheel slot holding the timer
+    } sTimer;
+
+    /**
+     * @brief Links of a timer scoped to a state.
+     * Scoped timers form a list per HSM, such that exits find them without searching the wheel.
+     */
+    typedef struct {
+        uint32_t next;              ///< Next scoped timer of HSM
+        uint32_t prev;              ///< Previous scoped timer of HSM
+    } sTimerScope;
+
+    /**
+     * @class BaseTimerService
+     * @brief Posts timeout events to HSMs using a hierarchical timing wheel
+     *
+     * Time advances in ticks by calling `tick`. Arming and disarming a timer
+     * take constant time, independent of the number of armed timers. Timers
+     * are kept in `TIMER_WHEEL_LEVELS` wheels of `TIMER_WHEEL_SLOTS` slots;
+     * every level covers `TIMER_WHEEL_SLOTS` times the range of the level below,
+     * and its slots are moved to the level below when they are reached.
+     *
+     * Expired timers deliver their event to the target they were armed with.
+     * HSMs post it to their attached queue (see `BaseHSM::post`), which also
+     * wakes HSMs run by a `Scheduler`; active objects post it to their mailbox.
+     * The service is not thread-safe: arm, disarm and tick from a single thread.
+     *
+     * Timers armed with `BaseState::startTimer` are scoped to the state and
+     * disarmed by the HSM when the state is exited. Timeout events that were
+     * already posted remain queued and are still dispatched.
+     *
+     * Use `TimerService` to provide the storage.
+     */
+    class BaseTimerService
+    {
+        public:
+
+            /**
+             * @brief Timer service constructor.
+             * @param timers Storage for `count` timers
+             * @param scopes Storage for `count` scope links
+             * @param slots Storage for `TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS` slots
+             * @param count Number of timers, at most `TIMER_MAX_COUNT`
+             */
+            BaseTimerService(sTimer* timers, sTimerScope* scopes, uint32_t* slots, uint32_t count);
+
+            /**
+             * @brief Arm timer.
+             * @param target Receiver of the timeout event, e.g. a `BaseHSM` or `ActiveObject`
+             * @param event Timeout event
+             * @param delay Number of ticks until expiry (`0` is treated as `1`)
+             * @param period Ticks between repeated expiries (`0` for a one-shot timer)
+             * @return Handle of timer, `TIMER_HANDLE_NONE` if no timer is available
+             */
+            tTimerHandle arm(TimerTarget& target, unsigned int event, uint32_t delay, uint32_t period = 0);
+
+            /**
+             * @brief Disarm timer.
+             * @param handle Handle of timer
+             * @retval `true` Timer disarmed
+             * @retval `false` Timer expired or was disarmed before
+             */
+            bool disarm(tTimerHandle handle);
+
+            /**
+             * @brief Check whether a timer is armed.
+             * @param handle Handle of timer
+             * @return Whether timer is armed
+             */
+            bool isArmed(tTimerHandle handle) const;
+
+            /**
+             * @brief Advance time by a single tick and post events of expired timers.
+             * @return Number of expired timers
+             */
+            unsigned int tick(void);
+
+            /**
+             * @brief Advance time by several ticks.
+             * @param ticks Number of ticks
+             * @return Number of expired timers
+             */
+            unsigned long advance(uint32_t ticks);
+
+            /**
+             * @brief Get current time.
+             * @return Number of ticks since construction (wraps around)
+             */
+            uint32_t getNow(void) const;
+
+            /**
+             * @brief Get number of armed timers.
+             * @return Armed timers
+             */
+            uint32_t getArmedCount(void) const;
+
+            /**
+             * @brief Get number of timeout events that could not be posted.
+             * @return Number of lost events
+             */
+            unsigned long getFailed(void) const;
+
+        private:
+
+            friend class BaseHSM;
+            friend class BaseState;
+
+            /**
+             * @brief Arm timer scoped to a state, called by `BaseState::startTimer`
+             * @param target Receiver of the timeout event, the `BaseHSM` owning the state if scoped
+             * @param state Index of state (`TIMER_STATE_NONE` if not scoped)
+             * @param event Timeout event
+             * @param delay Ticks until expiry
+             * @param period Ticks between repeated expiries
+             * @return Handle of timer
+             */
+            tTimerHandle armScoped_(TimerTarget& target, uint16_t state, unsigned int event, uint32_t delay, uint32_t period);
+
+            /**
+             * @brief Disarm timers scoped to a state, called by `BaseHSM` on exit
+             * @param hsm HSM owning the state
+             * @param state Index of exited state, `TIMER_STATE_NONE` for all states
+             */
+            void disarmScoped_(BaseHSM& hsm, uint16_t state);
+
+            /**
+             * @brief Place timer into the wheel slot matching its expiry
+             * @param index Index of timer
+             */
+            void place_(uint32_t index);
+
+            /**
+             * @brief Remove timer from its wheel slot
+             * @param index Index of timer
+             */
+            void unplace_(uint32_t index);
+
+            /**
+             * @brief Disarm timer and return it to the free list
+             * @param index Index of timer
+             */
+            void release_(uint32_t index);
+
+            /**
+             * @brief Return timer that is not in a wheel slot to the free list
+             * @param index Index of timer
+             */
+            void recycle_(uint32_t index);
+
+            /**
+             * @brief Move the timers of a slot to the levels below
+             * @param level Level of slot
+             */
+            void cascade_(unsigned int level);
+
+            sTimer* const timers_;          ///< Timers
+            sTimerScope* const scopes_;     ///< Scope links of timers
+            uint32_t* const slots_;         ///< First timer of every slot
+            const uint32_t count_;          ///< Number of timers
+            uint32_t free_;                 ///< First free timer
+            uint32_t now_;                  ///< Current tick
+            uint32_t armed_;                ///< Number of armed timers
+            unsigned long failed_;          ///< Events that could not be posted
+    };
+
+    /**
+     * @class TimerService
+     * @brief Posts timeout events to HSMs using a hierarchical timing wheel
+     *
+     * Provides the storage for `BaseTimerService`.
+     *
+     * @tparam COUNT Maximum number of armed timers
+     */
+    template <uint32_t COUNT>
+    class TimerService : public BaseTimerService
+    {
+        static_assert(COUNT > 0 && COUNT <= TIMER_MAX_COUNT, "Unsupported number of timers");
+
+        public:
+
+            /**
+             * @brief Timer service constructor.
+             */
+            TimerService() : BaseTimerService(timers_, scopes_, slots_, COUNT) {};
+
+        private:
+
+            /// Timers
+            sTimer timers_[COUNT];
+            /// Scope links of timers
+            sTimerScope scopes_[COUNT];
+            /// First timer of every slot
+            uint32_t slots_[TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS];
+    };
+}
+
+#endif /* _H_MICROHSM_TIMER_SERVICE */
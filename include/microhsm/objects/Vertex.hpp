@@ -9,9 +9,28 @@
 #ifndef _H_MICROHSM_VERTEX
 #define _H_MICROHSM_VERTEX
 
+#include <stdint.h>
+#include <limits>
+#include <type_traits>
+
+#include <microhsm/config.hpp>
+
 namespace microhsm
 {
+    /// ID of a vertex (see `MICROHSM_INDEX_TYPE`)
+    typedef MICROHSM_INDEX_TYPE tVertexID;
+
+    /// ID of an event as stored by event enumerations and static transitions (see `MICROHSM_INDEX_TYPE`)
+    typedef MICROHSM_INDEX_TYPE tEventID;
+
+    static_assert(std::is_unsigned<tVertexID>::value && sizeof(tVertexID) <= sizeof(unsigned int),
+            "`MICROHSM_INDEX_TYPE` must be an unsigned integer type of at most `unsigned int`");
+
+    static_assert(MICROHSM_MAX_DEPTH <= std::numeric_limits<tVertexID>::max(),
+            "`MICROHSM_MAX_DEPTH` does not fit into `MICROHSM_INDEX_TYPE`");
 
+    /// Largest vertex ID
+    #define VERTEX_ID_MAX (std::numeric_limits<microhsm::tVertexID>::max())
 
     /**
      * @class Vertex
@@ -29,22 +48,36 @@ namespace microhsm
              * @enum eType
              * @brief Type of vertex
              */
-            enum eType {
+            enum eType : uint8_t {
                 eSTATE,             ///< Vertex is a state
                 ePSEUDO_HISTORY,    ///< Vertex is a history pseudostate
+                ePSEUDO_CHOICE,     ///< Vertex is a choice pseudostate
+                ePSEUDO_JUNCTION,   ///< Vertex is a junction pseudostate
             };
 
             /**
              * @brief Vertex constructor
-             * @param id Unique ID of vertex
+             * @param id Unique ID of vertex, at most `VERTEX_ID_MAX`
              * @param type Type of vertex
+             * @note `BaseHSM::init` fails for vertices with larger IDs
              */
             Vertex(unsigned int id, eType type);
 
+            /**
+             * @brief Check whether the ID passed to the constructor fits into `ID`
+             * @retval `true` ID is valid
+             * @retval `false` ID exceeds `VERTEX_ID_MAX` and was truncated
+             */
+            bool hasValidID(void) const;
+
             /// @brief Unique vertex ID
-            const unsigned int ID;
+            const tVertexID ID;
             /// @brief Vertex type (`Vertex::e_type`)
             const eType TYPE;
+
+        private:
+            /// Whether the ID passed to the constructor fits into `ID`
+            const bool validID_;
     };
 
 }
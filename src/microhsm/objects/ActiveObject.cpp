@@ -0,0 +1,290 @@
+/**
+ * @file ActiveObject.cpp
+ * @brief Active objects scheduled on work-stealing workers
+ *
+ * @author Jelle Meijer
+ * @date 2025-05-23
+ */
+
+#include <microhsm/microhsm.hpp>
+
+namespace microhsm
+{
+    BaseWorkStealingDeque::BaseWorkStealingDeque(std::atomic<unsigned int>* buffer, unsigned int capacity) :
+        top_(0),
+        bottom_(0),
+        buffer_(buffer),
+        mask_(capacity - 1)
+    {
+#if MICROHSM_ASSERTIONS == 1
+        MICROHSM_ASSERT(capacity >= 2 && (capacity & (capacity - 1)) == 0);
+#endif
+    }
+
+    bool BaseWorkStealingDeque::push(unsigned int value)
+    {
+        const unsigned int b = this->bottom_.load(std::memory_order_relaxed);
+        const unsigned int t = this->top_.load(std::memory_order_acquire);
+        if (b - t > this->mask_) return false;
+        this->buffer_[b & this->mask_].store(value, std::memory_order_relaxed);
+        // Entry must be visible before thieves observe the new bottom
+        std::atomic_thread_fence(std::memory_order_release);
+        this->bottom_.store(b + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool BaseWorkStealingDeque::pop(unsigned int& value)
+    {
+        // Reserve bottom entry before looking at the top
+        const unsigned int b = this->bottom_.load(std::memory_order_relaxed) - 1;
+        this->bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        unsigned int t = this->top_.load(std::memory_order_relaxed);
+
+        if (static_cast<int>(b - t) < 0) {
+            // Empty
+            this->bottom_.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        value = this->buffer_[b & this->mask_].load(std::memory_order_relaxed);
+        if (b != t) return true;
+
+        // Last entry, race against thieves
+        const bool won = this->top_.compare_exchange_strong(t, t + 1,
+                std::memory_order_seq_cst, std::memory_order_relaxed);
+        this->bottom_.store(b + 1, std::memory_order_relaxed);
+        return won;
+    }
+
+    bool BaseWorkStealingDeque::steal(unsigned int& value)
+    {
+        unsigned int t = this->top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const unsigned int b = this->bottom_.load(std::memory_order_acquire);
+        if (static_cast<int>(b - t) <= 0) return false;
+
+        value = this->buffer_[t & this->mask_].load(std::memory_order_relaxed);
+        return this->top_.compare_exchange_strong(t, t + 1,
+                std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+
+    unsigned int BaseWorkStealingDeque::size(void) const
+    {
+        const unsigned int t = this->top_.load(std::memory_order_acquire);
+        const int n = static_cast<int>(this->bottom_.load(std::memory_order_acquire) - t);
+        return (n > 0) ? static_cast<unsigned int>(n) : 0;
+    }
+
+    ActiveObject::ActiveObject(BaseHSM& hsm, AbstractEventQueue& mailbox, void* ctx) :
+        hsm_(hsm),
+        mailbox_(mailbox),
+        ctx_(ctx),
+        runtime_(nullptr),
+        index_(0),
+        home_(0),
+        scheduled_(false),
+        scheduledAt_(0)
+    {
+    }
+
+    bool ActiveObject::post(unsigned int event)
+    {
+        if (this->runtime_ == nullptr) return false;
+        return this->hsm_.post(event);
+    }
+
+    bool ActiveObject::deliverTimeout(unsigned int event)
+    {
+        return this->post(event);
+    }
+
+    void ActiveObject::notify_(void* arg)
+    {
+        ActiveObject* object = static_cast<ActiveObject*>(arg);
+        // Only the thread making the object runnable hands it to the runtime
+        if (!object->scheduled_.exchange(true, std::memory_order_seq_cst)) object->runtime_->schedule_(*object);
+    }
+
+    BaseHSM& ActiveObject::getHSM(void)
+    {
+        return this->hsm_;
+    }
+
+    BaseActiveRuntime::BaseActiveRuntime(ActiveObject** objects, sWorker* workers, unsigned int workerCount, unsigned int maxObjects) :
+        objects_(objects),
+        workers_(workers),
+        workerCount_(workerCount),
+        maxObjects_(maxObjects),
+        objectCount_(0)
+    {
+        for (unsigned int i = 0; i < workerCount; i++) {
+            sWorker& w = this->workers_[i];
+            w.deque = nullptr;
+            w.inbox = nullptr;
+            w.random = i + 1;
+            w.runs.store(0, std::memory_order_relaxed);
+            w.dispatched.store(0, std::memory_order_relaxed);
+            w.steals.store(0, std::memory_order_relaxed);
+            w.stealAttempts.store(0, std::memory_order_relaxed);
+            w.peakDepth.store(0, std::memory_order_relaxed);
+            w.latencyTotal.store(0, std::memory_order_relaxed);
+            w.latencyMax.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    bool BaseActiveRuntime::add(ActiveObject& object)
+    {
+        if (this->objectCount_ >= this->maxObjects_) return false;
+        object.runtime_ = this;
+        object.index_ = this->objectCount_;
+        object.home_ = this->objectCount_ % this->workerCount_;
+        object.scheduled_.store(false, std::memory_order_relaxed);
+        this->objects_[this->objectCount_++] = &object;
+
+        // Events posted to the HSM itself go to the mailbox and schedule the object
+        object.hsm_.attachQueue(&object.mailbox_);
+        object.hsm_.setPostNotify(ActiveObject::notify_, &object);
+
+        // Events posted before the object was added
+        if (object.hsm_.hasQueuedEvents() && !object.scheduled_.exchange(true)) this->schedule_(object);
+        return true;
+    }
+
+    bool BaseActiveRuntime::runOnce(unsigned int worker)
+    {
+#if MICROHSM_ASSERTIONS == 1
+        MICROHSM_ASSERT(worker < this->workerCount_);
+#endif
+        unsigned int index;
+        if (!this->findWork_(worker, index)) return false;
+        this->run_(this->workers_[worker], *this->objects_[index]);
+        return true;
+    }
+
+    void BaseActiveRuntime::runWorker(unsigned int worker, const std::atomic<bool>& stop)
+    {
+        while (!stop.load(std::memory_order_acquire)) {
+            if (!this->runOnce(worker)) MICROHSM_QUEUE_WAIT();
+        }
+    }
+
+    sWorkerStats BaseActiveRuntime::getStats(unsigned int worker) const
+    {
+        const sWorker& w = this->workers_[worker];
+        sWorkerStats stats;
+        stats.runs = w.runs.load(std::memory_order_relaxed);
+        stats.dispatched = w.dispatched.load(std::memory_order_relaxed);
+        stats.steals = w.steals.load(std::memory_order_relaxed);
+        stats.stealAttempts = w.stealAttempts.load(std::memory_order_relaxed);
+        stats.depth = w.deque->size() + w.inbox->size();
+        stats.peakDepth = w.peakDepth.load(std::memory_order_relaxed);
+        stats.latencyTotal = w.latencyTotal.load(std::memory_order_relaxed);
+        stats.latencyMax = w.latencyMax.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    sWorkerStats BaseActiveRuntime::getTotalStats(void) const
+    {
+        sWorkerStats total = this->getStats(0);
+        for (unsigned int i = 1; i < this->workerCount_; i++) {
+            sWorkerStats stats = this->getStats(i);
+            total.runs += stats.runs;
+            total.dispatched += stats.dispatched;
+            total.steals += stats.steals;
+            total.stealAttempts += stats.stealAttempts;
+            total.depth += stats.depth;
+            total.peakDepth += stats.peakDepth;
+            total.latencyTotal += stats.latencyTotal;
+            if (stats.latencyMax > total.latencyMax) total.latencyMax = stats.latencyMax;
+        }
+        return total;
+    }
+
+    unsigned int BaseActiveRuntime::getWorkerCount(void) const
+    {
+        return this->workerCount_;
+    }
+
+    unsigned int BaseActiveRuntime::getObjectCount(void) const
+    {
+        return this->objectCount_;
+    }
+
+    void BaseActiveRuntime::schedule_(ActiveObject& object)
+    {
+        object.scheduledAt_ = MICROHSM_RUNTIME_CLOCK();
+        this->workers_[object.home_].inbox->push(object.index_);
+    }
+
+    bool BaseActiveRuntime::findWork_(unsigned int worker, unsigned int& index)
+    {
+        sWorker& w = this->workers_[worker];
+
+        // Move objects made runnable by other threads to the deque, where they can be stolen
+        unsigned int indices[MICROHSM_QUEUE_BATCH_SIZE];
+        unsigned int n = w.inbox->popBatch(indices, MICROHSM_QUEUE_BATCH_SIZE);
+        while (n > 0) {
+            for (unsigned int i = 0; i < n; i++) {
+                bool pushed = w.deque->push(indices[i]);
+#if MICROHSM_ASSERTIONS == 1
+                MICROHSM_ASSERT(pushed);    // Deque holds every object
+#endif
+                (void)pushed;
+            }
+            n = w.inbox->popBatch(indices, MICROHSM_QUEUE_BATCH_SIZE);
+        }
+        const unsigned int depth = w.deque->size();
+        if (depth > w.peakDepth.load(std::memory_order_relaxed)) w.peakDepth.store(depth, std::memory_order_relaxed);
+
+        if (w.deque->pop(index)) return true;
+
+        // Steal from other workers, starting at a random victim
+        w.random ^= w.random << 13;
+        w.random ^= w.random >> 17;
+        w.random ^= w.random << 5;
+        const unsigned int start = w.random % this->workerCount_;
+        for (unsigned int i = 0; i < this->workerCount_; i++) {
+            const unsigned int victim = (start + i) % this->workerCount_;
+            if (victim == worker) continue;
+            w.stealAttempts.fetch_add(1, std::memory_order_relaxed);
+            if (this->workers_[victim].deque->steal(index)) {
+                w.steals.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void BaseActiveRuntime::run_(sWorker& w, ActiveObject& object)
+    {
+        const unsigned long latency = MICROHSM_RUNTIME_CLOCK() - object.scheduledAt_;
+        w.latencyTotal.fetch_add(latency, std::memory_order_relaxed);
+        if (latency > w.latencyMax.load(std::memory_order_relaxed)) w.latencyMax.store(latency, std::memory_order_relaxed);
+
+        // Run-to-completion steps of this object, no other worker owns it
+        unsigned int events[MICROHSM_QUEUE_BATCH_SIZE];
+        unsigned int n = object.mailbox_.popBatch(events, MICROHSM_QUEUE_BATCH_SIZE);
+        for (unsigned int i = 0; i < n; i++) {
+            object.hsm_.dispatch(events[i], object.ctx_);
+        }
+        // Followed by at most a batch of events with payload posted to the HSM
+        for (unsigned int i = 0; i < MICROHSM_QUEUE_BATCH_SIZE && object.hsm_.runPayloadOnce_(object.ctx_); i++) n++;
+        w.runs.fetch_add(1, std::memory_order_relaxed);
+        w.dispatched.fetch_add(n, std::memory_order_relaxed);
+
+        if (!object.hsm_.hasQueuedEvents()) {
+            // Release object, unless an event was posted before the release became visible
+            object.scheduled_.store(false, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!object.hsm_.hasQueuedEvents() || object.scheduled_.exchange(true, std::memory_order_seq_cst)) return;
+        }
+
+        // More events queued, keep object runnable on this worker
+        object.scheduledAt_ = MICROHSM_RUNTIME_CLOCK();
+        bool pushed = w.deque->push(object.index_);
+#if MICROHSM_ASSERTIONS == 1
+        MICROHSM_ASSERT(pushed);
+#endif
+        (void)pushed;
+    }
+}
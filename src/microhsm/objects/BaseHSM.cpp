@@ -10,10 +10,68 @@
 
 namespace microhsm
 {
+    /// Write state index into a snapshot, least significant byte first
+    static inline uint8_t* writeIndex_(uint8_t* p, tStateIndex s)
+    {
+        for (unsigned int b = 0; b < sizeof(tStateIndex); b++) {
+            *p++ = static_cast<uint8_t>(s >> (8u * b));
+        }
+        return p;
+    }
+
+    /// Read state index from a snapshot, least significant byte first
+    static inline tStateIndex readIndex_(const uint8_t*& p)
+    {
+        unsigned int s = 0;
+        for (unsigned int b = 0; b < sizeof(tStateIndex); b++) {
+            s |= static_cast<unsigned int>(*p++) << (8u * b);
+        }
+        return static_cast<tStateIndex>(s);
+    }
+
+    /// Write entry of a definition that is being built, or compare it with the entry of a built definition
+    template <typename T>
+    static inline bool tableEntry_(T& entry, T value, bool compare)
+    {
+        if (compare) return entry == value;
+        entry = value;
+        return true;
+    }
+
+    /// Report why initialization failed, always returns `false`
+    static inline bool initError_(const char* reason)
+    {
+#if MICROHSM_TRACING == 1
+        MICROHSM_TRACE_INIT_ERROR(reason);
+#else
+        (void) reason;
+#endif
+        return false;
+    }
+
+    bool HSMDefinition::isBuilt() const
+    {
+        return this->built_;
+    }
+
+#if MICROHSM_INSTANCE_STORAGE == 1
     BaseHSM::BaseHSM(BaseState& initial) :
+        BaseHSM(initial, this->ownDefinition_)
+    {
+    };
+#endif
+
+    BaseHSM::BaseHSM(BaseState& initial, HSMDefinition& definition) :
         curState(&initial),
-        initState(initial)
+        initState(initial),
+        definition_(definition)
     {
+#if MICROHSM_INSTANCE_STORAGE == 1 && MICROHSM_DEFER_QUEUE_SIZE > 0
+        this->deferQueue_ = &this->ownDeferQueue_;
+#endif
+#if MICROHSM_TRANSITION_CACHE_SIZE > 0
+        this->clearTransitionCache();
+#endif
     };
 
     BaseHSM::~BaseHSM()
@@ -21,314 +79,1499 @@ namespace microhsm
     }
 
     /* --- Static Functions --- */
+#if MICROHSM_TRANSITION_CACHE_SIZE > 0
+    unsigned int BaseHSM::cacheIndex_(tStateIndex leaf, tStateIndex source,
+            tStateIndex target, eTransitionKind kind)
+    {
+        unsigned int h = leaf;
+        h = (h * 31u) + source;
+        h = (h * 31u) + target;
+        h = (h * 31u) + static_cast<unsigned int>(kind);
+        return h % MICROHSM_TRANSITION_CACHE_SIZE;
+    }
+#endif
+    /* --- End static functions --- */
+
+    /* --- Member functions --- */
+    eStatus BaseHSM::init(void* ctx)
+    {
+        if (!this->build_(ctx)) {
+            // Hierarchy does not fit the state table (or the definition), HSM stays inactive
+            this->setCurrentState_(STATE_INDEX_NONE);
+            return eTRANSITION_ERROR;
+        }
+        this->start_(ctx);
+        return eOK;
+    }
+
+    bool BaseHSM::build_(void* ctx)
+    {
+#if MICROHSM_TRANSITION_CACHE_SIZE > 0
+        this->clearTransitionCache();
+#endif
+
+        // Vertices of HSMs overriding `getVertex` are registered on first initialization
+        if (this->definition_.registryCount_ == 0) this->registerLookup_();
+
+        // Timers of a previous run are scoped to states that are no longer active
+        if (this->scopedTimers_ != TIMER_INDEX_NONE) this->timerService_->disarmScoped_(*this, TIMER_STATE_NONE);
+
+        // Place registered vertices by ID
+        this->buildRegistry_();
+        this->registryValid_ = this->verifyRegistry_();
+
+        // Flatten hierarchy, or bind to the hierarchy flattened by another instance
+        if (!this->buildStateTable_()) return false;
+        this->lcaStrategy_ = this->definition_.lcaStrategy_;
+        this->skippedAnonymousSweeps_ = 0;
+
+        // Initialize all states
+        bool valid = true;
+        for (tStateIndex i = 0; i < this->definition_.stateCount_; i++) {
+            this->state_(i)->init(ctx);
+            if (this->definition_.flags_[i] & eFLAG_ORTHOGONAL) {
+                valid = static_cast<BaseOrthogonalState*>(this->state_(i))->initRegions_(ctx) && valid;
+            }
+        }
+        return valid;
+    }
+
+    void BaseHSM::start_(void* ctx)
+    {
+#if MICROHSM_DEFER_QUEUE_SIZE > 0
+        // Events deferred by a previous configuration are discarded
+        this->clearDeferredEvents();
+#endif
+
+        // Perform entry on initial state
+        tStateIndex s = this->initState.index_;
+        this->enterState_(s, ctx);
+
+        // Walk down until the leaf initial state
+        s = enterInitialStates_(s, ctx);
+
+        this->setCurrentState_(s);
+
+        // Handle any initial anonymous transitions
+        this->runToCompletion_(EVENT_ANONYMOUS, ctx);
+    }
+
+    void BaseHSM::stop_(void* ctx)
+    {
+        this->exitUntilTarget_(this->cur_, STATE_INDEX_NONE, ctx);
+    }
+
+    tEventMask BaseHSM::getActiveEvents_()
+    {
+        if (this->cur_ == STATE_INDEX_NONE) return 0;
+#if MICROHSM_EVENT_MASKS == 1
+        tEventMask mask = this->definition_.chainMask_[this->cur_];
+#if MICROHSM_DEFER_QUEUE_SIZE > 0
+        mask |= this->definition_.chainDefer_[this->cur_];
+#endif
+        return mask;
+#else
+        return EVENT_MASK_ALL;
+#endif
+    }
+
+    void BaseHSM::registerVertices(std::initializer_list<Vertex*> vertices)
+    {
+        for (Vertex* v : vertices) {
+            this->registerVertex(v);
+        }
+    }
+
+    void BaseHSM::registerVertex(Vertex* v)
+    {
+        HSMDefinition& d = this->definition_;
+
+        // Other instances register the same vertices, at the same position
+        if (d.built_) return;
+        const intptr_t offset = this->offsetOf_(v);
+        const unsigned int stored = (d.registryCount_ < MICROHSM_MAX_VERTICES) ? d.registryCount_ : MICROHSM_MAX_VERTICES;
+        for (unsigned int i = 0; i < stored; i++) {
+            if (d.registry_[i] == offset) return;
+        }
+
+        if (d.registryCount_ < MICROHSM_MAX_VERTICES) {
+            d.registry_[d.registryCount_] = offset;
+        }
+        // Truncated IDs can alias other vertices, rejected by `init`
+        if (!v->hasValidID()) d.registryInvalidID_ = true;
+        if (d.registryCount_ == 0 || v->ID > d.registryMaxID_) {
+            d.registryMaxID_ = v->ID;
+        }
+        d.registryCount_++;
+        d.registryBuilt_ = false;
+    }
+
+    void BaseHSM::registerLookup_()
+    {
+        // Default `getVertex` only knows registered vertices
+        this->registryQueried_ = false;
+        this->getVertex(0);
+        if (this->registryQueried_) return;
+
+        const unsigned int maxID = this->getMaxID();
+        for (unsigned int id = 0; id <= maxID; id++) {
+            Vertex* v = this->getVertex(id);
+            if (v != nullptr) this->registerVertex(v);
+        }
+    }
+
+    intptr_t BaseHSM::offsetOf_(const Vertex* v)
+    {
+        return static_cast<intptr_t>(reinterpret_cast<uintptr_t>(v) - reinterpret_cast<uintptr_t>(this));
+    }
+
+    Vertex* BaseHSM::vertexAt_(intptr_t offset)
+    {
+        if (offset == 0) return nullptr;
+        return reinterpret_cast<Vertex*>(reinterpret_cast<uintptr_t>(this) + static_cast<uintptr_t>(offset));
+    }
+
+    BaseState* BaseHSM::state_(tStateIndex s)
+    {
+        // Offsets are taken of the `Vertex` base, which need not start the state
+        return static_cast<BaseState*>(this->vertexAt_(this->definition_.states_[s]));
+    }
+
+    void BaseHSM::buildRegistry_()
+    {
+        const unsigned int count = this->definition_.registryCount_;
+        if (count == 0 || count > MICROHSM_MAX_VERTICES) return;
+        if (this->definition_.registryBuilt_) return;
+
+        Vertex* vertices[MICROHSM_MAX_VERTICES];
+        unsigned int base = this->vertexAt_(this->definition_.registry_[0])->ID;
+        for (unsigned int i = 0; i < count; i++) {
+            vertices[i] = this->vertexAt_(this->definition_.registry_[i]);
+            if (vertices[i]->ID < base) base = vertices[i]->ID;
+        }
+
+        // Use IDs directly if they fit, otherwise search for perfect hash
+        const unsigned int span = this->definition_.registryMaxID_ - base + 1;
+        unsigned int slots = (span <= MICROHSM_MAX_VERTICES) ? span : count;
+        for (; slots <= MICROHSM_MAX_VERTICES; slots++) {
+            bool unique = true;
+            for (unsigned int i = 0; i < slots; i++) {
+                this->definition_.registry_[i] = 0;
+            }
+            for (unsigned int i = 0; i < count && unique; i++) {
+                intptr_t* slot = &this->definition_.registry_[(vertices[i]->ID - base) % slots];
+                unique = (*slot == 0);
+                *slot = this->offsetOf_(vertices[i]);
+            }
+            if (unique) {
+                this->definition_.registryBase_ = base;
+                this->definition_.registrySlots_ = slots;
+                this->definition_.registryModulus_ = (slots >= span) ? 0 : slots;
+                this->definition_.registryBuilt_ = true;
+                return;
+            }
+            // Duplicate IDs never become unique
+            if (slots >= span) break;
+        }
+
+        // No perfect hash found, restore registration order
+        for (unsigned int i = 0; i < count; i++) {
+            this->definition_.registry_[i] = this->offsetOf_(vertices[i]);
+        }
+    }
+
+    bool BaseHSM::verifyRegistry_()
+    {
+        if (!this->definition_.registryBuilt_) return false;
+
+        // Detect whether `getVertex` has been overridden
+        this->registryQueried_ = false;
+        this->getVertex(this->definition_.registryBase_);
+        if (this->registryQueried_) return true;
+
+        // Every vertex provided by `getVertex` must be registered
+        unsigned int found = 0;
+        for (unsigned int id = 0; id <= this->getMaxID(); id++) {
+            Vertex* v = this->getVertex(id);
+            if (v != this->findRegisteredVertex_(id)) return false;
+            if (v != nullptr) found++;
+        }
+        return found == this->definition_.registryCount_;
+    }
+
+    Vertex* BaseHSM::findRegisteredVertex_(unsigned int ID)
+    {
+        if (!this->definition_.registryBuilt_) {
+            // Vertices in order of registration
+            const unsigned int count = (this->definition_.registryCount_ < MICROHSM_MAX_VERTICES) ?
+                this->definition_.registryCount_ : MICROHSM_MAX_VERTICES;
+            for (unsigned int i = 0; i < count; i++) {
+                Vertex* v = this->vertexAt_(this->definition_.registry_[i]);
+                if (v->ID == ID) return v;
+            }
+            return nullptr;
+        }
+
+        if (ID < this->definition_.registryBase_) return nullptr;
+        unsigned int slot = ID - this->definition_.registryBase_;
+        if (this->definition_.registryModulus_ != 0) {
+            slot %= this->definition_.registryModulus_;
+        }
+        else if (slot >= this->definition_.registrySlots_) {
+            return nullptr;
+        }
+        Vertex* v = this->vertexAt_(this->definition_.registry_[slot]);
+        return (v != nullptr && v->ID == ID) ? v : nullptr;
+    }
+
+    Vertex* BaseHSM::lookupVertex_(unsigned int ID)
+    {
+        return this->registryValid_ ? this->findRegisteredVertex_(ID) : this->getVertex(ID);
+    }
+
+    Vertex* BaseHSM::getVertex(unsigned int ID)
+    {
+#if MICROHSM_ASSERTIONS == 1
+        MICROHSM_ASSERT(this->definition_.registryCount_ <= MICROHSM_MAX_VERTICES); // Increase `MICROHSM_MAX_VERTICES`
+#endif
+        this->registryQueried_ = true;
+        return this->findRegisteredVertex_(ID);
+    }
+
+    unsigned int BaseHSM::getMaxID()
+    {
+        return this->definition_.registryMaxID_;
+    }
+
+    bool BaseHSM::usesVertexRegistry()
+    {
+        return this->registryValid_;
+    }
+
+    bool BaseHSM::buildStateTable_()
+    {
+        HSMDefinition& d = this->definition_;
+
+        // Instances of a built definition are compared with it, the definition stays unchanged
+        const bool bound = d.built_;
+        if (!bound) {
+            // Table stays empty unless the complete hierarchy fits
+            d.stateCount_ = 0;
+            d.historyCount_ = 0;
+        }
+
+        // Vertices with truncated IDs can be shadowed by the vertex they alias
+        if (d.registryInvalidID_) return initError_("vertex ID exceeds MICROHSM_INDEX_TYPE");
+
+        // Assign indices to all states, iterate over registry if possible
+        tStateIndex count = 0;
+        const unsigned int end = this->registryValid_ ? d.registrySlots_ : this->getMaxID() + 1;
+        for (unsigned int i = 0; i < end; i++) {
+
+            Vertex* v = this->registryValid_ ? this->vertexAt_(d.registry_[i]) : this->getVertex(i);
+
+            if (v != nullptr) {
+                // Increase `MICROHSM_INDEX_TYPE`
+                if (!v->hasValidID()) return initError_("vertex ID exceeds MICROHSM_INDEX_TYPE");
+                if (v->TYPE == Vertex::eSTATE) {
+                    // Increase `MICROHSM_MAX_STATES`
+                    if (count >= MICROHSM_MAX_STATES) return initError_("hierarchy exceeds MICROHSM_MAX_STATES");
+                    if (!tableEntry_(d.states_[count], this->offsetOf_(v), bound)) return initError_("states differ from definition");
+                    BaseState* s = static_cast<BaseState*>(v);
+                    s->hsm_ = this;
+                    s->index_ = count;
+                    count++;
+                }
+            }
+        }
+        if (bound && count != d.stateCount_) return initError_("states differ from definition");
+
+        // Initial state must be part of the table
+        if (this->initState.hsm_ != this || this->initState.index_ >= count) return initError_("initial state not part of HSM");
+
+        // Choices continue from their parent, which must be part of the table
+        for (unsigned int i = 0; i < end; i++) {
+            Vertex* v = this->registryValid_ ? this->vertexAt_(d.registry_[i]) : this->getVertex(i);
+            if (v == nullptr || v->TYPE != Vertex::ePSEUDO_CHOICE) continue;
+
+            const BaseState* p = static_cast<Choice*>(v)->parent;
+            if (p != nullptr && (p->hsm_ != this || p->index_ >= count)) return initError_("choice parent not part of HSM");
+        }
+
+        // Resolve hierarchy into indices
+        unsigned int historyCount = 0;
+        for (tStateIndex i = 0; i < count; i++) {
+            BaseState* s = this->state_(i);
+            // Increase `MICROHSM_MAX_DEPTH`
+            if (s->depth >= MICROHSM_MAX_DEPTH) return initError_("hierarchy exceeds MICROHSM_MAX_DEPTH");
+#if MICROHSM_ASSERTIONS == 1
+            if (s->parent != nullptr) {
+                MICROHSM_ASSERT(s->parent->index_ != STATE_INDEX_NONE); // Parent not returned by `getVertex`
+            }
+#endif
+            uint8_t flags = 0;
+            if (s->isComposite_) flags |= eFLAG_COMPOSITE;
+            if (s->shallowHistory_ != nullptr) flags |= eFLAG_SHALLOW_HISTORY;
+            if (s->deepHistory_ != nullptr) flags |= eFLAG_DEEP_HISTORY;
+            if (s->shallowHistory_ != nullptr) historyCount++;
+            if (s->deepHistory_ != nullptr) historyCount++;
+            if (s->isOrthogonal_) flags |= eFLAG_ORTHOGONAL;
+            // Anonymous flag follows from the handled events
+            if (bound) flags = static_cast<uint8_t>(flags | (d.flags_[i] & eFLAG_ANONYMOUS));
+
+            bool same = tableEntry_(d.ids_[i], s->ID, bound) &&
+                tableEntry_(d.depth_[i], static_cast<uint8_t>(s->depth), bound) &&
+                tableEntry_(d.parent_[i], (s->parent == nullptr) ? static_cast<tStateIndex>(STATE_INDEX_NONE) : s->parent->index_, bound) &&
+                tableEntry_(d.initial_[i], (s->initial == nullptr) ? static_cast<tStateIndex>(STATE_INDEX_NONE) : s->initial->index_, bound) &&
+                tableEntry_(d.flags_[i], flags, bound);
+#if MICROHSM_EVENT_MASKS == 1
+            same = same && tableEntry_(d.mask_[i], s->handledEvents(), bound);
+#endif
+#if MICROHSM_DEFER_QUEUE_SIZE > 0
+            // Anonymous events cannot be deferred, nor events sharing the highest bit
+            same = same && tableEntry_(d.deferMask_[i], s->deferredEvents() & ~(eventBit(EVENT_ANONYMOUS) | EVENT_MASK_SHARED), bound);
+#endif
+            if (!same) return initError_("hierarchy differs from definition");
+        }
+        if (bound) return true;
+
+        // Combine handled events of states and their ancestors
+        for (tStateIndex i = 0; i < count; i++) {
+            tEventMask mask = 0;
+            for (tStateIndex s = i; s != STATE_INDEX_NONE; s = d.parent_[s]) {
+#if MICROHSM_EVENT_MASKS == 1
+                mask |= d.mask_[s];
+#else
+                mask |= this->state_(s)->handledEvents();
+#endif
+            }
+#if MICROHSM_EVENT_MASKS == 1
+            d.chainMask_[i] = mask;
+#endif
+#if MICROHSM_DEFER_QUEUE_SIZE > 0
+            tEventMask defer = 0;
+            for (tStateIndex s = i; s != STATE_INDEX_NONE; s = d.parent_[s]) {
+                defer |= d.deferMask_[s];
+            }
+            d.chainDefer_[i] = defer;
+#endif
+            if (mask & eventBit(EVENT_ANONYMOUS)) d.flags_[i] |= eFLAG_ANONYMOUS;
+        }
+
+        d.stateCount_ = count;
+        d.historyCount_ = historyCount;
+
+        this->numberStates_();
+        this->buildLCATables_();
+        d.built_ = true;
+        return true;
+    }
+
+    void BaseHSM::numberStates_()
+    {
+        const tStateIndex count = this->definition_.stateCount_;
+
+        // Determine subtree sizes (stored in `end_`) and maximum depth
+        uint8_t maxDepth = 0;
+        for (tStateIndex i = 0; i < count; i++) {
+            this->definition_.end_[i] = 1;
+            if (this->definition_.depth_[i] > maxDepth) maxDepth = this->definition_.depth_[i];
+        }
+        for (tStateIndex i = 0; i < count; i++) {
+            for (tStateIndex a = this->definition_.parent_[i]; a != STATE_INDEX_NONE; a = this->definition_.parent_[a]) {
+                this->definition_.end_[a]++;
+            }
+        }
+
+        // Assign pre-order numbers level by level, parents are numbered before their children
+        tStateIndex next[MICROHSM_MAX_STATES];
+        tStateIndex nextTop = 0;
+        for (uint8_t d = 0; d <= maxDepth; d++) {
+            for (tStateIndex i = 0; i < count; i++) {
+                if (this->definition_.depth_[i] != d) continue;
+
+                tStateIndex p = this->definition_.parent_[i];
+                tStateIndex* n = (p == STATE_INDEX_NONE) ? &nextTop : &next[p];
+                this->definition_.pre_[i] = *n;
+                *n = static_cast<tStateIndex>(*n + this->definition_.end_[i]);
+                next[i] = static_cast<tStateIndex>(this->definition_.pre_[i] + 1);
+            }
+        }
+
+        // Convert subtree sizes into highest pre-order number of subtree
+        for (tStateIndex i = 0; i < count; i++) {
+            this->definition_.end_[i] = static_cast<tStateIndex>(this->definition_.pre_[i] + this->definition_.end_[i] - 1);
+        }
+    }
+
+    tStateIndex BaseHSM::findStateIndex_(unsigned int ID)
+    {
+        Vertex* v = this->lookupVertex_(ID);
+        if (v == nullptr || v->TYPE != Vertex::eSTATE) return STATE_INDEX_NONE;
+
+        BaseState* s = static_cast<BaseState*>(v);
+        return (s->hsm_ == this) ? s->index_ : static_cast<tStateIndex>(STATE_INDEX_NONE);
+    }
+
+    bool BaseHSM::isAncestorOrSelf_(tStateIndex ancestor, tStateIndex s)
+    {
+        return this->definition_.pre_[ancestor] <= this->definition_.pre_[s] && this->definition_.pre_[s] <= this->definition_.end_[ancestor];
+    }
+
+    eStatus BaseHSM::dispatch(unsigned int event, void* ctx)
+    {
+        // Journal is written ahead of processing the event
+        if (this->journal_ != nullptr) this->journal_->append_(this->journalInstance_, event, nullptr, 0);
+        return this->runToCompletion_(event, ctx);
+    }
+
+    eStatus BaseHSM::runToCompletion_(unsigned int event, void* ctx)
+    {
+        eStatus status = this->dispatchEvent_(event, ctx);
+#if MICROHSM_DEFER_QUEUE_SIZE > 0
+        // Run-to-completion step finished, recall events no longer deferred
+        if (status == eOK && this->deferQueue_ != nullptr && this->deferQueue_->count_ > 0) this->recallDeferredEvents_(ctx);
+#endif
+        return status;
+    }
+
+    eStatus BaseHSM::dispatch(const Event& event, void* ctx)
+    {
+        // Journal is written ahead of processing the event
+        if (this->journal_ != nullptr) {
+            this->journal_->append_(this->journalInstance_, event.getID(), event.data(), event.size());
+        }
+        return this->runToCompletion_(event, ctx);
+    }
+
+    eStatus BaseHSM::runToCompletion_(const Event& event, void* ctx)
+    {
+        // Event is referenced (not copied) while it is being dispatched
+        this->event_ = &event;
+        eStatus status = this->dispatchEvent_(event.getID(), ctx);
+        this->event_ = nullptr;
+#if MICROHSM_DEFER_QUEUE_SIZE > 0
+        // Run-to-completion step finished, recall events no longer deferred
+        if (status == eOK && this->deferQueue_ != nullptr && this->deferQueue_->count_ > 0) this->recallDeferredEvents_(ctx);
+#endif
+        return status;
+    }
+
+    const Event* BaseHSM::getCurrentEvent()
+    {
+        return this->event_;
+    }
+
     void BaseHSM::performEffect_(const sTransition* t, void* ctx)
     {
+        if (!this->behavior_) return;
         if (t->effect != nullptr) {
             // Perform transition effect
             t->effect(ctx);
         }
+        if (t->eventEffect != nullptr) {
+            if (this->event_ != nullptr) {
+                t->eventEffect(ctx, *this->event_);
+            }
+            else {
+                // Dispatched by ID, provide event without payload
+                const Event e(this->eventID_);
+                t->eventEffect(ctx, e);
+            }
+        }
     }
 
-    void BaseHSM::updateHistories_(BaseState* newState)
+    eStatus BaseHSM::performTransitionInternal_(const sTransition* t, void* ctx)
     {
-#if MICROHSM_ASSERTIONS == 1
-        // `newState` must be 'leaf' state
-        bool isComposite = newState->isComposite();
-        MICROHSM_ASSERT(isComposite == false);
+        // Perform transition effect
+        this->performEffect_(t, ctx);
+        return eOK;
+    }
+
+    eStatus BaseHSM::dispatchEvent_(unsigned int event, void* ctx)
+    {
+        sTransition t;
+        t.eventEffect = nullptr;
+        eStatus status = eTRANSITION_ERROR;
+        this->eventID_ = event;
+
+#if MICROHSM_DEFER_QUEUE_SIZE > 0
+        // Only states below the deferring state can take the event
+        const tStateIndex deferrer = this->findDeferringState_(event);
+#else
+        const tStateIndex deferrer = STATE_INDEX_NONE;
 #endif
-        // Set histories
-        BaseState* s = newState;
-        while (s->parent != nullptr) {
-            // Update new history
-            if (s->parent->deepHistory_ != nullptr) {
-                s->parent->deepHistory_->setHistoryState(newState);
+
+        // Regions of an orthogonal leaf take priority over the state and its ancestors
+        if (this->cur_ != STATE_INDEX_NONE && (this->definition_.flags_[this->cur_] & eFLAG_ORTHOGONAL)) {
+            BaseOrthogonalState* orthogonal = static_cast<BaseOrthogonalState*>(this->state_(this->cur_));
+            status = orthogonal->dispatchRegions_(event, this->event_, ctx);
+            if (status != eEVENT_IGNORED) return status;
+            status = eTRANSITION_ERROR;
+        }
+
+        // Match event to state and perform transition
+        status = this->takeTransition_(event, &t, ctx, deferrer);
+        if (status == eEVENT_IGNORED) {
+#if MICROHSM_DEFER_QUEUE_SIZE > 0
+            if (deferrer != STATE_INDEX_NONE) {
+                // Deferred events are stored by ID, payloads cannot be kept
+                if (this->event_ != nullptr && this->event_->size() > 0) return eEVENT_NOT_DEFERRED;
+                return this->deferEvent_(event);
             }
-            // Update shallow history
-            if (s->parent->shallowHistory_ != nullptr) {
-                s->parent->shallowHistory_->setHistoryState(s);
+#endif
+#if MICROHSM_TRACING == 1
+            if (this->behavior_) {
+                MICROHSM_TRACE_DISPATCH_IGNORED(event);
             }
-            s = s->parent;
+#endif
+            return eEVENT_IGNORED;
+        }
+        if (status != eOK) return status;
+
+        // Handle anonymous transitions repeatedly (Run-to-completion)
+        while (this->definition_.flags_[this->cur_] & eFLAG_ANONYMOUS) {
+            // Completion events carry no payload
+            this->event_ = nullptr;
+            this->eventID_ = EVENT_ANONYMOUS;
+            t.eventEffect = nullptr;
+            status = this->takeTransition_(EVENT_ANONYMOUS, &t, ctx, STATE_INDEX_NONE);
+            if (status == eEVENT_IGNORED) return eOK;
+            if (status != eOK) return status;
+        }
+
+        // Active configuration cannot handle anonymous events
+        this->skippedAnonymousSweeps_++;
+        return status;
+    }
+
+    void BaseHSM::attachQueue(AbstractEventQueue* queue)
+    {
+        this->queue_ = queue;
+    }
+
+    bool BaseHSM::post(unsigned int event)
+    {
+        if (this->queue_ == nullptr || !this->queue_->push(event)) return false;
+        if (this->notify_ != nullptr) this->notify_(this->notifyArg_);
+        return true;
+    }
+
+    unsigned int BaseHSM::postBatch(const unsigned int* events, unsigned int count)
+    {
+        if (this->queue_ == nullptr) return 0;
+        const unsigned int pushed = this->queue_->pushBatch(events, count);
+        if (pushed > 0 && this->notify_ != nullptr) this->notify_(this->notifyArg_);
+        return pushed;
+    }
+
+    bool BaseHSM::deliverTimeout(unsigned int event)
+    {
+        return this->post(event);
+    }
+
+    void BaseHSM::setPostNotify(fPostNotify notify, void* arg)
+    {
+        this->notify_ = notify;
+        this->notifyArg_ = arg;
+    }
+
+    void BaseHSM::attachPayloadQueue(BasePayloadQueue* queue)
+    {
+        this->payloadQueue_ = queue;
+    }
+
+    void BaseHSM::attachTimerService(BaseTimerService* service)
+    {
+        // Timers armed through the previous service are no longer scoped
+        if (this->scopedTimers_ != TIMER_INDEX_NONE) this->timerService_->disarmScoped_(*this, TIMER_STATE_NONE);
+        this->timerService_ = service;
+    }
+
+    bool BaseHSM::post(Event&& event)
+    {
+        if (this->payloadQueue_ == nullptr || !this->payloadQueue_->push(static_cast<Event&&>(event))) return false;
+        if (this->notify_ != nullptr) this->notify_(this->notifyArg_);
+        return true;
+    }
+
+    bool BaseHSM::hasQueuedEvents(void) const
+    {
+        return (this->queue_ != nullptr && !this->queue_->empty()) ||
+            (this->payloadQueue_ != nullptr && this->payloadQueue_->size() != 0);
+    }
+
+    bool BaseHSM::runOnce(void* ctx)
+    {
+        unsigned int event;
+        if (this->queue_ != nullptr && this->queue_->pop(event)) {
+            this->dispatch(event, ctx);
+            return true;
+        }
+        return this->runPayloadOnce_(ctx);
+    }
+
+    unsigned int BaseHSM::runUntilEmpty(void* ctx)
+    {
+        unsigned int count = 0;
+        unsigned int n;
+        do {
+            n = 0;
+            if (this->queue_ != nullptr) {
+                // Pop events in batches, dispatch them one by one (run-to-completion)
+                unsigned int events[MICROHSM_QUEUE_BATCH_SIZE];
+                unsigned int popped = this->queue_->popBatch(events, MICROHSM_QUEUE_BATCH_SIZE);
+                while (popped > 0) {
+                    for (unsigned int i = 0; i < popped; i++) {
+                        this->dispatch(events[i], ctx);
+                    }
+                    n += popped;
+                    popped = this->queue_->popBatch(events, MICROHSM_QUEUE_BATCH_SIZE);
+                }
+            }
+            while (this->runPayloadOnce_(ctx)) n++;
+            count += n;
+        } while (n > 0 && this->payloadQueue_ != nullptr);
+        return count;
+    }
+
+    bool BaseHSM::runPayloadOnce_(void* ctx)
+    {
+        if (this->payloadQueue_ == nullptr) return false;
+        Event event;
+        if (!this->payloadQueue_->pop(event)) return false;
+        // Payload is released when `event` goes out of scope
+        this->dispatch(event, ctx);
+        return true;
+    }
+
+    BaseState* BaseHSM::getCurrentState()
+    {
+        return this->curState;
+    }
+
+    bool BaseHSM::inState(unsigned int ID)
+    {
+        if (this->cur_ == STATE_INDEX_NONE) return false;
+        tStateIndex s = this->findStateIndex_(ID);
+        return s != STATE_INDEX_NONE && this->isAncestorOrSelf_(s, this->cur_);
+    }
+
+    bool BaseHSM::inAnyState(const unsigned int* IDs, unsigned int count)
+    {
+        if (this->cur_ == STATE_INDEX_NONE) return false;
+        const tStateIndex cur = this->definition_.pre_[this->cur_];
+        for (unsigned int i = 0; i < count; i++) {
+            tStateIndex s = this->findStateIndex_(IDs[i]);
+            if (s != STATE_INDEX_NONE && this->definition_.pre_[s] <= cur && cur <= this->definition_.end_[s]) return true;
+        }
+        return false;
+    }
+
+#if MICROHSM_DEFER_QUEUE_SIZE > 0
+    DeferQueue::DeferQueue()
+    {
+        this->clear_();
+    }
+
+    unsigned int DeferQueue::getCount() const
+    {
+        return this->count_;
+    }
+
+    void DeferQueue::clear_()
+    {
+        // Chain all entries into the free list
+        for (unsigned int i = 0; i < MICROHSM_DEFER_QUEUE_SIZE; i++) {
+            this->deferred_[i].next = (i + 1 < MICROHSM_DEFER_QUEUE_SIZE) ? i + 1 : DEFER_INDEX_NONE;
+        }
+        for (unsigned int b = 0; b < EVENT_MASK_BITS; b++) {
+            this->head_[b] = DEFER_INDEX_NONE;
+            this->tail_[b] = DEFER_INDEX_NONE;
         }
+        this->free_ = 0;
+        this->count_ = 0;
+        this->pending_ = 0;
+        this->order_ = 0;
+    }
 
+    void BaseHSM::attachDeferQueue(DeferQueue* queue)
+    {
+        this->deferQueue_ = queue;
+        if (queue != nullptr) queue->clear_();
     }
 
-    eStatus BaseHSM::performTransitionInternal_(const sTransition* t, void* ctx)
+    unsigned int BaseHSM::getDeferredCount()
     {
-        // Perform transition effect
-        performEffect_(t, ctx);
-        return eOK;
+        return (this->deferQueue_ == nullptr) ? 0 : this->deferQueue_->count_;
     }
 
-    BaseState* BaseHSM::findLCA_(BaseState* a, BaseState* b)
+    unsigned long BaseHSM::getDeferOverflows()
     {
-        BaseState* s1 = a;
-        BaseState* s2 = b;
+        return this->deferOverflows_;
+    }
 
-        while(s1 != s2) {
-            // Move up from deepest state
-            if (s1 == nullptr || s2 == nullptr) return nullptr;
+    void BaseHSM::clearDeferredEvents()
+    {
+        if (this->deferQueue_ != nullptr) this->deferQueue_->clear_();
+        this->deferOverflows_ = 0;
+    }
 
-            if (s1->depth > s2->depth) {
-                s1 = s1->parent;
-            }
-            else if (s2->depth > s1->depth) {
-                s2 = s2->parent;
-            }
-            else {
-                s1 = s1->parent;
-                s2 = s2->parent;
-            }
+    tStateIndex BaseHSM::findDeferringState_(unsigned int event)
+    {
+        tStateIndex s = this->cur_;
+        const tEventMask bit = eventBit(event);
+        if (s == STATE_INDEX_NONE || (this->definition_.chainDefer_[s] & bit) == 0) return STATE_INDEX_NONE;
+        while ((this->definition_.deferMask_[s] & bit) == 0) {
+            s = this->definition_.parent_[s];
         }
-
-        // s1 contains lowest common ancestor or `nullptr
-        return s1;
+        return s;
     }
-    /* --- End static functions --- */
 
-    /* --- Member functions --- */
-    void BaseHSM::init(void* ctx)
+    eStatus BaseHSM::deferEvent_(unsigned int event)
     {
-        // Initialize all states
-        for (unsigned int id = 0; id < this->getMaxID(); id++) {
-
-            Vertex* v = this->getVertex(id);
-
-            if (v != nullptr) {
-                if (v->TYPE == Vertex::eSTATE) {
-                    BaseState* s = static_cast<BaseState*>(v);
-                    s->init(ctx);
-                }
-            }
+        DeferQueue* q = this->deferQueue_;
+        const unsigned int i = (q == nullptr) ? DEFER_INDEX_NONE : q->free_;
+        if (i == DEFER_INDEX_NONE) {
+            this->deferOverflows_++;
+            return eEVENT_IGNORED;
         }
+        q->free_ = q->deferred_[i].next;
 
-        // Perform entry on initial state
-        BaseState* s = &this->initState;
-        this->enterState_(s, ctx);
-
-        // Walk down until the leaf initial state
-        s = enterInitialStates_(s, ctx);
-
-        this->curState = s;
+        // Append to list of event bit, deferred events have a bit of their own
+        const unsigned int b = event;
+        q->deferred_[i].event = event;
+        q->deferred_[i].order = q->order_++;
+        q->deferred_[i].next = DEFER_INDEX_NONE;
+        if (q->tail_[b] == DEFER_INDEX_NONE) {
+            q->head_[b] = i;
+        }
+        else {
+            q->deferred_[q->tail_[b]].next = i;
+        }
+        q->tail_[b] = i;
 
-        // Handle any initial anonymous transitions
-        this->dispatch(EVENT_ANONYMOUS, ctx);
+        q->pending_ |= eventBit(event);
+        q->count_++;
+        return eEVENT_DEFERRED;
     }
 
-    eStatus BaseHSM::dispatch(unsigned int event, void* ctx)
+    void BaseHSM::recallDeferredEvents_(void* ctx)
     {
-        sTransition t;
-        eStatus status = eTRANSITION_ERROR;
-
-        // Match event to state
-        bool match = this->matchStateOrAncestor_(event, &t, ctx);
-        if (!match) {
-#if MICROHSM_TRACING == 1
-            MICROHSM_TRACE_DISPATCH_IGNORED(event);
-#endif
-            return eEVENT_IGNORED;
-        }
-
-#if MICROHSM_TRACING == 1
-            MICROHSM_TRACE_DISPATCH_MATCHED(event, t.sourceID);
-#endif
+        DeferQueue* q = this->deferQueue_;
 
-        // Perform transition
-        status = this->performTransition_(&t, ctx);
-        if (status != eOK) return status;
+        // Only events that are no longer deferred are recalled, the others are not touched
+        tEventMask ready = q->pending_ & ~this->definition_.chainDefer_[this->cur_];
+        while (ready != 0) {
+            // Find oldest deferred event among ready event bits
+            unsigned int oldest = DEFER_INDEX_NONE;
+            unsigned int bit = 0;
+            unsigned int b = 0;
+            for (tEventMask m = ready; m != 0; m >>= 1, b++) {
+                if ((m & 1u) == 0) continue;
+                const unsigned int i = q->head_[b];
+                if (oldest == DEFER_INDEX_NONE ||
+                        static_cast<long>(q->deferred_[i].order - q->deferred_[oldest].order) < 0) {
+                    oldest = i;
+                    bit = b;
+                }
+            }
 
-        // Handle anonymous transitions repeatedly (Run-to-completion)
-        match = this->matchStateOrAncestor_(0, &t, ctx);
-        while (match) {
-#if MICROHSM_TRACING == 1
-            MICROHSM_TRACE_DISPATCH_MATCHED(0, t.sourceID);
-#endif
-            status = this->performTransition_(&t, ctx);
-            if (status != eOK) return status;
+            // Remove from its list and release entry
+            const unsigned int event = q->deferred_[oldest].event;
+            q->head_[bit] = q->deferred_[oldest].next;
+            if (q->head_[bit] == DEFER_INDEX_NONE) {
+                q->tail_[bit] = DEFER_INDEX_NONE;
+                q->pending_ &= ~(static_cast<tEventMask>(1) << bit);
+            }
+            q->deferred_[oldest].next = q->free_;
+            q->free_ = oldest;
+            q->count_--;
 
-            match = this->matchStateOrAncestor_(0, &t, ctx);
+            // Recalled events are dispatched as if they just occurred
+            this->dispatchEvent_(event, ctx);
+            if (this->cur_ == STATE_INDEX_NONE) return;
+            ready = q->pending_ & ~this->definition_.chainDefer_[this->cur_];
         }
+    }
+#endif
 
-        return status;
+    unsigned long BaseHSM::getSkippedAnonymousSweeps()
+    {
+        return this->skippedAnonymousSweeps_;
     }
 
-    BaseState* BaseHSM::getCurrentState()
+    tEventMask BaseHSM::getHandledEvents()
     {
-        return this->curState;
+        tEventMask mask = 0;
+        for (tStateIndex i = 0; i < this->definition_.stateCount_; i++) {
+            mask |= this->state_(i)->handledEvents() | this->state_(i)->deferredEvents();
+        }
+        return mask;
     }
 
-    bool BaseHSM::inState(unsigned int ID)
+    eStatus BaseHSM::takeTransition_(unsigned int event, sTransition* t, void* ctx, tStateIndex last)
     {
-        const BaseState* s = this->curState;
-        while (s != nullptr) {
-            if (s->ID == ID) return true;
-            s = s->parent;
+        tStateIndex s = this->cur_;
+        while ((s = this->matchStateOrAncestor_(event, t, ctx, s, last)) != STATE_INDEX_NONE) {
+#if MICROHSM_TRACING == 1
+            if (this->behavior_) {
+                MICROHSM_TRACE_DISPATCH_MATCHED(event, t->sourceID);
+            }
+#endif
+            const eStatus status = this->performTransition_(t, s, ctx);
+            if (status != eEVENT_IGNORED) return status;
+
+            // No branch of a junction is enabled, ancestors take over
+            if (s == last) break;
+            s = this->definition_.parent_[s];
         }
-        return false;
+        return eEVENT_IGNORED;
     }
 
-    bool BaseHSM::matchStateOrAncestor_(unsigned int event, sTransition* t, void* ctx)
+    tStateIndex BaseHSM::matchStateOrAncestor_(unsigned int event, sTransition* t, void* ctx,
+            tStateIndex first, tStateIndex last)
     {
-        BaseState* s = this->curState;
-        bool match = false;
-        while (!match && s != nullptr) {
-            match = s->match(event, t, ctx);
-            s = s->parent;
+        tStateIndex s = first;
+#if MICROHSM_EVENT_MASKS == 1
+        // Reject events not handled by any state of the active configuration
+        const tEventMask bit = eventBit(event);
+        if (s == STATE_INDEX_NONE || (this->definition_.chainMask_[s] & bit) == 0) return STATE_INDEX_NONE;
+#endif
+        while (s != STATE_INDEX_NONE) {
+#if MICROHSM_EVENT_MASKS == 1
+            // Skip states that do not handle event
+            if ((this->definition_.mask_[s] & bit) != 0 && this->state_(s)->match(event, t, ctx)) break;
+#else
+            if (this->state_(s)->match(event, t, ctx)) break;
+#endif
+            if (s == last) return STATE_INDEX_NONE;
+            s = this->definition_.parent_[s];
         }
 
-        return match;
+        return s;
     }
 
-    eStatus BaseHSM::performTransition_(const sTransition* t, void* ctx)
+    eStatus BaseHSM::performTransition_(const sTransition* t, tStateIndex source, void* ctx)
     {
         /*
          * Steps:
-         *      0. Determine source and target.
-         *      1. Internal Transition?
+         *      0. Internal Transition?
          *          Yes:    Perform internal transitions and return
          *          No:     Continue to body of function
+         *      1. Determine target, selecting the branches of junctions
          *      2. Bubble up to source state
          *      3. Find LCA
          *      4. Bubble up to LCA
          *      5. Handle exit source (kind = external)
-         *      6. Perform transition effect
+         *      6. Perform transition effect(s)
          *      7. Handle re-entry source (kind = external)
          *      8. Enter until reaching target state
          *      9. Enter initial pseudo state(s)
          *      10. Update `curState`
          */
 
-        BaseState* s = nullptr;
+        // 0. Handle internal transition
+        if (t->kind == eKIND_INTERNAL) return this->performTransitionInternal_(t, ctx);
 
-        // 0. Determine source and target
-        Vertex* sourceV = this->getVertex(t->sourceID);
+        // 1. Determine target (source is the state that matched the event)
+        // Guards of junctions are evaluated before any state is exited
+        sTransition branches[MICROHSM_MAX_BRANCHES];
+        unsigned int count = 0;
+        Vertex* v = this->lookupVertex_(t->targetID);
+        while (v != nullptr && v->TYPE == Vertex::ePSEUDO_JUNCTION) {
+            if (count == MICROHSM_MAX_BRANCHES) {
 #if MICROHSM_ASSERTIONS == 1
-        MICROHSM_ASSERT(sourceV != nullptr);
-        MICROHSM_ASSERT(sourceV->TYPE == Vertex::eSTATE);
+                MICROHSM_ASSERT(false);     // Increase `MICROHSM_MAX_BRANCHES`
+#endif
+                return eTRANSITION_ERROR;
+            }
+            branches[count].eventEffect = nullptr;
+            if (!static_cast<BaseBranch*>(v)->select(&branches[count], ctx)) return eEVENT_IGNORED;
+            v = this->lookupVertex_(branches[count++].targetID);
+        }
+        if (v != nullptr && v->TYPE == Vertex::ePSEUDO_CHOICE) {
+            return this->performChoice_(t, branches, count, source, static_cast<Choice*>(v), ctx);
+        }
+
+        // Unknown targets are rejected before any state is exited
+        const tStateIndex target = this->getTransitionTarget_(v);
+        if (target == STATE_INDEX_NONE) return eTRANSITION_ERROR;
+
+#if MICROHSM_TRANSITION_CACHE_SIZE > 0
+        // Replay path if transition has been resolved before, otherwise record it
+        if (this->cacheEnabled_) {
+            sTransitionPath* path = &this->cache_[cacheIndex_(this->cur_, source, target, t->kind)];
+            if (path->leaf == this->cur_ && path->source == source &&
+                    path->target == target && path->kind == t->kind) {
+                this->cacheHits_++;
+                return this->replayTransitionPath_(path, t, branches, count, ctx);
+            }
+            this->cacheMisses_++;
+            path->leaf = this->cur_;
+            path->source = source;
+            path->target = target;
+            path->kind = t->kind;
+            path->exitCount = 0;
+            path->entryCount = 0;
+            this->record_ = path;
+        }
 #endif
-        BaseState* source = static_cast<BaseState*>(sourceV);
-        BaseState* target = getTransitionTarget_(t->targetID);
 
-        // 1. Handle internal transition
-        if (t->kind == eKIND_INTERNAL) return performTransitionInternal_(t, ctx);
+        // 2. - 8. Exit towards LCA, perform effects and enter target
+        this->traverse_(t->kind, source, target, t, branches, count, ctx);
+
+        // 9. Enter initial pseudo state(s)
+        tStateIndex s = enterInitialStates_(target, ctx);
+
+        // 10. Update state
+        this->setNewActiveState_(s);
+#if MICROHSM_TRANSITION_CACHE_SIZE > 0
+        this->record_ = nullptr;
+#endif
+        return eOK;
+    }
 
+    void BaseHSM::traverse_(eTransitionKind kind, tStateIndex source, tStateIndex target,
+            const sTransition* t, const sTransition* branches, unsigned int count, void* ctx)
+    {
         // 2. Bubble up to source state and exit along the way
-        source = exitUntilTarget_(this->curState, source, ctx);
+        const tStateIndex reached = exitUntilTarget_(this->cur_, source, ctx);
 #if MICROHSM_ASSERTIONS == 1
-        MICROHSM_ASSERT((source != nullptr)); // source state could not be reached
+        MICROHSM_ASSERT((reached == source)); // source state could not be reached
+#else
+        (void)reached;
 #endif
-        // 3. Find LCA
-        BaseState* lca = this->findLCA_(source, target);
+        // 3. Find LCA (no LCA exists for top-level choices)
+        tStateIndex lca = (source == STATE_INDEX_NONE || target == STATE_INDEX_NONE) ?
+            static_cast<tStateIndex>(STATE_INDEX_NONE) : this->findLCA_(source, target);
 
         // 4. Bubble up to LCA
         exitUntilTarget_(source, lca, ctx);
 
         // 5. Handle exit of source (local v.s. external)
-        if(t->kind == eKIND_EXTERNAL && lca == source) exitState_(lca, ctx);
+        if(kind == eKIND_EXTERNAL && lca == source) exitState_(lca, ctx);
 
-        // 6. Perform transition effect
-        performEffect_(t, ctx);
+        // 6. Perform transition effect, followed by the effects of the selected branches
+        this->performEffect_(t, ctx);
+        for (unsigned int i = 0; i < count; i++) {
+            this->performEffect_(&branches[i], ctx);
+        }
 
         // 7. Handle re-entry of source (local v.s. external)
-        if(t->kind == eKIND_EXTERNAL && lca == source) enterState_(lca, ctx);
+        if(kind == eKIND_EXTERNAL && lca == source) enterState_(lca, ctx);
 
         // 8. Enter until reaching target state
-        s = enterUntilTarget_(lca, target, ctx);
-#if MICROHSM_ASSERTIONS == 1
-        MICROHSM_ASSERT(s != nullptr);  // target could not be reached
-#endif
+        enterUntilTarget_(lca, target, ctx);
+    }
 
-        // 9. Enter initial pseudo state(s)
-        s = enterInitialStates_(s, ctx);
+    eStatus BaseHSM::performChoice_(const sTransition* t, const sTransition* branches, unsigned int count,
+            tStateIndex source, Choice* choice, void* ctx)
+    {
+        // Take the transition up to the parent of the choice, such that guards see its effects
+        tStateIndex position = (choice->parent == nullptr) ? static_cast<tStateIndex>(STATE_INDEX_NONE) : choice->parent->index_;
+        this->traverse_(t->kind, source, position, t, branches, count, ctx);
 
-        // 10. Update state
-        this->setNewActiveState_(s);
+        sTransition segments[MICROHSM_MAX_BRANCHES];
+        while (true) {
+            // Select branch of choice, followed by branches of chained junctions
+            Vertex* v = choice;
+            count = 0;
+            do {
+                segments[count].eventEffect = nullptr;
+                if (count == MICROHSM_MAX_BRANCHES || !static_cast<BaseBranch*>(v)->select(&segments[count], ctx)) {
+                    v = nullptr;
+                    break;
+                }
+                v = this->lookupVertex_(segments[count++].targetID);
+            } while (v != nullptr && v->TYPE == Vertex::ePSEUDO_JUNCTION);
+
+            const tStateIndex target = (v == nullptr || v->TYPE == Vertex::ePSEUDO_CHOICE) ?
+                static_cast<tStateIndex>(STATE_INDEX_NONE) : this->getTransitionTarget_(v);
+            if (v == nullptr || (v->TYPE != Vertex::ePSEUDO_CHOICE && target == STATE_INDEX_NONE)) {
+                // Ill-formed choice, default entry of the state containing it
+                return this->abortChoice_(position, ctx);
+            }
+
+            if (v->TYPE != Vertex::ePSEUDO_CHOICE) {
+                // Branches continue from the parent of the choice without exiting it
+                this->traverse_(eKIND_LOCAL, position, target, &segments[0], &segments[1], count - 1, ctx);
+                this->setNewActiveState_(enterInitialStates_(target, ctx));
+                return eOK;
+            }
+
+            // Move on to the parent of the next choice
+            choice = static_cast<Choice*>(v);
+            const tStateIndex next = (choice->parent == nullptr) ? static_cast<tStateIndex>(STATE_INDEX_NONE) : choice->parent->index_;
+            this->traverse_(eKIND_LOCAL, position, next, &segments[0], &segments[1], count - 1, ctx);
+            position = next;
+        }
+    }
+
+    eStatus BaseHSM::abortChoice_(tStateIndex position, void* ctx)
+    {
+        // Top-level choices fall back to the initial configuration of the HSM
+        tStateIndex s = position;
+        if (s == STATE_INDEX_NONE) {
+            s = this->initState.index_;
+            this->enterState_(s, ctx);
+        }
+        this->setNewActiveState_(this->enterInitialStates_(s, ctx));
+        return eTRANSITION_ERROR;
+    }
+
+#if MICROHSM_TRANSITION_CACHE_SIZE > 0
+    eStatus BaseHSM::replayTransitionPath_(const sTransitionPath* path, const sTransition* t,
+            const sTransition* branches, unsigned int count, void* ctx)
+    {
+        for (unsigned int i = 0; i < path->exitCount; i++) {
+            exitState_(path->exits[i], ctx);
+        }
+
+        this->performEffect_(t, ctx);
+        for (unsigned int i = 0; i < count; i++) {
+            this->performEffect_(&branches[i], ctx);
+        }
+
+        for (unsigned int i = 0; i < path->entryCount; i++) {
+            enterState_(path->entries[i], ctx);
+        }
+
+        // Entering the last state of the path has set `cur_` to the new leaf state
+        this->setNewActiveState_(this->cur_);
         return eOK;
     }
 
-    void BaseHSM::setNewActiveState_(BaseState* s)
+    void BaseHSM::abortRecording_()
+    {
+        // Mark entry as unused, such that it will never be matched
+        this->record_->leaf = STATE_INDEX_NONE;
+        this->record_ = nullptr;
+    }
+
+    void BaseHSM::enableTransitionCache(bool enable)
+    {
+        this->cacheEnabled_ = enable;
+        this->clearTransitionCache();
+    }
+
+    void BaseHSM::clearTransitionCache()
+    {
+        for (unsigned int i = 0; i < MICROHSM_TRANSITION_CACHE_SIZE; i++) {
+            this->cache_[i].leaf = STATE_INDEX_NONE;
+        }
+        this->record_ = nullptr;
+        this->cacheHits_ = 0;
+        this->cacheMisses_ = 0;
+    }
+
+    unsigned long BaseHSM::getTransitionCacheHits()
+    {
+        return this->cacheHits_;
+    }
+
+    unsigned long BaseHSM::getTransitionCacheMisses()
+    {
+        return this->cacheMisses_;
+    }
+#endif
+
+    void BaseHSM::setCurrentState_(tStateIndex s)
+    {
+        this->cur_ = s;
+        this->curState = (s == STATE_INDEX_NONE) ? nullptr : this->state_(s);
+    }
+
+    void BaseHSM::setNewActiveState_(tStateIndex s)
     {
-        this->curState = s;
+        this->setCurrentState_(s);
         updateHistories_(s);
     }
 
-    BaseState* BaseHSM::getTransitionTarget_(unsigned int targetID)
+    void BaseHSM::updateHistories_(tStateIndex newState)
     {
-        Vertex* targetV = this->getVertex(targetID);
-        switch (targetV->TYPE) {
-            case Vertex::eSTATE:
-                return static_cast<BaseState*>(targetV);
-            case Vertex::ePSEUDO_HISTORY: {
-                BaseHistory* h = static_cast<BaseHistory*>(targetV);
-                return h->getHistoryState();
+#if MICROHSM_ASSERTIONS == 1
+        // `newState` must be 'leaf' state
+        MICROHSM_ASSERT((this->definition_.flags_[newState] & eFLAG_COMPOSITE) == 0);
+#endif
+        // Set histories
+        tStateIndex s = newState;
+        tStateIndex p = this->definition_.parent_[s];
+        while (p != STATE_INDEX_NONE) {
+            uint8_t flags = this->definition_.flags_[p];
+            // Update deep history
+            if (flags & eFLAG_DEEP_HISTORY) {
+                this->state_(p)->deepHistory_->setHistoryState(this->state_(newState));
             }
-            default: {
-                return nullptr;
+            // Update shallow history
+            if (flags & eFLAG_SHALLOW_HISTORY) {
+                this->state_(p)->shallowHistory_->setHistoryState(this->state_(s));
             }
+            s = p;
+            p = this->definition_.parent_[p];
         }
     }
 
-    BaseState* BaseHSM::exitUntilTarget_(BaseState* startState, const BaseState* target, void* ctx)
+    void BaseHSM::buildLCATables_()
     {
-        BaseState* s = startState;
-        while (s != nullptr) {
-            if (s == target) break;
-            exitState_(s, ctx);
-            s = s->parent;
+        this->definition_.lcaStrategy_ = eLCA_WALK;
+#if MICROHSM_LCA_ACCELERATION == 1
+        const tStateIndex count = this->definition_.stateCount_;
+
+        // Binary lifting, level `k` is `2^k` ancestors up
+        uint8_t maxDepth = 0;
+        for (tStateIndex i = 0; i < count; i++) {
+            this->definition_.lcaUp_[0][i] = this->definition_.parent_[i];
+            if (this->definition_.depth_[i] > maxDepth) maxDepth = this->definition_.depth_[i];
         }
-        return s;
+        for (unsigned int k = 1; k < HSMDefinition::LCA_LEVELS; k++) {
+            for (tStateIndex i = 0; i < count; i++) {
+                tStateIndex half = this->definition_.lcaUp_[k - 1][i];
+                this->definition_.lcaUp_[k][i] = (half == STATE_INDEX_NONE) ? half : this->definition_.lcaUp_[k - 1][half];
+            }
+        }
+        // Walking shallow hierarchies is faster than lifting
+        if (maxDepth >= LCA_LIFTING_MIN_DEPTH) this->definition_.lcaStrategy_ = eLCA_LIFTING;
+
+        // Matrix of all pairs for small machines
+        if (count <= MICROHSM_LCA_MATRIX_SIZE) {
+            for (tStateIndex a = 0; a < count; a++) {
+                for (tStateIndex b = 0; b < count; b++) {
+                    this->definition_.lcaMatrix_[(a * count) + b] = this->walkLCA_(a, b);
+                }
+            }
+            this->definition_.lcaStrategy_ = eLCA_MATRIX;
+        }
+#endif
+    }
+
+    BaseState* BaseHSM::getCommonAncestor(unsigned int ID1, unsigned int ID2)
+    {
+        tStateIndex a = this->findStateIndex_(ID1);
+        tStateIndex b = this->findStateIndex_(ID2);
+        tStateIndex lca = this->findLCA_(a, b);
+        return (lca == STATE_INDEX_NONE) ? nullptr : this->state_(lca);
+    }
+
+    eLCAStrategy BaseHSM::getLCAStrategy()
+    {
+        return this->lcaStrategy_;
     }
 
-    BaseState* BaseHSM::enterUntilTarget_(const BaseState* start, BaseState* target, void* ctx)
+    bool BaseHSM::setLCAStrategy(eLCAStrategy strategy)
     {
-        // Edge case where we are already in the target
-        if (start == target) return target;
+        switch (strategy) {
+            case eLCA_WALK:
+                break;
+#if MICROHSM_LCA_ACCELERATION == 1
+            case eLCA_MATRIX:
+                if (this->definition_.stateCount_ > MICROHSM_LCA_MATRIX_SIZE) return false;
+                break;
+            case eLCA_LIFTING:
+                break;
+#endif
+            default:
+                return false;
+        }
+        this->lcaStrategy_ = strategy;
+        return true;
+    }
 
-        BaseState* s = target;
+    unsigned int BaseHSM::getSnapshotSize()
+    {
+        // Version, index width, number of states, active leaf and history states
+        unsigned int size = 2u + ((2u + this->definition_.historyCount_) * static_cast<unsigned int>(sizeof(tStateIndex)));
 
-        // Create path from start to target
-        while (s->parent != start) {
-            s->parent->tmp_ = s;
-            s = s->parent;
+        // Followed by the regions of orthogonal states
+        for (tStateIndex i = 0; i < this->definition_.stateCount_; i++) {
+            if (!(this->definition_.flags_[i] & eFLAG_ORTHOGONAL)) continue;
+            BaseOrthogonalState* orthogonal = static_cast<BaseOrthogonalState*>(this->state_(i));
+            for (unsigned int r = 0; r < orthogonal->count_; r++) {
+                size += orthogonal->regions_[r]->getSnapshotSize();
+            }
         }
+        return size;
+    }
 
-        // Walk path and perform entries
-        while(s != target) {
-            enterState_(s, ctx);
-            s = s->tmp_;
+    unsigned int BaseHSM::snapshot(uint8_t* buffer, unsigned int size)
+    {
+        const unsigned int length = this->getSnapshotSize();
+        if (size < length) return 0;
+
+        uint8_t* p = buffer;
+        *p++ = SNAPSHOT_VERSION;
+        *p++ = static_cast<uint8_t>(sizeof(tStateIndex));
+        p = writeIndex_(p, this->definition_.stateCount_);
+        p = writeIndex_(p, this->cur_);
+        for (tStateIndex i = 0; i < this->definition_.stateCount_; i++) {
+            const BaseState* s = this->state_(i);
+            if (this->definition_.flags_[i] & eFLAG_SHALLOW_HISTORY) {
+                const BaseState* h = s->shallowHistory_->getHistoryState();
+                p = writeIndex_(p, (h == nullptr) ? static_cast<tStateIndex>(STATE_INDEX_NONE) : h->index_);
+            }
+            if (this->definition_.flags_[i] & eFLAG_DEEP_HISTORY) {
+                const BaseState* h = s->deepHistory_->getHistoryState();
+                p = writeIndex_(p, (h == nullptr) ? static_cast<tStateIndex>(STATE_INDEX_NONE) : h->index_);
+            }
+        }
+        for (tStateIndex i = 0; i < this->definition_.stateCount_; i++) {
+            if (!(this->definition_.flags_[i] & eFLAG_ORTHOGONAL)) continue;
+            BaseOrthogonalState* orthogonal = static_cast<BaseOrthogonalState*>(this->state_(i));
+            for (unsigned int r = 0; r < orthogonal->count_; r++) {
+                p += orthogonal->regions_[r]->snapshot(p, length - static_cast<unsigned int>(p - buffer));
+            }
+        }
+        return length;
+    }
+
+    bool BaseHSM::restore(const uint8_t* buffer, unsigned int size)
+    {
+        // Verify complete snapshot, including regions, before changing anything
+        if (this->readSnapshot_(buffer, buffer + size, eSNAPSHOT_VERIFY) == nullptr) return false;
+        this->readSnapshot_(buffer, buffer + size, eSNAPSHOT_APPLY);
+        return true;
+    }
+
+    const uint8_t* BaseHSM::readSnapshot_(const uint8_t* p, const uint8_t* end, eSnapshotRead mode)
+    {
+        const unsigned int length = 2u + ((2u + this->definition_.historyCount_) * static_cast<unsigned int>(sizeof(tStateIndex)));
+        if (static_cast<unsigned long>(end - p) < length) return nullptr;
+        if (p[0] != SNAPSHOT_VERSION || p[1] != sizeof(tStateIndex)) return nullptr;
+        p += 2;
+        if (readIndex_(p) != this->definition_.stateCount_) return nullptr;
+
+        const tStateIndex leaf = readIndex_(p);
+        if (mode == eSNAPSHOT_VERIFY && leaf != STATE_INDEX_NONE &&
+                (leaf >= this->definition_.stateCount_ || (this->definition_.flags_[leaf] & eFLAG_COMPOSITE))) return nullptr;
+        if (mode == eSNAPSHOT_COMPARE && leaf != this->cur_) return nullptr;
+
+        for (tStateIndex i = 0; i < this->definition_.stateCount_; i++) {
+            BaseHistory* const histories[2] = {
+                (this->definition_.flags_[i] & eFLAG_SHALLOW_HISTORY) ? this->state_(i)->shallowHistory_ : nullptr,
+                (this->definition_.flags_[i] & eFLAG_DEEP_HISTORY) ? this->state_(i)->deepHistory_ : nullptr
+            };
+            for (unsigned int n = 0; n < 2u; n++) {
+                if (histories[n] == nullptr) continue;
+                const tStateIndex h = readIndex_(p);
+                const BaseState* stored = histories[n]->getHistoryState();
+                switch (mode) {
+                    case eSNAPSHOT_VERIFY:
+                        // Histories store descendants of their state
+                        if (h != STATE_INDEX_NONE && (h >= this->definition_.stateCount_ || h == i || !this->isAncestorOrSelf_(i, h))) {
+                            return nullptr;
+                        }
+                        break;
+                    case eSNAPSHOT_COMPARE:
+                        if (h != ((stored == nullptr) ? static_cast<tStateIndex>(STATE_INDEX_NONE) : stored->index_)) {
+                            return nullptr;
+                        }
+                        break;
+                    case eSNAPSHOT_APPLY:
+                        // Assign histories without performing behavior
+                        histories[n]->setHistoryState((h == STATE_INDEX_NONE) ? nullptr : this->state_(h));
+                        break;
+                }
+            }
+        }
+
+        // Regions of orthogonal states follow the owner
+        for (tStateIndex i = 0; i < this->definition_.stateCount_; i++) {
+            if (!(this->definition_.flags_[i] & eFLAG_ORTHOGONAL)) continue;
+            BaseOrthogonalState* orthogonal = static_cast<BaseOrthogonalState*>(this->state_(i));
+            for (unsigned int r = 0; r < orthogonal->count_; r++) {
+                p = orthogonal->regions_[r]->readSnapshot_(p, end, mode);
+                if (p == nullptr) return nullptr;
+            }
+        }
+        if (mode != eSNAPSHOT_APPLY) return p;
+
+        this->setCurrentState_(leaf);
+
+        // Deferred events and scoped timers belong to the replaced configuration
+#if MICROHSM_DEFER_QUEUE_SIZE > 0
+        if (this->getDeferredCount() > 0) this->clearDeferredEvents();
+#endif
+        if (this->scopedTimers_ != TIMER_INDEX_NONE) this->timerService_->disarmScoped_(*this, TIMER_STATE_NONE);
+
+        // Orthogonal leaf routes events according to its restored regions
+        if (leaf != STATE_INDEX_NONE && (this->definition_.flags_[leaf] & eFLAG_ORTHOGONAL)) {
+            static_cast<BaseOrthogonalState*>(this->state_(leaf))->refreshRoutes_();
+        }
+        return p;
+    }
+
+    void BaseHSM::attachJournal(BaseEventJournal* journal, uint32_t instance)
+    {
+        this->journal_ = journal;
+        this->journalInstance_ = instance;
+    }
+
+    void BaseHSM::enableBehavior(bool enabled)
+    {
+        this->behavior_ = enabled;
+
+        // Regions follow their owner
+        for (tStateIndex i = 0; i < this->definition_.stateCount_; i++) {
+            if (this->definition_.flags_[i] & eFLAG_ORTHOGONAL) {
+                static_cast<BaseOrthogonalState*>(this->state_(i))->enableBehavior_(enabled);
+            }
+        }
+    }
+
+    tStateIndex BaseHSM::walkLCA_(tStateIndex a, tStateIndex b)
+    {
+        tStateIndex s1 = a;
+        tStateIndex s2 = b;
+
+        while(s1 != s2) {
+            // Move up from deepest state
+            if (s1 == STATE_INDEX_NONE || s2 == STATE_INDEX_NONE) return STATE_INDEX_NONE;
+
+            if (this->definition_.depth_[s1] > this->definition_.depth_[s2]) {
+                s1 = this->definition_.parent_[s1];
+            }
+            else if (this->definition_.depth_[s2] > this->definition_.depth_[s1]) {
+                s2 = this->definition_.parent_[s2];
+            }
+            else {
+                s1 = this->definition_.parent_[s1];
+                s2 = this->definition_.parent_[s2];
+            }
+        }
+
+        // s1 contains lowest common ancestor or `STATE_INDEX_NONE`
+        return s1;
+    }
+
+    tStateIndex BaseHSM::findLCA_(tStateIndex a, tStateIndex b)
+    {
+        if (a == STATE_INDEX_NONE || b == STATE_INDEX_NONE) return STATE_INDEX_NONE;
+
+        switch (this->lcaStrategy_) {
+#if MICROHSM_LCA_ACCELERATION == 1
+            case eLCA_MATRIX:
+                return this->definition_.lcaMatrix_[(a * this->definition_.stateCount_) + b];
+            case eLCA_LIFTING: {
+                if (this->isAncestorOrSelf_(a, b)) return a;
+                if (this->isAncestorOrSelf_(b, a)) return b;
+                // Move `a` up to the highest ancestor that is not an ancestor of `b`
+                tStateIndex s = a;
+                for (unsigned int k = HSMDefinition::LCA_LEVELS; k > 0; k--) {
+                    tStateIndex up = this->definition_.lcaUp_[k - 1][s];
+                    if (up != STATE_INDEX_NONE && !this->isAncestorOrSelf_(up, b)) s = up;
+                }
+                return this->definition_.parent_[s];
+            }
+#endif
+            default:
+                return this->walkLCA_(a, b);
+        }
+    }
+
+    tStateIndex BaseHSM::getTransitionTarget_(Vertex* targetV)
+    {
+        const BaseState* s = nullptr;
+        if (targetV == nullptr) return STATE_INDEX_NONE;
+        switch (targetV->TYPE) {
+            case Vertex::eSTATE:
+                s = static_cast<BaseState*>(targetV);
+                break;
+            case Vertex::ePSEUDO_HISTORY:
+                s = static_cast<BaseHistory*>(targetV)->getHistoryState();
+                break;
+            default:
+                break;
         }
-        enterState_(s, ctx);
+        // Target must be a state of this HSM
+        return (s == nullptr || s->hsm_ != this) ? static_cast<tStateIndex>(STATE_INDEX_NONE) : s->index_;
+    }
 
+    tStateIndex BaseHSM::exitUntilTarget_(tStateIndex startState, tStateIndex target, void* ctx)
+    {
+        tStateIndex s = startState;
+        while (s != STATE_INDEX_NONE) {
+            if (s == target) break;
+            exitState_(s, ctx);
+            s = this->definition_.parent_[s];
+        }
         return s;
     }
 
-    void BaseHSM::enterState_(BaseState* s, void* ctx)
+    void BaseHSM::enterUntilTarget_(tStateIndex start, tStateIndex target, void* ctx)
+    {
+        // Create path from target to start, depth is verified during initialization
+        tStateIndex path[MICROHSM_MAX_DEPTH];
+        unsigned int length = 0;
+        tStateIndex s = target;
+        while (s != start) {
+            path[length++] = s;
+            s = this->definition_.parent_[s];
+        }
+
+        // Walk path in reverse and perform entries
+        while (length > 0) {
+            enterState_(path[--length], ctx);
+        }
+    }
+
+    void BaseHSM::enterState_(tStateIndex s, void* ctx)
     {
         // Assign current state to newly entered state
-        this->curState = s;
+        this->setCurrentState_(s);
 #if MICROHSM_TRACING == 1
-        MICROHSM_TRACE_ENTRY(s->ID);
+        if (this->behavior_) {
+            MICROHSM_TRACE_ENTRY(this->definition_.ids_[s]);
+        }
 #endif
         // Perform entry effect
-        s->entry(ctx);
+        if (this->behavior_) this->state_(s)->entry(ctx);
+        // Regions are entered after the state containing them
+        if (this->definition_.flags_[s] & eFLAG_ORTHOGONAL) static_cast<BaseOrthogonalState*>(this->state_(s))->enterRegions_(ctx);
+#if MICROHSM_TRANSITION_CACHE_SIZE > 0
+        if (this->record_ != nullptr) {
+            if (this->record_->entryCount < MICROHSM_MAX_DEPTH) {
+                this->record_->entries[this->record_->entryCount++] = s;
+            }
+            else {
+                this->abortRecording_();
+            }
+        }
+#endif
     }
 
-    void BaseHSM::exitState_(BaseState* s, void* ctx)
+    void BaseHSM::exitState_(tStateIndex s, void* ctx)
     {
 #if MICROHSM_TRACING == 1
-        MICROHSM_TRACE_EXIT(s->ID);
+        if (this->behavior_) {
+            MICROHSM_TRACE_EXIT(this->definition_.ids_[s]);
+        }
 #endif
+        // Regions are exited before the state containing them
+        if (this->definition_.flags_[s] & eFLAG_ORTHOGONAL) static_cast<BaseOrthogonalState*>(this->state_(s))->exitRegions_(ctx);
         // Perform exit effect
-        s->exit(ctx);
+        if (this->behavior_) this->state_(s)->exit(ctx);
+        // Disarm timers armed by the state
+        if (this->scopedTimers_ != TIMER_INDEX_NONE) this->timerService_->disarmScoped_(*this, s);
+#if MICROHSM_TRANSITION_CACHE_SIZE > 0
+        if (this->record_ != nullptr) {
+            if (this->record_->exitCount < MICROHSM_MAX_DEPTH) {
+                this->record_->exits[this->record_->exitCount++] = s;
+            }
+            else {
+                this->abortRecording_();
+            }
+        }
+#endif
         // Assign current state to parent of state we just left
-        this->curState = s->parent;
+        this->setCurrentState_(this->definition_.parent_[s]);
     }
 
-    BaseState* BaseHSM::enterInitialStates_(BaseState* state, void* ctx)
+    tStateIndex BaseHSM::enterInitialStates_(tStateIndex state, void* ctx)
     {
-        BaseState* s = state;
-        while (s->initial != nullptr) {
+        tStateIndex s = state;
+        while (this->definition_.initial_[s] != STATE_INDEX_NONE) {
             // Traverse initial states until reaching a 'leaf' state
-            s = s->initial;
+            s = this->definition_.initial_[s];
             enterState_(s, ctx);
         }
         return s;
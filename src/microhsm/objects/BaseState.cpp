@@ -93,6 +93,12 @@ namespace microhsm
 
     bool BaseState::isDescendentOf(unsigned int id)
     {
+        if (this->hsm_ != nullptr) {
+            // Use numbering of initialized HSM
+            tStateIndex a = this->hsm_->findStateIndex_(id);
+            return a != STATE_INDEX_NONE && this->hsm_->isAncestorOrSelf_(a, this->index_);
+        }
+
         bool descendent = false;
         BaseState* s = this;
         while (!descendent && s != nullptr) {
@@ -104,6 +110,13 @@ namespace microhsm
 
     BaseState* BaseState::getAncestor(unsigned int id)
     {
+        if (this->hsm_ != nullptr) {
+            // Use numbering of initialized HSM
+            tStateIndex a = this->hsm_->findStateIndex_(id);
+            if (a == STATE_INDEX_NONE || a == this->index_) return nullptr;
+            return this->hsm_->isAncestorOrSelf_(a, this->index_) ? this->hsm_->state_(a) : nullptr;
+        }
+
         BaseState* s = this->parent;
         while (s != nullptr) {
             if (s->ID == id) break;
@@ -115,10 +128,14 @@ namespace microhsm
 
     bool BaseState::transitionExternal(unsigned int target_ID, sTransition *t, fTransitionEffect effect)
     {
+#if MICROHSM_ASSERTIONS == 1
+        MICROHSM_ASSERT(target_ID <= VERTEX_ID_MAX);
+#endif
         t->sourceID = ID;
-        t->targetID = target_ID;
+        t->targetID = static_cast<tVertexID>(target_ID);
         t->kind = eKIND_EXTERNAL;
         t->effect = effect;
+        t->eventEffect = nullptr;
         return true;
     }
 
@@ -128,6 +145,7 @@ namespace microhsm
         t->targetID = ID;
         t->kind = eKIND_INTERNAL;
         t->effect = effect;
+        t->eventEffect = nullptr;
         return true;
     }
 
@@ -140,20 +158,39 @@ namespace microhsm
         // UML V2.5.1: Local transition source state must be composite
         bool isComposite = this->isComposite();
         MICROHSM_ASSERT(isComposite);
+        MICROHSM_ASSERT(target_ID <= VERTEX_ID_MAX);
 #endif
 
         t->sourceID = ID;
-        t->targetID = target_ID;
+        t->targetID = static_cast<tVertexID>(target_ID);
         t->kind = eKIND_LOCAL;
         t->effect = effect;
+        t->eventEffect = nullptr;
+        return true;
+    }
+
+    bool BaseState::eventEffect(sTransition* t, fEventEffect effect)
+    {
+        t->eventEffect = effect;
         return true;
     }
 
+    const Event* BaseState::currentEvent()
+    {
+        return (this->hsm_ == nullptr) ? nullptr : this->hsm_->event_;
+    }
+
+    tTimerHandle BaseState::startTimer(uint32_t delay, unsigned int event, uint32_t period)
+    {
+        if (this->hsm_ == nullptr || this->hsm_->timerService_ == nullptr) return TIMER_HANDLE_NONE;
+        return this->hsm_->timerService_->armScoped_(*this->hsm_, this->index_, event, delay, period);
+    }
+
     /* Static functions */
-    unsigned int BaseState::computeDepth_(BaseState* s)
+    tVertexID BaseState::computeDepth_(BaseState* s)
     {
         BaseState* ancestor = s;
-        unsigned int depth = 0;
+        tVertexID depth = 0;
         while (ancestor->parent != nullptr) {
             depth++;
             ancestor = ancestor->parent;
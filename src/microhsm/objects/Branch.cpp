@@ -0,0 +1,45 @@
+/**
+ * @file Branch.cpp
+ * @brief Choice and junction pseudostates
+ *
+ * @author Jelle Meijer
+ * @date 2025-05-23
+ */
+
+#include <microhsm/microhsm.hpp>
+
+namespace microhsm
+{
+    /* --- BaseBranch --- */
+    BaseBranch::BaseBranch(unsigned int id, eType type) : Vertex(id, type) {}
+
+    BaseBranch::~BaseBranch() {}
+
+    bool BaseBranch::branch(unsigned int target_ID, sTransition* t, fTransitionEffect effect)
+    {
+#if MICROHSM_ASSERTIONS == 1
+        MICROHSM_ASSERT(target_ID <= VERTEX_ID_MAX);
+#endif
+        t->sourceID = ID;
+        t->targetID = static_cast<tVertexID>(target_ID);
+        t->kind = eKIND_EXTERNAL;
+        t->effect = effect;
+        t->eventEffect = nullptr;
+        return true;
+    }
+
+    bool BaseBranch::noBranch()
+    {
+        return false;
+    }
+
+    /* --- Choice --- */
+    Choice::Choice(unsigned int id, BaseState* parentState) :
+        BaseBranch(id, ePSEUDO_CHOICE),
+        parent(parentState)
+    {
+    }
+
+    /* --- Junction --- */
+    Junction::Junction(unsigned int id) : BaseBranch(id, ePSEUDO_JUNCTION) {}
+}
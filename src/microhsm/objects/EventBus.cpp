@@ -0,0 +1,140 @@
+/**
+ * @file EventBus.cpp
+ * @brief Publish/subscribe delivery of events to many HSMs
+ *
+ * @author Jelle Meijer
+ * @date 2025-05-23
+ */
+
+#include <microhsm/microhsm.hpp>
+
+namespace microhsm
+{
+    /// Index of lowest set bit of `word` (must not be zero)
+    static inline unsigned int lowestBit_(uint32_t word)
+    {
+#if defined(__GNUC__)
+        return static_cast<unsigned int>(__builtin_ctz(word));
+#else
+        unsigned int i = 0;
+        while ((word & 1u) == 0) {
+            word >>= 1;
+            i++;
+        }
+        return i;
+#endif
+    }
+
+    BaseEventBus::BaseEventBus(AbstractEventQueue** queues, uint32_t* bitmap, uint32_t* summary,
+            unsigned int maxSubscribers, unsigned int eventCount) :
+        queues_(queues),
+        bitmap_(bitmap),
+        summary_(summary),
+        maxSubscribers_(maxSubscribers),
+        eventCount_(eventCount),
+        words_(BUS_WORDS(maxSubscribers)),
+        summaryWords_(BUS_WORDS(BUS_WORDS(maxSubscribers))),
+        subscriberCount_(0),
+        failed_(0)
+    {
+        for (unsigned int i = 0; i < eventCount * this->words_; i++) this->bitmap_[i] = 0;
+        for (unsigned int i = 0; i < eventCount * this->summaryWords_; i++) this->summary_[i] = 0;
+    }
+
+    int BaseEventBus::attach(AbstractEventQueue* queue)
+    {
+        if (this->subscriberCount_ >= this->maxSubscribers_) return -1;
+        this->queues_[this->subscriberCount_] = queue;
+        return static_cast<int>(this->subscriberCount_++);
+    }
+
+    int BaseEventBus::attach(BaseHSM& hsm, AbstractEventQueue* queue)
+    {
+        int subscriber = this->attach(queue);
+        if (subscriber < 0) return subscriber;
+        hsm.attachQueue(queue);
+        this->subscribeHandled(static_cast<unsigned int>(subscriber), hsm);
+        return subscriber;
+    }
+
+    void BaseEventBus::subscribe(unsigned int subscriber, unsigned int event)
+    {
+#if MICROHSM_ASSERTIONS == 1
+        MICROHSM_ASSERT(subscriber < this->subscriberCount_);
+        MICROHSM_ASSERT(event < this->eventCount_);
+#endif
+        const unsigned int word = subscriber / BUS_WORD_BITS;
+        this->bitmap_[(event * this->words_) + word] |= (1u << (subscriber % BUS_WORD_BITS));
+        this->summary_[(event * this->summaryWords_) + (word / BUS_WORD_BITS)] |= (1u << (word % BUS_WORD_BITS));
+    }
+
+    void BaseEventBus::subscribeHandled(unsigned int subscriber, BaseHSM& hsm)
+    {
+        const tEventMask mask = hsm.getHandledEvents();
+        for (unsigned int event = 0; event < this->eventCount_; event++) {
+            if (event == EVENT_ANONYMOUS) continue;
+            if ((mask & eventBit(event)) != 0) this->subscribe(subscriber, event);
+        }
+    }
+
+    void BaseEventBus::unsubscribe(unsigned int subscriber, unsigned int event)
+    {
+#if MICROHSM_ASSERTIONS == 1
+        MICROHSM_ASSERT(subscriber < this->subscriberCount_);
+        MICROHSM_ASSERT(event < this->eventCount_);
+#endif
+        const unsigned int word = subscriber / BUS_WORD_BITS;
+        uint32_t* bits = &this->bitmap_[(event * this->words_) + word];
+        *bits &= ~(1u << (subscriber % BUS_WORD_BITS));
+        if (*bits == 0) {
+            this->summary_[(event * this->summaryWords_) + (word / BUS_WORD_BITS)] &= ~(1u << (word % BUS_WORD_BITS));
+        }
+    }
+
+    bool BaseEventBus::isSubscribed(unsigned int subscriber, unsigned int event) const
+    {
+        if (subscriber >= this->subscriberCount_ || event >= this->eventCount_) return false;
+        const uint32_t bits = this->bitmap_[(event * this->words_) + (subscriber / BUS_WORD_BITS)];
+        return (bits & (1u << (subscriber % BUS_WORD_BITS))) != 0;
+    }
+
+    unsigned int BaseEventBus::publish(unsigned int event)
+    {
+        if (event >= this->eventCount_) return 0;
+
+        const uint32_t* summary = &this->summary_[event * this->summaryWords_];
+        const uint32_t* bitmap = &this->bitmap_[event * this->words_];
+        unsigned int delivered = 0;
+        unsigned long failed = 0;
+
+        // Visit non-empty words only, then every subscriber in such a word
+        for (unsigned int s = 0; s < this->summaryWords_; s++) {
+            uint32_t words = summary[s];
+            while (words != 0) {
+                const unsigned int w = (s * BUS_WORD_BITS) + lowestBit_(words);
+                words &= words - 1u;
+
+                uint32_t bits = bitmap[w];
+                while (bits != 0) {
+                    const unsigned int subscriber = (w * BUS_WORD_BITS) + lowestBit_(bits);
+                    bits &= bits - 1u;
+                    if (this->queues_[subscriber]->push(event)) delivered++;
+                    else failed++;
+                }
+            }
+        }
+
+        if (failed > 0) this->failed_.fetch_add(failed, std::memory_order_relaxed);
+        return delivered;
+    }
+
+    unsigned int BaseEventBus::getSubscriberCount(void) const
+    {
+        return this->subscriberCount_;
+    }
+
+    unsigned long BaseEventBus::getFailed(void) const
+    {
+        return this->failed_.load(std::memory_order_relaxed);
+    }
+}
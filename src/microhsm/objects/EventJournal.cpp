@@ -0,0 +1,259 @@
+/**
+ * @file EventJournal.cpp
+ * @brief Journal of dispatched events and deterministic replay
+ *
+ * @author Jelle Meijer
+ * @date 2025-05-23
+ */
+
+#include <string.h>
+
+#include <microhsm/microhsm.hpp>
+
+namespace microhsm
+{
+    /// Write little-endian 16-bit value
+    static inline void write16_(uint8_t* p, uint32_t value)
+    {
+        p[0] = static_cast<uint8_t>(value);
+        p[1] = static_cast<uint8_t>(value >> 8);
+    }
+
+    /// Write little-endian 32-bit value
+    static inline void write32_(uint8_t* p, uint32_t value)
+    {
+        p[0] = static_cast<uint8_t>(value);
+        p[1] = static_cast<uint8_t>(value >> 8);
+        p[2] = static_cast<uint8_t>(value >> 16);
+        p[3] = static_cast<uint8_t>(value >> 24);
+    }
+
+    /// Read little-endian 16-bit value
+    static inline unsigned int read16_(const uint8_t* p)
+    {
+        return static_cast<unsigned int>(p[0]) | (static_cast<unsigned int>(p[1]) << 8);
+    }
+
+    /// Read little-endian 32-bit value
+    static inline uint32_t read32_(const uint8_t* p)
+    {
+        return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+            (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    BaseEventJournal::BaseEventJournal(uint8_t* buffer, unsigned int capacity, fJournalCommit callback, void* ctx) :
+        buffer_(buffer),
+        capacity_(capacity),
+        commit_(callback),
+        ctx_(ctx),
+        length_(0),
+        sequence_(0),
+        commits_(0),
+        failedCommits_(0),
+        dropped_(0)
+    {
+#if MICROHSM_ASSERTIONS == 1
+        MICROHSM_ASSERT(callback != nullptr);
+#endif
+    }
+
+    bool BaseEventJournal::commit()
+    {
+        if (this->length_ == 0) return true;
+        if (!this->commit_(this->ctx_, this->buffer_, this->length_)) {
+            this->failedCommits_++;
+            return false;
+        }
+        this->commits_++;
+        this->length_ = 0;
+        return true;
+    }
+
+    bool BaseEventJournal::checkpoint(uint32_t instance, BaseHSM& hsm)
+    {
+        const unsigned int size = hsm.getSnapshotSize();
+        uint8_t* payload = this->reserve_(instance, JOURNAL_CHECKPOINT, size);
+        if (payload == nullptr) return false;
+        hsm.snapshot(payload, size);
+        return true;
+    }
+
+    uint32_t BaseEventJournal::getSequence() const
+    {
+        return this->sequence_;
+    }
+
+    unsigned int BaseEventJournal::getPending() const
+    {
+        return this->length_;
+    }
+
+    unsigned long BaseEventJournal::getCommits() const
+    {
+        return this->commits_;
+    }
+
+    unsigned long BaseEventJournal::getFailedCommits() const
+    {
+        return this->failedCommits_;
+    }
+
+    unsigned long BaseEventJournal::getDropped() const
+    {
+        return this->dropped_;
+    }
+
+    void BaseEventJournal::append_(uint32_t instance, unsigned int event, const void* data, unsigned int size)
+    {
+#if MICROHSM_ASSERTIONS == 1
+        MICROHSM_ASSERT(event < JOURNAL_CHECKPOINT);   // Event ID does not fit a record
+#endif
+        if (event >= JOURNAL_CHECKPOINT) {
+            // Event ID does not fit a record, sequence gap is detected by replay
+            this->sequence_++;
+            this->dropped_++;
+            return;
+        }
+        uint8_t* payload = this->reserve_(instance, event, size);
+        if (payload != nullptr && size > 0) memcpy(payload, data, size);
+    }
+
+    uint8_t* BaseEventJournal::reserve_(uint32_t instance, unsigned int event, unsigned int size)
+    {
+        // Sequence number is consumed even if the record is dropped
+        const uint32_t sequence = this->sequence_++;
+        const unsigned int length = JOURNAL_RECORD_HEADER_SIZE + size;
+        if (size > JOURNAL_MAX_PAYLOAD_SIZE || length > this->capacity_) {
+            this->dropped_++;
+            return nullptr;
+        }
+
+        // Group commit once the buffer is full
+        if (this->length_ + length > this->capacity_ && !this->commit()) {
+            this->dropped_++;
+            return nullptr;
+        }
+
+        uint8_t* record = this->buffer_ + this->length_;
+        write32_(record, sequence);
+        write32_(record + 4, instance);
+        write16_(record + 8, event);
+        write16_(record + 10, size);
+        this->length_ += length;
+        return record + JOURNAL_RECORD_HEADER_SIZE;
+    }
+
+    JournalReplay::JournalReplay(BaseHSM* const* hsms, void* const* contexts, uint32_t count) :
+        hsms_(hsms),
+        contexts_(contexts),
+        count_(count),
+        suppress_(false),
+        sequence_(0),
+        offset_(0),
+        events_(0),
+        checkpoints_(0)
+    {
+    }
+
+    void JournalReplay::suppressBehavior(bool suppress)
+    {
+        this->suppress_ = suppress;
+    }
+
+    void JournalReplay::setSequence(uint32_t sequence)
+    {
+        this->sequence_ = sequence;
+    }
+
+    eReplayStatus JournalReplay::replay(const uint8_t* data, unsigned long size)
+    {
+        if (this->suppress_) {
+            for (uint32_t i = 0; i < this->count_; i++) {
+                if (this->hsms_[i] != nullptr) this->hsms_[i]->enableBehavior(false);
+            }
+        }
+
+        eReplayStatus status = eREPLAY_OK;
+        unsigned long offset = 0;
+        while (offset < size) {
+            const uint8_t* record = data + offset;
+            if (size - offset < JOURNAL_RECORD_HEADER_SIZE) {
+                status = eREPLAY_TRUNCATED;
+                break;
+            }
+            const unsigned int length = read16_(record + 10);
+            if (size - offset - JOURNAL_RECORD_HEADER_SIZE < length) {
+                status = eREPLAY_TRUNCATED;
+                break;
+            }
+            if (read32_(record) != this->sequence_) {
+                status = eREPLAY_SEQUENCE;
+                break;
+            }
+            const uint32_t instance = read32_(record + 4);
+            if (instance >= this->count_ || this->hsms_[instance] == nullptr) {
+                status = eREPLAY_INSTANCE;
+                break;
+            }
+
+            BaseHSM& hsm = *this->hsms_[instance];
+            const unsigned int event = read16_(record + 8);
+            const uint8_t* payload = record + JOURNAL_RECORD_HEADER_SIZE;
+            if (event == JOURNAL_CHECKPOINT) {
+                if (!verify_(hsm, payload, length)) {
+                    status = eREPLAY_MISMATCH;
+                    break;
+                }
+                this->checkpoints_++;
+            }
+            else {
+                void* ctx = (this->contexts_ != nullptr) ? this->contexts_[instance] : nullptr;
+                if (length == 0) {
+                    hsm.dispatch(event, ctx);
+                }
+                else {
+                    // Payload is referenced in place
+                    const Event e(event, const_cast<uint8_t*>(payload), length, nullptr);
+                    hsm.dispatch(e, ctx);
+                }
+                this->events_++;
+            }
+            this->sequence_++;
+            offset += JOURNAL_RECORD_HEADER_SIZE + length;
+        }
+        this->offset_ = offset;
+
+        if (this->suppress_) {
+            for (uint32_t i = 0; i < this->count_; i++) {
+                if (this->hsms_[i] != nullptr) this->hsms_[i]->enableBehavior(true);
+            }
+        }
+        return status;
+    }
+
+    uint32_t JournalReplay::getSequence() const
+    {
+        return this->sequence_;
+    }
+
+    unsigned long JournalReplay::getOffset() const
+    {
+        return this->offset_;
+    }
+
+    unsigned long JournalReplay::getEvents() const
+    {
+        return this->events_;
+    }
+
+    unsigned long JournalReplay::getCheckpoints() const
+    {
+        return this->checkpoints_;
+    }
+
+    bool JournalReplay::verify_(BaseHSM& hsm, const uint8_t* snapshot, unsigned int size)
+    {
+        // Compared in place, snapshots of HSMs with regions have no upper bound
+        return hsm.readSnapshot_(snapshot, snapshot + size, BaseHSM::eSNAPSHOT_COMPARE) == snapshot + size;
+    }
+}
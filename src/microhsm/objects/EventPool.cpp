@@ -0,0 +1,197 @@
+/**
+ * @file EventPool.cpp
+ * @brief Fixed-block pools for reference-counted event payloads
+ *
+ * @author Jelle Meijer
+ * @date 2025-05-23
+ */
+
+#include <new>
+#include <stdint.h>
+
+#include <microhsm/microhsm.hpp>
+
+namespace microhsm
+{
+    /// Block index marking the end of the free list
+    #define POOL_INDEX_NONE 0xFFFFu
+
+    /// Free list head with index `index` and the tag of `head` incremented
+    #define POOL_NEXT_HEAD(head, index) ((((head) + 0x10000u) & 0xFFFF0000u) | (index))
+
+    static sPoolBlockHeader* headerOf_(const void* payload)
+    {
+        return reinterpret_cast<sPoolBlockHeader*>(
+            const_cast<unsigned char*>(static_cast<const unsigned char*>(payload)) - POOL_HEADER_SIZE);
+    }
+
+    BaseEventPool::BaseEventPool(unsigned char* storage, unsigned int blockSize, unsigned int count) :
+        freeHead_(count > 0 ? 0 : POOL_INDEX_NONE),
+        inUse_(0),
+        peak_(0),
+        exhausted_(0),
+        storage_(storage),
+        blockSize_(blockSize),
+        stride_(POOL_BLOCK_STRIDE(blockSize)),
+        count_(count)
+    {
+#if MICROHSM_ASSERTIONS == 1
+        MICROHSM_ASSERT(count < POOL_INDEX_NONE);
+        MICROHSM_ASSERT((reinterpret_cast<uintptr_t>(storage) % POOL_BLOCK_ALIGNMENT) == 0);
+#endif
+        // Chain all blocks into the free list
+        for (unsigned int i = 0; i < count; i++) {
+            sPoolBlockHeader* h = this->header_(i);
+            new (h) sPoolBlockHeader;
+            h->refs.store(0, std::memory_order_relaxed);
+            h->next.store((i + 1 < count) ? i + 1 : POOL_INDEX_NONE, std::memory_order_relaxed);
+            h->pool = this;
+        }
+    }
+
+    void* BaseEventPool::allocate(void)
+    {
+        unsigned int head = this->freeHead_.load(std::memory_order_acquire);
+        sPoolBlockHeader* h;
+        for (;;) {
+            const unsigned int index = head & 0xFFFFu;
+            if (index == POOL_INDEX_NONE) {
+                this->exhausted_.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+            // `next` can be stale when another thread popped the block, the tag makes the swap fail
+            h = this->header_(index);
+            const unsigned int next = h->next.load(std::memory_order_relaxed);
+            if (this->freeHead_.compare_exchange_weak(head, POOL_NEXT_HEAD(head, next),
+                    std::memory_order_acquire, std::memory_order_acquire)) break;
+        }
+        h->refs.store(1, std::memory_order_relaxed);
+
+        // Statistics
+        const unsigned int used = this->inUse_.fetch_add(1, std::memory_order_relaxed) + 1;
+        unsigned int peak = this->peak_.load(std::memory_order_relaxed);
+        while (used > peak && !this->peak_.compare_exchange_weak(peak, used, std::memory_order_relaxed)) {}
+
+        return reinterpret_cast<unsigned char*>(h) + POOL_HEADER_SIZE;
+    }
+
+    void* BaseEventPool::makeEvent(unsigned int id, unsigned int size, Event& event)
+    {
+#if MICROHSM_ASSERTIONS == 1
+        MICROHSM_ASSERT(size <= this->blockSize_);
+#endif
+        void* payload = this->allocate();
+        if (payload != nullptr) event = Event(id, payload, size, BaseEventPool::release);
+        return payload;
+    }
+
+    void BaseEventPool::retain(void* payload)
+    {
+        headerOf_(payload)->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void BaseEventPool::release(void* payload)
+    {
+        sPoolBlockHeader* h = headerOf_(payload);
+#if MICROHSM_ASSERTIONS == 1
+        MICROHSM_ASSERT(h->refs.load(std::memory_order_relaxed) > 0);
+#endif
+        // Last reference returns the block, writes of other owners happen before
+        if (h->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+        BaseEventPool* pool = h->pool;
+        const unsigned int offset = static_cast<unsigned int>(reinterpret_cast<unsigned char*>(h) - pool->storage_);
+        pool->free_(offset / pool->stride_);
+    }
+
+    Event BaseEventPool::share(const Event& event)
+    {
+#if MICROHSM_ASSERTIONS == 1
+        MICROHSM_ASSERT(event.isExternal());
+#endif
+        void* payload = const_cast<void*>(event.data());
+        BaseEventPool::retain(payload);
+        return Event(event.getID(), payload, event.size(), BaseEventPool::release);
+    }
+
+    unsigned int BaseEventPool::getReferences(const void* payload)
+    {
+        return headerOf_(payload)->refs.load(std::memory_order_relaxed);
+    }
+
+    unsigned int BaseEventPool::getBlockSize(void) const
+    {
+        return this->blockSize_;
+    }
+
+    unsigned int BaseEventPool::getCapacity(void) const
+    {
+        return this->count_;
+    }
+
+    unsigned int BaseEventPool::getInUse(void) const
+    {
+        return this->inUse_.load(std::memory_order_relaxed);
+    }
+
+    unsigned int BaseEventPool::getPeakInUse(void) const
+    {
+        return this->peak_.load(std::memory_order_relaxed);
+    }
+
+    unsigned long BaseEventPool::getExhausted(void) const
+    {
+        return this->exhausted_.load(std::memory_order_relaxed);
+    }
+
+    sPoolBlockHeader* BaseEventPool::header_(unsigned int index) const
+    {
+        return reinterpret_cast<sPoolBlockHeader*>(this->storage_ + (index * this->stride_));
+    }
+
+    void BaseEventPool::free_(unsigned int index)
+    {
+        sPoolBlockHeader* h = this->header_(index);
+        unsigned int head = this->freeHead_.load(std::memory_order_relaxed);
+        do {
+            h->next.store(head & 0xFFFFu, std::memory_order_relaxed);
+        } while (!this->freeHead_.compare_exchange_weak(head, POOL_NEXT_HEAD(head, index),
+                    std::memory_order_release, std::memory_order_relaxed));
+        this->inUse_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    EventPoolSet::EventPoolSet(BaseEventPool* const* pools, unsigned int count) :
+        pools_(pools),
+        count_(count),
+        exhausted_(0)
+    {
+#if MICROHSM_ASSERTIONS == 1
+        for (unsigned int i = 1; i < count; i++) {
+            MICROHSM_ASSERT(pools[i - 1]->getBlockSize() <= pools[i]->getBlockSize());
+        }
+#endif
+    }
+
+    void* EventPoolSet::allocate(unsigned int size)
+    {
+        // Smallest fitting pool first, larger pools when it is exhausted
+        for (unsigned int i = 0; i < this->count_; i++) {
+            if (this->pools_[i]->getBlockSize() < size) continue;
+            void* payload = this->pools_[i]->allocate();
+            if (payload != nullptr) return payload;
+        }
+        this->exhausted_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    void* EventPoolSet::makeEvent(unsigned int id, unsigned int size, Event& event)
+    {
+        void* payload = this->allocate(size);
+        if (payload != nullptr) event = Event(id, payload, size, BaseEventPool::release);
+        return payload;
+    }
+
+    unsigned long EventPoolSet::getExhausted(void) const
+    {
+        return this->exhausted_.load(std::memory_order_relaxed);
+    }
+}
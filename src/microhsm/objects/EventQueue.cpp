@@ -0,0 +1,326 @@
+/**
+ * @file EventQueue.cpp
+ * @brief Bounded event queues
+ *
+ * @author Jelle Meijer
+ * @date 2025-05-23
+ */
+
+#include <utility>
+
+#include <microhsm/microhsm.hpp>
+
+namespace microhsm
+{
+    BaseEventQueue::BaseEventQueue(unsigned int* buffer, unsigned int capacity) :
+        head_(0),
+        tailCache_(0),
+        tail_(0),
+        headCache_(0),
+        dropped_(0),
+        buffer_(buffer),
+        mask_(capacity - 1)
+    {
+#if MICROHSM_ASSERTIONS == 1
+        MICROHSM_ASSERT(capacity >= 2 && (capacity & (capacity - 1)) == 0);
+#endif
+    }
+
+    bool BaseEventQueue::push(unsigned int event)
+    {
+        // Indices run freely, their difference is the number of queued events
+        const unsigned int tail = this->tail_.load(std::memory_order_relaxed);
+        if (tail - this->headCache_ > this->mask_) {
+            // Queue appears full, refresh view of consumer
+            this->headCache_ = this->head_.load(std::memory_order_acquire);
+            if (tail - this->headCache_ > this->mask_) {
+                this->dropped_.store(this->dropped_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        this->buffer_[tail & this->mask_] = event;
+        this->tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    unsigned int BaseEventQueue::pushBatch(const unsigned int* events, unsigned int count)
+    {
+        const unsigned int tail = this->tail_.load(std::memory_order_relaxed);
+        unsigned int free = this->mask_ + 1 - (tail - this->headCache_);
+        if (free < count) {
+            this->headCache_ = this->head_.load(std::memory_order_acquire);
+            free = this->mask_ + 1 - (tail - this->headCache_);
+        }
+
+        // Copy all events that fit, publish them at once
+        const unsigned int n = (count < free) ? count : free;
+        for (unsigned int i = 0; i < n; i++) {
+            this->buffer_[(tail + i) & this->mask_] = events[i];
+        }
+        this->tail_.store(tail + n, std::memory_order_release);
+
+        if (n < count) {
+            this->dropped_.store(this->dropped_.load(std::memory_order_relaxed) + (count - n), std::memory_order_relaxed);
+        }
+        return n;
+    }
+
+    bool BaseEventQueue::pop(unsigned int& event)
+    {
+        const unsigned int head = this->head_.load(std::memory_order_relaxed);
+        if (head == this->tailCache_) {
+            // Queue appears empty, refresh view of producer
+            this->tailCache_ = this->tail_.load(std::memory_order_acquire);
+            if (head == this->tailCache_) return false;
+        }
+        event = this->buffer_[head & this->mask_];
+        this->head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    unsigned int BaseEventQueue::popBatch(unsigned int* events, unsigned int max)
+    {
+        const unsigned int head = this->head_.load(std::memory_order_relaxed);
+        if (this->tailCache_ - head < max) {
+            this->tailCache_ = this->tail_.load(std::memory_order_acquire);
+        }
+
+        // Copy all available events, release their slots at once
+        const unsigned int available = this->tailCache_ - head;
+        const unsigned int n = (max < available) ? max : available;
+        for (unsigned int i = 0; i < n; i++) {
+            events[i] = this->buffer_[(head + i) & this->mask_];
+        }
+        this->head_.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+    unsigned int BaseEventQueue::size(void) const
+    {
+        // Load `head_` first, such that the observed `tail_` is never behind it
+        const unsigned int head = this->head_.load(std::memory_order_acquire);
+        return this->tail_.load(std::memory_order_acquire) - head;
+    }
+
+    unsigned int BaseEventQueue::capacity(void) const
+    {
+        return this->mask_ + 1;
+    }
+
+    unsigned long BaseEventQueue::getDropped(void) const
+    {
+        return this->dropped_.load(std::memory_order_relaxed);
+    }
+
+    BaseMPSCEventQueue::BaseMPSCEventQueue(sQueueSlot* slots, unsigned int capacity, eQueuePolicy policy) :
+        head_(0),
+        tail_(0),
+        blocked_(0),
+        droppedNewest_(0),
+        droppedOldest_(0),
+        failed_(0),
+        slots_(slots),
+        mask_(capacity - 1),
+        policy_(policy)
+    {
+#if MICROHSM_ASSERTIONS == 1
+        MICROHSM_ASSERT(capacity >= 2 && (capacity & (capacity - 1)) == 0);
+#endif
+        // Every slot is free for the first lap
+        for (unsigned int i = 0; i < capacity; i++) {
+            this->slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool BaseMPSCEventQueue::push(unsigned int event)
+    {
+        return this->pushBatch(&event, 1) == 1;
+    }
+
+    unsigned int BaseMPSCEventQueue::pushBatch(const unsigned int* events, unsigned int count)
+    {
+        unsigned int queued = 0;
+        while (queued < count) {
+            unsigned int pos;
+            const unsigned int n = this->claim_(count - queued, pos);
+            if (n == 0) {
+                if (!this->handleFull_(count - queued)) break;
+                continue;
+            }
+
+            // Fill claimed slots and hand them to the consumer
+            for (unsigned int i = 0; i < n; i++) {
+                sQueueSlot* slot = &this->slots_[(pos + i) & this->mask_];
+                slot->event = events[queued + i];
+                slot->sequence.store(pos + i + 1, std::memory_order_release);
+            }
+            queued += n;
+        }
+        return queued;
+    }
+
+    unsigned int BaseMPSCEventQueue::claim_(unsigned int count, unsigned int& pos)
+    {
+        pos = this->tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            // Count consecutive free slots
+            unsigned int n = 0;
+            unsigned int seq = 0;
+            while (n < count) {
+                seq = this->slots_[(pos + n) & this->mask_].sequence.load(std::memory_order_acquire);
+                if (seq != pos + n) break;
+                n++;
+            }
+
+            if (n == 0) {
+                // Slot still holds an event of the previous lap
+                if (static_cast<int>(seq - pos) < 0) return 0;
+                // Slot was claimed by another producer
+                pos = this->tail_.load(std::memory_order_relaxed);
+                continue;
+            }
+
+            if (this->tail_.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed)) return n;
+            // `pos` holds the new tail
+        }
+    }
+
+    bool BaseMPSCEventQueue::handleFull_(unsigned int count)
+    {
+        unsigned int event;
+        switch (this->policy_) {
+            case eQUEUE_BLOCK:
+                this->blocked_.fetch_add(1, std::memory_order_relaxed);
+                MICROHSM_QUEUE_WAIT();
+                return true;
+            case eQUEUE_DROP_OLDEST:
+                if (this->pop(event)) this->droppedOldest_.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            case eQUEUE_DROP_NEWEST:
+                this->droppedNewest_.fetch_add(count, std::memory_order_relaxed);
+                return false;
+            case eQUEUE_FAIL:
+            default:
+                this->failed_.fetch_add(count, std::memory_order_relaxed);
+                return false;
+        }
+    }
+
+    bool BaseMPSCEventQueue::pop(unsigned int& event)
+    {
+        return this->popBatch(&event, 1) == 1;
+    }
+
+    unsigned int BaseMPSCEventQueue::popBatch(unsigned int* events, unsigned int max)
+    {
+        // Head is claimed with compare-and-swap, because producers pop under `eQUEUE_DROP_OLDEST`
+        unsigned int pos = this->head_.load(std::memory_order_relaxed);
+        unsigned int n;
+        for (;;) {
+            // Count consecutive published events
+            n = 0;
+            unsigned int seq = 0;
+            while (n < max) {
+                seq = this->slots_[(pos + n) & this->mask_].sequence.load(std::memory_order_acquire);
+                if (seq != pos + n + 1) break;
+                n++;
+            }
+
+            if (n == 0) {
+                // Slot not published yet
+                if (static_cast<int>(seq - (pos + 1)) < 0) return 0;
+                // Slot was popped by a producer dropping the oldest event
+                pos = this->head_.load(std::memory_order_relaxed);
+                continue;
+            }
+
+            if (this->head_.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed)) break;
+        }
+
+        // Copy events and free slots for the next lap
+        for (unsigned int i = 0; i < n; i++) {
+            sQueueSlot* slot = &this->slots_[(pos + i) & this->mask_];
+            events[i] = slot->event;
+            slot->sequence.store(pos + i + this->mask_ + 1, std::memory_order_release);
+        }
+        return n;
+    }
+
+    unsigned int BaseMPSCEventQueue::size(void) const
+    {
+        // Load `head_` first, such that the observed `tail_` is never behind it
+        const unsigned int head = this->head_.load(std::memory_order_acquire);
+        return this->tail_.load(std::memory_order_acquire) - head;
+    }
+
+    unsigned int BaseMPSCEventQueue::capacity(void) const
+    {
+        return this->mask_ + 1;
+    }
+
+    eQueuePolicy BaseMPSCEventQueue::getPolicy(void) const
+    {
+        return this->policy_;
+    }
+
+    unsigned long BaseMPSCEventQueue::getBlocked(void) const
+    {
+        return this->blocked_.load(std::memory_order_relaxed);
+    }
+
+    unsigned long BaseMPSCEventQueue::getDroppedNewest(void) const
+    {
+        return this->droppedNewest_.load(std::memory_order_relaxed);
+    }
+
+    unsigned long BaseMPSCEventQueue::getDroppedOldest(void) const
+    {
+        return this->droppedOldest_.load(std::memory_order_relaxed);
+    }
+
+    unsigned long BaseMPSCEventQueue::getFailed(void) const
+    {
+        return this->failed_.load(std::memory_order_relaxed);
+    }
+
+    BasePayloadQueue::BasePayloadQueue(Event* buffer, unsigned int capacity) :
+        head_(0),
+        tail_(0),
+        buffer_(buffer),
+        mask_(capacity - 1)
+    {
+#if MICROHSM_ASSERTIONS == 1
+        MICROHSM_ASSERT(capacity >= 2 && (capacity & (capacity - 1)) == 0);
+#endif
+    }
+
+    bool BasePayloadQueue::push(Event&& event)
+    {
+        const unsigned int tail = this->tail_.load(std::memory_order_relaxed);
+        if (tail - this->head_.load(std::memory_order_acquire) > this->mask_) return false;
+        this->buffer_[tail & this->mask_] = std::move(event);
+        this->tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool BasePayloadQueue::pop(Event& event)
+    {
+        const unsigned int head = this->head_.load(std::memory_order_relaxed);
+        if (head == this->tail_.load(std::memory_order_acquire)) return false;
+        event = std::move(this->buffer_[head & this->mask_]);
+        this->head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    unsigned int BasePayloadQueue::size(void) const
+    {
+        // Load `head_` first, such that the observed `tail_` is never behind it
+        const unsigned int head = this->head_.load(std::memory_order_acquire);
+        return this->tail_.load(std::memory_order_acquire) - head;
+    }
+
+    unsigned int BasePayloadQueue::capacity(void) const
+    {
+        return this->mask_ + 1;
+    }
+}
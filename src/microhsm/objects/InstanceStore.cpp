@@ -0,0 +1,228 @@
+/**
+ * @file InstanceStore.cpp
+ * @brief Persistent storage of table-driven HSM instances
+ *
+ * @author Jelle Meijer
+ * @date 2025-05-23
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include <microhsm/microhsm.hpp>
+
+namespace microhsm
+{
+    /// Fletcher-style checksum over 64-bit words, sensitive to the order of the words
+    static inline uint64_t checksum64_(const uint8_t* data, unsigned long size)
+    {
+        uint64_t a = 1;
+        uint64_t b = 0;
+        unsigned long i = 0;
+        for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+            uint64_t w;
+            memcpy(&w, data + i, sizeof(w));
+            a += w;
+            b += a;
+        }
+        for (; i < size; i++) {
+            a += data[i];
+            b += a;
+        }
+        return a ^ ((b << 32) | (b >> 32));
+    }
+
+    /// Checksum of the fields of a header preceding `headerCheck`, except `dirty`
+    static inline uint32_t headerCheck_(const sStoreHeader& header)
+    {
+        // `dirty` is cleared by `close` without rewriting the check, a torn close cannot invalidate the layout
+        sStoreHeader fields = header;
+        fields.dirty = 0;
+        return static_cast<uint32_t>(
+                checksum64_(reinterpret_cast<const uint8_t*>(&fields), offsetof(sStoreHeader, headerCheck)));
+    }
+
+    BaseInstanceStore::BaseInstanceStore(BaseStaticDefinition& definition, unsigned int slots,
+            unsigned int recordSize, unsigned int userOffset) :
+        definition_(definition),
+        slots_(slots),
+        recordSize_(recordSize),
+        userOffset_(userOffset),
+        header_(nullptr),
+        records_(nullptr),
+        count_(0)
+    {
+    }
+
+    unsigned long BaseInstanceStore::getRequiredSize(uint32_t count) const
+    {
+        return STORE_HEADER_SIZE + (static_cast<unsigned long>(count) * this->recordSize_);
+    }
+
+    eStoreStatus BaseInstanceStore::format(void* memory, unsigned long size, uint32_t count)
+    {
+#if MICROHSM_ASSERTIONS == 1
+        MICROHSM_ASSERT((reinterpret_cast<uintptr_t>(memory) & 7u) == 0);
+        MICROHSM_ASSERT(this->slots_ >= this->definition_.getHistoryCount());   // Record has too few history slots
+#endif
+        if (size < this->getRequiredSize(count)) return eSTORE_TOO_SMALL;
+
+        // Header is dirty until every instance was started
+        this->header_ = static_cast<sStoreHeader*>(memory);
+        this->records_ = static_cast<uint8_t*>(memory) + STORE_HEADER_SIZE;
+        this->count_ = count;
+        memset(memory, 0, this->getRequiredSize(count));
+        this->describe_(*this->header_, count);
+
+        for (uint32_t i = 0; i < count; i++) {
+            tStaticIndex* record = this->getRecord_(i);
+            this->definition_.start_(record[0], record + 1, this->slots_, this->getUserData_(i));
+        }
+        return eSTORE_OK;
+    }
+
+    eStoreStatus BaseInstanceStore::open(void* memory, unsigned long size, bool recover)
+    {
+#if MICROHSM_ASSERTIONS == 1
+        MICROHSM_ASSERT((reinterpret_cast<uintptr_t>(memory) & 7u) == 0);
+        MICROHSM_ASSERT(this->slots_ >= this->definition_.getHistoryCount());   // Record has too few history slots
+#endif
+        this->header_ = nullptr;
+        if (size < STORE_HEADER_SIZE) return eSTORE_TOO_SMALL;
+
+        // Header must describe this definition and record type
+        sStoreHeader* header = static_cast<sStoreHeader*>(memory);
+        sStoreHeader expected;
+        this->describe_(expected, header->count);
+        expected.dirty = header->dirty;
+        if (memcmp(header, &expected, offsetof(sStoreHeader, headerCheck)) != 0 ||
+                header->headerCheck != headerCheck_(*header)) {
+            return eSTORE_LAYOUT;
+        }
+        if (size < this->getRequiredSize(header->count)) return eSTORE_TOO_SMALL;
+        if (header->dirty != 0 && !recover) return eSTORE_DIRTY;
+
+        this->records_ = static_cast<uint8_t*>(memory) + STORE_HEADER_SIZE;
+        this->count_ = header->count;
+        if (header->dirty == 0 && this->checksum_() != header->checksum) return eSTORE_CHECKSUM;
+
+        // Every record must hold a configuration the definition can dispatch
+        if (!this->verifyRecords_()) return eSTORE_CORRUPT;
+
+        // Dirty until closed
+        this->header_ = header;
+        this->describe_(*this->header_, this->count_);
+        return eSTORE_OK;
+    }
+
+    void BaseInstanceStore::close()
+    {
+        if (this->header_ == nullptr) return;
+        this->header_->checksum = this->checksum_();
+        this->header_->dirty = 0;
+        this->header_ = nullptr;
+    }
+
+    bool BaseInstanceStore::isOpen() const
+    {
+        return this->header_ != nullptr;
+    }
+
+    uint32_t BaseInstanceStore::getCount() const
+    {
+        return (this->header_ != nullptr) ? this->count_ : 0;
+    }
+
+    eStatus BaseInstanceStore::dispatch(uint32_t index, unsigned int event)
+    {
+#if MICROHSM_ASSERTIONS == 1
+        MICROHSM_ASSERT(this->header_ != nullptr && index < this->count_);
+#endif
+        tStaticIndex* record = this->getRecord_(index);
+        return this->definition_.dispatch_(record[0], record + 1, event, this->getUserData_(index));
+    }
+
+    unsigned int BaseInstanceStore::getCurrentState(uint32_t index) const
+    {
+        return BaseStaticDefinition::toID_(this->getRecord_(index)[0]);
+    }
+
+    bool BaseInstanceStore::inState(uint32_t index, unsigned int ID) const
+    {
+        return this->definition_.inState_(this->getRecord_(index)[0], ID);
+    }
+
+    unsigned int BaseInstanceStore::getHistoryState(uint32_t index, unsigned int ID) const
+    {
+        return this->definition_.getHistoryState_(this->getRecord_(index) + 1, ID);
+    }
+
+    void* BaseInstanceStore::getUserData_(uint32_t index)
+    {
+        return this->records_ + (static_cast<unsigned long>(index) * this->recordSize_) + this->userOffset_;
+    }
+
+    tStaticIndex* BaseInstanceStore::getRecord_(uint32_t index) const
+    {
+        return reinterpret_cast<tStaticIndex*>(this->records_ + (static_cast<unsigned long>(index) * this->recordSize_));
+    }
+
+    void BaseInstanceStore::describe_(sStoreHeader& header, uint32_t count) const
+    {
+        header.magic = STORE_MAGIC;
+        header.version = STORE_VERSION;
+        header.indexWidth = static_cast<uint8_t>(sizeof(tStaticIndex));
+        header.dirty = 1;
+        header.vertexCount = this->definition_.vertexCount_;
+        header.historyCount = this->definition_.getHistoryCount();
+        header.recordSize = this->recordSize_;
+        header.userOffset = this->userOffset_;
+        header.count = count;
+        header.headerCheck = headerCheck_(header);
+    }
+
+    bool BaseInstanceStore::verifyRecords_() const
+    {
+        const BaseStaticDefinition& d = this->definition_;
+        const unsigned int slots = d.getHistoryCount();
+        if (d.vertexCount_ <= STORE_MASK_BITS) {
+            // Masks of the states every slot may hold, records are checked without walking the hierarchy
+            uint64_t leaves = 0;
+            uint64_t valid[STORE_MASK_BITS];
+            for (unsigned int v = 0; v < d.vertexCount_; v++) {
+                if (d.isLeafState_(v)) leaves |= static_cast<uint64_t>(1) << v;
+                const unsigned int slot = d.data_[v].slot;
+                if (slot == VERTEX_NONE) continue;
+                valid[slot] = 0;
+                for (unsigned int s = 0; s < d.vertexCount_; s++) {
+                    if (d.isHistoryState_(v, s)) valid[slot] |= static_cast<uint64_t>(1) << s;
+                }
+            }
+
+            for (uint32_t i = 0; i < this->count_; i++) {
+                const tStaticIndex* record = this->getRecord_(i);
+                if (record[0] >= d.vertexCount_ || ((leaves >> record[0]) & 1u) == 0) return false;
+                for (unsigned int h = 0; h < slots; h++) {
+                    const tStaticIndex s = record[1 + h];
+                    if (s >= d.vertexCount_ || ((valid[h] >> s) & 1u) == 0) return false;
+                }
+            }
+            return true;
+        }
+
+        for (uint32_t i = 0; i < this->count_; i++) {
+            const tStaticIndex* record = this->getRecord_(i);
+            if (!d.isLeafState_(record[0])) return false;
+            for (unsigned int v = 0; v < d.vertexCount_; v++) {
+                const unsigned int slot = d.data_[v].slot;
+                if (slot != VERTEX_NONE && !d.isHistoryState_(v, record[1 + slot])) return false;
+            }
+        }
+        return true;
+    }
+
+    uint64_t BaseInstanceStore::checksum_() const
+    {
+        return checksum64_(this->records_, static_cast<unsigned long>(this->count_) * this->recordSize_);
+    }
+}
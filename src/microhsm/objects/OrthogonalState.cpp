@@ -0,0 +1,294 @@
+/**
+ * @file OrthogonalState.cpp
+ * @brief States with orthogonal regions
+ *
+ * @author Jelle Meijer
+ * @date 2025-05-23
+ */
+
+#include <microhsm/microhsm.hpp>
+
+namespace microhsm
+{
+    /// Index of lowest set bit of a non-zero mask
+    static inline unsigned int lowestBit_(unsigned long long mask)
+    {
+#if defined(__GNUC__)
+        return static_cast<unsigned int>(__builtin_ctzll(mask));
+#else
+        unsigned int i = 0;
+        while ((mask & 1ull) == 0) {
+            mask >>= 1;
+            i++;
+        }
+        return i;
+#endif
+    }
+
+    /// Index of the bit representing an event in an event mask
+    static inline unsigned int eventBitIndex_(unsigned int event)
+    {
+        return (event < EVENT_MASK_BITS) ? event : (EVENT_MASK_BITS - 1u);
+    }
+
+    /// Rank of the status of a region, regions report the status with the highest rank
+    static inline unsigned int statusRank_(eStatus status)
+    {
+        switch (status) {
+            case eTRANSITION_ERROR:
+                return 4u;
+            case eOK:
+                return 3u;
+            case eEVENT_DEFERRED:
+                return 2u;
+            case eEVENT_NOT_DEFERRED:
+                return 1u;
+            default:
+                break;
+        }
+        return 0u;
+    }
+
+    RegionExecutor::RegionExecutor() :
+        state_(nullptr),
+        event_(0),
+        payload_(nullptr),
+        ctx_(nullptr),
+        results_(nullptr),
+        pending_(0),
+        remaining_(0),
+        busy_(false),
+        parallel_(0),
+        workerRegions_(0)
+    {
+    }
+
+    bool RegionExecutor::runOnce()
+    {
+        if (!this->runRegion_()) return false;
+        this->workerRegions_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void RegionExecutor::runWorker(const std::atomic<bool>& stop)
+    {
+        while (!stop.load(std::memory_order_acquire)) {
+            if (!this->runOnce()) MICROHSM_QUEUE_WAIT();
+        }
+    }
+
+    unsigned long RegionExecutor::getParallelDispatches() const
+    {
+        return this->parallel_.load(std::memory_order_relaxed);
+    }
+
+    unsigned long RegionExecutor::getWorkerRegions() const
+    {
+        return this->workerRegions_.load(std::memory_order_relaxed);
+    }
+
+    bool RegionExecutor::execute_(BaseOrthogonalState& state, tRegionMask regions, tRegionMask sequential,
+            unsigned int event, const Event* payload, void* ctx, eStatus* results)
+    {
+        if (this->busy_.exchange(true, std::memory_order_acquire)) return false;
+
+        // Publish job, claiming a region synchronizes with this release
+        this->state_ = &state;
+        this->event_ = event;
+        this->payload_ = payload;
+        this->ctx_ = ctx;
+        this->results_ = results;
+        unsigned int count = 0;
+        for (tRegionMask m = regions; m != 0; m &= m - 1u) count++;
+        this->remaining_.store(count, std::memory_order_relaxed);
+        this->pending_.store(regions, std::memory_order_release);
+
+        // Regions that are not independent run on this thread, one after another
+        while (sequential != 0) {
+            const unsigned int r = lowestBit_(sequential);
+            sequential &= sequential - 1u;
+            results[r] = state.dispatchRegion_(r, event, payload, ctx);
+        }
+
+        // Help with independent regions, then wait until workers finished theirs
+        while (this->runRegion_()) {}
+        while (this->remaining_.load(std::memory_order_acquire) != 0) {
+            MICROHSM_QUEUE_WAIT();
+        }
+
+        this->parallel_.fetch_add(1, std::memory_order_relaxed);
+        this->busy_.store(false, std::memory_order_release);
+        return true;
+    }
+
+    bool RegionExecutor::runRegion_()
+    {
+        // Claim lowest pending region
+        tRegionMask pending = this->pending_.load(std::memory_order_acquire);
+        tRegionMask bit;
+        do {
+            if (pending == 0) return false;
+            bit = pending & (~pending + 1u);
+        } while (!this->pending_.compare_exchange_weak(pending, pending & ~bit,
+                    std::memory_order_acq_rel, std::memory_order_acquire));
+
+        // Job stays valid until this region finished
+        const unsigned int r = lowestBit_(bit);
+        this->results_[r] = this->state_->dispatchRegion_(r, this->event_, this->payload_, this->ctx_);
+        this->remaining_.fetch_sub(1, std::memory_order_release);
+        return true;
+    }
+
+    BaseOrthogonalState::BaseOrthogonalState(unsigned int id, BaseState* parentState, BaseHSM** regions,
+            void** contexts, tEventMask* handled, tRegionMask* routes, unsigned int count) :
+        BaseState(id, parentState, nullptr),
+        regions_(regions),
+        contexts_(contexts),
+        handled_(handled),
+        routes_(routes),
+        count_(count),
+        executor_(nullptr),
+        independent_(0)
+    {
+#if MICROHSM_ASSERTIONS == 1
+        MICROHSM_ASSERT(count > 0 && count <= REGION_MAX_COUNT);
+#endif
+        this->isOrthogonal_ = true;
+        for (unsigned int r = 0; r < count; r++) {
+            this->contexts_[r] = nullptr;
+        }
+        for (unsigned int b = 0; b < EVENT_MASK_BITS; b++) {
+            this->routes_[b] = 0;
+        }
+    }
+
+    BaseHSM* BaseOrthogonalState::getRegion(unsigned int index)
+    {
+        return (index < this->count_) ? this->regions_[index] : nullptr;
+    }
+
+    unsigned int BaseOrthogonalState::getRegionCount() const
+    {
+        return this->count_;
+    }
+
+    tRegionMask BaseOrthogonalState::getRoutes(unsigned int event) const
+    {
+        return this->routes_[eventBitIndex_(event)];
+    }
+
+    void BaseOrthogonalState::setRegionContext(unsigned int index, void* ctx)
+    {
+        if (index < this->count_) this->contexts_[index] = ctx;
+    }
+
+    void BaseOrthogonalState::setExecutor(RegionExecutor* executor, tRegionMask independent)
+    {
+        this->executor_ = executor;
+        this->independent_ = independent;
+    }
+
+    bool BaseOrthogonalState::initRegions_(void* ctx)
+    {
+        bool valid = true;
+        for (unsigned int r = 0; r < this->count_; r++) {
+#if MICROHSM_ASSERTIONS == 1
+            MICROHSM_ASSERT(this->regions_[r] != nullptr && this->regions_[r] != this->hsm_);
+#endif
+            // Regions follow the behavior setting of their owner
+            this->regions_[r]->behavior_ = this->hsm_->behavior_;
+            valid = this->regions_[r]->build_(this->regionContext_(r, ctx)) && valid;
+            this->handled_[r] = 0;
+        }
+        for (unsigned int b = 0; b < EVENT_MASK_BITS; b++) {
+            this->routes_[b] = 0;
+        }
+        return valid;
+    }
+
+    void BaseOrthogonalState::enterRegions_(void* ctx)
+    {
+        for (unsigned int r = 0; r < this->count_; r++) {
+            this->regions_[r]->start_(this->regionContext_(r, ctx));
+            this->updateRoutes_(r);
+        }
+    }
+
+    void BaseOrthogonalState::exitRegions_(void* ctx)
+    {
+        for (unsigned int r = this->count_; r-- > 0;) {
+            this->regions_[r]->stop_(this->regionContext_(r, ctx));
+            this->updateRoutes_(r);
+        }
+    }
+
+    eStatus BaseOrthogonalState::dispatchRegions_(unsigned int event, const Event* payload, void* ctx)
+    {
+        eStatus result = eEVENT_IGNORED;
+
+        // Only regions whose active configuration handles the event are visited
+        const tRegionMask routes = this->routes_[eventBitIndex_(event)];
+        const tRegionMask parallel = routes & this->independent_;
+        eStatus results[REGION_MAX_COUNT];
+
+        // Parallel dispatch pays off for at least two independent regions
+        const bool executed = this->executor_ != nullptr && (parallel & (parallel - 1u)) != 0 &&
+                this->executor_->execute_(*this, parallel, routes & ~parallel, event, payload, ctx, results);
+        if (!executed) {
+            for (tRegionMask pending = routes; pending != 0; pending &= pending - 1u) {
+                const unsigned int r = lowestBit_(pending);
+                results[r] = this->dispatchRegion_(r, event, payload, ctx);
+            }
+        }
+
+        // Routes are updated once all regions finished
+        for (tRegionMask pending = routes; pending != 0; pending &= pending - 1u) {
+            const unsigned int r = lowestBit_(pending);
+            if (statusRank_(results[r]) > statusRank_(result)) result = results[r];
+            this->updateRoutes_(r);
+        }
+        return result;
+    }
+
+    eStatus BaseOrthogonalState::dispatchRegion_(unsigned int r, unsigned int event, const Event* payload, void* ctx)
+    {
+        // Events are journaled by the owner, the regions follow from replaying the owner
+        BaseHSM* region = this->regions_[r];
+        void* regionCtx = this->regionContext_(r, ctx);
+        return (payload != nullptr) ? region->runToCompletion_(*payload, regionCtx) : region->runToCompletion_(event, regionCtx);
+    }
+
+    void* BaseOrthogonalState::regionContext_(unsigned int r, void* ctx) const
+    {
+        return (this->contexts_[r] != nullptr) ? this->contexts_[r] : ctx;
+    }
+
+    void BaseOrthogonalState::enableBehavior_(bool enabled)
+    {
+        for (unsigned int r = 0; r < this->count_; r++) {
+            this->regions_[r]->enableBehavior(enabled);
+        }
+    }
+
+    void BaseOrthogonalState::refreshRoutes_()
+    {
+        for (unsigned int r = 0; r < this->count_; r++) {
+            this->updateRoutes_(r);
+        }
+    }
+
+    void BaseOrthogonalState::updateRoutes_(unsigned int r)
+    {
+        const tEventMask handled = this->regions_[r]->getActiveEvents_();
+        tEventMask changed = handled ^ this->handled_[r];
+        if (changed == 0) return;
+
+        // Toggle the region in the routes of events it started or stopped handling
+        const tRegionMask bit = static_cast<tRegionMask>(1) << r;
+        while (changed != 0) {
+            this->routes_[lowestBit_(changed)] ^= bit;
+            changed &= changed - 1u;
+        }
+        this->handled_[r] = handled;
+    }
+}
@@ -0,0 +1,154 @@
+/**
+ * @file Scheduler.cpp
+ * @brief Cooperative priority scheduler for run-to-completion steps
+ *
+ * @author Jelle Meijer
+ * @date 2025-05-23
+ */
+
+#include <microhsm/microhsm.hpp>
+
+namespace microhsm
+{
+    /// Index of highest set bit of `word` (must not be zero)
+    static inline unsigned int highestBit_(uint32_t word)
+    {
+#if defined(__GNUC__)
+        return 31u - static_cast<unsigned int>(__builtin_clz(word));
+#else
+        unsigned int i = 31;
+        while ((word & 0x80000000u) == 0) {
+            word <<= 1;
+            i--;
+        }
+        return i;
+#endif
+    }
+
+    BaseScheduler::BaseScheduler(sSchedulerEntry* entries, std::atomic<uint32_t>* ready, unsigned int priorities) :
+        entries_(entries),
+        ready_(ready),
+        groups_(0),
+        priorities_(priorities),
+        idle_(nullptr),
+        idleArg_(nullptr),
+        idleCalls_(0)
+    {
+#if MICROHSM_ASSERTIONS == 1
+        MICROHSM_ASSERT(priorities <= SCHEDULER_MAX_PRIORITIES);
+#endif
+        for (unsigned int p = 0; p < priorities; p++) {
+            this->entries_[p].hsm = nullptr;
+            this->entries_[p].queue = nullptr;
+            this->entries_[p].ctx = nullptr;
+            this->entries_[p].scheduler = this;
+            this->entries_[p].priority = p;
+        }
+        for (unsigned int g = 0; g < SCHEDULER_WORD_BITS; g++) {
+            this->ready_[g].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    bool BaseScheduler::add(BaseHSM& hsm, AbstractEventQueue& queue, void* ctx, unsigned int priority)
+    {
+        if (priority >= this->priorities_ || this->entries_[priority].hsm != nullptr) return false;
+        this->entries_[priority].hsm = &hsm;
+        this->entries_[priority].queue = &queue;
+        this->entries_[priority].ctx = ctx;
+        hsm.attachQueue(&queue);
+        hsm.setPostNotify(notifyReady_, &this->entries_[priority]);
+        if (hsm.hasQueuedEvents()) this->setReady_(priority);
+        return true;
+    }
+
+    bool BaseScheduler::post(unsigned int priority, unsigned int event)
+    {
+        if (priority >= this->priorities_ || this->entries_[priority].hsm == nullptr) return false;
+        // HSM notifies the scheduler
+        return this->entries_[priority].hsm->post(event);
+    }
+
+    bool BaseScheduler::runOnce(void)
+    {
+        const unsigned int p = this->getReadyPriority();
+        if (p == SCHEDULER_PRIORITY_NONE) return false;
+
+        // One run-to-completion step, the HSM stays ready while events (with payload) are queued
+        sSchedulerEntry& e = this->entries_[p];
+        const bool dispatched = e.hsm->runOnce(e.ctx);
+        if (!e.hsm->hasQueuedEvents()) this->clearReady_(p);
+        return dispatched;
+    }
+
+    unsigned int BaseScheduler::runUntilIdle(void)
+    {
+        unsigned int count = 0;
+        while (this->getReadyPriority() != SCHEDULER_PRIORITY_NONE) {
+            if (this->runOnce()) count++;
+        }
+        return count;
+    }
+
+    void BaseScheduler::run(const std::atomic<bool>& stop)
+    {
+        while (!stop.load(std::memory_order_acquire)) {
+            if (this->getReadyPriority() != SCHEDULER_PRIORITY_NONE) {
+                this->runOnce();
+                continue;
+            }
+            this->idleCalls_++;
+            if (this->idle_ != nullptr) this->idle_(this->idleArg_);
+        }
+    }
+
+    void BaseScheduler::setIdleHook(fSchedulerIdle hook, void* arg)
+    {
+        this->idle_ = hook;
+        this->idleArg_ = arg;
+    }
+
+    unsigned int BaseScheduler::getReadyPriority(void) const
+    {
+        uint32_t groups = this->groups_.load(std::memory_order_acquire);
+        while (groups != 0) {
+            const unsigned int g = highestBit_(groups);
+            const uint32_t ready = this->ready_[g].load(std::memory_order_acquire);
+            if (ready != 0) return (g * SCHEDULER_WORD_BITS) + highestBit_(ready);
+            // Group is being cleared by `clearReady_`
+            groups &= ~(1u << g);
+        }
+        return SCHEDULER_PRIORITY_NONE;
+    }
+
+    unsigned long BaseScheduler::getIdleCalls(void) const
+    {
+        return this->idleCalls_;
+    }
+
+    void BaseScheduler::setReady_(unsigned int priority)
+    {
+        const unsigned int g = priority / SCHEDULER_WORD_BITS;
+        this->ready_[g].fetch_or(1u << (priority % SCHEDULER_WORD_BITS), std::memory_order_release);
+        this->groups_.fetch_or(1u << g, std::memory_order_release);
+    }
+
+    void BaseScheduler::notifyReady_(void* arg)
+    {
+        sSchedulerEntry* e = static_cast<sSchedulerEntry*>(arg);
+        e->scheduler->setReady_(e->priority);
+    }
+
+    void BaseScheduler::clearReady_(unsigned int priority)
+    {
+        const unsigned int g = priority / SCHEDULER_WORD_BITS;
+        const uint32_t bit = 1u << (priority % SCHEDULER_WORD_BITS);
+        const uint32_t left = this->ready_[g].fetch_and(~bit, std::memory_order_acq_rel) & ~bit;
+        if (left == 0) {
+            this->groups_.fetch_and(~(1u << g), std::memory_order_acq_rel);
+            // Another priority of the group became ready while clearing the group
+            if (this->ready_[g].load(std::memory_order_acquire) != 0) this->groups_.fetch_or(1u << g, std::memory_order_release);
+        }
+        // Event posted after the queues were found empty
+        if (this->entries_[priority].hsm->hasQueuedEvents()) this->setReady_(priority);
+    }
+}
@@ -0,0 +1,494 @@
+/**
+ * @file StaticHSM.cpp
+ * @brief Table-driven Hierarchical State Machines
+ *
+ * @author Jelle Meijer
+ * @date 2025-05-23
+ */
+
+#include <microhsm/microhsm.hpp>
+
+namespace microhsm
+{
+    /// Write static index into a snapshot, least significant byte first
+    static inline uint8_t* writeIndex_(uint8_t* p, tStaticIndex s)
+    {
+        for (unsigned int b = 0; b < sizeof(tStaticIndex); b++) {
+            *p++ = static_cast<uint8_t>(s >> (8u * b));
+        }
+        return p;
+    }
+
+    /// Read static index from a snapshot, least significant byte first
+    static inline tStaticIndex readIndex_(const uint8_t*& p)
+    {
+        unsigned int s = 0;
+        for (unsigned int b = 0; b < sizeof(tStaticIndex); b++) {
+            s |= static_cast<unsigned int>(*p++) << (8u * b);
+        }
+        return static_cast<tStaticIndex>(s);
+    }
+
+    BaseStaticDefinition::BaseStaticDefinition(const sStaticVertex* vertices, unsigned int vertexCount,
+            const sStaticTransition* transitions, unsigned int transitionCount,
+            unsigned int eventCount, unsigned int initial,
+            unsigned int* table, unsigned int* next, sStaticVertexData* data) :
+        vertices_(vertices),
+        transitions_(transitions),
+        table_(table),
+        next_(next),
+        data_(data),
+        vertexCount_(vertexCount),
+        transitionCount_(transitionCount),
+        eventCount_(eventCount),
+        initial_(initial),
+        historyCount_(0),
+        valid_(false)
+    {
+    }
+
+    eStatus BaseStaticDefinition::init(void)
+    {
+#if MICROHSM_ASSERTIONS == 1
+        MICROHSM_ASSERT(initial_ < vertexCount_);
+        MICROHSM_ASSERT(vertices_[initial_].type == eSTATIC_STATE);
+        MICROHSM_ASSERT(vertexCount_ < STATIC_INDEX_NONE);
+#endif
+        // Instances of a rejected definition stay inactive
+        valid_ = false;
+
+        // Resolve hierarchy
+        for (unsigned int v = 0; v < vertexCount_; v++) {
+            data_[v].depth = 0;
+            data_[v].shallow = VERTEX_NONE;
+            data_[v].deep = VERTEX_NONE;
+            data_[v].slot = VERTEX_NONE;
+            data_[v].history = VERTEX_NONE;
+
+            unsigned int p = vertices_[v].parent;
+            while (p != VERTEX_NONE) {
+#if MICROHSM_ASSERTIONS == 1
+                MICROHSM_ASSERT(p < vertexCount_);
+                MICROHSM_ASSERT(vertices_[p].type == eSTATIC_STATE);
+#endif
+                data_[v].depth++;
+                // Increase `MICROHSM_MAX_DEPTH`, entry paths are limited to it (also ends cyclic hierarchies)
+                if (p >= vertexCount_ || data_[v].depth >= MICROHSM_MAX_DEPTH) return eTRANSITION_ERROR;
+                p = vertices_[p].parent;
+            }
+        }
+
+        // Attach history pseudostates to their states, assign slots and default histories
+        historyCount_ = 0;
+        for (unsigned int v = 0; v < vertexCount_; v++) {
+            const sStaticVertex* h = &vertices_[v];
+            if (h->type == eSTATIC_STATE) continue;
+
+#if MICROHSM_ASSERTIONS == 1
+            MICROHSM_ASSERT(h->parent != VERTEX_NONE);                      // History must belong to a state
+            MICROHSM_ASSERT(vertices_[h->parent].initial != VERTEX_NONE);   // History must belong to composite state
+#endif
+            unsigned int s = (h->initial == VERTEX_NONE) ? vertices_[h->parent].initial : h->initial;
+            if (h->type == eSTATIC_SHALLOW_HISTORY) {
+                data_[h->parent].shallow = v;
+            }
+            else {
+                data_[h->parent].deep = v;
+                // Walk down initial states until leaf state is reached
+                while (vertices_[s].initial != VERTEX_NONE) {
+                    s = vertices_[s].initial;
+                }
+            }
+            data_[v].slot = historyCount_++;
+            data_[v].history = s;
+        }
+
+        // Build transition chains
+        for (unsigned int t = 0; t < transitionCount_; t++) {
+#if MICROHSM_ASSERTIONS == 1
+            MICROHSM_ASSERT(transitions_[t].source < vertexCount_);
+            MICROHSM_ASSERT(transitions_[t].target < vertexCount_);
+            MICROHSM_ASSERT(transitions_[t].event < eventCount_);
+#endif
+            next_[t] = findTransition_(transitions_[t].source, transitions_[t].event, t + 1);
+        }
+
+        // Build dispatch table
+        for (unsigned int v = 0; v < vertexCount_; v++) {
+            for (unsigned int e = 0; e < eventCount_; e++) {
+                table_[(v * eventCount_) + e] = (vertices_[v].type == eSTATIC_STATE) ?
+                    findTransition_(v, e, 0) : VERTEX_NONE;
+            }
+        }
+        valid_ = true;
+        return eOK;
+    }
+
+    unsigned int BaseStaticDefinition::getHistoryCount(void) const
+    {
+        return historyCount_;
+    }
+
+    unsigned int BaseStaticDefinition::toID_(tStaticIndex s)
+    {
+        return (s == STATIC_INDEX_NONE) ? VERTEX_NONE : s;
+    }
+
+    void BaseStaticDefinition::start_(tStaticIndex& state, tStaticIndex* history, unsigned int slots, void* ctx)
+    {
+#if MICROHSM_ASSERTIONS == 1
+        MICROHSM_ASSERT(slots >= historyCount_);    // Instance has too few history slots
+#else
+        (void)slots;
+#endif
+        // Instances of a rejected definition stay inactive and ignore all events
+        state = STATIC_INDEX_NONE;
+        if (!valid_) return;
+
+        // Reset histories to their defaults
+        for (unsigned int v = 0; v < vertexCount_; v++) {
+            if (data_[v].slot != VERTEX_NONE) history[data_[v].slot] = static_cast<tStaticIndex>(data_[v].history);
+        }
+
+        // Enter initial state and walk down until the leaf initial state
+        this->enterState_(state, initial_, ctx);
+        this->enterInitialStates_(state, ctx);
+
+        // Handle any initial anonymous transitions
+        this->dispatch_(state, history, EVENT_ANONYMOUS, ctx);
+    }
+
+    eStatus BaseStaticDefinition::dispatch_(tStaticIndex& state, tStaticIndex* history, unsigned int event, void* ctx)
+    {
+        eStatus status = eTRANSITION_ERROR;
+
+        // Match event to state
+        unsigned int t = (event < eventCount_ && state != STATIC_INDEX_NONE) ? this->match_(state, event, ctx) : VERTEX_NONE;
+        if (t == VERTEX_NONE) {
+#if MICROHSM_TRACING == 1
+            MICROHSM_TRACE_DISPATCH_IGNORED(event);
+#endif
+            return eEVENT_IGNORED;
+        }
+
+#if MICROHSM_TRACING == 1
+        MICROHSM_TRACE_DISPATCH_MATCHED(event, transitions_[t].source);
+#endif
+
+        // Perform transition
+        status = this->performTransition_(state, history, &transitions_[t], ctx);
+        if (status != eOK) return status;
+
+        // Handle anonymous transitions repeatedly (Run-to-completion)
+        t = this->match_(state, EVENT_ANONYMOUS, ctx);
+        while (t != VERTEX_NONE) {
+#if MICROHSM_TRACING == 1
+            MICROHSM_TRACE_DISPATCH_MATCHED(EVENT_ANONYMOUS, transitions_[t].source);
+#endif
+            status = this->performTransition_(state, history, &transitions_[t], ctx);
+            if (status != eOK) return status;
+
+            t = this->match_(state, EVENT_ANONYMOUS, ctx);
+        }
+
+        return status;
+    }
+
+    bool BaseStaticDefinition::inState_(tStaticIndex state, unsigned int ID) const
+    {
+        unsigned int s = toID_(state);
+        while (s != VERTEX_NONE) {
+            if (s == ID) return true;
+            s = vertices_[s].parent;
+        }
+        return false;
+    }
+
+    unsigned int BaseStaticDefinition::getHistoryState_(const tStaticIndex* history, unsigned int ID) const
+    {
+#if MICROHSM_ASSERTIONS == 1
+        MICROHSM_ASSERT(ID < vertexCount_);
+        MICROHSM_ASSERT(vertices_[ID].type != eSTATIC_STATE);
+#endif
+        return toID_(history[data_[ID].slot]);
+    }
+
+    unsigned int BaseStaticDefinition::findTransition_(unsigned int state, unsigned int event, unsigned int start)
+    {
+        unsigned int s = state;
+        unsigned int first = start;
+        while (s != VERTEX_NONE) {
+            for (unsigned int t = first; t < transitionCount_; t++) {
+                if (transitions_[t].source == s && transitions_[t].event == event) return t;
+            }
+            // Continue with all transitions of parent
+            s = vertices_[s].parent;
+            first = 0;
+        }
+        return VERTEX_NONE;
+    }
+
+    unsigned int BaseStaticDefinition::match_(tStaticIndex state, unsigned int event, void* ctx) const
+    {
+        unsigned int t = table_[(state * eventCount_) + event];
+        while (t != VERTEX_NONE) {
+            fTransitionGuard guard = transitions_[t].guard;
+            if (guard == nullptr || guard(ctx)) break;
+            t = next_[t];
+        }
+        return t;
+    }
+
+    unsigned int BaseStaticDefinition::getTransitionTarget_(const tStaticIndex* history, unsigned int ID) const
+    {
+        if (vertices_[ID].type == eSTATIC_STATE) return ID;
+        return history[data_[ID].slot];
+    }
+
+    unsigned int BaseStaticDefinition::findLCA_(unsigned int a, unsigned int b) const
+    {
+        unsigned int s1 = a;
+        unsigned int s2 = b;
+
+        while (s1 != s2) {
+            // Move up from deepest state
+            if (s1 == VERTEX_NONE || s2 == VERTEX_NONE) return VERTEX_NONE;
+
+            if (data_[s1].depth > data_[s2].depth) {
+                s1 = vertices_[s1].parent;
+            }
+            else if (data_[s2].depth > data_[s1].depth) {
+                s2 = vertices_[s2].parent;
+            }
+            else {
+                s1 = vertices_[s1].parent;
+                s2 = vertices_[s2].parent;
+            }
+        }
+
+        return s1;
+    }
+
+    eStatus BaseStaticDefinition::performTransition_(tStaticIndex& state, tStaticIndex* history,
+            const sStaticTransition* t, void* ctx) const
+    {
+        // See `BaseHSM::performTransition_` for the steps taken
+        unsigned int source = t->source;
+        unsigned int target = this->getTransitionTarget_(history, t->target);
+
+        if (t->kind == eKIND_INTERNAL) {
+            if (t->effect != nullptr) t->effect(ctx);
+            return eOK;
+        }
+
+        source = this->exitUntilTarget_(state, source, ctx);
+#if MICROHSM_ASSERTIONS == 1
+        MICROHSM_ASSERT(source != VERTEX_NONE); // source state could not be reached
+#endif
+        unsigned int lca = this->findLCA_(source, target);
+        this->exitUntilTarget_(state, lca, ctx);
+
+        bool reenter = (t->kind == eKIND_EXTERNAL && lca == source);
+        if (reenter) this->exitState_(state, ctx);
+        if (t->effect != nullptr) t->effect(ctx);
+        if (reenter) this->enterState_(state, lca, ctx);
+
+        this->enterUntilTarget_(state, lca, target, ctx);
+        this->enterInitialStates_(state, ctx);
+        this->updateHistories_(history, state);
+        return eOK;
+    }
+
+    unsigned int BaseStaticDefinition::exitUntilTarget_(tStaticIndex& state, unsigned int target, void* ctx) const
+    {
+        unsigned int s = toID_(state);
+        while (s != VERTEX_NONE) {
+            if (s == target) break;
+            this->exitState_(state, ctx);
+            s = toID_(state);
+        }
+        return s;
+    }
+
+    void BaseStaticDefinition::enterUntilTarget_(tStaticIndex& state, unsigned int start, unsigned int target, void* ctx) const
+    {
+        // Create path from target to start
+        unsigned int path[MICROHSM_MAX_DEPTH];
+        unsigned int length = 0;
+        unsigned int s = target;
+        while (s != start) {
+#if MICROHSM_ASSERTIONS == 1
+            MICROHSM_ASSERT(length < MICROHSM_MAX_DEPTH);
+#endif
+            path[length++] = s;
+            s = vertices_[s].parent;
+        }
+
+        // Walk path in reverse and perform entries
+        while (length > 0) {
+            this->enterState_(state, path[--length], ctx);
+        }
+    }
+
+    void BaseStaticDefinition::enterInitialStates_(tStaticIndex& state, void* ctx) const
+    {
+        unsigned int s = state;
+        while (vertices_[s].initial != VERTEX_NONE) {
+            // Traverse initial states until reaching a 'leaf' state
+            s = vertices_[s].initial;
+            this->enterState_(state, s, ctx);
+        }
+    }
+
+    void BaseStaticDefinition::enterState_(tStaticIndex& state, unsigned int s, void* ctx) const
+    {
+        state = static_cast<tStaticIndex>(s);
+#if MICROHSM_TRACING == 1
+        MICROHSM_TRACE_ENTRY(s);
+#endif
+        if (vertices_[s].entry != nullptr) vertices_[s].entry(ctx);
+    }
+
+    void BaseStaticDefinition::exitState_(tStaticIndex& state, void* ctx) const
+    {
+        const unsigned int s = state;
+#if MICROHSM_TRACING == 1
+        MICROHSM_TRACE_EXIT(s);
+#endif
+        if (vertices_[s].exit != nullptr) vertices_[s].exit(ctx);
+        state = static_cast<tStaticIndex>(vertices_[s].parent);
+    }
+
+    void BaseStaticDefinition::updateHistories_(tStaticIndex* history, unsigned int s) const
+    {
+        // Update histories of ancestors
+        unsigned int child = s;
+        unsigned int p = vertices_[s].parent;
+        while (p != VERTEX_NONE) {
+            if (data_[p].deep != VERTEX_NONE) history[data_[data_[p].deep].slot] = static_cast<tStaticIndex>(s);
+            if (data_[p].shallow != VERTEX_NONE) history[data_[data_[p].shallow].slot] = static_cast<tStaticIndex>(child);
+            child = p;
+            p = vertices_[p].parent;
+        }
+    }
+
+    unsigned long BaseStaticDefinition::getSnapshotSize(unsigned int count) const
+    {
+        // Active leaf state and history slots of every instance
+        return STATIC_SNAPSHOT_HEADER_SIZE +
+            (static_cast<unsigned long>(count) * (1u + historyCount_) * sizeof(tStaticIndex));
+    }
+
+    bool BaseStaticDefinition::isLeafState_(unsigned int s) const
+    {
+        return s < vertexCount_ && vertices_[s].type == eSTATIC_STATE && vertices_[s].initial == VERTEX_NONE;
+    }
+
+    bool BaseStaticDefinition::isHistoryState_(unsigned int v, unsigned int s) const
+    {
+        if (s >= vertexCount_ || vertices_[s].type != eSTATIC_STATE) return false;
+
+        // Shallow histories store a substate, deep histories a leaf state below their state
+        if (vertices_[v].type == eSTATIC_SHALLOW_HISTORY) return vertices_[s].parent == vertices_[v].parent;
+        return vertices_[s].initial == VERTEX_NONE && this->inState_(static_cast<tStaticIndex>(s), vertices_[v].parent);
+    }
+
+    uint8_t* BaseStaticDefinition::writeSnapshotHeader_(uint8_t* buffer, unsigned int count) const
+    {
+        // Version, index width, vertex count (16 bits), history count (16 bits), instance count (32 bits)
+        const uint32_t fields[3] = {vertexCount_, historyCount_, count};
+        const unsigned int widths[3] = {2, 2, 4};
+        uint8_t* p = buffer;
+        *p++ = SNAPSHOT_VERSION;
+        *p++ = static_cast<uint8_t>(sizeof(tStaticIndex));
+        for (unsigned int f = 0; f < 3; f++) {
+            for (unsigned int b = 0; b < widths[f]; b++) {
+                *p++ = static_cast<uint8_t>(fields[f] >> (8u * b));
+            }
+        }
+        return p;
+    }
+
+    bool BaseStaticDefinition::verifySnapshot_(const uint8_t* buffer, unsigned long size, unsigned int count) const
+    {
+        if (size < this->getSnapshotSize(count)) return false;
+
+        uint8_t header[STATIC_SNAPSHOT_HEADER_SIZE];
+        this->writeSnapshotHeader_(header, count);
+        for (unsigned int b = 0; b < STATIC_SNAPSHOT_HEADER_SIZE; b++) {
+            if (buffer[b] != header[b]) return false;
+        }
+
+        const uint8_t* p = buffer + STATIC_SNAPSHOT_HEADER_SIZE;
+        for (unsigned int i = 0; i < count; i++) {
+            if (!this->isLeafState_(readIndex_(p))) return false;
+
+            const uint8_t* history = p;
+            for (unsigned int v = 0; v < vertexCount_; v++) {
+                if (data_[v].slot == VERTEX_NONE) continue;
+
+                const uint8_t* slot = history + (data_[v].slot * sizeof(tStaticIndex));
+                if (!this->isHistoryState_(v, readIndex_(slot))) return false;
+            }
+            p = history + (historyCount_ * sizeof(tStaticIndex));
+        }
+        return true;
+    }
+
+    uint8_t* BaseStaticDefinition::writeInstance_(uint8_t* p, tStaticIndex state, const tStaticIndex* history) const
+    {
+        p = writeIndex_(p, state);
+        for (unsigned int h = 0; h < historyCount_; h++) {
+            p = writeIndex_(p, history[h]);
+        }
+        return p;
+    }
+
+    const uint8_t* BaseStaticDefinition::readInstance_(const uint8_t* p, tStaticIndex& state, tStaticIndex* history) const
+    {
+        state = readIndex_(p);
+        for (unsigned int h = 0; h < historyCount_; h++) {
+            history[h] = readIndex_(p);
+        }
+        return p;
+    }
+
+    BaseStaticHSM::BaseStaticHSM(const sStaticVertex* vertices, unsigned int vertexCount,
+            const sStaticTransition* transitions, unsigned int transitionCount,
+            unsigned int eventCount, unsigned int initial,
+            unsigned int* table, unsigned int* next, sStaticVertexData* data,
+            tStaticIndex* history) :
+        definition_(vertices, vertexCount, transitions, transitionCount, eventCount, initial, table, next, data),
+        history_(history),
+        slots_(vertexCount),
+        curState_(static_cast<tStaticIndex>(initial))
+    {
+    }
+
+    eStatus BaseStaticHSM::init(void* ctx)
+    {
+        const eStatus status = definition_.init();
+        definition_.start_(curState_, history_, slots_, ctx);
+        return status;
+    }
+
+    eStatus BaseStaticHSM::dispatch(unsigned int event, void* ctx)
+    {
+        return definition_.dispatch_(curState_, history_, event, ctx);
+    }
+
+    unsigned int BaseStaticHSM::getCurrentState()
+    {
+        return BaseStaticDefinition::toID_(curState_);
+    }
+
+    bool BaseStaticHSM::inState(unsigned int ID)
+    {
+        return definition_.inState_(curState_, ID);
+    }
+
+    unsigned int BaseStaticHSM::getHistoryState(unsigned int ID)
+    {
+        return definition_.getHistoryState_(history_, ID);
+    }
+}
@@ -0,0 +1,235 @@
+/**
+ * @file TimerService.cpp
+ * @brief Time events on a hierarchical timing wheel
+ *
+ * @author Jelle Meijer
+ * @date 2025-05-23
+ */
+
+#include <microhsm/microhsm.hpp>
+
+/// Mask of the index bits of a timer handle
+#define TIMER_INDEX_MASK_ ((1u << TIMER_INDEX_BITS) - 1u)
+
+namespace microhsm
+{
+    BaseTimerService::BaseTimerService(sTimer* timers, sTimerScope* scopes, uint32_t* slots, uint32_t count) :
+        timers_(timers),
+        scopes_(scopes),
+        slots_(slots),
+        count_(count),
+        free_(0),
+        now_(0),
+        armed_(0),
+        failed_(0)
+    {
+#if MICROHSM_ASSERTIONS == 1
+        MICROHSM_ASSERT(count > 0 && count <= TIMER_MAX_COUNT);
+#endif
+        for (uint32_t i = 0; i < count; i++) {
+            this->timers_[i].next = (i + 1 < count) ? i + 1 : TIMER_INDEX_NONE;
+            this->timers_[i].target = nullptr;
+            this->timers_[i].generation = 0;
+        }
+        for (unsigned int i = 0; i < TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS; i++) {
+            this->slots_[i] = TIMER_INDEX_NONE;
+        }
+    }
+
+    tTimerHandle BaseTimerService::arm(TimerTarget& target, unsigned int event, uint32_t delay, uint32_t period)
+    {
+        return this->armScoped_(target, TIMER_STATE_NONE, event, delay, period);
+    }
+
+    tTimerHandle BaseTimerService::armScoped_(TimerTarget& target, uint16_t state, unsigned int event, uint32_t delay, uint32_t period)
+    {
+        const uint32_t index = this->free_;
+        if (index == TIMER_INDEX_NONE) return TIMER_HANDLE_NONE;
+
+        sTimer* timer = &this->timers_[index];
+        this->free_ = timer->next;
+        timer->expiry = this->now_ + ((delay > 0) ? delay : 1);
+        timer->period = period;
+        timer->target = &target;
+        timer->event = event;
+        timer->state = state;
+        this->place_(index);
+        this->armed_++;
+
+        if (state != TIMER_STATE_NONE) {
+            // Link into scoped timers of HSM, only HSMs arm scoped timers
+            BaseHSM& hsm = static_cast<BaseHSM&>(target);
+            this->scopes_[index].prev = TIMER_INDEX_NONE;
+            this->scopes_[index].next = hsm.scopedTimers_;
+            if (hsm.scopedTimers_ != TIMER_INDEX_NONE) this->scopes_[hsm.scopedTimers_].prev = index;
+            hsm.scopedTimers_ = index;
+        }
+        return (static_cast<uint32_t>(timer->generation) << TIMER_INDEX_BITS) | index;
+    }
+
+    bool BaseTimerService::disarm(tTimerHandle handle)
+    {
+        if (!this->isArmed(handle)) return false;
+        this->release_(handle & TIMER_INDEX_MASK_);
+        return true;
+    }
+
+    bool BaseTimerService::isArmed(tTimerHandle handle) const
+    {
+        const uint32_t index = handle & TIMER_INDEX_MASK_;
+        if (index >= this->count_) return false;
+        const sTimer* timer = &this->timers_[index];
+        // Handle of a released timer has an older generation
+        return timer->target != nullptr && (handle >> TIMER_INDEX_BITS) == timer->generation;
+    }
+
+    void BaseTimerService::disarmScoped_(BaseHSM& hsm, uint16_t state)
+    {
+        uint32_t index = hsm.scopedTimers_;
+        while (index != TIMER_INDEX_NONE) {
+            const uint32_t next = this->scopes_[index].next;
+            if (state == TIMER_STATE_NONE || this->timers_[index].state == state) this->release_(index);
+            index = next;
+        }
+    }
+
+    unsigned int BaseTimerService::tick(void)
+    {
+        this->now_++;
+
+        // Move timers of reached slots of higher levels down, starting at the highest level
+        unsigned int levels = 1;
+        while (levels < TIMER_WHEEL_LEVELS &&
+                ((this->now_ >> (TIMER_WHEEL_BITS * levels)) << (TIMER_WHEEL_BITS * levels)) == this->now_) {
+            levels++;
+        }
+        for (unsigned int level = levels - 1; level > 0; level--) {
+            this->cascade_(level);
+        }
+
+        // Every timer of the reached slot of the lowest level has expired. Timers are taken from the slot
+        // one at a time, such that targets can disarm any timer (including the current one) during delivery.
+        // Timers placed again never land in this slot, their delay is at least one tick.
+        const unsigned int slot = this->now_ & (TIMER_WHEEL_SLOTS - 1);
+        unsigned int expired = 0;
+        while (this->slots_[slot] != TIMER_INDEX_NONE) {
+            const uint32_t index = this->slots_[slot];
+            sTimer* timer = &this->timers_[index];
+            this->unplace_(index);
+            timer->next = TIMER_INDEX_NONE;
+
+            if (timer->expiry != this->now_) {
+                // Delay exceeded the range of the wheel
+                this->place_(index);
+                continue;
+            }
+            const uint8_t generation = timer->generation;
+            if (!timer->target->deliverTimeout(timer->event)) this->failed_++;
+            expired++;
+            // Timer was disarmed (and possibly armed again) by the target
+            if (timer->generation != generation) continue;
+            if (timer->period > 0) {
+                timer->expiry = this->now_ + timer->period;
+                this->place_(index);
+            }
+            else {
+                this->recycle_(index);
+            }
+        }
+        return expired;
+    }
+
+    unsigned long BaseTimerService::advance(uint32_t ticks)
+    {
+        unsigned long expired = 0;
+        for (uint32_t i = 0; i < ticks; i++) {
+            expired += this->tick();
+        }
+        return expired;
+    }
+
+    uint32_t BaseTimerService::getNow(void) const
+    {
+        return this->now_;
+    }
+
+    uint32_t BaseTimerService::getArmedCount(void) const
+    {
+        return this->armed_;
+    }
+
+    unsigned long BaseTimerService::getFailed(void) const
+    {
+        return this->failed_;
+    }
+
+    void BaseTimerService::place_(uint32_t index)
+    {
+        sTimer* timer = &this->timers_[index];
+        uint32_t delta = timer->expiry - this->now_;
+        uint32_t expiry = timer->expiry;
+        if (delta > TIMER_WHEEL_RANGE) {
+            // Park at the end of the wheel, placed again once reached
+            delta = TIMER_WHEEL_RANGE;
+            expiry = this->now_ + TIMER_WHEEL_RANGE;
+        }
+
+        // Lowest level whose range covers the delay
+        unsigned int level = 0;
+        while (level + 1 < TIMER_WHEEL_LEVELS && delta >= (1ul << (TIMER_WHEEL_BITS * (level + 1)))) {
+            level++;
+        }
+        const unsigned int slot = (level * TIMER_WHEEL_SLOTS) +
+            ((expiry >> (TIMER_WHEEL_BITS * level)) & (TIMER_WHEEL_SLOTS - 1));
+
+        timer->slot = static_cast<uint8_t>(slot);
+        timer->prev = TIMER_INDEX_NONE;
+        timer->next = this->slots_[slot];
+        if (timer->next != TIMER_INDEX_NONE) this->timers_[timer->next].prev = index;
+        this->slots_[slot] = index;
+    }
+
+    void BaseTimerService::unplace_(uint32_t index)
+    {
+        sTimer* timer = &this->timers_[index];
+        if (timer->prev != TIMER_INDEX_NONE) this->timers_[timer->prev].next = timer->next;
+        else if (this->slots_[timer->slot] == index) this->slots_[timer->slot] = timer->next;
+        if (timer->next != TIMER_INDEX_NONE) this->timers_[timer->next].prev = timer->prev;
+    }
+
+    void BaseTimerService::release_(uint32_t index)
+    {
+        this->unplace_(index);
+        this->recycle_(index);
+    }
+
+    void BaseTimerService::recycle_(uint32_t index)
+    {
+        sTimer* timer = &this->timers_[index];
+        if (timer->state != TIMER_STATE_NONE) {
+            const sTimerScope* scope = &this->scopes_[index];
+            if (scope->prev != TIMER_INDEX_NONE) this->scopes_[scope->prev].next = scope->next;
+            else static_cast<BaseHSM*>(timer->target)->scopedTimers_ = scope->next;
+            if (scope->next != TIMER_INDEX_NONE) this->scopes_[scope->next].prev = scope->prev;
+        }
+
+        timer->target = nullptr;
+        timer->generation++;
+        timer->next = this->free_;
+        this->free_ = index;
+        this->armed_--;
+    }
+
+    void BaseTimerService::cascade_(unsigned int level)
+    {
+        const unsigned int slot = (level * TIMER_WHEEL_SLOTS) +
+            ((this->now_ >> (TIMER_WHEEL_BITS * level)) & (TIMER_WHEEL_SLOTS - 1));
+        uint32_t index = this->slots_[slot];
+        this->slots_[slot] = TIMER_INDEX_NONE;
+        while (index != TIMER_INDEX_NONE) {
+            const uint32_t next = this->timers_[index].next;
+            this->place_(index);
+            index = next;
+        }
+    }
+}
@@ -12,9 +12,18 @@ namespace microhsm
 {
 
     Vertex::Vertex(unsigned int id, eType type):
-        ID(id),
-        TYPE(type)
+        ID(static_cast<tVertexID>(id)),
+        TYPE(type),
+        validID_(id <= VERTEX_ID_MAX)
     {
+#if MICROHSM_ASSERTIONS == 1
+        MICROHSM_ASSERT(id <= VERTEX_ID_MAX);   // ID does not fit into `MICROHSM_INDEX_TYPE`
+#endif
+    }
+
+    bool Vertex::hasValidID() const
+    {
+        return this->validID_;
     }
 
 }
@@ -0,0 +1,39 @@
+/**
+ * @file ActiveHSM.cpp
+ * @brief Test HSM executed as active object
+ */
+
+#include <active/ActiveHSM.hpp>
+
+namespace microhsm_tests
+{
+    HSMDefinition ActiveHSM::definition;
+
+    static void count(void* ctx)
+    {
+        sActiveCTX* c = static_cast<sActiveCTX*>(ctx);
+        if (c->running.exchange(true)) c->overlaps++;
+        c->count++;
+        c->running.store(false);
+    }
+
+    static void echo(void* ctx)
+    {
+        sActiveCTX* c = static_cast<sActiveCTX*>(ctx);
+        if (c->echo != nullptr) c->echo->post(eAEVENT_COUNT);
+    }
+
+    HSM_DEFINE_STATE_MATCH(AStateCounting)
+    {
+        (void)ctx;
+        switch(event) {
+            case eAEVENT_COUNT:
+                return transitionInternal(t, count);
+            case eAEVENT_ECHO:
+                return transitionInternal(t, echo);
+            default:
+                break;
+        }
+        return noTransition();
+    }
+}
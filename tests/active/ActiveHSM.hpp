@@ -0,0 +1,55 @@
+/**
+ * @file ActiveHSM.hpp
+ * @brief Test HSM executed as active object
+ */
+#ifndef _H_MICROHSM_TESTS_ACTIVEHSM
+#define _H_MICROHSM_TESTS_ACTIVEHSM
+
+#include <atomic>
+
+#include <microhsm/microhsm.hpp>
+#include <microhsm/macros.hpp>
+
+using namespace microhsm;
+
+namespace microhsm_tests
+{
+    /// @brief Event enumerations
+    HSM_CREATE_EVENT_LIST(e_aevents,
+            eAEVENT_COUNT,
+            eAEVENT_ECHO
+    )
+
+    HSM_CREATE_VERTEX_LIST(e_astates,
+            eASTATE_COUNTING = 70
+    )
+
+    /// @brief Context counting events and detecting overlapping run-to-completion steps
+    typedef struct {
+        std::atomic<bool> running;
+        unsigned int count;
+        unsigned int overlaps;
+        BaseHSM* echo;              ///< HSM posted a count event on every echo event (`nullptr` if not echoing)
+    } sActiveCTX;
+
+    /* State Declarations */
+    HSM_DECLARE_STATE_TOP_LEVEL(AStateCounting, eASTATE_COUNTING)
+
+    /* HSM Declaration */
+    class ActiveHSM : public BaseHSM
+    {
+    public:
+
+        /// Structure shared by all instances
+        static HSMDefinition definition;
+
+        ActiveHSM() : BaseHSM(state_counting, definition)
+        {
+            this->registerVertices({&state_counting});
+        };
+
+        AStateCounting state_counting = AStateCounting(nullptr);
+    };
+}
+
+#endif
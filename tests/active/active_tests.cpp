@@ -0,0 +1,203 @@
+#include <unity.h>
+
+#include <thread>
+
+#include <active/active_tests.hpp>
+#include <active/ActiveHSM.hpp>
+
+namespace microhsm_tests
+{
+    /// Objects, workers and producers of the threaded test
+    static const unsigned int ACTIVE_OBJECTS = 16;
+    static const unsigned int ACTIVE_WORKERS = 4;
+    static const unsigned int ACTIVE_PRODUCERS = 2;
+    static const unsigned int ACTIVE_EVENTS = 2000;
+
+    /// HSM with mailbox and active object
+    struct sActiveTestObject {
+        sActiveTestObject() : object(hsm, mailbox, &ctx) {};
+
+        ActiveHSM hsm;
+        MPSCEventQueue<64> mailbox;
+        sActiveCTX ctx;
+        ActiveObject object;
+    };
+
+    static sActiveTestObject activeObjects[ACTIVE_OBJECTS];
+
+    static void setupActive(unsigned int count)
+    {
+        for (unsigned int i = 0; i < count; i++) {
+            activeObjects[i].ctx.running.store(false);
+            activeObjects[i].ctx.count = 0;
+            activeObjects[i].ctx.overlaps = 0;
+            activeObjects[i].ctx.echo = nullptr;
+            TEST_ASSERT_EQUAL(eOK, activeObjects[i].hsm.init(&activeObjects[i].ctx));
+        }
+    }
+
+    void atest_deque()
+    {
+        WorkStealingDeque<4> deque;
+        unsigned int value = 0;
+
+        TEST_ASSERT_FALSE(deque.pop(value));
+        TEST_ASSERT_FALSE(deque.steal(value));
+        for (unsigned int i = 0; i < 4; i++) TEST_ASSERT_TRUE(deque.push(i));
+        TEST_ASSERT_FALSE(deque.push(4));
+        TEST_ASSERT_EQUAL(4, deque.size());
+
+        // Owner pops newest, thieves steal oldest
+        TEST_ASSERT_TRUE(deque.pop(value));
+        TEST_ASSERT_EQUAL(3, value);
+        TEST_ASSERT_TRUE(deque.steal(value));
+        TEST_ASSERT_EQUAL(0, value);
+        TEST_ASSERT_TRUE(deque.steal(value));
+        TEST_ASSERT_EQUAL(1, value);
+        TEST_ASSERT_TRUE(deque.pop(value));
+        TEST_ASSERT_EQUAL(2, value);
+        TEST_ASSERT_EQUAL(0, deque.size());
+    }
+
+    void atest_scheduling()
+    {
+        setupActive(4);
+        ActiveRuntime<2, 4> runtime;
+        ActiveObject& a = activeObjects[0].object;
+        ActiveObject& b = activeObjects[1].object;
+        ActiveObject& c = activeObjects[2].object;
+
+        ActiveObject unused(activeObjects[3].hsm, activeObjects[3].mailbox, &activeObjects[3].ctx);
+        TEST_ASSERT_FALSE(unused.post(eAEVENT_COUNT));  // Not added to a runtime
+        TEST_ASSERT_TRUE(runtime.add(a));           // Home worker 0
+        TEST_ASSERT_TRUE(runtime.add(b));           // Home worker 1
+        TEST_ASSERT_TRUE(runtime.add(c));           // Home worker 0
+
+        for (unsigned int i = 0; i < MICROHSM_QUEUE_BATCH_SIZE + 1; i++) TEST_ASSERT_TRUE(a.post(eAEVENT_COUNT));
+        TEST_ASSERT_TRUE(c.post(eAEVENT_COUNT));
+        TEST_ASSERT_TRUE(b.post(eAEVENT_COUNT));
+        TEST_ASSERT_EQUAL(2, runtime.getStats(0).depth);
+
+        // Worker 0 runs c (newest), then one batch of a, which stays runnable
+        TEST_ASSERT_TRUE(runtime.runOnce(0));
+        TEST_ASSERT_EQUAL(1, activeObjects[2].ctx.count);
+        TEST_ASSERT_TRUE(runtime.runOnce(0));
+        TEST_ASSERT_EQUAL(MICROHSM_QUEUE_BATCH_SIZE, activeObjects[0].ctx.count);
+
+        // Worker 1 runs b, then steals a from worker 0
+        TEST_ASSERT_TRUE(runtime.runOnce(1));
+        TEST_ASSERT_EQUAL(1, activeObjects[1].ctx.count);
+        TEST_ASSERT_TRUE(runtime.runOnce(1));
+        TEST_ASSERT_EQUAL(MICROHSM_QUEUE_BATCH_SIZE + 1, activeObjects[0].ctx.count);
+        TEST_ASSERT_EQUAL(1, runtime.getStats(1).steals);
+
+        // Idle
+        TEST_ASSERT_FALSE(runtime.runOnce(0));
+        TEST_ASSERT_FALSE(runtime.runOnce(1));
+        sWorkerStats total = runtime.getTotalStats();
+        TEST_ASSERT_EQUAL(4, total.runs);
+        TEST_ASSERT_EQUAL(MICROHSM_QUEUE_BATCH_SIZE + 3, total.dispatched);
+        TEST_ASSERT_EQUAL(0, total.depth);
+    }
+
+    void atest_threads()
+    {
+        setupActive(ACTIVE_OBJECTS);
+        static ActiveRuntime<ACTIVE_WORKERS, ACTIVE_OBJECTS> runtime;
+        for (unsigned int i = 0; i < ACTIVE_OBJECTS; i++) {
+            TEST_ASSERT_TRUE(runtime.add(activeObjects[i].object));
+        }
+
+        std::atomic<bool> stop(false);
+        std::thread workers[ACTIVE_WORKERS];
+        for (unsigned int w = 0; w < ACTIVE_WORKERS; w++) {
+            workers[w] = std::thread([w, &stop]() {runtime.runWorker(w, stop);});
+        }
+        std::thread producers[ACTIVE_PRODUCERS];
+        for (unsigned int p = 0; p < ACTIVE_PRODUCERS; p++) {
+            producers[p] = std::thread([]() {
+                for (unsigned int i = 0; i < ACTIVE_EVENTS; i++) {
+                    activeObjects[i % ACTIVE_OBJECTS].object.post(eAEVENT_COUNT);
+                }
+            });
+        }
+        for (unsigned int p = 0; p < ACTIVE_PRODUCERS; p++) producers[p].join();
+
+        // Wait until all events are dispatched
+        while (runtime.getTotalStats().dispatched < ACTIVE_PRODUCERS * ACTIVE_EVENTS) std::this_thread::yield();
+        stop.store(true);
+        for (unsigned int w = 0; w < ACTIVE_WORKERS; w++) workers[w].join();
+
+        for (unsigned int i = 0; i < ACTIVE_OBJECTS; i++) {
+            TEST_ASSERT_EQUAL(ACTIVE_PRODUCERS * ACTIVE_EVENTS / ACTIVE_OBJECTS, activeObjects[i].ctx.count);
+            TEST_ASSERT_EQUAL(0, activeObjects[i].ctx.overlaps);
+        }
+        TEST_ASSERT_EQUAL(0, runtime.getTotalStats().depth);
+    }
+
+    void atest_timers()
+    {
+        setupActive(2);
+        ActiveRuntime<1, 2> runtime;
+        TEST_ASSERT_TRUE(runtime.add(activeObjects[0].object));
+        TEST_ASSERT_TRUE(runtime.add(activeObjects[1].object));
+        TimerService<4> timers;
+
+        // Timers targeting the object and its HSM both schedule the object
+        TEST_ASSERT_NOT_EQUAL(TIMER_HANDLE_NONE, timers.arm(activeObjects[0].object, eAEVENT_COUNT, 2));
+        TEST_ASSERT_NOT_EQUAL(TIMER_HANDLE_NONE, timers.arm(activeObjects[1].hsm, eAEVENT_COUNT, 2));
+        TEST_ASSERT_FALSE(runtime.runOnce(0));
+        TEST_ASSERT_EQUAL(2, timers.advance(2));
+        TEST_ASSERT_TRUE(runtime.runOnce(0));
+        TEST_ASSERT_TRUE(runtime.runOnce(0));
+        TEST_ASSERT_FALSE(runtime.runOnce(0));
+        TEST_ASSERT_EQUAL(1, activeObjects[0].ctx.count);
+        TEST_ASSERT_EQUAL(1, activeObjects[1].ctx.count);
+        TEST_ASSERT_EQUAL(0, timers.getFailed());
+
+        // Event posted by the HSM to itself during its run-to-completion step
+        activeObjects[0].ctx.echo = &activeObjects[0].hsm;
+        TEST_ASSERT_TRUE(activeObjects[0].object.post(eAEVENT_ECHO));
+        TEST_ASSERT_TRUE(runtime.runOnce(0));
+        TEST_ASSERT_TRUE(runtime.runOnce(0));
+        TEST_ASSERT_EQUAL(2, activeObjects[0].ctx.count);
+        activeObjects[0].ctx.echo = nullptr;
+    }
+
+    void atest_payload()
+    {
+        setupActive(1);
+        ActiveRuntime<1, 1> runtime;
+        TEST_ASSERT_TRUE(runtime.add(activeObjects[0].object));
+        PayloadQueue<16> payloads;
+        activeObjects[0].hsm.attachPayloadQueue(&payloads);
+
+        // Event with payload schedules the idle object
+        TEST_ASSERT_TRUE(activeObjects[0].hsm.post(Event(eAEVENT_COUNT, 1)));
+        TEST_ASSERT_TRUE(runtime.runOnce(0));
+        TEST_ASSERT_EQUAL(1, activeObjects[0].ctx.count);
+        TEST_ASSERT_FALSE(runtime.runOnce(0));
+
+        // Object stays runnable until the mailbox and the payload queue are drained
+        for (unsigned int i = 0; i < MICROHSM_QUEUE_BATCH_SIZE + 1; i++) {
+            TEST_ASSERT_TRUE(activeObjects[0].hsm.post(Event(eAEVENT_COUNT, i)));
+        }
+        TEST_ASSERT_TRUE(activeObjects[0].object.post(eAEVENT_COUNT));
+        TEST_ASSERT_TRUE(runtime.runOnce(0));
+        TEST_ASSERT_EQUAL(MICROHSM_QUEUE_BATCH_SIZE + 2, activeObjects[0].ctx.count);
+        TEST_ASSERT_TRUE(runtime.runOnce(0));
+        TEST_ASSERT_EQUAL(MICROHSM_QUEUE_BATCH_SIZE + 3, activeObjects[0].ctx.count);
+        TEST_ASSERT_FALSE(runtime.runOnce(0));
+        TEST_ASSERT_EQUAL(MICROHSM_QUEUE_BATCH_SIZE + 3, runtime.getTotalStats().dispatched);
+        activeObjects[0].hsm.attachPayloadQueue(nullptr);
+    }
+
+    void run_active_tests(void)
+    {
+        RUN_TEST(atest_deque);
+        RUN_TEST(atest_scheduling);
+        RUN_TEST(atest_timers);
+        RUN_TEST(atest_payload);
+        RUN_TEST(atest_threads);
+    }
+}
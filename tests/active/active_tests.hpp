@@ -0,0 +1,9 @@
+#ifndef _H_MICROHSM_TESTS_ACTIVE_TESTS
+#define _H_MICROHSM_TESTS_ACTIVE_TESTS
+
+namespace microhsm_tests
+{
+    void run_active_tests(void);
+}
+
+#endif
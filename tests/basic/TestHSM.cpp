@@ -15,12 +15,13 @@ namespace microhsm_tests
 
     Vertex* TestHSM::getVertex(unsigned int ID)
     {
+        if (ID >= eSTATE_COUNT) return nullptr;
         return this->vertices[ID];
     }
 
     unsigned int TestHSM::getMaxID()
     {
-        return eSTATE_COUNT;
+        return eSTATE_COUNT - 1;
     }
 
     unsigned int TestState::getEntryCount()
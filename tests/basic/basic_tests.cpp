@@ -16,7 +16,7 @@ namespace microhsm_tests
     {
         MICROHSM_TEST_MESSAGE("Initializing regular test HSM")
         testCTX.init();
-        testHSM.init(static_cast<void*>(&testCTX));
+        TEST_ASSERT_EQUAL(eOK, testHSM.init(static_cast<void*>(&testCTX)));
         MICROHSM_TEST_MESSAGE("Initialized")
     }
 
@@ -459,11 +459,50 @@ namespace microhsm_tests
     }
 
     // Test functions
+    void test_in_any_state()
+    {
+        setupTest();
+        const unsigned int idsS[] = {eSTATE_U, eSTATE_S};
+        const unsigned int idsS2[] = {eSTATE_S21, eSTATE_S22, eSTATE_S2};
+        TEST_ASSERT_TRUE(testHSM.inAnyState(idsS, 2));
+        TEST_ASSERT_FALSE(testHSM.inAnyState(idsS, 1));
+        TEST_ASSERT_FALSE(testHSM.inAnyState(idsS2, 3));
+        TEST_ASSERT_FALSE(testHSM.inAnyState(idsS, 0));
+
+        // C: S1 -> S2 (S21)
+        testHSM.dispatch(eEVENT_C, &testCTX);
+        TEST_ASSERT_TRUE(testHSM.inAnyState(idsS2, 1));
+        TEST_ASSERT_TRUE(testHSM.inAnyState(idsS2, 3));
+
+        // Unknown IDs are never active
+        const unsigned int unknown[] = {eSTATE_COUNT, 1000};
+        TEST_ASSERT_FALSE(testHSM.inAnyState(unknown, 2));
+        TEST_ASSERT_FALSE(testHSM.inState(1000));
+    }
+
+    void test_state_ancestry()
+    {
+        setupTest();
+        // Compare numbering against walking parents for every pair of states
+        for (unsigned int a = 0; a < eSTATE_COUNT; a++) {
+            BaseState* sa = static_cast<BaseState*>(testHSM.getVertex(a));
+            for (unsigned int b = 0; b < eSTATE_COUNT; b++) {
+                BaseState* ancestor = sa->parent;
+                while (ancestor != nullptr && ancestor->ID != b) ancestor = ancestor->parent;
+
+                TEST_ASSERT_EQUAL(ancestor != nullptr || a == b, sa->isDescendentOf(b));
+                TEST_ASSERT_EQUAL_PTR(ancestor, sa->getAncestor(b));
+            }
+        }
+    }
+
     void run_basic_tests(void)
     {
         RUN_TEST(test_initial_configuration);
         RUN_TEST(test_anonymous_transitions);
         RUN_TEST(test_state_functions);
+        RUN_TEST(test_in_any_state);
+        RUN_TEST(test_state_ancestry);
         RUN_TEST(test_transition_a);
         RUN_TEST(test_transition_b);
         RUN_TEST(test_transition_c);
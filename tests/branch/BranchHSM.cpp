@@ -0,0 +1,133 @@
+/**
+ * @file BranchHSM.cpp
+ * @brief Test HSM with choice and junction pseudostates
+ */
+
+#include <branch/BranchHSM.hpp>
+
+namespace microhsm_tests
+{
+    HSMDefinition BranchHSM::definition;
+
+    static void logBranch(void* ctx, unsigned int entry)
+    {
+        sBranchCTX* c = static_cast<sBranchCTX*>(ctx);
+        if (c->count < 32) c->log[c->count++] = entry;
+    }
+
+    static void computeLevel(void* ctx)
+    {
+        sBranchCTX* c = static_cast<sBranchCTX*>(ctx);
+        c->level = c->input * 2;
+        logBranch(ctx, eBSTATE_LEVEL | BRANCH_EFFECT);
+    }
+
+    static void effectHigh(void* ctx)
+    {
+        logBranch(ctx, eBSTATE_HIGH | BRANCH_EFFECT);
+    }
+
+    static void effectRange(void* ctx)
+    {
+        logBranch(ctx, eBSTATE_RANGE | BRANCH_EFFECT);
+    }
+
+    static void effectIdle(void* ctx)
+    {
+        logBranch(ctx, eBSTATE_IDLE | BRANCH_EFFECT);
+    }
+
+    static void countFallback(void* ctx)
+    {
+        static_cast<sBranchCTX*>(ctx)->fallbacks++;
+    }
+
+    void clearBranchLog(sBranchCTX& ctx)
+    {
+        ctx.count = 0;
+    }
+
+    HSM_DEFINE_STATE_ENTRY(BBaseState)
+    {
+        logBranch(ctx, this->ID);
+    }
+
+    HSM_DEFINE_STATE_EXIT(BBaseState)
+    {
+        logBranch(ctx, this->ID | BRANCH_EXIT);
+    }
+
+    HSM_DEFINE_STATE_MATCH(BStateIdle)
+    {
+        (void)ctx;
+        switch (event) {
+            case eBEVENT_GO:
+                return transitionExternal(eBSTATE_LEVEL, t, computeLevel);
+            case eBEVENT_FAIL:
+                return transitionExternal(eBSTATE_BROKEN, t, nullptr);
+            default:
+                break;
+        }
+        return noTransition();
+    }
+
+    HSM_DEFINE_STATE_MATCH(BStateActive)
+    {
+        (void)ctx;
+        switch (event) {
+            case eBEVENT_GO:
+                return transitionExternal(eBSTATE_IDLE, t, nullptr);
+            case eBEVENT_CHECK:
+                return transitionInternal(t, countFallback);
+            case eBEVENT_LOST:
+                return transitionExternal(eBSTATE_UNKNOWN, t, nullptr);
+            default:
+                break;
+        }
+        return noTransition();
+    }
+
+    HSM_DEFINE_STATE_MATCH(BStateLow)
+    {
+        (void)ctx;
+        (void)event;
+        (void)t;
+        return noTransition();
+    }
+
+    HSM_DEFINE_STATE_MATCH(BStateHigh)
+    {
+        (void)ctx;
+        if (event == eBEVENT_CHECK) return transitionExternal(eBSTATE_LIMIT, t, nullptr);
+        return noTransition();
+    }
+
+    bool BChoiceLevel::select(sTransition* t, void* ctx)
+    {
+        logBranch(ctx, this->ID | BRANCH_GUARD);
+        if (static_cast<sBranchCTX*>(ctx)->level == 0) return branch(eBSTATE_UNKNOWN, t, nullptr);
+        if (static_cast<sBranchCTX*>(ctx)->level > 10) return branch(eBSTATE_HIGH, t, effectHigh);
+        return branch(eBSTATE_LOW, t, nullptr);
+    }
+
+    bool BJunctionLimit::select(sTransition* t, void* ctx)
+    {
+        logBranch(ctx, this->ID | BRANCH_GUARD);
+        if (static_cast<sBranchCTX*>(ctx)->level > 20) return branch(eBSTATE_RANGE, t, effectRange);
+        return noBranch();
+    }
+
+    bool BJunctionRange::select(sTransition* t, void* ctx)
+    {
+        logBranch(ctx, this->ID | BRANCH_GUARD);
+        if (static_cast<sBranchCTX*>(ctx)->level > 30) return branch(eBSTATE_IDLE, t, effectIdle);
+        return branch(eBSTATE_LEVEL, t, nullptr);
+    }
+
+    bool BChoiceBroken::select(sTransition* t, void* ctx)
+    {
+        (void)t;
+        logBranch(ctx, this->ID | BRANCH_GUARD);
+        return noBranch();
+    }
+}
@@ -0,0 +1,140 @@
+/**
+ * @file BranchHSM.hpp
+ * @brief Test HSM with choice and junction pseudostates
+ */
+#ifndef _H_MICROHSM_TESTS_BRANCHHSM
+#define _H_MICROHSM_TESTS_BRANCHHSM
+
+#include <microhsm/microhsm.hpp>
+#include <microhsm/macros.hpp>
+
+using namespace microhsm;
+
+namespace microhsm_tests
+{
+    /// Exits are logged as the ID of the state with this flag set
+    static const unsigned int BRANCH_EXIT = 0x100;
+    /// Guard evaluations are logged as the ID of the pseudostate with this flag set
+    static const unsigned int BRANCH_GUARD = 0x200;
+    /// Effects are logged as the ID of the target with this flag set
+    static const unsigned int BRANCH_EFFECT = 0x400;
+
+    /// @brief Event enumerations
+    HSM_CREATE_EVENT_LIST(e_bevents,
+            eBEVENT_GO,
+            eBEVENT_CHECK,
+            eBEVENT_FAIL,
+            eBEVENT_LOST
+    )
+
+    HSM_CREATE_VERTEX_LIST(e_bstates,
+            eBSTATE_IDLE = 100,
+            eBSTATE_ACTIVE,
+            eBSTATE_LOW,
+            eBSTATE_HIGH,
+            eBSTATE_LEVEL,      // Choice
+            eBSTATE_LIMIT,      // Junction
+            eBSTATE_RANGE,      // Junction
+            eBSTATE_BROKEN,     // Choice without enabled branch
+            eBSTATE_UNKNOWN     // Not a vertex of the HSM
+    )
+
+    /// @brief Context logging entries, exits, guards and effects
+    typedef struct {
+        unsigned int log[32];
+        unsigned int count;
+        unsigned int input;         ///< Input of the `eBEVENT_GO` effect
+        unsigned int level;         ///< Computed by the `eBEVENT_GO` effect, inspected by guards
+        unsigned int fallbacks;     ///< Events handled by `eBSTATE_ACTIVE`
+    } sBranchCTX;
+
+    /// @brief Clear log of context
+    void clearBranchLog(sBranchCTX& ctx);
+
+    /* State Declarations */
+    // Logs entries and exits
+    HSM_DECLARE_BASE_STATE(BBaseState,
+        HSM_DECLARE_STATE_ENTRY()
+        HSM_DECLARE_STATE_EXIT()
+    )
+
+    HSM_DECLARE_STATE_TOP_LEVEL_FROM_BASE(BStateIdle, BBaseState,
+        HSM_DECLARE_HANDLED_EVENTS(eBEVENT_GO, eBEVENT_FAIL)
+    )
+    HSM_DECLARE_STATE_TOP_LEVEL_FROM_BASE(BStateActive, BBaseState,
+        HSM_DECLARE_HANDLED_EVENTS(eBEVENT_GO, eBEVENT_CHECK, eBEVENT_LOST)
+    )
+    HSM_DECLARE_STATE_FROM_BASE(BStateLow, BStateActive, BBaseState,
+        HSM_DECLARE_HANDLED_EVENTS()
+    )
+    HSM_DECLARE_STATE_FROM_BASE(BStateHigh, BStateActive, BBaseState,
+        HSM_DECLARE_HANDLED_EVENTS(eBEVENT_CHECK)
+    )
+
+    /// @brief Selects `eBSTATE_HIGH` or `eBSTATE_LOW` based upon the level computed by the incoming transition,
+    /// selects an unknown target for level `0`
+    class BChoiceLevel : public Choice
+    {
+    public:
+
+        explicit BChoiceLevel(BaseState* parentState) : Choice(eBSTATE_LEVEL, parentState) {};
+
+        bool select(sTransition* t, void* ctx) override;
+    };
+
+    /// @brief Continues to `eBSTATE_RANGE` for high levels, has no enabled branch otherwise
+    class BJunctionLimit : public Junction
+    {
+    public:
+
+        BJunctionLimit() : Junction(eBSTATE_LIMIT) {};
+
+        bool select(sTransition* t, void* ctx) override;
+    };
+
+    /// @brief Selects `eBSTATE_IDLE` or the choice `eBSTATE_LEVEL`
+    class BJunctionRange : public Junction
+    {
+    public:
+
+        BJunctionRange() : Junction(eBSTATE_RANGE) {};
+
+        bool select(sTransition* t, void* ctx) override;
+    };
+
+    /// @brief Top-level choice without enabled branch
+    class BChoiceBroken : public Choice
+    {
+    public:
+
+        BChoiceBroken() : Choice(eBSTATE_BROKEN, nullptr) {};
+
+        bool select(sTransition* t, void* ctx) override;
+    };
+
+    /* HSM Declaration */
+    class BranchHSM : public BaseHSM
+    {
+    public:
+
+        /// Structure shared by all instances
+        static HSMDefinition definition;
+
+        BranchHSM() : BaseHSM(state_idle, definition)
+        {
+            this->registerVertices({&state_idle, &state_active, &state_low, &state_high, &choice_level,
+                    &junction_limit, &junction_range, &choice_broken});
+        };
+
+        BStateIdle state_idle = BStateIdle(eBSTATE_IDLE, nullptr);
+        BStateActive state_active = BStateActive(eBSTATE_ACTIVE, &state_low);
+        BStateLow state_low = BStateLow(eBSTATE_LOW, &state_active, nullptr);
+        BStateHigh state_high = BStateHigh(eBSTATE_HIGH, &state_active, nullptr);
+        BChoiceLevel choice_level = BChoiceLevel(&state_active);
+        BJunctionLimit junction_limit;
+        BJunctionRange junction_range;
+        BChoiceBroken choice_broken;
+    };
+}
+
+#endif
@@ -0,0 +1,141 @@
+#include <unity.h>
+
+#include <branch/branch_tests.hpp>
+#include <branch/BranchHSM.hpp>
+
+namespace microhsm_tests
+{
+    static BranchHSM branchHSM;
+    static sBranchCTX branchCTX;
+
+    static void setupBranch(unsigned int input)
+    {
+        branchCTX.input = input;
+        branchCTX.level = 0;
+        branchCTX.fallbacks = 0;
+        TEST_ASSERT_EQUAL(eOK, branchHSM.init(&branchCTX));
+        clearBranchLog(branchCTX);
+    }
+
+    static void assertLog(const unsigned int* expected, unsigned int count)
+    {
+        TEST_ASSERT_EQUAL(count, branchCTX.count);
+        TEST_ASSERT_EQUAL_UINT_ARRAY(expected, branchCTX.log, count);
+        clearBranchLog(branchCTX);
+    }
+
+    void btest_choice()
+    {
+        setupBranch(6);
+
+        // Guards of a choice see the effect of the incoming transition
+        TEST_ASSERT_EQUAL(eOK, branchHSM.dispatch(eBEVENT_GO, &branchCTX));
+        const unsigned int high[] = {
+            eBSTATE_IDLE | BRANCH_EXIT, eBSTATE_LEVEL | BRANCH_EFFECT, eBSTATE_ACTIVE,
+            eBSTATE_LEVEL | BRANCH_GUARD, eBSTATE_HIGH | BRANCH_EFFECT, eBSTATE_HIGH
+        };
+        assertLog(high, 6);
+        TEST_ASSERT_TRUE(branchHSM.inState(eBSTATE_HIGH));
+
+        TEST_ASSERT_EQUAL(eOK, branchHSM.dispatch(eBEVENT_GO, &branchCTX));
+        TEST_ASSERT_TRUE(branchHSM.inState(eBSTATE_IDLE));
+        clearBranchLog(branchCTX);
+
+        branchCTX.input = 3;
+        TEST_ASSERT_EQUAL(eOK, branchHSM.dispatch(eBEVENT_GO, &branchCTX));
+        const unsigned int low[] = {
+            eBSTATE_IDLE | BRANCH_EXIT, eBSTATE_LEVEL | BRANCH_EFFECT, eBSTATE_ACTIVE,
+            eBSTATE_LEVEL | BRANCH_GUARD, eBSTATE_LOW
+        };
+        assertLog(low, 5);
+        TEST_ASSERT_TRUE(branchHSM.inState(eBSTATE_LOW));
+    }
+
+    void btest_junction()
+    {
+        setupBranch(6);
+        TEST_ASSERT_EQUAL(eOK, branchHSM.dispatch(eBEVENT_GO, &branchCTX));
+        TEST_ASSERT_TRUE(branchHSM.inState(eBSTATE_HIGH));
+        clearBranchLog(branchCTX);
+
+        // Without enabled branch the transition is not taken, the parent takes the event
+        TEST_ASSERT_EQUAL(eOK, branchHSM.dispatch(eBEVENT_CHECK, &branchCTX));
+        const unsigned int fallback[] = {eBSTATE_LIMIT | BRANCH_GUARD};
+        assertLog(fallback, 1);
+        TEST_ASSERT_EQUAL(1, branchCTX.fallbacks);
+        TEST_ASSERT_TRUE(branchHSM.inState(eBSTATE_HIGH));
+
+        // Guards of chained junctions are evaluated before any state is exited
+        branchCTX.level = 40;
+        TEST_ASSERT_EQUAL(eOK, branchHSM.dispatch(eBEVENT_CHECK, &branchCTX));
+        const unsigned int idle[] = {
+            eBSTATE_LIMIT | BRANCH_GUARD, eBSTATE_RANGE | BRANCH_GUARD,
+            eBSTATE_HIGH | BRANCH_EXIT, eBSTATE_ACTIVE | BRANCH_EXIT,
+            eBSTATE_RANGE | BRANCH_EFFECT, eBSTATE_IDLE | BRANCH_EFFECT, eBSTATE_IDLE
+        };
+        assertLog(idle, 7);
+        TEST_ASSERT_TRUE(branchHSM.inState(eBSTATE_IDLE));
+        TEST_ASSERT_EQUAL(1, branchCTX.fallbacks);
+    }
+
+    void btest_junction_to_choice()
+    {
+        setupBranch(6);
+        TEST_ASSERT_EQUAL(eOK, branchHSM.dispatch(eBEVENT_GO, &branchCTX));
+        clearBranchLog(branchCTX);
+
+        // Junctions leading to a choice are resolved first, the parent of the choice is not exited
+        branchCTX.level = 25;
+        TEST_ASSERT_EQUAL(eOK, branchHSM.dispatch(eBEVENT_CHECK, &branchCTX));
+        const unsigned int chain[] = {
+            eBSTATE_LIMIT | BRANCH_GUARD, eBSTATE_RANGE | BRANCH_GUARD, eBSTATE_HIGH | BRANCH_EXIT,
+            eBSTATE_RANGE | BRANCH_EFFECT, eBSTATE_LEVEL | BRANCH_GUARD, eBSTATE_HIGH | BRANCH_EFFECT, eBSTATE_HIGH
+        };
+        assertLog(chain, 7);
+        TEST_ASSERT_TRUE(branchHSM.inState(eBSTATE_HIGH));
+        TEST_ASSERT_EQUAL(0, branchCTX.fallbacks);
+    }
+
+    void btest_choice_without_branch()
+    {
+        setupBranch(6);
+
+        // Ill-formed top-level choice ends the transition in the initial configuration
+        TEST_ASSERT_EQUAL(eTRANSITION_ERROR, branchHSM.dispatch(eBEVENT_FAIL, &branchCTX));
+        const unsigned int broken[] = {eBSTATE_IDLE | BRANCH_EXIT, eBSTATE_BROKEN | BRANCH_GUARD, eBSTATE_IDLE};
+        assertLog(broken, 3);
+        TEST_ASSERT_TRUE(branchHSM.inState(eBSTATE_IDLE));
+
+        // HSM continues normally
+        TEST_ASSERT_EQUAL(eOK, branchHSM.dispatch(eBEVENT_GO, &branchCTX));
+        TEST_ASSERT_TRUE(branchHSM.inState(eBSTATE_HIGH));
+    }
+
+    void btest_choice_unknown_target()
+    {
+        setupBranch(0);
+
+        // Choice selecting an unknown vertex ends the transition in the default configuration of its parent
+        TEST_ASSERT_EQUAL(eTRANSITION_ERROR, branchHSM.dispatch(eBEVENT_GO, &branchCTX));
+        const unsigned int fallback[] = {
+            eBSTATE_IDLE | BRANCH_EXIT, eBSTATE_LEVEL | BRANCH_EFFECT, eBSTATE_ACTIVE,
+            eBSTATE_LEVEL | BRANCH_GUARD, eBSTATE_LOW
+        };
+        assertLog(fallback, 5);
+        TEST_ASSERT_TRUE(branchHSM.inState(eBSTATE_LOW));
+
+        // Transition to an unknown vertex is rejected before any state is exited
+        TEST_ASSERT_EQUAL(eTRANSITION_ERROR, branchHSM.dispatch(eBEVENT_LOST, &branchCTX));
+        TEST_ASSERT_EQUAL(0, branchCTX.count);
+        TEST_ASSERT_TRUE(branchHSM.inState(eBSTATE_LOW));
+    }
+
+    void run_branch_tests(void)
+    {
+        RUN_TEST(btest_choice);
+        RUN_TEST(btest_junction);
+        RUN_TEST(btest_junction_to_choice);
+        RUN_TEST(btest_choice_without_branch);
+        RUN_TEST(btest_choice_unknown_target);
+    }
+}
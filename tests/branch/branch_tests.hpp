@@ -0,0 +1,9 @@
+#ifndef _H_MICROHSM_TESTS_BRANCH_TESTS
+#define _H_MICROHSM_TESTS_BRANCH_TESTS
+
+namespace microhsm_tests
+{
+    void run_branch_tests(void);
+}
+
+#endif
@@ -0,0 +1,39 @@
+/**
+ * @file BusHSM.cpp
+ * @brief Test HSM subscribing to an event bus
+ */
+
+#include <bus/BusHSM.hpp>
+
+#define UNUSED_ARG_(x) (void)x;
+
+namespace microhsm_tests
+{
+    HSMDefinition BusHSM::definition;
+
+    HSM_DEFINE_STATE_MATCH(BStateOff)
+    {
+        UNUSED_ARG_(ctx);
+        switch(event) {
+            case eBEVENT_ON:
+                return transitionExternal(eBSTATE_ON, t, nullptr);
+            default:
+                break;
+        }
+        return noTransition();
+    }
+
+    HSM_DEFINE_STATE_MATCH(BStateOn)
+    {
+        UNUSED_ARG_(ctx);
+        switch(event) {
+            case eBEVENT_OFF:
+                return transitionExternal(eBSTATE_OFF, t, nullptr);
+            case eBEVENT_TICK:
+                return transitionInternal(t, nullptr);
+            default:
+                break;
+        }
+        return noTransition();
+    }
+}
@@ -0,0 +1,55 @@
+/**
+ * @file BusHSM.hpp
+ * @brief Test HSM subscribing to an event bus
+ */
+#ifndef _H_MICROHSM_TESTS_BUSHSM
+#define _H_MICROHSM_TESTS_BUSHSM
+
+#include <microhsm/microhsm.hpp>
+#include <microhsm/macros.hpp>
+
+using namespace microhsm;
+
+namespace microhsm_tests
+{
+    /// @brief Event enumerations
+    HSM_CREATE_EVENT_LIST(e_bevents,
+            eBEVENT_ON,
+            eBEVENT_OFF,
+            eBEVENT_TICK,
+            eBEVENT_ALARM,      // Not handled by any state
+            eBEVENT_COUNT
+    )
+
+    HSM_CREATE_VERTEX_LIST(e_bstates,
+            eBSTATE_OFF = 60,
+            eBSTATE_ON
+    )
+
+    /* State Declarations */
+    HSM_DECLARE_STATE_TOP_LEVEL(BStateOff, eBSTATE_OFF,
+        HSM_DECLARE_HANDLED_EVENTS(eBEVENT_ON)
+    )
+    HSM_DECLARE_STATE_TOP_LEVEL(BStateOn, eBSTATE_ON,
+        HSM_DECLARE_HANDLED_EVENTS(eBEVENT_OFF, eBEVENT_TICK)
+    )
+
+    /* HSM Declaration */
+    class BusHSM : public BaseHSM
+    {
+    public:
+
+        /// Structure shared by all instances
+        static HSMDefinition definition;
+
+        BusHSM() : BaseHSM(state_off, definition)
+        {
+            this->registerVertices({&state_off, &state_on});
+        };
+
+        BStateOff state_off = BStateOff(nullptr);
+        BStateOn state_on = BStateOn(nullptr);
+    };
+}
+
+#endif
@@ -0,0 +1,113 @@
+#include <unity.h>
+
+#include <bus/bus_tests.hpp>
+#include <bus/BusHSM.hpp>
+
+namespace microhsm_tests
+{
+    /// Subscribers of the bitmap test, spanning several bitmap words
+    static const unsigned int BUS_SUBSCRIBERS = 100;
+
+    void btest_subscribe()
+    {
+        EventBus<4, eBEVENT_COUNT> bus;
+        EventQueue<4> a;
+        EventQueue<4> b;
+        unsigned int event = 0;
+
+        TEST_ASSERT_EQUAL(0, bus.attach(&a));
+        TEST_ASSERT_EQUAL(1, bus.attach(&b));
+        bus.subscribe(0, eBEVENT_TICK);
+        bus.subscribe(1, eBEVENT_TICK);
+        bus.subscribe(1, eBEVENT_ALARM);
+        TEST_ASSERT_TRUE(bus.isSubscribed(1, eBEVENT_ALARM));
+        TEST_ASSERT_FALSE(bus.isSubscribed(0, eBEVENT_ALARM));
+
+        TEST_ASSERT_EQUAL(2, bus.publish(eBEVENT_TICK));
+        TEST_ASSERT_EQUAL(1, bus.publish(eBEVENT_ALARM));
+        TEST_ASSERT_EQUAL(0, bus.publish(eBEVENT_ON));
+        TEST_ASSERT_EQUAL(0, bus.publish(eBEVENT_COUNT));
+        TEST_ASSERT_EQUAL(1, a.size());
+        TEST_ASSERT_EQUAL(2, b.size());
+
+        bus.unsubscribe(0, eBEVENT_TICK);
+        TEST_ASSERT_FALSE(bus.isSubscribed(0, eBEVENT_TICK));
+        TEST_ASSERT_EQUAL(1, bus.publish(eBEVENT_TICK));
+        TEST_ASSERT_EQUAL(1, a.size());
+        TEST_ASSERT_TRUE(a.pop(event));
+        TEST_ASSERT_EQUAL(eBEVENT_TICK, event);
+    }
+
+    void btest_handled_events()
+    {
+        static BusHSM hsms[2];
+        static EventQueue<8> queues[2];
+        EventBus<2, eBEVENT_COUNT> bus;
+
+        for (unsigned int i = 0; i < 2; i++) {
+            TEST_ASSERT_EQUAL(eOK, hsms[i].init(nullptr));
+            TEST_ASSERT_EQUAL(i, bus.attach(hsms[i], &queues[i]));
+        }
+
+        // Subscriptions follow the events declared by the states
+        TEST_ASSERT_TRUE(bus.isSubscribed(0, eBEVENT_ON));
+        TEST_ASSERT_TRUE(bus.isSubscribed(0, eBEVENT_OFF));
+        TEST_ASSERT_TRUE(bus.isSubscribed(0, eBEVENT_TICK));
+        TEST_ASSERT_FALSE(bus.isSubscribed(0, eBEVENT_ALARM));
+        TEST_ASSERT_FALSE(bus.isSubscribed(0, EVENT_ANONYMOUS));
+
+        TEST_ASSERT_EQUAL(0, bus.publish(eBEVENT_ALARM));
+        TEST_ASSERT_EQUAL(2, bus.publish(eBEVENT_ON));
+        TEST_ASSERT_EQUAL(2, bus.publish(eBEVENT_TICK));
+        for (unsigned int i = 0; i < 2; i++) {
+            TEST_ASSERT_EQUAL(2, hsms[i].runUntilEmpty(nullptr));
+            TEST_ASSERT_TRUE(hsms[i].inState(eBSTATE_ON));
+            hsms[i].attachQueue(nullptr);
+        }
+    }
+
+    void btest_limits()
+    {
+        EventBus<1, eBEVENT_COUNT> bus;
+        EventQueue<2> queue;
+        EventQueue<2> other;
+
+        TEST_ASSERT_EQUAL(0, bus.attach(&queue));
+        TEST_ASSERT_EQUAL(-1, bus.attach(&other));
+        TEST_ASSERT_EQUAL(1, bus.getSubscriberCount());
+
+        // Full queue rejects event
+        bus.subscribe(0, eBEVENT_TICK);
+        TEST_ASSERT_EQUAL(1, bus.publish(eBEVENT_TICK));
+        TEST_ASSERT_EQUAL(1, bus.publish(eBEVENT_TICK));
+        TEST_ASSERT_EQUAL(0, bus.publish(eBEVENT_TICK));
+        TEST_ASSERT_EQUAL(1, bus.getFailed());
+    }
+
+    void btest_many_subscribers()
+    {
+        static EventBus<BUS_SUBSCRIBERS, eBEVENT_COUNT> bus;
+        static EventQueue<2> queues[BUS_SUBSCRIBERS];
+
+        unsigned int expected = 0;
+        for (unsigned int i = 0; i < BUS_SUBSCRIBERS; i++) {
+            TEST_ASSERT_EQUAL(i, bus.attach(&queues[i]));
+            if (i % 7 == 0) {
+                bus.subscribe(i, eBEVENT_ALARM);
+                expected++;
+            }
+        }
+        TEST_ASSERT_EQUAL(expected, bus.publish(eBEVENT_ALARM));
+        for (unsigned int i = 0; i < BUS_SUBSCRIBERS; i++) {
+            TEST_ASSERT_EQUAL((i % 7 == 0) ? 1 : 0, queues[i].size());
+        }
+    }
+
+    void run_bus_tests(void)
+    {
+        RUN_TEST(btest_subscribe);
+        RUN_TEST(btest_handled_events);
+        RUN_TEST(btest_limits);
+        RUN_TEST(btest_many_subscribers);
+    }
+}
@@ -0,0 +1,9 @@
+#ifndef _H_MICROHSM_TESTS_BUS_TESTS
+#define _H_MICROHSM_TESTS_BUS_TESTS
+
+namespace microhsm_tests
+{
+    void run_bus_tests(void);
+}
+
+#endif
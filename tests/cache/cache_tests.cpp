@@ -0,0 +1,170 @@
+#include <unity.h>
+
+#include <context/TestCTX.hpp>
+
+#include <cache/cache_tests.hpp>
+#include <basic/TestHSM.hpp>
+#include <history/HistoryHSM.hpp>
+
+namespace microhsm_tests
+{
+    static TestCTX cacheCTX = TestCTX();
+    static TestHSM cacheHSM = TestHSM();
+    static HistoryHSM cacheHistoryHSM = HistoryHSM();
+
+    /// Events dispatched to `TestHSM`, every transition of the HSM is taken at least twice
+    static const unsigned int testEvents[] = {
+        eEVENT_A, eEVENT_B, eEVENT_F, eEVENT_F, eEVENT_B, eEVENT_C, eEVENT_C, eEVENT_E,
+        eEVENT_G, eEVENT_A, eEVENT_D, eEVENT_E, eEVENT_B, eEVENT_E, eEVENT_E, eEVENT_G,
+        eEVENT_F, eEVENT_C, eEVENT_A, eEVENT_B, eEVENT_F, eEVENT_F, eEVENT_B, eEVENT_C,
+        eEVENT_C, eEVENT_E, eEVENT_G, eEVENT_A, eEVENT_D, eEVENT_E, eEVENT_B, eEVENT_E,
+    };
+
+    /// Events dispatched to `HistoryHSM`
+    static const unsigned int historyEvents[] = {
+        eHEVENT_C, eHEVENT_C, eHEVENT_B, eHEVENT_A, eHEVENT_A, eHEVENT_B, eHEVENT_B, eHEVENT_A,
+        eHEVENT_A, eHEVENT_C, eHEVENT_C, eHEVENT_B, eHEVENT_B, eHEVENT_B, eHEVENT_A, eHEVENT_A,
+    };
+
+    static const unsigned int TEST_EVENT_COUNT = sizeof(testEvents) / sizeof(testEvents[0]);
+    static const unsigned int HISTORY_EVENT_COUNT = sizeof(historyEvents) / sizeof(historyEvents[0]);
+
+    /// Observable result of a single dispatch
+    typedef struct {
+        eStatus status;
+        unsigned int stateID;
+        bool flag;
+        unsigned int entryCounts[eSTATE_COUNT];
+        unsigned int exitCounts[eSTATE_COUNT];
+    } sStep;
+
+    static sStep uncached[TEST_EVENT_COUNT];
+    static sStep cached[TEST_EVENT_COUNT];
+
+    /* Private functions */
+    static void recordStep(sStep* step, eStatus status)
+    {
+        step->status = status;
+        step->stateID = cacheHSM.getCurrentState()->ID;
+        step->flag = cacheCTX.getFlag();
+        for (unsigned int id = 0; id < eSTATE_COUNT; id++) {
+            TestState* s = static_cast<TestState*>(cacheHSM.getVertex(id));
+            step->entryCounts[id] = s->getEntryCount();
+            step->exitCounts[id] = s->getExitCount();
+        }
+    }
+
+    static void runSequence(sStep* steps, bool cacheEnabled)
+    {
+        cacheHSM.enableTransitionCache(cacheEnabled);
+        cacheCTX.init();
+        TEST_ASSERT_EQUAL(eOK, cacheHSM.init(static_cast<void*>(&cacheCTX)));
+        for (unsigned int i = 0; i < TEST_EVENT_COUNT; i++) {
+            eStatus status = cacheHSM.dispatch(testEvents[i], &cacheCTX);
+            recordStep(&steps[i], status);
+        }
+    }
+
+    static void assertStepsEqual(const sStep* expected, const sStep* actual)
+    {
+        for (unsigned int i = 0; i < TEST_EVENT_COUNT; i++) {
+            TEST_ASSERT_EQUAL(expected[i].status, actual[i].status);
+            TEST_ASSERT_EQUAL(expected[i].stateID, actual[i].stateID);
+            TEST_ASSERT_EQUAL(expected[i].flag, actual[i].flag);
+            TEST_ASSERT_EQUAL_UINT_ARRAY(expected[i].entryCounts, actual[i].entryCounts, eSTATE_COUNT);
+            TEST_ASSERT_EQUAL_UINT_ARRAY(expected[i].exitCounts, actual[i].exitCounts, eSTATE_COUNT);
+        }
+    }
+
+    /**
+     * @brief Test that replaying cached paths behaves identical to resolving them
+     */
+    void ctest_cached_matches_uncached()
+    {
+        runSequence(uncached, false);
+        TEST_ASSERT_EQUAL(0, cacheHSM.getTransitionCacheHits());
+        TEST_ASSERT_EQUAL(0, cacheHSM.getTransitionCacheMisses());
+
+        runSequence(cached, true);
+        TEST_ASSERT_TRUE(cacheHSM.getTransitionCacheHits() > 0);
+        TEST_ASSERT_TRUE(cacheHSM.getTransitionCacheMisses() > 0);
+
+        assertStepsEqual(uncached, cached);
+    }
+
+    /**
+     * @brief Test cache statistics
+     */
+    void ctest_cache_statistics()
+    {
+        cacheHSM.enableTransitionCache(true);
+        cacheCTX.init();
+        TEST_ASSERT_EQUAL(eOK, cacheHSM.init(static_cast<void*>(&cacheCTX)));
+
+        // EVENT_A: S1 -> S1 (external), first time is resolved
+        eStatus status = cacheHSM.dispatch(eEVENT_A, &cacheCTX);
+        TEST_ASSERT_EQUAL(eOK, status);
+        TEST_ASSERT_EQUAL(0, cacheHSM.getTransitionCacheHits());
+        TEST_ASSERT_EQUAL(1, cacheHSM.getTransitionCacheMisses());
+
+        // EVENT_A: S1 -> S1 (external), second time is replayed
+        status = cacheHSM.dispatch(eEVENT_A, &cacheCTX);
+        TEST_ASSERT_EQUAL(eOK, status);
+        TEST_ASSERT_EQUAL(1, cacheHSM.getTransitionCacheHits());
+        TEST_ASSERT_EQUAL(1, cacheHSM.getTransitionCacheMisses());
+        TEST_ASSERT_EQUAL(3, cacheHSM.state_s1.getEntryCount());
+        TEST_ASSERT_EQUAL(2, cacheHSM.state_s1.getExitCount());
+        TEST_ASSERT_EQUAL(1, cacheHSM.state_s.getEntryCount());
+        TEST_ASSERT_EQUAL(0, cacheHSM.state_s.getExitCount());
+
+        // EVENT_F: S1 -> S22 (external), new path is resolved
+        status = cacheHSM.dispatch(eEVENT_F, &cacheCTX);
+        TEST_ASSERT_EQUAL(eOK, status);
+        TEST_ASSERT_EQUAL(1, cacheHSM.getTransitionCacheHits());
+        TEST_ASSERT_EQUAL(2, cacheHSM.getTransitionCacheMisses());
+
+        // EVENT_F: S22 -> S21 (external)
+        // EVENT_F: S (internal), internal transitions are not cached
+        cacheHSM.dispatch(eEVENT_F, &cacheCTX);
+        status = cacheHSM.dispatch(eEVENT_F, &cacheCTX);
+        TEST_ASSERT_EQUAL(eOK, status);
+        TEST_ASSERT_TRUE(cacheHSM.inState(eSTATE_S21));
+        TEST_ASSERT_EQUAL(1, cacheHSM.getTransitionCacheHits());
+        TEST_ASSERT_EQUAL(3, cacheHSM.getTransitionCacheMisses());
+
+        cacheHSM.clearTransitionCache();
+        TEST_ASSERT_EQUAL(0, cacheHSM.getTransitionCacheHits());
+        TEST_ASSERT_EQUAL(0, cacheHSM.getTransitionCacheMisses());
+    }
+
+    /**
+     * @brief Test that history targets are resolved before the cache lookup
+     */
+    void ctest_cached_history()
+    {
+        unsigned int expected[HISTORY_EVENT_COUNT];
+
+        cacheHistoryHSM.enableTransitionCache(false);
+        TEST_ASSERT_EQUAL(eOK, cacheHistoryHSM.init(nullptr));
+        for (unsigned int i = 0; i < HISTORY_EVENT_COUNT; i++) {
+            cacheHistoryHSM.dispatch(historyEvents[i], nullptr);
+            expected[i] = cacheHistoryHSM.getCurrentState()->ID;
+        }
+
+        cacheHistoryHSM.enableTransitionCache(true);
+        TEST_ASSERT_EQUAL(eOK, cacheHistoryHSM.init(nullptr));
+        for (unsigned int i = 0; i < HISTORY_EVENT_COUNT; i++) {
+            cacheHistoryHSM.dispatch(historyEvents[i], nullptr);
+            TEST_ASSERT_EQUAL(expected[i], cacheHistoryHSM.getCurrentState()->ID);
+        }
+        TEST_ASSERT_TRUE(cacheHistoryHSM.getTransitionCacheHits() > 0);
+    }
+
+    // Test functions
+    void run_cache_tests(void)
+    {
+        RUN_TEST(ctest_cached_matches_uncached);
+        RUN_TEST(ctest_cache_statistics);
+        RUN_TEST(ctest_cached_history);
+    }
+}
@@ -0,0 +1,9 @@
+#ifndef _H_MICROHSM_TESTS_CACHE_TESTS
+#define _H_MICROHSM_TESTS_CACHE_TESTS
+
+namespace microhsm_tests
+{
+    void run_cache_tests(void);
+}
+
+#endif
@@ -0,0 +1,68 @@
+/**
+ * @file DeferHSM.cpp
+ * @brief Test HSM with states deferring events
+ */
+
+#include <defer/DeferHSM.hpp>
+
+#define UNUSED_ARG_(x) (void)x;
+
+namespace microhsm_tests
+{
+    HSMDefinition DeferHSM::definition;
+
+    static void countPing(void* ctx)
+    {
+        static_cast<sDeferCTX*>(ctx)->pings++;
+    }
+
+    HSM_DEFINE_STATE_MATCH(DStateIdle)
+    {
+        UNUSED_ARG_(ctx);
+        switch(event) {
+            case eDEVENT_START:
+                return transitionExternal(eDSTATE_BUSY, t, nullptr);
+            case eDEVENT_PING:
+                return transitionInternal(t, countPing);
+            default:
+                break;
+        }
+        return noTransition();
+    }
+
+    HSM_DEFINE_STATE_MATCH(DStateBusy)
+    {
+        UNUSED_ARG_(ctx);
+        switch(event) {
+            case eDEVENT_DONE:
+                return transitionExternal(eDSTATE_IDLE, t, nullptr);
+            default:
+                break;
+        }
+        return noTransition();
+    }
+
+    HSM_DEFINE_STATE_MATCH(DStateBusyA)
+    {
+        UNUSED_ARG_(ctx);
+        switch(event) {
+            case eDEVENT_NEXT:
+                return transitionExternal(eDSTATE_BUSY_B, t, nullptr);
+            default:
+                break;
+        }
+        return noTransition();
+    }
+
+    HSM_DEFINE_STATE_MATCH(DStateBusyB)
+    {
+        UNUSED_ARG_(ctx);
+        switch(event) {
+            case eDEVENT_START:
+                return transitionExternal(eDSTATE_BUSY_A, t, nullptr);
+            default:
+                break;
+        }
+        return noTransition();
+    }
+}
@@ -0,0 +1,76 @@
+/**
+ * @file DeferHSM.hpp
+ * @brief Test HSM with states deferring events
+ */
+#ifndef _H_MICROHSM_TESTS_DEFERHSM
+#define _H_MICROHSM_TESTS_DEFERHSM
+
+#include <microhsm/microhsm.hpp>
+#include <microhsm/macros.hpp>
+
+using namespace microhsm;
+
+namespace microhsm_tests
+{
+    /// @brief Event enumerations
+    HSM_CREATE_EVENT_LIST(e_devents,
+            eDEVENT_START,
+            eDEVENT_DONE,
+            eDEVENT_NEXT,
+            eDEVENT_PING
+    )
+
+    /// @brief Events sharing the most significant bit of event masks
+    static const unsigned int DEVENT_HIGH = EVENT_MASK_BITS + 1;
+    static const unsigned int DEVENT_HIGHER = EVENT_MASK_BITS + 2;
+
+    HSM_CREATE_VERTEX_LIST(e_dstates,
+            eDSTATE_IDLE = 40,
+            eDSTATE_BUSY,
+            eDSTATE_BUSY_A,
+            eDSTATE_BUSY_B
+    )
+
+    /// @brief Context counting the number of handled pings
+    typedef struct {
+        unsigned int pings;
+    } sDeferCTX;
+
+    /* State Declarations */
+    // Handles pings
+    HSM_DECLARE_STATE_TOP_LEVEL(DStateIdle, eDSTATE_IDLE)
+    // Defers start until done
+    HSM_DECLARE_STATE_TOP_LEVEL(DStateBusy, eDSTATE_BUSY,
+        HSM_DECLARE_DEFERRED_EVENTS(eDEVENT_START)
+    )
+    // Defers pings
+    HSM_DECLARE_STATE(DStateBusyA, eDSTATE_BUSY_A, DStateBusy,
+        HSM_DECLARE_DEFERRED_EVENTS(eDEVENT_PING)
+    )
+    // Handles start, which takes precedence over deferral of parent
+    // Declares deferral of an event without a bit of its own, which is ignored
+    HSM_DECLARE_STATE(DStateBusyB, eDSTATE_BUSY_B, DStateBusy,
+        HSM_DECLARE_MEMBER(tEventMask deferredEvents(void) override {return eventBit(DEVENT_HIGH);})
+    )
+
+    /* HSM Declaration */
+    class DeferHSM : public BaseHSM
+    {
+    public:
+
+        /// Structure shared by all instances
+        static HSMDefinition definition;
+
+        DeferHSM() : BaseHSM(state_idle, definition)
+        {
+            this->registerVertices({&state_idle, &state_busy, &state_busy_a, &state_busy_b});
+        };
+
+        DStateIdle state_idle = DStateIdle(nullptr);
+        DStateBusy state_busy = DStateBusy(&state_busy_a);
+        DStateBusyA state_busy_a = DStateBusyA(&state_busy, nullptr);
+        DStateBusyB state_busy_b = DStateBusyB(&state_busy, nullptr);
+    };
+}
+
+#endif
@@ -0,0 +1,168 @@
+#include <unity.h>
+
+#include <defer/defer_tests.hpp>
+#include <defer/DeferHSM.hpp>
+
+namespace microhsm_tests
+{
+    static DeferHSM deferHSM = DeferHSM();
+    static DeferHSM unqueuedHSM = DeferHSM();
+    static DeferQueue deferQueue;
+    static sDeferCTX deferCTX;
+
+    static void setupDefer()
+    {
+        deferCTX.pings = 0;
+        deferHSM.attachDeferQueue(&deferQueue);
+        TEST_ASSERT_EQUAL(eOK, deferHSM.init(&deferCTX));
+    }
+
+    void dtest_defer_and_recall()
+    {
+        setupDefer();
+        TEST_ASSERT_EQUAL(eOK, deferHSM.dispatch(eDEVENT_START, &deferCTX));
+        TEST_ASSERT_TRUE(deferHSM.inState(eDSTATE_BUSY_A));
+
+        // Start and ping are deferred in busy A
+        TEST_ASSERT_EQUAL(eEVENT_DEFERRED, deferHSM.dispatch(eDEVENT_START, &deferCTX));
+        TEST_ASSERT_EQUAL(eEVENT_DEFERRED, deferHSM.dispatch(eDEVENT_PING, &deferCTX));
+        TEST_ASSERT_EQUAL(eEVENT_DEFERRED, deferHSM.dispatch(eDEVENT_PING, &deferCTX));
+        TEST_ASSERT_EQUAL(3, deferHSM.getDeferredCount());
+        TEST_ASSERT_EQUAL(0, deferCTX.pings);
+
+        // Done: idle recalls start (oldest), which defers the pings again
+        TEST_ASSERT_EQUAL(eOK, deferHSM.dispatch(eDEVENT_DONE, &deferCTX));
+        TEST_ASSERT_TRUE(deferHSM.inState(eDSTATE_BUSY_A));
+        TEST_ASSERT_EQUAL(2, deferHSM.getDeferredCount());
+        TEST_ASSERT_EQUAL(0, deferCTX.pings);
+
+        // Done: idle recalls both pings
+        TEST_ASSERT_EQUAL(eOK, deferHSM.dispatch(eDEVENT_DONE, &deferCTX));
+        TEST_ASSERT_TRUE(deferHSM.inState(eDSTATE_IDLE));
+        TEST_ASSERT_EQUAL(0, deferHSM.getDeferredCount());
+        TEST_ASSERT_EQUAL(2, deferCTX.pings);
+    }
+
+    void dtest_recall_order()
+    {
+        setupDefer();
+        deferHSM.dispatch(eDEVENT_START, &deferCTX);
+
+        // Ping deferred before start: idle handles ping, then start
+        TEST_ASSERT_EQUAL(eEVENT_DEFERRED, deferHSM.dispatch(eDEVENT_PING, &deferCTX));
+        TEST_ASSERT_EQUAL(eEVENT_DEFERRED, deferHSM.dispatch(eDEVENT_START, &deferCTX));
+        TEST_ASSERT_EQUAL(eOK, deferHSM.dispatch(eDEVENT_DONE, &deferCTX));
+        TEST_ASSERT_EQUAL(1, deferCTX.pings);
+        TEST_ASSERT_TRUE(deferHSM.inState(eDSTATE_BUSY_A));
+        TEST_ASSERT_EQUAL(0, deferHSM.getDeferredCount());
+    }
+
+    void dtest_transition_precedence()
+    {
+        setupDefer();
+        deferHSM.dispatch(eDEVENT_START, &deferCTX);
+        TEST_ASSERT_EQUAL(eEVENT_DEFERRED, deferHSM.dispatch(eDEVENT_PING, &deferCTX));
+
+        // Busy B does not defer pings, they are recalled (and ignored)
+        TEST_ASSERT_EQUAL(eOK, deferHSM.dispatch(eDEVENT_NEXT, &deferCTX));
+        TEST_ASSERT_TRUE(deferHSM.inState(eDSTATE_BUSY_B));
+        TEST_ASSERT_EQUAL(0, deferHSM.getDeferredCount());
+        TEST_ASSERT_EQUAL(0, deferCTX.pings);
+
+        // Start is handled by busy B, although busy defers it
+        TEST_ASSERT_EQUAL(eOK, deferHSM.dispatch(eDEVENT_START, &deferCTX));
+        TEST_ASSERT_TRUE(deferHSM.inState(eDSTATE_BUSY_A));
+        TEST_ASSERT_EQUAL(0, deferHSM.getDeferredCount());
+
+        // Events that are neither handled nor deferred are ignored
+        TEST_ASSERT_EQUAL(eEVENT_IGNORED, deferHSM.dispatch(eDEVENT_NEXT + 100, &deferCTX));
+    }
+
+    void dtest_overflow()
+    {
+        setupDefer();
+        deferHSM.dispatch(eDEVENT_START, &deferCTX);
+
+        for (unsigned int i = 0; i < MICROHSM_DEFER_QUEUE_SIZE; i++) {
+            TEST_ASSERT_EQUAL(eEVENT_DEFERRED, deferHSM.dispatch(eDEVENT_PING, &deferCTX));
+        }
+        TEST_ASSERT_EQUAL(eEVENT_IGNORED, deferHSM.dispatch(eDEVENT_PING, &deferCTX));
+        TEST_ASSERT_EQUAL(1, deferHSM.getDeferOverflows());
+        TEST_ASSERT_EQUAL(MICROHSM_DEFER_QUEUE_SIZE, deferHSM.getDeferredCount());
+
+        // Entries are reused after recall
+        deferHSM.dispatch(eDEVENT_DONE, &deferCTX);
+        TEST_ASSERT_EQUAL(MICROHSM_DEFER_QUEUE_SIZE, deferCTX.pings);
+        deferHSM.dispatch(eDEVENT_START, &deferCTX);
+        TEST_ASSERT_EQUAL(eEVENT_DEFERRED, deferHSM.dispatch(eDEVENT_PING, &deferCTX));
+
+        // Reinitialization discards deferred events
+        setupDefer();
+        TEST_ASSERT_EQUAL(0, deferHSM.getDeferredCount());
+        TEST_ASSERT_EQUAL(0, deferHSM.getDeferOverflows());
+    }
+
+    void dtest_shared_bit()
+    {
+        setupDefer();
+        deferHSM.dispatch(eDEVENT_START, &deferCTX);
+        deferHSM.dispatch(eDEVENT_NEXT, &deferCTX);
+        TEST_ASSERT_TRUE(deferHSM.inState(eDSTATE_BUSY_B));
+
+        // Events sharing the most significant bit are never deferred
+        TEST_ASSERT_EQUAL(eEVENT_IGNORED, deferHSM.dispatch(DEVENT_HIGH, &deferCTX));
+        TEST_ASSERT_EQUAL(eEVENT_IGNORED, deferHSM.dispatch(DEVENT_HIGHER, &deferCTX));
+        TEST_ASSERT_EQUAL(0, deferHSM.getDeferredCount());
+    }
+
+    void dtest_payload()
+    {
+        setupDefer();
+        deferHSM.dispatch(eDEVENT_START, &deferCTX);
+        TEST_ASSERT_TRUE(deferHSM.inState(eDSTATE_BUSY_A));
+
+        // Payload cannot be kept, event is dropped instead of deferred
+        const Event payload(eDEVENT_PING, 42u);
+        TEST_ASSERT_EQUAL(eEVENT_NOT_DEFERRED, deferHSM.dispatch(payload, &deferCTX));
+        TEST_ASSERT_EQUAL(0, deferHSM.getDeferredCount());
+
+        // Events without payload are deferred
+        const Event ping(eDEVENT_PING);
+        TEST_ASSERT_EQUAL(eEVENT_DEFERRED, deferHSM.dispatch(ping, &deferCTX));
+        TEST_ASSERT_EQUAL(1, deferHSM.getDeferredCount());
+
+        TEST_ASSERT_EQUAL(eOK, deferHSM.dispatch(eDEVENT_DONE, &deferCTX));
+        TEST_ASSERT_EQUAL(1, deferCTX.pings);
+    }
+
+    void dtest_no_queue()
+    {
+        setupDefer();
+        deferCTX.pings = 0;
+        unqueuedHSM.attachDeferQueue(nullptr);
+        TEST_ASSERT_EQUAL(eOK, unqueuedHSM.init(&deferCTX));
+        unqueuedHSM.dispatch(eDEVENT_START, &deferCTX);
+        TEST_ASSERT_TRUE(unqueuedHSM.inState(eDSTATE_BUSY_A));
+
+        // Without a queue deferred events are lost, other instances are unaffected
+        TEST_ASSERT_EQUAL(eEVENT_IGNORED, unqueuedHSM.dispatch(eDEVENT_PING, &deferCTX));
+        TEST_ASSERT_EQUAL(0, unqueuedHSM.getDeferredCount());
+        TEST_ASSERT_EQUAL(1, unqueuedHSM.getDeferOverflows());
+        TEST_ASSERT_EQUAL(0, deferQueue.getCount());
+
+        TEST_ASSERT_EQUAL(eOK, unqueuedHSM.dispatch(eDEVENT_DONE, &deferCTX));
+        TEST_ASSERT_TRUE(unqueuedHSM.inState(eDSTATE_IDLE));
+        TEST_ASSERT_EQUAL(0, deferCTX.pings);
+    }
+
+    void run_defer_tests(void)
+    {
+        RUN_TEST(dtest_defer_and_recall);
+        RUN_TEST(dtest_recall_order);
+        RUN_TEST(dtest_transition_precedence);
+        RUN_TEST(dtest_overflow);
+        RUN_TEST(dtest_shared_bit);
+        RUN_TEST(dtest_payload);
+        RUN_TEST(dtest_no_queue);
+    }
+}
@@ -0,0 +1,9 @@
+#ifndef _H_MICROHSM_TESTS_DEFER_TESTS
+#define _H_MICROHSM_TESTS_DEFER_TESTS
+
+namespace microhsm_tests
+{
+    void run_defer_tests(void);
+}
+
+#endif
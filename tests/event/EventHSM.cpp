@@ -0,0 +1,59 @@
+/**
+ * @file EventHSM.cpp
+ * @brief Test HSM receiving events with payload
+ */
+
+#include <event/EventHSM.hpp>
+
+namespace microhsm_tests
+{
+    HSMDefinition EventHSM::definition;
+
+    static void storeLimit(void* ctx, const Event& event)
+    {
+        const int* limit = event.get<int>();
+        if (limit != nullptr) static_cast<sEventCTX*>(ctx)->limit = *limit;
+    }
+
+    static void storeSample(void* ctx, const Event& event)
+    {
+        sEventCTX* c = static_cast<sEventCTX*>(ctx);
+        const sSample* sample = event.get<sSample>();
+        c->samples++;
+        if (sample != nullptr) c->lastValue = sample->value;
+    }
+
+    HSM_DEFINE_STATE_MATCH(EStateIdle)
+    {
+        sEventCTX* c = static_cast<sEventCTX*>(ctx);
+        const Event* e = currentEvent();
+        const sSample* sample = (e == nullptr) ? nullptr : e->get<sSample>();
+        switch(event) {
+            case eEEVENT_LIMIT:
+                return transitionInternal(t, nullptr) && eventEffect(t, storeLimit);
+            case eEEVENT_SAMPLE:
+                // Guard reads the payload without copying it
+                if (sample != nullptr && sample->value > c->limit) {
+                    return transitionExternal(eESTATE_ALARM, t, nullptr) && eventEffect(t, storeSample);
+                }
+                break;
+            default:
+                break;
+        }
+        return noTransition();
+    }
+
+    HSM_DEFINE_STATE_MATCH(EStateAlarm)
+    {
+        (void)ctx;
+        switch(event) {
+            case eEEVENT_SAMPLE:
+                return transitionInternal(t, nullptr) && eventEffect(t, storeSample);
+            case eEEVENT_RESET:
+                return transitionExternal(eESTATE_IDLE, t, nullptr);
+            default:
+                break;
+        }
+        return noTransition();
+    }
+}
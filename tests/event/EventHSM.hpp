@@ -0,0 +1,64 @@
+/**
+ * @file EventHSM.hpp
+ * @brief Test HSM receiving events with payload
+ */
+#ifndef _H_MICROHSM_TESTS_EVENTHSM
+#define _H_MICROHSM_TESTS_EVENTHSM
+
+#include <microhsm/microhsm.hpp>
+#include <microhsm/macros.hpp>
+
+using namespace microhsm;
+
+namespace microhsm_tests
+{
+    /// @brief Event enumerations
+    HSM_CREATE_EVENT_LIST(e_eevents,
+            eEEVENT_LIMIT,      // Payload: `int` limit
+            eEEVENT_SAMPLE,     // Payload: `sSample`
+            eEEVENT_RESET
+    )
+
+    HSM_CREATE_VERTEX_LIST(e_estates,
+            eESTATE_IDLE = 50,
+            eESTATE_ALARM
+    )
+
+    /// @brief Payload of sample events
+    typedef struct {
+        unsigned int channel;
+        int value;
+    } sSample;
+
+    /// @brief Context storing the received payloads
+    typedef struct {
+        int limit;
+        int lastValue;
+        unsigned int samples;
+    } sEventCTX;
+
+    /* State Declarations */
+    // Stores limit, raises alarm when a sample exceeds the limit
+    HSM_DECLARE_STATE_TOP_LEVEL(EStateIdle, eESTATE_IDLE)
+    // Counts samples until reset
+    HSM_DECLARE_STATE_TOP_LEVEL(EStateAlarm, eESTATE_ALARM)
+
+    /* HSM Declaration */
+    class EventHSM : public BaseHSM
+    {
+    public:
+
+        /// Structure shared by all instances
+        static HSMDefinition definition;
+
+        EventHSM() : BaseHSM(state_idle, definition)
+        {
+            this->registerVertices({&state_idle, &state_alarm});
+        };
+
+        EStateIdle state_idle = EStateIdle(nullptr);
+        EStateAlarm state_alarm = EStateAlarm(nullptr);
+    };
+}
+
+#endif
@@ -0,0 +1,128 @@
+#include <unity.h>
+
+#include <event/event_tests.hpp>
+#include <event/EventHSM.hpp>
+
+namespace microhsm_tests
+{
+    static EventHSM eventHSM = EventHSM();
+    static sEventCTX eventCTX;
+    static unsigned int releases;
+
+    static void releasePayload(void* payload)
+    {
+        (void)payload;
+        releases++;
+    }
+
+    static void setupEvent()
+    {
+        eventCTX.limit = 0;
+        eventCTX.lastValue = 0;
+        eventCTX.samples = 0;
+        releases = 0;
+        TEST_ASSERT_EQUAL(eOK, eventHSM.init(&eventCTX));
+    }
+
+    void etest_inline_payload()
+    {
+        setupEvent();
+        TEST_ASSERT_EQUAL(eOK, eventHSM.dispatch(Event(eEEVENT_LIMIT, 10), &eventCTX));
+        TEST_ASSERT_EQUAL(10, eventCTX.limit);
+
+        // Guard rejects sample below limit
+        sSample low = {1, 5};
+        TEST_ASSERT_EQUAL(eEVENT_IGNORED, eventHSM.dispatch(Event(eEEVENT_SAMPLE, low), &eventCTX));
+        TEST_ASSERT_TRUE(eventHSM.inState(eESTATE_IDLE));
+
+        sSample high = {1, 12};
+        TEST_ASSERT_EQUAL(eOK, eventHSM.dispatch(Event(eEEVENT_SAMPLE, high), &eventCTX));
+        TEST_ASSERT_TRUE(eventHSM.inState(eESTATE_ALARM));
+        TEST_ASSERT_EQUAL(12, eventCTX.lastValue);
+        TEST_ASSERT_EQUAL(1, eventCTX.samples);
+        TEST_ASSERT_NULL(eventHSM.getCurrentEvent());
+    }
+
+    void etest_external_payload()
+    {
+        setupEvent();
+        sSample sample = {2, 7};
+        {
+            Event e(eEEVENT_SAMPLE, &sample, sizeof(sample), releasePayload);
+            TEST_ASSERT_TRUE(e.isExternal());
+            TEST_ASSERT_EQUAL_PTR(&sample, e.data());
+            TEST_ASSERT_EQUAL(eOK, eventHSM.dispatch(e, &eventCTX));
+            TEST_ASSERT_EQUAL(7, eventCTX.lastValue);
+            TEST_ASSERT_EQUAL(0, releases);
+        }
+        // Released once the event is destroyed
+        TEST_ASSERT_EQUAL(1, releases);
+    }
+
+    void etest_move_semantics()
+    {
+        setupEvent();
+        sSample sample = {3, 1};
+        Event a(eEEVENT_SAMPLE, &sample, sizeof(sample), releasePayload);
+        Event b(std::move(a));
+        TEST_ASSERT_EQUAL(0, a.size());
+        TEST_ASSERT_NULL(a.data());
+        TEST_ASSERT_EQUAL_PTR(&sample, b.data());
+
+        // Moving into an event with payload releases its old payload
+        Event c(eEEVENT_SAMPLE, &sample, sizeof(sample), releasePayload);
+        c = std::move(b);
+        TEST_ASSERT_EQUAL(1, releases);
+        c.reset();
+        TEST_ASSERT_EQUAL(2, releases);
+        TEST_ASSERT_EQUAL(eEEVENT_SAMPLE, c.getID());
+
+        // Inline payloads are copied on move
+        Event d(eEEVENT_LIMIT, 42);
+        Event f(std::move(d));
+        TEST_ASSERT_FALSE(f.isExternal());
+        TEST_ASSERT_EQUAL(42, *f.get<int>());
+        TEST_ASSERT_NULL(f.get<sSample>());
+    }
+
+    void etest_payload_queue()
+    {
+        setupEvent();
+        PayloadQueue<4> queue;
+        sSample sample = {4, 3};
+        TEST_ASSERT_TRUE(queue.push(Event(eEEVENT_LIMIT, 2)));
+        TEST_ASSERT_TRUE(queue.push(Event(eEEVENT_SAMPLE, &sample, sizeof(sample), releasePayload)));
+        TEST_ASSERT_EQUAL(2, queue.size());
+        TEST_ASSERT_EQUAL(0, releases);
+
+        Event e;
+        while (queue.pop(e)) eventHSM.dispatch(e, &eventCTX);
+        TEST_ASSERT_TRUE(eventHSM.inState(eESTATE_ALARM));
+        TEST_ASSERT_EQUAL(3, eventCTX.lastValue);
+
+        // Payload is released when the popped event is reset
+        e.reset();
+        TEST_ASSERT_EQUAL(1, releases);
+    }
+
+    void etest_dispatch_by_id()
+    {
+        setupEvent();
+        eventHSM.dispatch(Event(eEEVENT_SAMPLE, sSample{0, 1}), &eventCTX);
+        TEST_ASSERT_TRUE(eventHSM.inState(eESTATE_ALARM));
+
+        // Effects receive an event without payload
+        TEST_ASSERT_EQUAL(eOK, eventHSM.dispatch(eEEVENT_SAMPLE, &eventCTX));
+        TEST_ASSERT_EQUAL(2, eventCTX.samples);
+        TEST_ASSERT_EQUAL(1, eventCTX.lastValue);
+    }
+
+    void run_event_tests(void)
+    {
+        RUN_TEST(etest_inline_payload);
+        RUN_TEST(etest_external_payload);
+        RUN_TEST(etest_move_semantics);
+        RUN_TEST(etest_payload_queue);
+        RUN_TEST(etest_dispatch_by_id);
+    }
+}
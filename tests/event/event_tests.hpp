@@ -0,0 +1,9 @@
+#ifndef _H_MICROHSM_TESTS_EVENT_TESTS
+#define _H_MICROHSM_TESTS_EVENT_TESTS
+
+namespace microhsm_tests
+{
+    void run_event_tests(void);
+}
+
+#endif
@@ -10,7 +10,7 @@ namespace microhsm_tests {
     void setup()
     {
         MICROHSM_TEST_MESSAGE("Initializing history test HSM")
-        historyHSM.init(nullptr);
+        TEST_ASSERT_EQUAL(eOK, historyHSM.init(nullptr));
         MICROHSM_TEST_MESSAGE("Initialized")
 
     }
@@ -0,0 +1,263 @@
+#include <string.h>
+#include <unity.h>
+
+#include <context/TestCTX.hpp>
+
+#include <journal/journal_tests.hpp>
+#include <basic/TestHSM.hpp>
+#include <event/EventHSM.hpp>
+#include <history/HistoryHSM.hpp>
+
+namespace microhsm_tests
+{
+    /// Storage receiving committed records
+    typedef struct {
+        uint8_t data[1024];
+        unsigned int length;
+        unsigned int commits;
+        bool fail;
+    } sJournalStorage;
+
+    static bool storeRecords(void* ctx, const uint8_t* data, unsigned int size)
+    {
+        sJournalStorage* storage = static_cast<sJournalStorage*>(ctx);
+        if (storage->fail || storage->length + size > sizeof(storage->data)) return false;
+        memcpy(storage->data + storage->length, data, size);
+        storage->length += size;
+        storage->commits++;
+        return true;
+    }
+
+    static sJournalStorage journalStorage;
+    static HistoryHSM journalSource = HistoryHSM();
+    static HistoryHSM journalTarget = HistoryHSM();
+
+    static void setupJournal()
+    {
+        memset(&journalStorage, 0, sizeof(journalStorage));
+    }
+
+    /**
+     * @brief Test replaying recorded events into another instance
+     */
+    void jtest_record_replay()
+    {
+        setupJournal();
+        EventJournal<256> journal(storeRecords, &journalStorage);
+        TEST_ASSERT_EQUAL(eOK, journalSource.init(nullptr));
+        TEST_ASSERT_EQUAL(eOK, journalTarget.init(nullptr));
+        journalSource.attachJournal(&journal, 1);
+
+        // C: I -> H(H1(H11)), C: H11 -> H12, B: H -> I, B: I -> H (deep history)
+        static const unsigned int events[] = {eHEVENT_C, eHEVENT_C, eHEVENT_B, eHEVENT_B};
+        for (unsigned int i = 0; i < sizeof(events) / sizeof(events[0]); i++) {
+            journalSource.dispatch(events[i], nullptr);
+        }
+        TEST_ASSERT_TRUE(journal.checkpoint(1, journalSource));
+        TEST_ASSERT_EQUAL(5, journal.getSequence());
+        TEST_ASSERT_EQUAL(0, journalStorage.length);
+        TEST_ASSERT_TRUE(journal.commit());
+        TEST_ASSERT_EQUAL(1, journalStorage.commits);
+        TEST_ASSERT_EQUAL((5 * JOURNAL_RECORD_HEADER_SIZE) + journalSource.getSnapshotSize(), journalStorage.length);
+        journalSource.attachJournal(nullptr, 0);
+
+        // Instance 0 is unused
+        BaseHSM* const hsms[] = {nullptr, &journalTarget};
+        JournalReplay replay(hsms, nullptr, 2);
+        TEST_ASSERT_EQUAL(eREPLAY_OK, replay.replay(journalStorage.data, journalStorage.length));
+        TEST_ASSERT_EQUAL(4, replay.getEvents());
+        TEST_ASSERT_EQUAL(1, replay.getCheckpoints());
+        TEST_ASSERT_EQUAL(journalStorage.length, replay.getOffset());
+        TEST_ASSERT_EQUAL(journalSource.getCurrentState()->ID, journalTarget.getCurrentState()->ID);
+        TEST_ASSERT_TRUE(journalTarget.inState(eSTATE_H12));
+    }
+
+    /**
+     * @brief Test that payloads are journaled and replayed with behavior
+     */
+    void jtest_payload()
+    {
+        setupJournal();
+        EventJournal<256> journal(storeRecords, &journalStorage);
+        EventHSM source = EventHSM();
+        EventHSM target = EventHSM();
+        sEventCTX sourceCTX = {0, 0, 0};
+        sEventCTX targetCTX = {0, 0, 0};
+        TEST_ASSERT_EQUAL(eOK, source.init(&sourceCTX));
+        TEST_ASSERT_EQUAL(eOK, target.init(&targetCTX));
+        source.attachJournal(&journal, 0);
+
+        // Guard of samples depends on the limit stored by a transition effect
+        sSample low = {1, 5};
+        sSample high = {1, 12};
+        source.dispatch(Event(eEEVENT_LIMIT, 10), &sourceCTX);
+        source.dispatch(Event(eEEVENT_SAMPLE, low), &sourceCTX);
+        source.dispatch(Event(eEEVENT_SAMPLE, &high, sizeof(high), nullptr), &sourceCTX);
+        TEST_ASSERT_TRUE(source.inState(eESTATE_ALARM));
+        TEST_ASSERT_TRUE(journal.checkpoint(0, source));
+        TEST_ASSERT_TRUE(journal.commit());
+
+        BaseHSM* const hsms[] = {&target};
+        void* const contexts[] = {&targetCTX};
+        JournalReplay replay(hsms, contexts, 1);
+        TEST_ASSERT_EQUAL(eREPLAY_OK, replay.replay(journalStorage.data, journalStorage.length));
+        TEST_ASSERT_TRUE(target.inState(eESTATE_ALARM));
+        TEST_ASSERT_EQUAL(sourceCTX.limit, targetCTX.limit);
+        TEST_ASSERT_EQUAL(sourceCTX.lastValue, targetCTX.lastValue);
+        TEST_ASSERT_EQUAL(sourceCTX.samples, targetCTX.samples);
+    }
+
+    /**
+     * @brief Test committing records in groups and dropping records that cannot be committed
+     */
+    void jtest_group_commit()
+    {
+        setupJournal();
+        TestCTX ctx = TestCTX();
+        TestHSM hsm = TestHSM();
+        ctx.init();
+        TEST_ASSERT_EQUAL(eOK, hsm.init(&ctx));
+
+        // Buffer holds four records without payload
+        EventJournal<(4 * JOURNAL_RECORD_HEADER_SIZE) + 4> journal(storeRecords, &journalStorage);
+        hsm.attachJournal(&journal, 0);
+        for (unsigned int i = 0; i < 10; i++) {
+            hsm.dispatch(eEVENT_A + (i % 3), &ctx);
+        }
+        TEST_ASSERT_EQUAL(2, journalStorage.commits);
+        TEST_ASSERT_EQUAL(8 * JOURNAL_RECORD_HEADER_SIZE, journalStorage.length);
+        TEST_ASSERT_EQUAL(2 * JOURNAL_RECORD_HEADER_SIZE, journal.getPending());
+
+        // Failing storage keeps pending records, records that do not fit are dropped
+        journalStorage.fail = true;
+        for (unsigned int i = 0; i < 4; i++) {
+            hsm.dispatch(eEVENT_A, &ctx);
+        }
+        TEST_ASSERT_EQUAL(2, journal.getDropped());
+        TEST_ASSERT_EQUAL(2, journal.getFailedCommits());
+        TEST_ASSERT_FALSE(journal.commit());
+        journalStorage.fail = false;
+        TEST_ASSERT_TRUE(journal.commit());
+        hsm.dispatch(eEVENT_B, &ctx);
+        TEST_ASSERT_TRUE(journal.commit());
+        TEST_ASSERT_EQUAL(4, journal.getCommits());
+        TEST_ASSERT_EQUAL(0, journal.getPending());
+        TEST_ASSERT_EQUAL(15, journal.getSequence());
+
+        // Replay stops at the gap left by the dropped records
+        TestHSM target = TestHSM();
+        TEST_ASSERT_EQUAL(eOK, target.init(&ctx));
+        BaseHSM* const hsms[] = {&target};
+        void* const contexts[] = {&ctx};
+        JournalReplay replay(hsms, contexts, 1);
+        TEST_ASSERT_EQUAL(eREPLAY_SEQUENCE, replay.replay(journalStorage.data, journalStorage.length));
+        TEST_ASSERT_EQUAL(12, replay.getEvents());
+        TEST_ASSERT_EQUAL(12, replay.getSequence());
+        TEST_ASSERT_EQUAL(12 * JOURNAL_RECORD_HEADER_SIZE, replay.getOffset());
+    }
+
+    /**
+     * @brief Test replaying without performing behavior
+     */
+    void jtest_suppressed()
+    {
+        setupJournal();
+        EventJournal<512> journal(storeRecords, &journalStorage);
+        TestCTX ctx = TestCTX();
+        TestHSM source = TestHSM();
+        TestHSM target = TestHSM();
+        ctx.init();
+        TEST_ASSERT_EQUAL(eOK, source.init(&ctx));
+        TEST_ASSERT_EQUAL(eOK, target.init(&ctx));
+        source.attachJournal(&journal, 0);
+        for (unsigned int i = 0; i < 20; i++) {
+            source.dispatch(eEVENT_A + ((i * 3u) % 7u), &ctx);
+            source.dispatch(eEVENT_A + (((i * 5u) + 1u) % 7u), &ctx);
+        }
+        TEST_ASSERT_TRUE(journal.checkpoint(0, source));
+        TEST_ASSERT_TRUE(journal.commit());
+
+        unsigned int entries[eSTATE_COUNT];
+        unsigned int exits[eSTATE_COUNT];
+        for (unsigned int id = 0; id < eSTATE_COUNT; id++) {
+            entries[id] = static_cast<TestState*>(target.getVertex(id))->getEntryCount();
+            exits[id] = static_cast<TestState*>(target.getVertex(id))->getExitCount();
+        }
+
+        BaseHSM* const hsms[] = {&target};
+        void* const contexts[] = {&ctx};
+        JournalReplay replay(hsms, contexts, 1);
+        replay.suppressBehavior(true);
+        TEST_ASSERT_EQUAL(eREPLAY_OK, replay.replay(journalStorage.data, journalStorage.length));
+        TEST_ASSERT_EQUAL(1, replay.getCheckpoints());
+        TEST_ASSERT_EQUAL(source.getCurrentState()->ID, target.getCurrentState()->ID);
+        for (unsigned int id = 0; id < eSTATE_COUNT; id++) {
+            TEST_ASSERT_EQUAL(entries[id], static_cast<TestState*>(target.getVertex(id))->getEntryCount());
+            TEST_ASSERT_EQUAL(exits[id], static_cast<TestState*>(target.getVertex(id))->getExitCount());
+        }
+
+        // Behavior is performed again after the replay
+        const unsigned int exitsBefore = static_cast<TestState*>(target.getCurrentState())->getExitCount();
+        BaseState* const left = target.getCurrentState();
+        for (unsigned int e = eEVENT_A; e <= eEVENT_G && target.getCurrentState() == left; e++) {
+            target.dispatch(e, &ctx);
+        }
+        TEST_ASSERT_TRUE(target.getCurrentState() != left);
+        TEST_ASSERT_EQUAL(exitsBefore + 1, static_cast<TestState*>(left)->getExitCount());
+    }
+
+    /**
+     * @brief Test replaying chunks and rejecting invalid records
+     */
+    void jtest_invalid()
+    {
+        setupJournal();
+        EventJournal<256> journal(storeRecords, &journalStorage);
+        TEST_ASSERT_EQUAL(eOK, journalSource.init(nullptr));
+        TEST_ASSERT_EQUAL(eOK, journalTarget.init(nullptr));
+        journalSource.attachJournal(&journal, 0);
+        journalSource.dispatch(eHEVENT_C, nullptr);
+        TEST_ASSERT_TRUE(journal.checkpoint(0, journalSource));
+        journalSource.dispatch(eHEVENT_C, nullptr);
+        TEST_ASSERT_TRUE(journal.checkpoint(0, journalSource));
+        TEST_ASSERT_TRUE(journal.commit());
+        journalSource.attachJournal(nullptr, 0);
+        const unsigned int first = JOURNAL_RECORD_HEADER_SIZE;
+        const unsigned int checkpoint = JOURNAL_RECORD_HEADER_SIZE + journalSource.getSnapshotSize();
+
+        // Chunk ending within a record continues at the offset
+        BaseHSM* const hsms[] = {&journalTarget};
+        JournalReplay replay(hsms, nullptr, 1);
+        TEST_ASSERT_EQUAL(eREPLAY_TRUNCATED, replay.replay(journalStorage.data, first + 3));
+        TEST_ASSERT_EQUAL(first, replay.getOffset());
+        const unsigned long offset = replay.getOffset();
+        TEST_ASSERT_EQUAL(eREPLAY_OK, replay.replay(journalStorage.data + offset, journalStorage.length - offset));
+        TEST_ASSERT_EQUAL(2, replay.getCheckpoints());
+
+        // Configuration differs from the first checkpoint
+        TEST_ASSERT_EQUAL(eOK, journalTarget.init(nullptr));
+        JournalReplay mismatch(hsms, nullptr, 1);
+        TEST_ASSERT_EQUAL(eREPLAY_SEQUENCE, mismatch.replay(journalStorage.data + first, journalStorage.length - first));
+        TEST_ASSERT_EQUAL(0, mismatch.getOffset());
+        mismatch.setSequence(1);
+        TEST_ASSERT_EQUAL(eREPLAY_MISMATCH, mismatch.replay(journalStorage.data + first, journalStorage.length - first));
+        TEST_ASSERT_EQUAL(0, mismatch.getCheckpoints());
+
+        // Unknown instance
+        TEST_ASSERT_EQUAL(eOK, journalTarget.init(nullptr));
+        JournalReplay unknown(hsms, nullptr, 1);
+        journalStorage.data[first + checkpoint + 4] = 1;
+        TEST_ASSERT_EQUAL(eREPLAY_INSTANCE, unknown.replay(journalStorage.data, journalStorage.length));
+        TEST_ASSERT_EQUAL(first + checkpoint, unknown.getOffset());
+        TEST_ASSERT_EQUAL(2, unknown.getSequence());
+    }
+
+    void run_journal_tests(void)
+    {
+        RUN_TEST(jtest_record_replay);
+        RUN_TEST(jtest_payload);
+        RUN_TEST(jtest_group_commit);
+        RUN_TEST(jtest_suppressed);
+        RUN_TEST(jtest_invalid);
+    }
+}
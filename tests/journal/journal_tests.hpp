@@ -0,0 +1,9 @@
+#ifndef _H_MICROHSM_TESTS_JOURNAL_TESTS
+#define _H_MICROHSM_TESTS_JOURNAL_TESTS
+
+namespace microhsm_tests
+{
+    void run_journal_tests(void);
+}
+
+#endif
@@ -0,0 +1,115 @@
+#include <unity.h>
+
+#include <context/TestCTX.hpp>
+
+#include <lca/lca_tests.hpp>
+#include <basic/TestHSM.hpp>
+#include <history/HistoryHSM.hpp>
+
+namespace microhsm_tests
+{
+    static TestCTX lcaCTX = TestCTX();
+    static TestHSM lcaHSM = TestHSM();
+    static HistoryHSM lcaHistoryHSM = HistoryHSM();
+
+    static const eLCAStrategy strategies[] = {eLCA_WALK, eLCA_MATRIX, eLCA_LIFTING};
+    static const unsigned int STRATEGY_COUNT = sizeof(strategies) / sizeof(strategies[0]);
+
+    /// Events dispatched to `TestHSM`
+    static const unsigned int lcaEvents[] = {
+        eEVENT_A, eEVENT_B, eEVENT_F, eEVENT_F, eEVENT_B, eEVENT_C, eEVENT_C, eEVENT_E,
+        eEVENT_G, eEVENT_A, eEVENT_D, eEVENT_E, eEVENT_B, eEVENT_E, eEVENT_E, eEVENT_G,
+    };
+    static const unsigned int LCA_EVENT_COUNT = sizeof(lcaEvents) / sizeof(lcaEvents[0]);
+
+    /* Private functions */
+    static BaseState* expectedAncestor(BaseHSM& hsm, unsigned int ID1, unsigned int ID2)
+    {
+        // Deepest ancestor (or self) of first state that is ancestor (or self) of second state
+        BaseState* s = static_cast<BaseState*>(hsm.getVertex(ID1));
+        BaseState* other = static_cast<BaseState*>(hsm.getVertex(ID2));
+        while (s != nullptr) {
+            BaseState* o = other;
+            while (o != nullptr && o != s) o = o->parent;
+            if (o != nullptr) break;
+            s = s->parent;
+        }
+        return s;
+    }
+
+    static void verifyAllPairs(BaseHSM& hsm, unsigned int minID, unsigned int maxID)
+    {
+        for (unsigned int a = minID; a <= maxID; a++) {
+            Vertex* va = hsm.getVertex(a);
+            if (va == nullptr || va->TYPE != Vertex::eSTATE) continue;
+            for (unsigned int b = minID; b <= maxID; b++) {
+                Vertex* vb = hsm.getVertex(b);
+                if (vb == nullptr || vb->TYPE != Vertex::eSTATE) continue;
+                TEST_ASSERT_EQUAL_PTR(expectedAncestor(hsm, a, b), hsm.getCommonAncestor(a, b));
+            }
+        }
+    }
+
+    void ltest_strategy_selection()
+    {
+        lcaCTX.init();
+        TEST_ASSERT_EQUAL(eOK, lcaHSM.init(&lcaCTX));
+        TEST_ASSERT_EQUAL(eLCA_MATRIX, lcaHSM.getLCAStrategy());
+
+        TEST_ASSERT_TRUE(lcaHSM.setLCAStrategy(eLCA_LIFTING));
+        TEST_ASSERT_EQUAL(eLCA_LIFTING, lcaHSM.getLCAStrategy());
+        TEST_ASSERT_TRUE(lcaHSM.setLCAStrategy(eLCA_WALK));
+        TEST_ASSERT_EQUAL(eLCA_WALK, lcaHSM.getLCAStrategy());
+
+        // Initialization selects strategy again
+        TEST_ASSERT_EQUAL(eOK, lcaHSM.init(&lcaCTX));
+        TEST_ASSERT_EQUAL(eLCA_MATRIX, lcaHSM.getLCAStrategy());
+    }
+
+    void ltest_common_ancestors()
+    {
+        lcaCTX.init();
+        TEST_ASSERT_EQUAL(eOK, lcaHSM.init(&lcaCTX));
+        TEST_ASSERT_EQUAL(eOK, lcaHistoryHSM.init(&lcaCTX));
+
+        for (unsigned int i = 0; i < STRATEGY_COUNT; i++) {
+            TEST_ASSERT_TRUE(lcaHSM.setLCAStrategy(strategies[i]));
+            TEST_ASSERT_TRUE(lcaHistoryHSM.setLCAStrategy(strategies[i]));
+            verifyAllPairs(lcaHSM, 0, lcaHSM.getMaxID());
+            verifyAllPairs(lcaHistoryHSM, eSTATE_H, lcaHistoryHSM.getMaxID());
+        }
+
+        TEST_ASSERT_EQUAL(eSTATE_S, lcaHSM.getCommonAncestor(eSTATE_S21, eSTATE_S1)->ID);
+        TEST_ASSERT_NULL(lcaHSM.getCommonAncestor(eSTATE_S21, eSTATE_U));
+        TEST_ASSERT_NULL(lcaHSM.getCommonAncestor(eSTATE_S21, 1000));
+    }
+
+    void ltest_dispatch_strategies()
+    {
+        unsigned int walked[LCA_EVENT_COUNT];
+
+        for (unsigned int i = 0; i < STRATEGY_COUNT; i++) {
+            lcaCTX.init();
+            TEST_ASSERT_EQUAL(eOK, lcaHSM.init(&lcaCTX));
+            TEST_ASSERT_TRUE(lcaHSM.setLCAStrategy(strategies[i]));
+
+            for (unsigned int e = 0; e < LCA_EVENT_COUNT; e++) {
+                lcaHSM.dispatch(lcaEvents[e], &lcaCTX);
+                unsigned int id = lcaHSM.getCurrentState()->ID;
+                if (strategies[i] == eLCA_WALK) {
+                    walked[e] = id;
+                }
+                else {
+                    TEST_ASSERT_EQUAL(walked[e], id);
+                }
+            }
+        }
+    }
+
+    void run_lca_tests(void)
+    {
+        RUN_TEST(ltest_strategy_selection);
+        RUN_TEST(ltest_common_ancestors);
+        RUN_TEST(ltest_dispatch_strategies);
+    }
+}
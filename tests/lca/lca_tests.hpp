@@ -0,0 +1,9 @@
+#ifndef _H_MICROHSM_TESTS_LCA_TESTS
+#define _H_MICROHSM_TESTS_LCA_TESTS
+
+namespace microhsm_tests
+{
+    void run_lca_tests(void);
+}
+
+#endif
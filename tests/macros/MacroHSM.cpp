@@ -11,6 +11,8 @@
 namespace microhsm_tests
 {
 
+    HSMDefinition MacroHSM::definition;
+
     Vertex* MacroHSM::getVertex(unsigned int ID)
     {
         unsigned int index = ID - 8;
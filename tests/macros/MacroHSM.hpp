@@ -59,7 +59,10 @@ namespace microhsm_tests
     {
     public:
 
-        MacroHSM() : BaseHSM(state_s) {};
+        /// Structure shared by all instances
+        static HSMDefinition definition;
+
+        MacroHSM() : BaseHSM(state_s, definition) {};
 
         Vertex* getVertex(unsigned int ID) override;
         unsigned int getMaxID() override;
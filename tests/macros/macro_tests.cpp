@@ -15,7 +15,7 @@ namespace microhsm_tests
     {
         MICROHSM_TEST_MESSAGE("Initializing macro test HSM")
         testCTX.init();
-        macroHSM.init(static_cast<void*>(&testCTX));
+        TEST_ASSERT_EQUAL(eOK, macroHSM.init(static_cast<void*>(&testCTX)));
         MICROHSM_TEST_MESSAGE("Initialized")
     }
 
@@ -262,6 +262,18 @@ namespace microhsm_tests
         TEST_ASSERT_TRUE(testCTX.getFlag());
     }
 
+    void mtest_index_type()
+    {
+        // Enumerations and stored IDs follow `MICROHSM_INDEX_TYPE`
+        bool vertexEnum = std::is_same<std::underlying_type<e_mstates>::type, microhsm::tVertexID>::value;
+        bool eventEnum = std::is_same<std::underlying_type<e_mevents>::type, microhsm::tEventID>::value;
+        TEST_ASSERT_TRUE(vertexEnum);
+        TEST_ASSERT_TRUE(eventEnum);
+        TEST_ASSERT_EQUAL(sizeof(MICROHSM_INDEX_TYPE), sizeof(macroHSM.state_s.ID));
+        TEST_ASSERT_EQUAL(sizeof(MICROHSM_INDEX_TYPE), sizeof(macroHSM.state_s.depth));
+        TEST_ASSERT_TRUE(VERTEX_ID_MAX == std::numeric_limits<MICROHSM_INDEX_TYPE>::max());
+    }
+
     void run_macro_tests(void)
     {
         RUN_TEST(mtest_initial_configuration);
@@ -272,5 +284,6 @@ namespace microhsm_tests
         RUN_TEST(mtest_transition_e);
         RUN_TEST(mtest_transition_f);
         RUN_TEST(mtest_transition_g);
+        RUN_TEST(mtest_index_type);
     }
 }
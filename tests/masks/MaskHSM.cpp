@@ -0,0 +1,89 @@
+/**
+ * @file MaskHSM.cpp
+ * @brief Test HSM with states declaring their handled events
+ */
+
+#include <masks/MaskHSM.hpp>
+
+namespace microhsm_tests
+{
+
+    HSMDefinition MaskHSM::definition;
+
+    Vertex* MaskHSM::getVertex(unsigned int ID)
+    {
+        unsigned int index = ID - eKSTATE_P;
+        if (index >= (sizeof(states) / sizeof(Vertex*))) {
+                return nullptr;
+        }
+        return this->states[index];
+    }
+
+    unsigned int MaskHSM::getMaxID()
+    {
+        return eKSTATE_E;
+    }
+
+    HSM_DEFINE_STATE_MATCH(KStateP)
+    {
+        static_cast<sMaskCTX*>(ctx)->matchCalls++;
+        switch(event) {
+            case eKEVENT_X:
+                return transitionExternal(eKSTATE_B, t, nullptr);
+            default:
+                break;
+        }
+        return noTransition();
+    }
+
+    HSM_DEFINE_STATE_MATCH(KStateA)
+    {
+        static_cast<sMaskCTX*>(ctx)->matchCalls++;
+        switch(event) {
+            case eKEVENT_Y:
+            case eKEVENT_HIGH:
+                return transitionExternal(eKSTATE_B, t, nullptr);
+            default:
+                break;
+        }
+        return noTransition();
+    }
+
+    HSM_DEFINE_STATE_MATCH(KStateB)
+    {
+        static_cast<sMaskCTX*>(ctx)->matchCalls++;
+        switch(event) {
+            case eKEVENT_Z:
+                return transitionExternal(eKSTATE_A, t, nullptr);
+            case eKEVENT_W:
+                return transitionExternal(eKSTATE_D, t, nullptr);
+            default:
+                break;
+        }
+        return noTransition();
+    }
+
+    HSM_DEFINE_STATE_MATCH(KStateD)
+    {
+        static_cast<sMaskCTX*>(ctx)->matchCalls++;
+        switch(event) {
+            case EVENT_ANONYMOUS:
+                return transitionExternal(eKSTATE_E, t, nullptr);
+            default:
+                break;
+        }
+        return noTransition();
+    }
+
+    HSM_DEFINE_STATE_MATCH(KStateE)
+    {
+        static_cast<sMaskCTX*>(ctx)->matchCalls++;
+        switch(event) {
+            case eKEVENT_V:
+                return transitionExternal(eKSTATE_A, t, nullptr);
+            default:
+                break;
+        }
+        return noTransition();
+    }
+}
@@ -0,0 +1,83 @@
+/**
+ * @file MaskHSM.hpp
+ * @brief Test HSM with states declaring their handled events
+ */
+#ifndef _H_MICROHSM_TESTS_MASKHSM
+#define _H_MICROHSM_TESTS_MASKHSM
+
+#include <microhsm/microhsm.hpp>
+#include <microhsm/macros.hpp>
+
+using namespace microhsm;
+
+namespace microhsm_tests
+{
+    /// @brief Event enumerations
+    HSM_CREATE_EVENT_LIST(e_kevents,
+            eKEVENT_X,
+            eKEVENT_Y,
+            eKEVENT_Z,
+            eKEVENT_W,
+            eKEVENT_V,
+            eKEVENT_HIGH = 100  // Does not fit into event mask
+    )
+
+    HSM_CREATE_VERTEX_LIST(e_kstates,
+            eKSTATE_P = 30,
+            eKSTATE_A,
+            eKSTATE_B,
+            eKSTATE_D,
+            eKSTATE_E
+    )
+
+    /// @brief Context counting the number of `match` calls
+    typedef struct {
+        unsigned int matchCalls;
+    } sMaskCTX;
+
+    /* State Declarations */
+    HSM_DECLARE_STATE_TOP_LEVEL(KStateP, eKSTATE_P,
+        HSM_DECLARE_HANDLED_EVENTS(eKEVENT_X)
+    )
+    HSM_DECLARE_STATE(KStateA, eKSTATE_A, KStateP,
+        HSM_DECLARE_HANDLED_EVENTS(eKEVENT_Y, eKEVENT_HIGH)
+    )
+    HSM_DECLARE_STATE(KStateB, eKSTATE_B, KStateP,
+        HSM_DECLARE_HANDLED_EVENTS(eKEVENT_Z, eKEVENT_W)
+    )
+    HSM_DECLARE_STATE_TOP_LEVEL(KStateD, eKSTATE_D,
+        HSM_DECLARE_HANDLED_EVENTS(EVENT_ANONYMOUS)
+    )
+    // Does not declare handled events
+    HSM_DECLARE_STATE_TOP_LEVEL(KStateE, eKSTATE_E)
+
+    /* HSM Declaration */
+    class MaskHSM : public BaseHSM
+    {
+    public:
+
+        /// Structure shared by all instances
+        static HSMDefinition definition;
+
+        MaskHSM() : BaseHSM(state_p, definition) {};
+
+        Vertex* getVertex(unsigned int ID) override;
+        unsigned int getMaxID() override;
+
+        KStateP state_p = KStateP(&state_a);
+        KStateA state_a = KStateA(&state_p, nullptr);
+        KStateB state_b = KStateB(&state_p, nullptr);
+        KStateD state_d = KStateD(nullptr);
+        KStateE state_e = KStateE(nullptr);
+
+        BaseState* states[5] = {
+            &state_p,
+            &state_a,
+            &state_b,
+            &state_d,
+            &state_e
+        };
+    };
+}
+
+#endif
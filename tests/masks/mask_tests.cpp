@@ -0,0 +1,129 @@
+#include "microhsm_config.hpp"
+#include <unity.h>
+
+#include <masks/mask_tests.hpp>
+#include <masks/MaskHSM.hpp>
+
+namespace microhsm_tests
+{
+
+    static MaskHSM maskHSM = MaskHSM();
+    static sMaskCTX maskCTX;
+
+    static void maskSetup()
+    {
+        maskCTX.matchCalls = 0;
+        TEST_ASSERT_EQUAL(eOK, maskHSM.init(static_cast<void*>(&maskCTX)));
+    }
+
+    void ktest_event_masks()
+    {
+        TEST_ASSERT_EQUAL(0, eventMask());
+        TEST_ASSERT_EQUAL(0x1, eventMask(EVENT_ANONYMOUS));
+        TEST_ASSERT_EQUAL(0x6, eventMask(eKEVENT_X, eKEVENT_Y));
+        TEST_ASSERT_TRUE(eventMask(eKEVENT_HIGH) == eventBit(EVENT_MASK_BITS - 1));
+        TEST_ASSERT_TRUE(eventMask(eKEVENT_HIGH) == eventBit(eKEVENT_HIGH + 1));
+    }
+
+    void ktest_initial_configuration()
+    {
+        maskSetup();
+        TEST_ASSERT_TRUE(maskHSM.inState(eKSTATE_P));
+        TEST_ASSERT_TRUE(maskHSM.inState(eKSTATE_A));
+        // No state handles anonymous events
+        TEST_ASSERT_EQUAL(0, maskCTX.matchCalls);
+    }
+
+    void ktest_ignored_events()
+    {
+        maskSetup();
+        // Not handled by A or P
+        TEST_ASSERT_EQUAL(eEVENT_IGNORED, maskHSM.dispatch(eKEVENT_Z, &maskCTX));
+        TEST_ASSERT_EQUAL(eEVENT_IGNORED, maskHSM.dispatch(eKEVENT_W, &maskCTX));
+        TEST_ASSERT_EQUAL(eEVENT_IGNORED, maskHSM.dispatch(eKEVENT_V, &maskCTX));
+        TEST_ASSERT_TRUE(maskHSM.inState(eKSTATE_A));
+        TEST_ASSERT_EQUAL(0, maskCTX.matchCalls);
+    }
+
+    void ktest_ancestor_match()
+    {
+        maskSetup();
+        // X: A is skipped, P -> B
+        TEST_ASSERT_EQUAL(eOK, maskHSM.dispatch(eKEVENT_X, &maskCTX));
+        TEST_ASSERT_TRUE(maskHSM.inState(eKSTATE_B));
+        TEST_ASSERT_EQUAL(1, maskCTX.matchCalls);
+
+        // Z: B -> A
+        TEST_ASSERT_EQUAL(eOK, maskHSM.dispatch(eKEVENT_Z, &maskCTX));
+        TEST_ASSERT_TRUE(maskHSM.inState(eKSTATE_A));
+        TEST_ASSERT_EQUAL(2, maskCTX.matchCalls);
+    }
+
+    void ktest_event_outside_mask()
+    {
+        maskSetup();
+        // HIGH does not fit into mask, shares bit with other high events: A -> B
+        TEST_ASSERT_EQUAL(eOK, maskHSM.dispatch(eKEVENT_HIGH, &maskCTX));
+        TEST_ASSERT_TRUE(maskHSM.inState(eKSTATE_B));
+        TEST_ASSERT_EQUAL(1, maskCTX.matchCalls);
+    }
+
+    void ktest_anonymous_and_undeclared()
+    {
+        maskSetup();
+        TEST_ASSERT_EQUAL(eOK, maskHSM.dispatch(eKEVENT_X, &maskCTX));
+        maskCTX.matchCalls = 0;
+
+        // W: B -> D, anonymous: D -> E, E is matched against anonymous event
+        TEST_ASSERT_EQUAL(eOK, maskHSM.dispatch(eKEVENT_W, &maskCTX));
+        TEST_ASSERT_TRUE(maskHSM.inState(eKSTATE_E));
+        TEST_ASSERT_EQUAL(3, maskCTX.matchCalls);
+
+        // E does not declare handled events, every event is matched
+        TEST_ASSERT_EQUAL(eEVENT_IGNORED, maskHSM.dispatch(eKEVENT_Z, &maskCTX));
+        TEST_ASSERT_EQUAL(4, maskCTX.matchCalls);
+
+        // V: E -> A
+        TEST_ASSERT_EQUAL(eOK, maskHSM.dispatch(eKEVENT_V, &maskCTX));
+        TEST_ASSERT_TRUE(maskHSM.inState(eKSTATE_A));
+        TEST_ASSERT_EQUAL(5, maskCTX.matchCalls);
+    }
+
+    void ktest_skipped_anonymous_sweeps()
+    {
+        maskSetup();
+        TEST_ASSERT_EQUAL(0, maskHSM.getSkippedAnonymousSweeps());
+
+        // X: A -> B, no state of B's chain handles anonymous events
+        TEST_ASSERT_EQUAL(eOK, maskHSM.dispatch(eKEVENT_X, &maskCTX));
+        TEST_ASSERT_EQUAL(1, maskHSM.getSkippedAnonymousSweeps());
+
+        // Ignored events do not result in a sweep
+        TEST_ASSERT_EQUAL(eEVENT_IGNORED, maskHSM.dispatch(eKEVENT_Y, &maskCTX));
+        TEST_ASSERT_EQUAL(1, maskHSM.getSkippedAnonymousSweeps());
+
+        // W: B -> D -> E, D handles anonymous events, E does not declare its events
+        TEST_ASSERT_EQUAL(eOK, maskHSM.dispatch(eKEVENT_W, &maskCTX));
+        TEST_ASSERT_TRUE(maskHSM.inState(eKSTATE_E));
+        TEST_ASSERT_EQUAL(1, maskHSM.getSkippedAnonymousSweeps());
+
+        // V: E -> A
+        TEST_ASSERT_EQUAL(eOK, maskHSM.dispatch(eKEVENT_V, &maskCTX));
+        TEST_ASSERT_EQUAL(2, maskHSM.getSkippedAnonymousSweeps());
+
+        // Reset upon initialization
+        maskSetup();
+        TEST_ASSERT_EQUAL(0, maskHSM.getSkippedAnonymousSweeps());
+    }
+
+    void run_mask_tests(void)
+    {
+        RUN_TEST(ktest_event_masks);
+        RUN_TEST(ktest_initial_configuration);
+        RUN_TEST(ktest_ignored_events);
+        RUN_TEST(ktest_ancestor_match);
+        RUN_TEST(ktest_event_outside_mask);
+        RUN_TEST(ktest_anonymous_and_undeclared);
+        RUN_TEST(ktest_skipped_anonymous_sweeps);
+    }
+}
@@ -0,0 +1,9 @@
+#ifndef _H_MICROHSM_TESTS_MASK_TESTS
+#define _H_MICROHSM_TESTS_MASK_TESTS
+
+namespace microhsm_tests
+{
+    void run_mask_tests(void);
+}
+
+#endif
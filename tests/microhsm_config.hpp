@@ -20,6 +20,20 @@
 #endif
 
 
+// Enable transition cache
+#define MICROHSM_TRANSITION_CACHE_SIZE 8
+
+// Enable least common ancestor lookup (matrix for all test HSMs)
+#define MICROHSM_LCA_ACCELERATION 1
+#define MICROHSM_LCA_MATRIX_SIZE 8
+
+// Enable deferred events
+#define MICROHSM_DEFER_QUEUE_SIZE 8
+
+// Yield while waiting for a slot of a full multi-producer queue
+#include <thread>
+#define MICROHSM_QUEUE_WAIT() std::this_thread::yield()
+
 // Enable tracing
 #define MICROHSM_TRACING 1
 
@@ -111,6 +125,7 @@ inline const char* get_state_name_(unsigned int state)
 #define MICROHSM_TRACE_EXIT(id) std::cout << "EXIT," << get_state_name_(id) << std::endl
 #define MICROHSM_TRACE_DISPATCH_IGNORED(event) std::cout << "IGNORED," << get_event_name_(event) << std::endl
 #define MICROHSM_TRACE_DISPATCH_MATCHED(event, id) std::cout << "MATCH," << get_event_name_(event) << "," << get_state_name_(id) << std::endl
+#define MICROHSM_TRACE_INIT_ERROR(reason) std::cout << "INIT_ERROR," << reason << std::endl
 
 #define MICROHSM_TEST_MESSAGE(msg) std::cout << "MESSAGE," << msg << std::endl;
 
@@ -0,0 +1,142 @@
+/**
+ * @file OrthogonalHSM.cpp
+ * @brief Test HSM with an orthogonal state of two regions
+ */
+
+#include <thread>
+
+#include <orthogonal/OrthogonalHSM.hpp>
+
+namespace microhsm_tests
+{
+    HSMDefinition RegionAHSM::definition;
+    HSMDefinition RegionBHSM::definition;
+    HSMDefinition OrthogonalHSM::definition;
+
+    static void logState(void* ctx, unsigned int entry)
+    {
+        sOrthogonalCTX* c = static_cast<sOrthogonalCTX*>(ctx);
+        if (c->count < 32) c->log[c->count++] = entry;
+    }
+
+    static void countShared(void* ctx)
+    {
+        static_cast<sOrthogonalCTX*>(ctx)->shared++;
+    }
+
+    // Waits for the other region, only meets it when both regions run concurrently
+    static void rendezvous(void* ctx)
+    {
+        sOrthogonalCTX* c = static_cast<sOrthogonalCTX*>(ctx);
+        c->arrivals.fetch_add(1);
+        for (unsigned long i = 0; i < 10000000ul; i++) {
+            if (c->arrivals.load() >= 2) {
+                c->met.fetch_add(1);
+                return;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    void clearOrthogonalLog(sOrthogonalCTX& ctx)
+    {
+        ctx.count = 0;
+    }
+
+    HSM_DEFINE_STATE_ENTRY(OBaseState)
+    {
+        logState(ctx, this->ID);
+    }
+
+    HSM_DEFINE_STATE_EXIT(OBaseState)
+    {
+        logState(ctx, this->ID | ORTHOGONAL_EXIT);
+    }
+
+    HSM_DEFINE_STATE_MATCH(OStateOff)
+    {
+        (void)ctx;
+        if (event == eOEVENT_POWER) return transitionExternal(eOSTATE_ON, t, nullptr);
+        return noTransition();
+    }
+
+    void OStateOn::entry(void* ctx)
+    {
+        logState(ctx, this->ID);
+    }
+
+    void OStateOn::exit(void* ctx)
+    {
+        logState(ctx, this->ID | ORTHOGONAL_EXIT);
+    }
+
+    bool OStateOn::match(unsigned int event, sTransition* t, void* ctx)
+    {
+        (void)ctx;
+        switch (event) {
+            case eOEVENT_POWER:
+                return transitionExternal(eOSTATE_OFF, t, nullptr);
+            case eOEVENT_RESET:
+                return transitionExternal(eOSTATE_ON, t, nullptr);
+            default:
+                break;
+        }
+        return noTransition();
+    }
+
+    HSM_DEFINE_STATE_MATCH(OStateA1)
+    {
+        (void)ctx;
+        switch (event) {
+            case eOEVENT_KEY:
+                return transitionExternal(eOSTATE_A2, t, nullptr);
+            case eOEVENT_SHARED:
+                return transitionInternal(t, countShared);
+            case eOEVENT_SYNC:
+                return transitionInternal(t, rendezvous);
+            case eOEVENT_BROKEN:
+                // State of the owner, unknown to the region
+                return transitionExternal(eOSTATE_OFF, t, nullptr);
+            default:
+                break;
+        }
+        return noTransition();
+    }
+
+    HSM_DEFINE_STATE_MATCH(OStateA2)
+    {
+        (void)ctx;
+        if (event == eOEVENT_KEY) return transitionExternal(eOSTATE_A1, t, nullptr);
+        return noTransition();
+    }
+
+    HSM_DEFINE_STATE_MATCH(OStateB1)
+    {
+        (void)ctx;
+        switch (event) {
+            case eOEVENT_MODE:
+            case eOEVENT_SHARED:
+                return transitionExternal(eOSTATE_B2, t, nullptr);
+            case eOEVENT_SYNC:
+                return transitionInternal(t, rendezvous);
+            default:
+                break;
+        }
+        return noTransition();
+    }
+
+    HSM_DEFINE_STATE_MATCH(OStateB2)
+    {
+        (void)ctx;
+        if (event == eOEVENT_MODE) return transitionExternal(eOSTATE_B1, t, nullptr);
+        return noTransition();
+    }
+
+    HSM_DEFINE_STATE_MATCH(OStateB21)
+    {
+        (void)ctx;
+        (void)event;
+        (void)t;
+        return noTransition();
+    }
+}
@@ -0,0 +1,150 @@
+/**
+ * @file OrthogonalHSM.hpp
+ * @brief Test HSM with an orthogonal state of two regions
+ */
+#ifndef _H_MICROHSM_TESTS_ORTHOGONALHSM
+#define _H_MICROHSM_TESTS_ORTHOGONALHSM
+
+#include <atomic>
+
+#include <microhsm/microhsm.hpp>
+#include <microhsm/macros.hpp>
+
+using namespace microhsm;
+
+namespace microhsm_tests
+{
+    /// Exits are logged as the ID of the state with this flag set
+    static const unsigned int ORTHOGONAL_EXIT = 0x100;
+
+    /// @brief Event enumerations
+    HSM_CREATE_EVENT_LIST(e_oevents,
+            eOEVENT_POWER,
+            eOEVENT_KEY,
+            eOEVENT_MODE,
+            eOEVENT_SHARED,
+            eOEVENT_RESET,
+            eOEVENT_UNUSED,
+            eOEVENT_SYNC,
+            eOEVENT_BROKEN
+    )
+
+    HSM_CREATE_VERTEX_LIST(e_ostates,
+            eOSTATE_OFF = 90,
+            eOSTATE_ON,
+            eOSTATE_A1,
+            eOSTATE_A2,
+            eOSTATE_B1,
+            eOSTATE_B2,
+            eOSTATE_B21
+    )
+
+    /// @brief Context logging entries and exits
+    typedef struct {
+        unsigned int log[32];
+        unsigned int count;
+        unsigned int shared;
+        std::atomic<unsigned int> arrivals;     ///< Regions that reached the rendezvous
+        std::atomic<unsigned int> met;          ///< Regions that met another region at the rendezvous
+    } sOrthogonalCTX;
+
+    /// @brief Clear log of context
+    void clearOrthogonalLog(sOrthogonalCTX& ctx);
+
+    /* State Declarations */
+    // Logs entries and exits
+    HSM_DECLARE_BASE_STATE(OBaseState,
+        HSM_DECLARE_STATE_ENTRY()
+        HSM_DECLARE_STATE_EXIT()
+    )
+
+    HSM_DECLARE_STATE_TOP_LEVEL_FROM_BASE(OStateOff, OBaseState,
+        HSM_DECLARE_HANDLED_EVENTS(eOEVENT_POWER)
+    )
+
+    // Region A
+    HSM_DECLARE_STATE_TOP_LEVEL_FROM_BASE(OStateA1, OBaseState,
+        HSM_DECLARE_HANDLED_EVENTS(eOEVENT_KEY, eOEVENT_SHARED, eOEVENT_SYNC, eOEVENT_BROKEN)
+    )
+    HSM_DECLARE_STATE_TOP_LEVEL_FROM_BASE(OStateA2, OBaseState,
+        HSM_DECLARE_HANDLED_EVENTS(eOEVENT_KEY)
+    )
+
+    // Region B
+    HSM_DECLARE_STATE_TOP_LEVEL_FROM_BASE(OStateB1, OBaseState,
+        HSM_DECLARE_HANDLED_EVENTS(eOEVENT_MODE, eOEVENT_SHARED, eOEVENT_SYNC)
+    )
+    HSM_DECLARE_STATE_TOP_LEVEL_FROM_BASE(OStateB2, OBaseState,
+        HSM_DECLARE_HANDLED_EVENTS(eOEVENT_MODE)
+    )
+    HSM_DECLARE_STATE_FROM_BASE(OStateB21, OStateB2, OBaseState,
+        HSM_DECLARE_HANDLED_EVENTS()
+    )
+
+    /// @brief Orthogonal state with regions A and B
+    class OStateOn : public OrthogonalState<2>
+    {
+    public:
+
+        OStateOn(BaseHSM* const (&regions)[2]) : OrthogonalState<2>(eOSTATE_ON, nullptr, regions) {};
+
+        bool match(unsigned int event, sTransition* t, void* ctx) override;
+        void entry(void* ctx) override;
+        void exit(void* ctx) override;
+        HSM_DECLARE_HANDLED_EVENTS(eOEVENT_POWER, eOEVENT_RESET)
+    };
+
+    /* HSM Declarations */
+    class RegionAHSM : public BaseHSM
+    {
+    public:
+
+        /// Structure shared by all instances
+        static HSMDefinition definition;
+
+        RegionAHSM() : BaseHSM(state_a1, definition)
+        {
+            this->registerVertices({&state_a1, &state_a2});
+        };
+
+        OStateA1 state_a1 = OStateA1(eOSTATE_A1, nullptr);
+        OStateA2 state_a2 = OStateA2(eOSTATE_A2, nullptr);
+    };
+
+    class RegionBHSM : public BaseHSM
+    {
+    public:
+
+        /// Structure shared by all instances
+        static HSMDefinition definition;
+
+        RegionBHSM() : BaseHSM(state_b1, definition)
+        {
+            this->registerVertices({&state_b1, &state_b2, &state_b21});
+        };
+
+        OStateB1 state_b1 = OStateB1(eOSTATE_B1, nullptr);
+        OStateB2 state_b2 = OStateB2(eOSTATE_B2, &state_b21);
+        OStateB21 state_b21 = OStateB21(eOSTATE_B21, &state_b2, nullptr);
+    };
+
+    class OrthogonalHSM : public BaseHSM
+    {
+    public:
+
+        /// Structure shared by all instances
+        static HSMDefinition definition;
+
+        OrthogonalHSM(BaseHSM& regionA, BaseHSM& regionB) :
+            BaseHSM(state_off, definition),
+            state_on({&regionA, &regionB})
+        {
+            this->registerVertices({&state_off, &state_on});
+        };
+
+        OStateOff state_off = OStateOff(eOSTATE_OFF, nullptr);
+        OStateOn state_on;
+    };
+}
+
+#endif
@@ -0,0 +1,327 @@
+#include <string.h>
+#include <thread>
+
+#include <unity.h>
+
+#include <orthogonal/orthogonal_tests.hpp>
+#include <orthogonal/OrthogonalHSM.hpp>
+
+namespace microhsm_tests
+{
+    // Regions are constructed separately from the HSM owning them
+    static RegionAHSM regionA;
+    static RegionBHSM regionB;
+    static OrthogonalHSM orthogonalHSM(regionA, regionB);
+    static sOrthogonalCTX orthogonalCTX;
+
+    // Second machine of the same structure, receiving snapshots and journals
+    static RegionAHSM copyRegionA;
+    static RegionBHSM copyRegionB;
+    static OrthogonalHSM copyHSM(copyRegionA, copyRegionB);
+    static sOrthogonalCTX copyCTX;
+
+    /// Storage receiving committed journal records
+    typedef struct {
+        uint8_t data[256];
+        unsigned int length;
+    } sRegionJournal;
+
+    static sRegionJournal regionJournal;
+
+    static bool storeRegionRecords(void* ctx, const uint8_t* data, unsigned int size)
+    {
+        sRegionJournal* storage = static_cast<sRegionJournal*>(ctx);
+        if (storage->length + size > sizeof(storage->data)) return false;
+        memcpy(storage->data + storage->length, data, size);
+        storage->length += size;
+        return true;
+    }
+
+    static void setupOrthogonal()
+    {
+        orthogonalCTX.shared = 0;
+        TEST_ASSERT_EQUAL(eOK, orthogonalHSM.init(&orthogonalCTX));
+        clearOrthogonalLog(orthogonalCTX);
+    }
+
+    static void assertLog(const unsigned int* expected, unsigned int count)
+    {
+        TEST_ASSERT_EQUAL(count, orthogonalCTX.count);
+        TEST_ASSERT_EQUAL_UINT_ARRAY(expected, orthogonalCTX.log, count);
+        clearOrthogonalLog(orthogonalCTX);
+    }
+
+    void otest_entry_exit_order()
+    {
+        setupOrthogonal();
+        TEST_ASSERT_TRUE(orthogonalHSM.inState(eOSTATE_OFF));
+        TEST_ASSERT_FALSE(regionA.inState(eOSTATE_A1));
+
+        // State is entered before its regions, regions in order
+        TEST_ASSERT_EQUAL(eOK, orthogonalHSM.dispatch(eOEVENT_POWER, &orthogonalCTX));
+        const unsigned int entries[] = {
+            eOSTATE_OFF | ORTHOGONAL_EXIT, eOSTATE_ON, eOSTATE_A1, eOSTATE_B1
+        };
+        assertLog(entries, 4);
+        TEST_ASSERT_TRUE(orthogonalHSM.inState(eOSTATE_ON));
+        TEST_ASSERT_TRUE(regionA.inState(eOSTATE_A1));
+        TEST_ASSERT_TRUE(regionB.inState(eOSTATE_B1));
+
+        TEST_ASSERT_EQUAL(eOK, orthogonalHSM.dispatch(eOEVENT_MODE, &orthogonalCTX));
+        TEST_ASSERT_TRUE(regionB.inState(eOSTATE_B21));
+        clearOrthogonalLog(orthogonalCTX);
+
+        // Regions are exited innermost first in reverse order, before the state itself
+        TEST_ASSERT_EQUAL(eOK, orthogonalHSM.dispatch(eOEVENT_POWER, &orthogonalCTX));
+        const unsigned int exits[] = {
+            eOSTATE_B21 | ORTHOGONAL_EXIT, eOSTATE_B2 | ORTHOGONAL_EXIT, eOSTATE_A1 | ORTHOGONAL_EXIT,
+            eOSTATE_ON | ORTHOGONAL_EXIT, eOSTATE_OFF
+        };
+        assertLog(exits, 5);
+        TEST_ASSERT_NULL(regionA.getCurrentState());
+        TEST_ASSERT_NULL(regionB.getCurrentState());
+
+        // Events of regions are ignored while the orthogonal state is inactive
+        TEST_ASSERT_EQUAL(eEVENT_IGNORED, orthogonalHSM.dispatch(eOEVENT_KEY, &orthogonalCTX));
+    }
+
+    void otest_region_dispatch()
+    {
+        setupOrthogonal();
+        TEST_ASSERT_EQUAL(eOK, orthogonalHSM.dispatch(eOEVENT_POWER, &orthogonalCTX));
+        BaseOrthogonalState& on = orthogonalHSM.state_on;
+        TEST_ASSERT_EQUAL(2, on.getRegionCount());
+        TEST_ASSERT_EQUAL_PTR(&regionB, on.getRegion(1));
+        TEST_ASSERT_NULL(on.getRegion(2));
+
+        // Events are routed to the regions handling them
+        TEST_ASSERT_EQUAL(0x1, on.getRoutes(eOEVENT_KEY));
+        TEST_ASSERT_EQUAL(0x2, on.getRoutes(eOEVENT_MODE));
+        TEST_ASSERT_EQUAL(0x3, on.getRoutes(eOEVENT_SHARED));
+        TEST_ASSERT_EQUAL(0x0, on.getRoutes(eOEVENT_UNUSED));
+
+        // Both regions take the event
+        TEST_ASSERT_EQUAL(eOK, orthogonalHSM.dispatch(eOEVENT_SHARED, &orthogonalCTX));
+        TEST_ASSERT_EQUAL(1, orthogonalCTX.shared);
+        TEST_ASSERT_TRUE(regionA.inState(eOSTATE_A1));
+        TEST_ASSERT_TRUE(regionB.inState(eOSTATE_B21));
+        TEST_ASSERT_EQUAL(0x1, on.getRoutes(eOEVENT_SHARED));
+
+        TEST_ASSERT_EQUAL(eOK, orthogonalHSM.dispatch(eOEVENT_KEY, &orthogonalCTX));
+        TEST_ASSERT_TRUE(regionA.inState(eOSTATE_A2));
+        TEST_ASSERT_TRUE(regionB.inState(eOSTATE_B21));
+        TEST_ASSERT_EQUAL(0x0, on.getRoutes(eOEVENT_SHARED));
+        TEST_ASSERT_EQUAL(eEVENT_IGNORED, orthogonalHSM.dispatch(eOEVENT_SHARED, &orthogonalCTX));
+        TEST_ASSERT_EQUAL(eEVENT_IGNORED, orthogonalHSM.dispatch(eOEVENT_UNUSED, &orthogonalCTX));
+
+        // Events not taken by a region reach the orthogonal state, re-entry restarts the regions
+        clearOrthogonalLog(orthogonalCTX);
+        TEST_ASSERT_EQUAL(eOK, orthogonalHSM.dispatch(eOEVENT_RESET, &orthogonalCTX));
+        const unsigned int reset[] = {
+            eOSTATE_B21 | ORTHOGONAL_EXIT, eOSTATE_B2 | ORTHOGONAL_EXIT, eOSTATE_A2 | ORTHOGONAL_EXIT,
+            eOSTATE_ON | ORTHOGONAL_EXIT, eOSTATE_ON, eOSTATE_A1, eOSTATE_B1
+        };
+        assertLog(reset, 7);
+        TEST_ASSERT_EQUAL(0x3, on.getRoutes(eOEVENT_SHARED));
+    }
+
+    void otest_parallel_regions()
+    {
+        setupOrthogonal();
+        TEST_ASSERT_EQUAL(eOK, orthogonalHSM.dispatch(eOEVENT_POWER, &orthogonalCTX));
+
+        RegionExecutor executor;
+        std::atomic<bool> stop(false);
+        std::thread worker([&executor, &stop]() { executor.runWorker(stop); });
+        orthogonalHSM.state_on.setExecutor(&executor, 0x3);
+
+        // Both regions wait for each other, which requires them to run concurrently
+        orthogonalCTX.arrivals.store(0);
+        orthogonalCTX.met.store(0);
+        TEST_ASSERT_EQUAL(eOK, orthogonalHSM.dispatch(eOEVENT_SYNC, &orthogonalCTX));
+        TEST_ASSERT_EQUAL(2, orthogonalCTX.met.load());
+        TEST_ASSERT_EQUAL(1, executor.getParallelDispatches());
+        TEST_ASSERT_EQUAL(1, executor.getWorkerRegions());
+
+        // Routes are updated after the regions joined
+        TEST_ASSERT_EQUAL(eOK, orthogonalHSM.dispatch(eOEVENT_SHARED, &orthogonalCTX));
+        TEST_ASSERT_EQUAL(1, orthogonalCTX.shared);
+        TEST_ASSERT_TRUE(regionB.inState(eOSTATE_B21));
+        TEST_ASSERT_EQUAL(0x1, orthogonalHSM.state_on.getRoutes(eOEVENT_SHARED));
+        TEST_ASSERT_EQUAL(2, executor.getParallelDispatches());
+
+        // Events of a single region are dispatched by the calling thread
+        TEST_ASSERT_EQUAL(eOK, orthogonalHSM.dispatch(eOEVENT_KEY, &orthogonalCTX));
+        TEST_ASSERT_EQUAL(2, executor.getParallelDispatches());
+
+        stop.store(true);
+        worker.join();
+        orthogonalHSM.state_on.setExecutor(nullptr, 0);
+    }
+
+    void otest_region_error()
+    {
+        setupOrthogonal();
+        TEST_ASSERT_EQUAL(eOK, orthogonalHSM.dispatch(eOEVENT_POWER, &orthogonalCTX));
+
+        // Failing region fails the dispatch of the owner, the configuration is kept
+        TEST_ASSERT_EQUAL(eTRANSITION_ERROR, orthogonalHSM.dispatch(eOEVENT_BROKEN, &orthogonalCTX));
+        TEST_ASSERT_TRUE(orthogonalHSM.inState(eOSTATE_ON));
+        TEST_ASSERT_TRUE(regionA.inState(eOSTATE_A1));
+        TEST_ASSERT_EQUAL(eOK, orthogonalHSM.dispatch(eOEVENT_POWER, &orthogonalCTX));
+    }
+
+    void otest_region_snapshot()
+    {
+        setupOrthogonal();
+        TEST_ASSERT_EQUAL(eOK, orthogonalHSM.dispatch(eOEVENT_POWER, &orthogonalCTX));
+        TEST_ASSERT_EQUAL(eOK, orthogonalHSM.dispatch(eOEVENT_KEY, &orthogonalCTX));
+        TEST_ASSERT_EQUAL(eOK, orthogonalHSM.dispatch(eOEVENT_MODE, &orthogonalCTX));
+
+        // Snapshot of the owner holds its regions
+        uint8_t buffer[64];
+        const unsigned int size = orthogonalHSM.getSnapshotSize();
+        TEST_ASSERT_EQUAL(size, orthogonalHSM.snapshot(buffer, sizeof(buffer)));
+        TEST_ASSERT_EQUAL(size, regionA.getSnapshotSize() + regionB.getSnapshotSize() +
+                2u + (2u * sizeof(tStateIndex)));
+
+        TEST_ASSERT_EQUAL(eOK, copyHSM.init(&copyCTX));
+        TEST_ASSERT_FALSE(copyHSM.restore(buffer, size - 1));
+        TEST_ASSERT_TRUE(copyHSM.inState(eOSTATE_OFF));
+        TEST_ASSERT_TRUE(copyHSM.restore(buffer, size));
+        TEST_ASSERT_TRUE(copyHSM.inState(eOSTATE_ON));
+        TEST_ASSERT_TRUE(copyRegionA.inState(eOSTATE_A2));
+        TEST_ASSERT_TRUE(copyRegionB.inState(eOSTATE_B21));
+
+        // Restored regions take their events
+        TEST_ASSERT_EQUAL(0x1, copyHSM.state_on.getRoutes(eOEVENT_KEY));
+        TEST_ASSERT_EQUAL(eOK, copyHSM.dispatch(eOEVENT_KEY, &copyCTX));
+        TEST_ASSERT_TRUE(copyRegionA.inState(eOSTATE_A1));
+
+        // Regions are restored when the orthogonal state is inactive as well
+        TEST_ASSERT_EQUAL(eOK, orthogonalHSM.dispatch(eOEVENT_POWER, &orthogonalCTX));
+        TEST_ASSERT_EQUAL(size, orthogonalHSM.snapshot(buffer, sizeof(buffer)));
+        TEST_ASSERT_TRUE(copyHSM.restore(buffer, size));
+        TEST_ASSERT_TRUE(copyHSM.inState(eOSTATE_OFF));
+        TEST_ASSERT_NULL(copyRegionA.getCurrentState());
+        TEST_ASSERT_NULL(copyRegionB.getCurrentState());
+    }
+
+    void otest_region_journal()
+    {
+        setupOrthogonal();
+        TEST_ASSERT_EQUAL(eOK, copyHSM.init(&copyCTX));
+        memset(&regionJournal, 0, sizeof(regionJournal));
+
+        // Events reach the regions through the journal of the owner
+        EventJournal<256> journal(storeRegionRecords, &regionJournal);
+        orthogonalHSM.attachJournal(&journal, 0);
+        TEST_ASSERT_EQUAL(eOK, orthogonalHSM.dispatch(eOEVENT_POWER, &orthogonalCTX));
+        TEST_ASSERT_EQUAL(eOK, orthogonalHSM.dispatch(eOEVENT_KEY, &orthogonalCTX));
+        TEST_ASSERT_EQUAL(eOK, orthogonalHSM.dispatch(eOEVENT_SHARED, &orthogonalCTX));
+        TEST_ASSERT_EQUAL(3, journal.getSequence());
+        TEST_ASSERT_TRUE(journal.checkpoint(0, orthogonalHSM));
+        TEST_ASSERT_TRUE(journal.commit());
+        orthogonalHSM.attachJournal(nullptr, 0);
+
+        // Checkpoint verifies the regions of the replayed owner
+        BaseHSM* const hsms[] = {&copyHSM};
+        void* const contexts[] = {&copyCTX};
+        JournalReplay replay(hsms, contexts, 1);
+        TEST_ASSERT_EQUAL(eREPLAY_OK, replay.replay(regionJournal.data, regionJournal.length));
+        TEST_ASSERT_EQUAL(1, replay.getCheckpoints());
+        TEST_ASSERT_TRUE(copyRegionA.inState(eOSTATE_A2));
+        TEST_ASSERT_TRUE(copyRegionB.inState(eOSTATE_B21));
+
+        // Differing region fails the checkpoint
+        TEST_ASSERT_EQUAL(eOK, copyHSM.init(&copyCTX));
+        TEST_ASSERT_EQUAL(eOK, copyHSM.dispatch(eOEVENT_POWER, &copyCTX));
+        TEST_ASSERT_EQUAL(eOK, copyHSM.dispatch(eOEVENT_KEY, &copyCTX));
+        const unsigned int checkpoint = regionJournal.length - (JOURNAL_RECORD_HEADER_SIZE + orthogonalHSM.getSnapshotSize());
+        JournalReplay verify(hsms, contexts, 1);
+        verify.setSequence(3);
+        TEST_ASSERT_EQUAL(eREPLAY_MISMATCH, verify.replay(regionJournal.data + checkpoint, regionJournal.length - checkpoint));
+    }
+
+    void otest_region_behavior()
+    {
+        // Regions built after disabling behavior follow the owner
+        orthogonalHSM.enableBehavior(false);
+        setupOrthogonal();
+        TEST_ASSERT_EQUAL(eOK, orthogonalHSM.dispatch(eOEVENT_POWER, &orthogonalCTX));
+        TEST_ASSERT_EQUAL(eOK, orthogonalHSM.dispatch(eOEVENT_SHARED, &orthogonalCTX));
+        TEST_ASSERT_EQUAL(0, orthogonalCTX.count);
+        TEST_ASSERT_EQUAL(0, orthogonalCTX.shared);
+        TEST_ASSERT_TRUE(regionB.inState(eOSTATE_B21));
+
+        // Enabling behavior of the owner enables its regions
+        orthogonalHSM.enableBehavior(true);
+        TEST_ASSERT_EQUAL(eOK, orthogonalHSM.dispatch(eOEVENT_KEY, &orthogonalCTX));
+        const unsigned int key[] = {eOSTATE_A1 | ORTHOGONAL_EXIT, eOSTATE_A2};
+        assertLog(key, 2);
+    }
+
+    void otest_region_contexts()
+    {
+        sOrthogonalCTX contextA;
+        sOrthogonalCTX contextB;
+        contextA.count = 0;
+        contextA.shared = 0;
+        contextB.count = 0;
+        contextB.shared = 0;
+        orthogonalHSM.state_on.setRegionContext(0, &contextA);
+        orthogonalHSM.state_on.setRegionContext(1, &contextB);
+        setupOrthogonal();
+
+        // Regions perform their behavior on their own context
+        TEST_ASSERT_EQUAL(eOK, orthogonalHSM.dispatch(eOEVENT_POWER, &orthogonalCTX));
+        const unsigned int owner[] = {eOSTATE_OFF | ORTHOGONAL_EXIT, eOSTATE_ON};
+        assertLog(owner, 2);
+        TEST_ASSERT_EQUAL(1, contextA.count);
+        TEST_ASSERT_EQUAL(eOSTATE_A1, contextA.log[0]);
+        TEST_ASSERT_EQUAL(1, contextB.count);
+        TEST_ASSERT_EQUAL(eOSTATE_B1, contextB.log[0]);
+
+        // Regions running in parallel do not touch each other's context
+        RegionExecutor executor;
+        std::atomic<bool> stop(false);
+        std::thread worker([&executor, &stop]() { executor.runWorker(stop); });
+        orthogonalHSM.state_on.setExecutor(&executor, 0x3);
+        TEST_ASSERT_EQUAL(eOK, orthogonalHSM.dispatch(eOEVENT_SHARED, &orthogonalCTX));
+        stop.store(true);
+        worker.join();
+        orthogonalHSM.state_on.setExecutor(nullptr, 0);
+
+        TEST_ASSERT_EQUAL(1, executor.getParallelDispatches());
+        TEST_ASSERT_EQUAL(1, contextA.shared);
+        TEST_ASSERT_EQUAL(1, contextA.count);
+        TEST_ASSERT_EQUAL(0, contextB.shared);
+        const unsigned int entries[] = {eOSTATE_B1, eOSTATE_B1 | ORTHOGONAL_EXIT, eOSTATE_B2, eOSTATE_B21};
+        TEST_ASSERT_EQUAL(4, contextB.count);
+        TEST_ASSERT_EQUAL_UINT_ARRAY(entries, contextB.log, 4);
+        TEST_ASSERT_EQUAL(0, orthogonalCTX.shared);
+        TEST_ASSERT_EQUAL(0, orthogonalCTX.count);
+
+        // Exit of the regions uses their context as well
+        TEST_ASSERT_EQUAL(eOK, orthogonalHSM.dispatch(eOEVENT_POWER, &orthogonalCTX));
+        TEST_ASSERT_EQUAL(eOSTATE_A1 | ORTHOGONAL_EXIT, contextA.log[1]);
+        TEST_ASSERT_EQUAL(6, contextB.count);
+        const unsigned int exits[] = {eOSTATE_ON | ORTHOGONAL_EXIT, eOSTATE_OFF};
+        assertLog(exits, 2);
+
+        orthogonalHSM.state_on.setRegionContext(0, nullptr);
+        orthogonalHSM.state_on.setRegionContext(1, nullptr);
+    }
+
+    void run_orthogonal_tests(void)
+    {
+        RUN_TEST(otest_entry_exit_order);
+        RUN_TEST(otest_region_dispatch);
+        RUN_TEST(otest_parallel_regions);
+        RUN_TEST(otest_region_error);
+        RUN_TEST(otest_region_snapshot);
+        RUN_TEST(otest_region_journal);
+        RUN_TEST(otest_region_behavior);
+        RUN_TEST(otest_region_contexts);
+    }
+}
@@ -0,0 +1,9 @@
+#ifndef _H_MICROHSM_TESTS_ORTHOGONAL_TESTS
+#define _H_MICROHSM_TESTS_ORTHOGONAL_TESTS
+
+namespace microhsm_tests
+{
+    void run_orthogonal_tests(void);
+}
+
+#endif
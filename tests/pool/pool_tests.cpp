@@ -0,0 +1,153 @@
+#include <unity.h>
+
+#include <thread>
+
+#include <pool/pool_tests.hpp>
+#include <event/EventHSM.hpp>
+
+namespace microhsm_tests
+{
+    /// Number of HSMs receiving the same event
+    static const unsigned int POOL_CONSUMERS = 3;
+
+    /// Threads and allocations per thread of the concurrency test
+    static const unsigned int POOL_THREADS = 4;
+    static const unsigned int POOL_ALLOCATIONS = 5000;
+
+    void ptest_allocate_release()
+    {
+        EventPool<32, 2> pool;
+        TEST_ASSERT_EQUAL(32, pool.getBlockSize());
+        TEST_ASSERT_EQUAL(2, pool.getCapacity());
+
+        void* a = pool.allocate();
+        void* b = pool.allocate();
+        TEST_ASSERT_NOT_NULL(a);
+        TEST_ASSERT_NOT_NULL(b);
+        TEST_ASSERT_TRUE(a != b);
+        TEST_ASSERT_EQUAL(1, BaseEventPool::getReferences(a));
+
+        // Exhausted
+        TEST_ASSERT_NULL(pool.allocate());
+        TEST_ASSERT_EQUAL(1, pool.getExhausted());
+        TEST_ASSERT_EQUAL(2, pool.getInUse());
+
+        // Block is only returned after last reference is released
+        BaseEventPool::retain(a);
+        BaseEventPool::release(a);
+        TEST_ASSERT_NULL(pool.allocate());
+        BaseEventPool::release(a);
+        TEST_ASSERT_EQUAL(1, pool.getInUse());
+        TEST_ASSERT_EQUAL_PTR(a, pool.allocate());
+
+        BaseEventPool::release(a);
+        BaseEventPool::release(b);
+        TEST_ASSERT_EQUAL(0, pool.getInUse());
+        TEST_ASSERT_EQUAL(2, pool.getPeakInUse());
+    }
+
+    void ptest_fan_out()
+    {
+        static EventHSM hsms[POOL_CONSUMERS];
+        static PayloadQueue<4> queues[POOL_CONSUMERS];
+        sEventCTX ctxs[POOL_CONSUMERS] = {};
+        EventPool<sizeof(sSample), 1> pool;
+
+        // Single allocation shared by all consumers
+        Event event;
+        sSample* sample = static_cast<sSample*>(pool.makeEvent(eEEVENT_SAMPLE, sizeof(sSample), event));
+        TEST_ASSERT_NOT_NULL(sample);
+        sample->channel = 0;
+        sample->value = 9;
+
+        for (unsigned int i = 0; i < POOL_CONSUMERS; i++) {
+            TEST_ASSERT_EQUAL(eOK, hsms[i].init(&ctxs[i]));
+            hsms[i].attachPayloadQueue(&queues[i]);
+            TEST_ASSERT_TRUE(hsms[i].post(BaseEventPool::share(event)));
+        }
+        event.reset();
+        TEST_ASSERT_EQUAL(POOL_CONSUMERS, BaseEventPool::getReferences(sample));
+
+        for (unsigned int i = 0; i < POOL_CONSUMERS; i++) {
+            TEST_ASSERT_EQUAL(1, pool.getInUse());
+            TEST_ASSERT_EQUAL(1, hsms[i].runUntilEmpty(&ctxs[i]));
+            TEST_ASSERT_TRUE(hsms[i].inState(eESTATE_ALARM));
+            TEST_ASSERT_EQUAL(9, ctxs[i].lastValue);
+            hsms[i].attachPayloadQueue(nullptr);
+        }
+
+        // Recycled after last run-to-completion step
+        TEST_ASSERT_EQUAL(0, pool.getInUse());
+        TEST_ASSERT_EQUAL(0, pool.getExhausted());
+    }
+
+    void ptest_size_classes()
+    {
+        EventPool<16, 1> small;
+        EventPool<64, 1> large;
+        BaseEventPool* const pools[] = {&small, &large};
+        EventPoolSet set(pools, 2);
+
+        // Smallest fitting pool, then larger pools
+        void* a = set.allocate(8);
+        void* b = set.allocate(8);
+        TEST_ASSERT_EQUAL(1, small.getInUse());
+        TEST_ASSERT_EQUAL(1, large.getInUse());
+        TEST_ASSERT_EQUAL(1, small.getExhausted());
+
+        // Too large or no block left
+        TEST_ASSERT_NULL(set.allocate(128));
+        TEST_ASSERT_NULL(set.allocate(8));
+        TEST_ASSERT_EQUAL(2, set.getExhausted());
+
+        BaseEventPool::release(a);
+        BaseEventPool::release(b);
+
+        Event event;
+        TEST_ASSERT_NOT_NULL(set.makeEvent(eEEVENT_SAMPLE, 32, event));
+        TEST_ASSERT_EQUAL(1, large.getInUse());
+        TEST_ASSERT_EQUAL(32, event.size());
+        event.reset();
+        TEST_ASSERT_EQUAL(0, large.getInUse());
+    }
+
+    void ptest_concurrent()
+    {
+        static EventPool<8, POOL_THREADS> pool;
+        std::thread threads[POOL_THREADS];
+
+        for (unsigned int t = 0; t < POOL_THREADS; t++) {
+            threads[t] = std::thread([]() {
+                for (unsigned int i = 0; i < POOL_ALLOCATIONS; i++) {
+                    unsigned int* block = static_cast<unsigned int*>(pool.allocate());
+                    if (block == nullptr) continue;
+                    *block = i;
+                    BaseEventPool::retain(block);
+                    std::this_thread::yield();
+                    BaseEventPool::release(block);
+                    BaseEventPool::release(block);
+                }
+            });
+        }
+        for (unsigned int t = 0; t < POOL_THREADS; t++) threads[t].join();
+
+        // One block per thread, no block is lost or handed out twice
+        TEST_ASSERT_EQUAL(0, pool.getExhausted());
+        TEST_ASSERT_EQUAL(0, pool.getInUse());
+        void* blocks[POOL_THREADS];
+        for (unsigned int t = 0; t < POOL_THREADS; t++) {
+            blocks[t] = pool.allocate();
+            TEST_ASSERT_NOT_NULL(blocks[t]);
+        }
+        TEST_ASSERT_NULL(pool.allocate());
+        for (unsigned int t = 0; t < POOL_THREADS; t++) BaseEventPool::release(blocks[t]);
+    }
+
+    void run_pool_tests(void)
+    {
+        RUN_TEST(ptest_allocate_release);
+        RUN_TEST(ptest_fan_out);
+        RUN_TEST(ptest_size_classes);
+        RUN_TEST(ptest_concurrent);
+    }
+}
@@ -0,0 +1,9 @@
+#ifndef _H_MICROHSM_TESTS_POOL_TESTS
+#define _H_MICROHSM_TESTS_POOL_TESTS
+
+namespace microhsm_tests
+{
+    void run_pool_tests(void);
+}
+
+#endif
@@ -0,0 +1,267 @@
+#include <unity.h>
+
+#include <thread>
+
+#include <context/TestCTX.hpp>
+
+#include <queue/queue_tests.hpp>
+#include <basic/TestHSM.hpp>
+
+namespace microhsm_tests
+{
+    static TestCTX queueCTX = TestCTX();
+    static TestCTX queueReferenceCTX = TestCTX();
+    static TestHSM queueHSM = TestHSM();
+    static TestHSM queueReferenceHSM = TestHSM();
+
+    /// Events posted to `TestHSM`
+    static const unsigned int queueEvents[] = {
+        eEVENT_A, eEVENT_B, eEVENT_F, eEVENT_F, eEVENT_B, eEVENT_C, eEVENT_C, eEVENT_E,
+        eEVENT_G, eEVENT_A, eEVENT_D, eEVENT_E, eEVENT_B, eEVENT_E, eEVENT_E, eEVENT_G,
+    };
+
+    static const unsigned int QUEUE_EVENT_COUNT = sizeof(queueEvents) / sizeof(queueEvents[0]);
+
+    /// Number of times `queueEvents` is posted by the producer thread
+    static const unsigned int QUEUE_ROUNDS = 32;
+
+    /// Producers and events per producer of the multi-producer tests
+    static const unsigned int MPSC_PRODUCERS = 4;
+    static const unsigned int MPSC_EVENTS = 2000;
+    static const unsigned int MPSC_BATCH = 5;
+
+    void qtest_queue_bounds()
+    {
+        EventQueue<4> queue;
+        unsigned int event = 0;
+
+        TEST_ASSERT_EQUAL(4, queue.capacity());
+        TEST_ASSERT_TRUE(queue.empty());
+        TEST_ASSERT_FALSE(queue.pop(event));
+
+        // Fill queue, wrap around a few times
+        for (unsigned int round = 0; round < 3; round++) {
+            for (unsigned int i = 0; i < 4; i++) {
+                TEST_ASSERT_TRUE(queue.push(round * 4 + i));
+            }
+            TEST_ASSERT_EQUAL(4, queue.size());
+            TEST_ASSERT_FALSE(queue.push(100));
+
+            for (unsigned int i = 0; i < 4; i++) {
+                TEST_ASSERT_TRUE(queue.pop(event));
+                TEST_ASSERT_EQUAL(round * 4 + i, event);
+            }
+            TEST_ASSERT_TRUE(queue.empty());
+        }
+        TEST_ASSERT_EQUAL(3, queue.getDropped());
+
+        // Batches are truncated to the free slots
+        const unsigned int batch[6] = {1, 2, 3, 4, 5, 6};
+        unsigned int events[6];
+        TEST_ASSERT_TRUE(queue.push(0));
+        TEST_ASSERT_EQUAL(3, queue.pushBatch(batch, 6));
+        TEST_ASSERT_EQUAL(6, queue.getDropped());
+        TEST_ASSERT_EQUAL(4, queue.popBatch(events, 6));
+        TEST_ASSERT_EQUAL(0, events[0]);
+        TEST_ASSERT_EQUAL(3, events[3]);
+        TEST_ASSERT_EQUAL(0, queue.popBatch(events, 6));
+    }
+
+    void qtest_post_and_run()
+    {
+        EventQueue<8> queue;
+        queueCTX.init();
+        queueReferenceCTX.init();
+        TEST_ASSERT_EQUAL(eOK, queueHSM.init(&queueCTX));
+        TEST_ASSERT_EQUAL(eOK, queueReferenceHSM.init(&queueReferenceCTX));
+
+        // Nothing can be posted without a queue
+        TEST_ASSERT_FALSE(queueHSM.post(eEVENT_A));
+        TEST_ASSERT_FALSE(queueHSM.runOnce(&queueCTX));
+
+        queueHSM.attachQueue(&queue);
+        TEST_ASSERT_FALSE(queueHSM.runOnce(&queueCTX));
+
+        // Posting does not dispatch
+        TEST_ASSERT_TRUE(queueHSM.post(queueEvents[0]));
+        TEST_ASSERT_TRUE(queueHSM.inState(eSTATE_S1));
+        TEST_ASSERT_TRUE(queueHSM.runOnce(&queueCTX));
+        queueReferenceHSM.dispatch(queueEvents[0], &queueReferenceCTX);
+        TEST_ASSERT_EQUAL(queueReferenceHSM.getCurrentState()->ID, queueHSM.getCurrentState()->ID);
+
+        // Events are dispatched in order
+        for (unsigned int i = 1; i < QUEUE_EVENT_COUNT; i += 4) {
+            for (unsigned int j = i; j < i + 4 && j < QUEUE_EVENT_COUNT; j++) {
+                TEST_ASSERT_TRUE(queueHSM.post(queueEvents[j]));
+                queueReferenceHSM.dispatch(queueEvents[j], &queueReferenceCTX);
+            }
+            TEST_ASSERT_TRUE(queueHSM.runUntilEmpty(&queueCTX) > 0);
+            TEST_ASSERT_EQUAL(queueReferenceHSM.getCurrentState()->ID, queueHSM.getCurrentState()->ID);
+            TEST_ASSERT_EQUAL(queueReferenceCTX.getFlag(), queueCTX.getFlag());
+        }
+        TEST_ASSERT_EQUAL(0, queueHSM.runUntilEmpty(&queueCTX));
+
+        queueHSM.attachQueue(nullptr);
+    }
+
+    void qtest_concurrent_producer()
+    {
+        EventQueue<8> queue;
+        queueCTX.init();
+        queueReferenceCTX.init();
+        TEST_ASSERT_EQUAL(eOK, queueHSM.init(&queueCTX));
+        TEST_ASSERT_EQUAL(eOK, queueReferenceHSM.init(&queueReferenceCTX));
+        queueHSM.attachQueue(&queue);
+
+        // Producer retries when the queue is full
+        std::thread producer([]() {
+            for (unsigned int r = 0; r < QUEUE_ROUNDS; r++) {
+                for (unsigned int i = 0; i < QUEUE_EVENT_COUNT; i++) {
+                    while (!queueHSM.post(queueEvents[i])) {
+                        std::this_thread::yield();
+                    }
+                }
+            }
+        });
+
+        unsigned int dispatched = 0;
+        while (dispatched < QUEUE_ROUNDS * QUEUE_EVENT_COUNT) {
+            dispatched += queueHSM.runUntilEmpty(&queueCTX);
+        }
+        producer.join();
+
+        for (unsigned int r = 0; r < QUEUE_ROUNDS; r++) {
+            for (unsigned int i = 0; i < QUEUE_EVENT_COUNT; i++) {
+                queueReferenceHSM.dispatch(queueEvents[i], &queueReferenceCTX);
+            }
+        }
+
+        TEST_ASSERT_EQUAL(QUEUE_ROUNDS * QUEUE_EVENT_COUNT, dispatched);
+        TEST_ASSERT_TRUE(queue.empty());
+        TEST_ASSERT_EQUAL(queueReferenceHSM.getCurrentState()->ID, queueHSM.getCurrentState()->ID);
+        TEST_ASSERT_EQUAL(queueReferenceCTX.getFlag(), queueCTX.getFlag());
+
+        queueHSM.attachQueue(nullptr);
+    }
+
+    void qtest_mpsc_policies()
+    {
+        const unsigned int batch[6] = {1, 2, 3, 4, 5, 6};
+        unsigned int events[8];
+        unsigned int event = 0;
+
+        // Drop newest: pushed events that do not fit are discarded
+        MPSCEventQueue<4> dropNewest(eQUEUE_DROP_NEWEST);
+        TEST_ASSERT_EQUAL(eQUEUE_DROP_NEWEST, dropNewest.getPolicy());
+        TEST_ASSERT_EQUAL(4, dropNewest.pushBatch(batch, 6));
+        TEST_ASSERT_FALSE(dropNewest.push(7));
+        TEST_ASSERT_EQUAL(3, dropNewest.getDroppedNewest());
+        TEST_ASSERT_EQUAL(4, dropNewest.popBatch(events, 8));
+        TEST_ASSERT_EQUAL(1, events[0]);
+        TEST_ASSERT_EQUAL(4, events[3]);
+        TEST_ASSERT_TRUE(dropNewest.empty());
+
+        // Drop oldest: queued events make room for pushed events
+        MPSCEventQueue<4> dropOldest(eQUEUE_DROP_OLDEST);
+        TEST_ASSERT_EQUAL(6, dropOldest.pushBatch(batch, 6));
+        TEST_ASSERT_TRUE(dropOldest.push(7));
+        TEST_ASSERT_EQUAL(3, dropOldest.getDroppedOldest());
+        TEST_ASSERT_EQUAL(4, dropOldest.size());
+        for (unsigned int i = 4; i <= 7; i++) {
+            TEST_ASSERT_TRUE(dropOldest.pop(event));
+            TEST_ASSERT_EQUAL(i, event);
+        }
+        TEST_ASSERT_FALSE(dropOldest.pop(event));
+
+        // Fail: pushed events are rejected and counted
+        MPSCEventQueue<4> fail(eQUEUE_FAIL);
+        TEST_ASSERT_EQUAL(4, fail.pushBatch(batch, 6));
+        TEST_ASSERT_FALSE(fail.push(7));
+        TEST_ASSERT_EQUAL(3, fail.getFailed());
+        TEST_ASSERT_EQUAL(0, fail.getDroppedNewest());
+
+        // Slots are reused after popping
+        TEST_ASSERT_TRUE(fail.pop(event));
+        TEST_ASSERT_TRUE(fail.push(7));
+        TEST_ASSERT_EQUAL(4, fail.popBatch(events, 8));
+        TEST_ASSERT_EQUAL(2, events[0]);
+        TEST_ASSERT_EQUAL(7, events[3]);
+    }
+
+    void qtest_mpsc_concurrent_producers()
+    {
+        MPSCEventQueue<16> queue(eQUEUE_BLOCK);
+        std::thread producers[MPSC_PRODUCERS];
+
+        // Events encode producer and sequence number, posted in batches
+        for (unsigned int p = 0; p < MPSC_PRODUCERS; p++) {
+            producers[p] = std::thread([&queue, p]() {
+                unsigned int batch[MPSC_BATCH];
+                for (unsigned int i = 0; i < MPSC_EVENTS; i += MPSC_BATCH) {
+                    for (unsigned int j = 0; j < MPSC_BATCH; j++) batch[j] = (p * MPSC_EVENTS) + i + j;
+                    queue.pushBatch(batch, MPSC_BATCH);
+                }
+            });
+        }
+
+        // Every producer's events arrive in order
+        unsigned int next[MPSC_PRODUCERS] = {0};
+        unsigned int received = 0;
+        bool ordered = true;
+        unsigned int events[8];
+        while (received < MPSC_PRODUCERS * MPSC_EVENTS) {
+            unsigned int n = queue.popBatch(events, 8);
+            for (unsigned int i = 0; i < n; i++) {
+                unsigned int p = events[i] / MPSC_EVENTS;
+                ordered = ordered && (events[i] % MPSC_EVENTS == next[p]);
+                next[p]++;
+            }
+            received += n;
+            if (n == 0) std::this_thread::yield();
+        }
+        for (std::thread& t : producers) t.join();
+
+        TEST_ASSERT_TRUE(ordered);
+        TEST_ASSERT_TRUE(queue.empty());
+        TEST_ASSERT_EQUAL(0, queue.getFailed() + queue.getDroppedNewest() + queue.getDroppedOldest());
+    }
+
+    void qtest_mpsc_shared_hsm()
+    {
+        MPSCEventQueue<16> queue(eQUEUE_BLOCK);
+        queueCTX.init();
+        TEST_ASSERT_EQUAL(eOK, queueHSM.init(&queueCTX));
+        queueHSM.attachQueue(&queue);
+
+        // Producers post the same sequence, the HSM dispatches every event
+        std::thread producers[MPSC_PRODUCERS];
+        for (std::thread& t : producers) {
+            t = std::thread([]() {
+                for (unsigned int i = 0; i < QUEUE_EVENT_COUNT; i += 4) {
+                    queueHSM.postBatch(&queueEvents[i], 4);
+                }
+            });
+        }
+
+        unsigned int dispatched = 0;
+        while (dispatched < MPSC_PRODUCERS * QUEUE_EVENT_COUNT) {
+            dispatched += queueHSM.runUntilEmpty(&queueCTX);
+        }
+        for (std::thread& t : producers) t.join();
+
+        TEST_ASSERT_EQUAL(MPSC_PRODUCERS * QUEUE_EVENT_COUNT, dispatched);
+        TEST_ASSERT_TRUE(queue.empty());
+
+        queueHSM.attachQueue(nullptr);
+    }
+
+    void run_queue_tests(void)
+    {
+        RUN_TEST(qtest_queue_bounds);
+        RUN_TEST(qtest_post_and_run);
+        RUN_TEST(qtest_concurrent_producer);
+        RUN_TEST(qtest_mpsc_policies);
+        RUN_TEST(qtest_mpsc_concurrent_producers);
+        RUN_TEST(qtest_mpsc_shared_hsm);
+    }
+}
@@ -0,0 +1,9 @@
+#ifndef _H_MICROHSM_TESTS_QUEUE_TESTS
+#define _H_MICROHSM_TESTS_QUEUE_TESTS
+
+namespace microhsm_tests
+{
+    void run_queue_tests(void);
+}
+
+#endif
@@ -0,0 +1,70 @@
+/**
+ * @file RegistryHSM.cpp
+ * @brief Test HSM with sparse IDs relying on vertex registration
+ */
+
+#include <registry/RegistryHSM.hpp>
+
+#define UNUSED_ARG_(x) (void)x;
+
+namespace microhsm_tests
+{
+
+    HSMDefinition RegistryHSM::definition;
+
+    HSM_DEFINE_STATE_MATCH(RStateR)
+    {
+        UNUSED_ARG_(ctx);
+        switch(event) {
+            case eREVENT_B:
+                return transitionExternal(eRSTATE_Q, t, nullptr);
+            default:
+                break;
+        }
+        return noTransition();
+    }
+
+    HSM_DEFINE_STATE_MATCH(RStateR1)
+    {
+        UNUSED_ARG_(ctx);
+        switch(event) {
+            case eREVENT_A:
+                return transitionExternal(eRSTATE_R2, t, nullptr);
+            default:
+                break;
+        }
+        return noTransition();
+    }
+
+    HSM_DEFINE_STATE_MATCH(RStateR2)
+    {
+        UNUSED_ARG_(ctx);
+        switch(event) {
+            case eREVENT_A:
+                return transitionExternal(eRSTATE_R1, t, nullptr);
+            default:
+                break;
+        }
+        return noTransition();
+    }
+
+    HSM_DEFINE_STATE_MATCH(RStateQ)
+    {
+        UNUSED_ARG_(ctx);
+        switch(event) {
+            case eREVENT_C:
+                return transitionExternal(eRSTATE_R_HISTORY, t, nullptr);
+            default:
+                break;
+        }
+        return noTransition();
+    }
+
+    bool LimitState::match(unsigned int event, sTransition* t, void* ctx)
+    {
+        UNUSED_ARG_(event);
+        UNUSED_ARG_(t);
+        UNUSED_ARG_(ctx);
+        return noTransition();
+    }
+}
@@ -0,0 +1,132 @@
+/**
+ * @file RegistryHSM.hpp
+ * @brief Test HSM with sparse IDs relying on vertex registration
+ */
+#ifndef _H_MICROHSM_TESTS_REGISTRYHSM
+#define _H_MICROHSM_TESTS_REGISTRYHSM
+
+#include <new>
+#include <type_traits>
+
+#include <microhsm/microhsm.hpp>
+#include <microhsm/macros.hpp>
+
+using namespace microhsm;
+
+namespace microhsm_tests
+{
+    /// @brief Event enumerations
+    HSM_CREATE_EVENT_LIST(e_revents,
+            eREVENT_A,
+            eREVENT_B,
+            eREVENT_C,
+    )
+
+    /// @brief Sparse vertex IDs
+    HSM_CREATE_VERTEX_LIST(e_rstates,
+            eRSTATE_R = 5,
+            eRSTATE_R_HISTORY = 42,
+            eRSTATE_R1 = 1000,
+            eRSTATE_R2 = 70000,
+            eRSTATE_Q = 123456
+    )
+
+    /* State Declarations */
+    HSM_DECLARE_STATE_TOP_LEVEL(RStateR, eRSTATE_R)
+    HSM_DECLARE_STATE(RStateR1, eRSTATE_R1, RStateR)
+    HSM_DECLARE_STATE(RStateR2, eRSTATE_R2, RStateR)
+    HSM_DECLARE_STATE_TOP_LEVEL(RStateQ, eRSTATE_Q)
+
+    /* HSM Declaration, does not implement `getVertex` and `getMaxID` */
+    class RegistryHSM : public BaseHSM
+    {
+    public:
+
+        /// Structure shared by all instances
+        static HSMDefinition definition;
+
+        RegistryHSM() : BaseHSM(state_r, definition)
+        {
+            this->registerVertices({&state_r, &history_r, &state_r1, &state_r2, &state_q});
+        };
+
+        RStateR state_r = RStateR(&state_r1, &history_r, nullptr);
+        ShallowHistory history_r = ShallowHistory(eRSTATE_R_HISTORY, nullptr);
+        RStateR1 state_r1 = RStateR1(&state_r, nullptr);
+        RStateR2 state_r2 = RStateR2(&state_r, nullptr);
+        RStateQ state_q = RStateQ(nullptr);
+    };
+
+    /// State without transitions, used to build hierarchies of any size
+    class LimitState : public BaseState
+    {
+    public:
+
+        LimitState(unsigned int id, BaseState* parentState, BaseState* initialState) :
+            BaseState(id, parentState, initialState) {};
+
+        bool match(unsigned int event, sTransition* t, void* ctx) override;
+    };
+
+    /**
+     * HSM of `COUNT` states with IDs `0` to `COUNT - 1`: a chain of `DEPTH`
+     * nested states, the remaining states are siblings of the innermost one.
+     */
+    template <unsigned int COUNT, unsigned int DEPTH>
+    class LimitHSM : public BaseHSM
+    {
+        static_assert(DEPTH >= 2 && DEPTH <= COUNT, "Unsupported hierarchy");
+
+    public:
+
+        /// Structure shared by all instances
+        static HSMDefinition definition;
+
+        LimitHSM() : BaseHSM(state(0), definition)
+        {
+            for (unsigned int i = 0; i < COUNT; i++) {
+                BaseState* parentState = (i == 0) ? nullptr : &state((i < DEPTH) ? i - 1 : DEPTH - 2);
+                BaseState* initialState = (i + 1 < DEPTH) ? &state(i + 1) : nullptr;
+                new (&storage_[i]) LimitState(i, parentState, initialState);
+            }
+        };
+
+        ~LimitHSM()
+        {
+            for (unsigned int i = 0; i < COUNT; i++) {
+                state(i).~LimitState();
+            }
+        };
+
+        Vertex* getVertex(unsigned int ID) override {return (ID < COUNT) ? &state(ID) : nullptr;};
+        unsigned int getMaxID(void) override {return COUNT - 1;};
+
+    private:
+
+        LimitState& state(unsigned int i) {return *reinterpret_cast<LimitState*>(&storage_[i]);};
+
+        typename std::aligned_storage<sizeof(LimitState), alignof(LimitState)>::type storage_[COUNT];
+    };
+
+    template <unsigned int COUNT, unsigned int DEPTH>
+    HSMDefinition LimitHSM<COUNT, DEPTH>::definition;
+
+    /// HSM of two states using the definition it is given, `nested` places B inside A
+    class SharedHSM : public BaseHSM
+    {
+    public:
+
+        SharedHSM(HSMDefinition& definition, bool nested) :
+            BaseHSM(state_a, definition),
+            state_a(eRSTATE_R, nullptr, nested ? &state_b : nullptr),
+            state_b(eRSTATE_R1, nested ? &state_a : nullptr, nullptr)
+        {
+            this->registerVertices({&state_a, &state_b});
+        };
+
+        LimitState state_a;
+        LimitState state_b;
+    };
+}
+
+#endif
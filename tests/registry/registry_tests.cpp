@@ -0,0 +1,129 @@
+#include <unity.h>
+
+#include <registry/registry_tests.hpp>
+#include <registry/RegistryHSM.hpp>
+#include <basic/TestHSM.hpp>
+#include <history/HistoryHSM.hpp>
+
+namespace microhsm_tests
+{
+
+    static RegistryHSM registryHSM = RegistryHSM();
+    static TestHSM registryTestHSM = TestHSM();
+    static HistoryHSM registryHistoryHSM = HistoryHSM();
+    static LimitHSM<MICROHSM_MAX_STATES, MICROHSM_MAX_DEPTH> fittingHSM;
+    static LimitHSM<MICROHSM_MAX_STATES + 1, 2> wideHSM;
+    static LimitHSM<MICROHSM_MAX_DEPTH + 1, MICROHSM_MAX_DEPTH + 1> deepHSM;
+    static RegistryHSM strayHSM = RegistryHSM();
+    static HSMDefinition sharedDefinition;
+    static SharedHSM sharedHSM(sharedDefinition, false);
+    static SharedHSM boundHSM(sharedDefinition, false);
+    static SharedHSM nestedHSM(sharedDefinition, true);
+
+    void rtest_sparse_ids()
+    {
+        TEST_ASSERT_EQUAL(eOK, registryHSM.init(nullptr));
+        TEST_ASSERT_TRUE(registryHSM.usesVertexRegistry());
+        TEST_ASSERT_EQUAL(eRSTATE_Q, registryHSM.getMaxID());
+
+        TEST_ASSERT_EQUAL_PTR(static_cast<Vertex*>(&registryHSM.state_r), registryHSM.getVertex(eRSTATE_R));
+        TEST_ASSERT_EQUAL_PTR(static_cast<Vertex*>(&registryHSM.history_r), registryHSM.getVertex(eRSTATE_R_HISTORY));
+        TEST_ASSERT_EQUAL_PTR(static_cast<Vertex*>(&registryHSM.state_r1), registryHSM.getVertex(eRSTATE_R1));
+        TEST_ASSERT_EQUAL_PTR(static_cast<Vertex*>(&registryHSM.state_r2), registryHSM.getVertex(eRSTATE_R2));
+        TEST_ASSERT_EQUAL_PTR(static_cast<Vertex*>(&registryHSM.state_q), registryHSM.getVertex(eRSTATE_Q));
+
+        TEST_ASSERT_NULL(registryHSM.getVertex(0));
+        TEST_ASSERT_NULL(registryHSM.getVertex(6));
+        TEST_ASSERT_NULL(registryHSM.getVertex(999));
+        TEST_ASSERT_NULL(registryHSM.getVertex(eRSTATE_Q + 1));
+    }
+
+    void rtest_sparse_transitions()
+    {
+        TEST_ASSERT_EQUAL(eOK, registryHSM.init(nullptr));
+        TEST_ASSERT_TRUE(registryHSM.inState(eRSTATE_R1));
+
+        // A: R1 -> R2
+        TEST_ASSERT_EQUAL(eOK, registryHSM.dispatch(eREVENT_A, nullptr));
+        TEST_ASSERT_TRUE(registryHSM.inState(eRSTATE_R2));
+
+        // B: R -> Q
+        TEST_ASSERT_EQUAL(eOK, registryHSM.dispatch(eREVENT_B, nullptr));
+        TEST_ASSERT_TRUE(registryHSM.inState(eRSTATE_Q));
+        TEST_ASSERT_FALSE(registryHSM.inState(eRSTATE_R));
+
+        // C: Q -> R(H) -> R2
+        TEST_ASSERT_EQUAL(eOK, registryHSM.dispatch(eREVENT_C, nullptr));
+        TEST_ASSERT_TRUE(registryHSM.inState(eRSTATE_R2));
+    }
+
+    void rtest_overridden_lookup()
+    {
+        // Registered vertices agree with `getVertex` of these HSMs
+        TEST_ASSERT_EQUAL(eOK, registryTestHSM.init(nullptr));
+        TEST_ASSERT_EQUAL(eOK, registryHistoryHSM.init(nullptr));
+        TEST_ASSERT_TRUE(registryTestHSM.usesVertexRegistry());
+        TEST_ASSERT_TRUE(registryHistoryHSM.usesVertexRegistry());
+        TEST_ASSERT_EQUAL(eSTATE_I, registryHistoryHSM.getMaxID());
+    }
+
+    void rtest_stray_vertex()
+    {
+        // Vertices constructed after an HSM do not end up in its registry
+        LimitState stray(eRSTATE_R1, nullptr, nullptr);
+        TEST_ASSERT_EQUAL(eOK, strayHSM.init(nullptr));
+        TEST_ASSERT_TRUE(strayHSM.usesVertexRegistry());
+        TEST_ASSERT_EQUAL_PTR(static_cast<Vertex*>(&strayHSM.state_r1), strayHSM.getVertex(eRSTATE_R1));
+        TEST_ASSERT_EQUAL(eOK, strayHSM.dispatch(eREVENT_A, nullptr));
+        TEST_ASSERT_TRUE(strayHSM.inState(eRSTATE_R2));
+    }
+
+    void rtest_shared_definition()
+    {
+        // First instance builds the definition
+        TEST_ASSERT_FALSE(sharedDefinition.isBuilt());
+        TEST_ASSERT_EQUAL(eOK, sharedHSM.init(nullptr));
+        TEST_ASSERT_TRUE(sharedDefinition.isBuilt());
+
+        // Other instances resolve their own vertices through it
+        TEST_ASSERT_EQUAL(eOK, boundHSM.init(nullptr));
+        TEST_ASSERT_TRUE(boundHSM.usesVertexRegistry());
+        TEST_ASSERT_EQUAL_PTR(static_cast<Vertex*>(&boundHSM.state_b), boundHSM.getVertex(eRSTATE_R1));
+        TEST_ASSERT_EQUAL_PTR(&boundHSM.state_a, boundHSM.getCurrentState());
+        TEST_ASSERT_TRUE(boundHSM.inState(eRSTATE_R));
+        TEST_ASSERT_FALSE(boundHSM.inState(eRSTATE_R1));
+
+        // Instances with a different hierarchy are rejected, the definition is unchanged
+        TEST_ASSERT_EQUAL(eTRANSITION_ERROR, nestedHSM.init(nullptr));
+        TEST_ASSERT_NULL(nestedHSM.getCurrentState());
+        TEST_ASSERT_EQUAL(eOK, sharedHSM.init(nullptr));
+        TEST_ASSERT_EQUAL_PTR(&sharedHSM.state_a, sharedHSM.getCurrentState());
+    }
+
+    void rtest_state_table_limits()
+    {
+        // Largest hierarchy fitting the state table
+        TEST_ASSERT_EQUAL(eOK, fittingHSM.init(nullptr));
+        TEST_ASSERT_TRUE(fittingHSM.inState(MICROHSM_MAX_DEPTH - 1));
+
+        // Hierarchies exceeding the state table leave the HSM inactive
+        TEST_ASSERT_EQUAL(eTRANSITION_ERROR, wideHSM.init(nullptr));
+        TEST_ASSERT_NULL(wideHSM.getCurrentState());
+        TEST_ASSERT_FALSE(wideHSM.inState(0));
+        TEST_ASSERT_EQUAL(eEVENT_IGNORED, wideHSM.dispatch(eREVENT_A, nullptr));
+
+        TEST_ASSERT_EQUAL(eTRANSITION_ERROR, deepHSM.init(nullptr));
+        TEST_ASSERT_NULL(deepHSM.getCurrentState());
+        TEST_ASSERT_EQUAL(eEVENT_IGNORED, deepHSM.dispatch(eREVENT_A, nullptr));
+    }
+
+    void run_registry_tests(void)
+    {
+        RUN_TEST(rtest_sparse_ids);
+        RUN_TEST(rtest_sparse_transitions);
+        RUN_TEST(rtest_overridden_lookup);
+        RUN_TEST(rtest_stray_vertex);
+        RUN_TEST(rtest_shared_definition);
+        RUN_TEST(rtest_state_table_limits);
+    }
+}
@@ -0,0 +1,9 @@
+#ifndef _H_MICROHSM_TESTS_REGISTRY_TESTS
+#define _H_MICROHSM_TESTS_REGISTRY_TESTS
+
+namespace microhsm_tests
+{
+    void run_registry_tests(void);
+}
+
+#endif
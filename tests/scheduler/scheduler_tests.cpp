@@ -0,0 +1,159 @@
+#include <unity.h>
+
+#include <scheduler/scheduler_tests.hpp>
+#include <active/ActiveHSM.hpp>
+
+namespace microhsm_tests
+{
+    /// Priorities of the scheduled HSMs, spanning several bitmap words
+    static const unsigned int schedulerPriorities[] = {1, 5, 40, 70};
+    static const unsigned int SCHEDULER_HSMS = sizeof(schedulerPriorities) / sizeof(schedulerPriorities[0]);
+
+    static ActiveHSM schedulerHSMs[SCHEDULER_HSMS];
+    static EventQueue<8> schedulerQueues[SCHEDULER_HSMS];
+    static sActiveCTX schedulerCTXs[SCHEDULER_HSMS];
+
+    static void setupScheduler(BaseScheduler& scheduler)
+    {
+        for (unsigned int i = 0; i < SCHEDULER_HSMS; i++) {
+            schedulerCTXs[i].running.store(false);
+            schedulerCTXs[i].count = 0;
+            schedulerCTXs[i].overlaps = 0;
+            schedulerCTXs[i].echo = nullptr;
+            TEST_ASSERT_EQUAL(eOK, schedulerHSMs[i].init(&schedulerCTXs[i]));
+            TEST_ASSERT_TRUE(scheduler.add(schedulerHSMs[i], schedulerQueues[i], &schedulerCTXs[i], schedulerPriorities[i]));
+        }
+    }
+
+    static void stopWhenIdle(void* arg)
+    {
+        static_cast<std::atomic<bool>*>(arg)->store(true);
+    }
+
+    void stest_priority_order()
+    {
+        Scheduler<80> scheduler;
+        setupScheduler(scheduler);
+        TEST_ASSERT_FALSE(scheduler.add(schedulerHSMs[0], schedulerQueues[0], nullptr, 5));    // In use
+        TEST_ASSERT_FALSE(scheduler.add(schedulerHSMs[0], schedulerQueues[0], nullptr, 80));   // Out of range
+        TEST_ASSERT_FALSE(scheduler.post(2, eAEVENT_COUNT));
+        TEST_ASSERT_EQUAL(SCHEDULER_PRIORITY_NONE, scheduler.getReadyPriority());
+
+        TEST_ASSERT_TRUE(scheduler.post(1, eAEVENT_COUNT));
+        TEST_ASSERT_TRUE(scheduler.post(1, eAEVENT_COUNT));
+        TEST_ASSERT_TRUE(scheduler.post(40, eAEVENT_COUNT));
+        TEST_ASSERT_TRUE(scheduler.post(70, eAEVENT_COUNT));
+        TEST_ASSERT_TRUE(scheduler.post(70, eAEVENT_COUNT));
+        TEST_ASSERT_EQUAL(70, scheduler.getReadyPriority());
+
+        // Highest priority runs first, one event per step
+        TEST_ASSERT_TRUE(scheduler.runOnce());
+        TEST_ASSERT_EQUAL(1, schedulerCTXs[3].count);
+        TEST_ASSERT_TRUE(scheduler.runOnce());
+        TEST_ASSERT_EQUAL(2, schedulerCTXs[3].count);
+        TEST_ASSERT_EQUAL(40, scheduler.getReadyPriority());
+
+        // Newly posted higher priority event preempts remaining lower priority work
+        TEST_ASSERT_TRUE(scheduler.post(5, eAEVENT_COUNT));
+        TEST_ASSERT_TRUE(scheduler.runOnce());
+        TEST_ASSERT_EQUAL(1, schedulerCTXs[2].count);
+        TEST_ASSERT_TRUE(scheduler.runOnce());
+        TEST_ASSERT_EQUAL(1, schedulerCTXs[1].count);
+        TEST_ASSERT_EQUAL(0, schedulerCTXs[0].count);
+
+        TEST_ASSERT_EQUAL(2, scheduler.runUntilIdle());
+        TEST_ASSERT_EQUAL(2, schedulerCTXs[0].count);
+        TEST_ASSERT_FALSE(scheduler.runOnce());
+    }
+
+    void stest_idle_hook()
+    {
+        Scheduler<80> scheduler;
+        setupScheduler(scheduler);
+        std::atomic<bool> stop(false);
+        scheduler.setIdleHook(stopWhenIdle, &stop);
+
+        scheduler.post(5, eAEVENT_COUNT);
+        scheduler.post(70, eAEVENT_COUNT);
+        scheduler.run(stop);
+        TEST_ASSERT_EQUAL(1, scheduler.getIdleCalls());
+        TEST_ASSERT_EQUAL(1, schedulerCTXs[1].count);
+        TEST_ASSERT_EQUAL(1, schedulerCTXs[3].count);
+    }
+
+    void stest_self_post()
+    {
+        Scheduler<80> scheduler;
+        setupScheduler(scheduler);
+        schedulerCTXs[2].echo = &schedulerHSMs[2];
+
+        // Event posted by the HSM to itself during its run-to-completion step
+        TEST_ASSERT_TRUE(scheduler.post(40, eAEVENT_ECHO));
+        TEST_ASSERT_TRUE(scheduler.runOnce());
+        TEST_ASSERT_EQUAL(40, scheduler.getReadyPriority());
+        TEST_ASSERT_EQUAL(1, scheduler.runUntilIdle());
+        TEST_ASSERT_EQUAL(1, schedulerCTXs[2].count);
+
+        // Event posted to the HSM directly
+        TEST_ASSERT_TRUE(schedulerHSMs[3].post(eAEVENT_COUNT));
+        TEST_ASSERT_EQUAL(70, scheduler.getReadyPriority());
+        TEST_ASSERT_EQUAL(1, scheduler.runUntilIdle());
+        TEST_ASSERT_EQUAL(1, schedulerCTXs[3].count);
+        schedulerCTXs[2].echo = nullptr;
+    }
+
+    void stest_payload()
+    {
+        Scheduler<80> scheduler;
+        setupScheduler(scheduler);
+        PayloadQueue<4> payloads;
+        schedulerHSMs[0].attachPayloadQueue(&payloads);
+
+        // Event with payload makes the scheduled HSM ready
+        TEST_ASSERT_TRUE(schedulerHSMs[0].post(Event(eAEVENT_COUNT, 1)));
+        TEST_ASSERT_EQUAL(1, scheduler.getReadyPriority());
+        TEST_ASSERT_EQUAL(1, scheduler.runUntilIdle());
+        TEST_ASSERT_EQUAL(1, schedulerCTXs[0].count);
+
+        // HSM stays ready until both queues are drained
+        TEST_ASSERT_TRUE(schedulerHSMs[0].post(Event(eAEVENT_COUNT, 2)));
+        TEST_ASSERT_TRUE(scheduler.post(1, eAEVENT_COUNT));
+        TEST_ASSERT_TRUE(scheduler.runOnce());
+        TEST_ASSERT_EQUAL(1, scheduler.getReadyPriority());
+        TEST_ASSERT_TRUE(scheduler.runOnce());
+        TEST_ASSERT_EQUAL(SCHEDULER_PRIORITY_NONE, scheduler.getReadyPriority());
+        TEST_ASSERT_EQUAL(3, schedulerCTXs[0].count);
+        TEST_ASSERT_EQUAL(0, payloads.size());
+        schedulerHSMs[0].attachPayloadQueue(nullptr);
+    }
+
+    void stest_timer()
+    {
+        Scheduler<80> scheduler;
+        setupScheduler(scheduler);
+        TimerService<4> timers;
+
+        // Expired timer makes the scheduled HSM ready
+        TEST_ASSERT_NOT_EQUAL(TIMER_HANDLE_NONE, timers.arm(schedulerHSMs[1], eAEVENT_COUNT, 3, 3));
+        TEST_ASSERT_EQUAL(0, timers.advance(2));
+        TEST_ASSERT_EQUAL(SCHEDULER_PRIORITY_NONE, scheduler.getReadyPriority());
+        TEST_ASSERT_EQUAL(1, timers.tick());
+        TEST_ASSERT_EQUAL(5, scheduler.getReadyPriority());
+        TEST_ASSERT_EQUAL(1, scheduler.runUntilIdle());
+        TEST_ASSERT_EQUAL(1, schedulerCTXs[1].count);
+
+        TEST_ASSERT_EQUAL(2, timers.advance(6));
+        TEST_ASSERT_EQUAL(2, scheduler.runUntilIdle());
+        TEST_ASSERT_EQUAL(3, schedulerCTXs[1].count);
+        TEST_ASSERT_EQUAL(0, timers.getFailed());
+    }
+
+    void run_scheduler_tests(void)
+    {
+        RUN_TEST(stest_priority_order);
+        RUN_TEST(stest_idle_hook);
+        RUN_TEST(stest_self_post);
+        RUN_TEST(stest_payload);
+        RUN_TEST(stest_timer);
+    }
+}
@@ -0,0 +1,9 @@
+#ifndef _H_MICROHSM_TESTS_SCHEDULER_TESTS
+#define _H_MICROHSM_TESTS_SCHEDULER_TESTS
+
+namespace microhsm_tests
+{
+    void run_scheduler_tests(void);
+}
+
+#endif
@@ -0,0 +1,187 @@
+#include <string.h>
+#include <unity.h>
+
+#include <context/TestCTX.hpp>
+
+#include <snapshot/snapshot_tests.hpp>
+#include <basic/TestHSM.hpp>
+#include <history/HistoryHSM.hpp>
+#include <static/StaticTestHSM.hpp>
+
+namespace microhsm_tests
+{
+    static HistoryHSM snapshotSource = HistoryHSM();
+    static HistoryHSM snapshotTarget = HistoryHSM();
+
+    /// Size of a `HistoryHSM` snapshot: header, active leaf and two histories
+    static const unsigned int HISTORY_SNAPSHOT_SIZE = 2u + (4u * sizeof(tStateIndex));
+
+    static unsigned int historyStateID(HistoryHSM& hsm, unsigned int ID)
+    {
+        return static_cast<BaseHistory*>(hsm.getVertex(ID))->getHistoryState()->ID;
+    }
+
+    /**
+     * @brief Test restoring active state and histories into another instance
+     */
+    void sntest_round_trip()
+    {
+        TEST_ASSERT_EQUAL(eOK, snapshotSource.init(nullptr));
+        TEST_ASSERT_EQUAL(eOK, snapshotTarget.init(nullptr));
+
+        // C: I -> H(H1(H11)), C: H11 -> H12, B: H -> I
+        TEST_ASSERT_EQUAL(eOK, snapshotSource.dispatch(eHEVENT_C, nullptr));
+        TEST_ASSERT_EQUAL(eOK, snapshotSource.dispatch(eHEVENT_C, nullptr));
+        TEST_ASSERT_EQUAL(eOK, snapshotSource.dispatch(eHEVENT_B, nullptr));
+
+        uint8_t buffer[HISTORY_SNAPSHOT_SIZE];
+        TEST_ASSERT_EQUAL(HISTORY_SNAPSHOT_SIZE, snapshotSource.getSnapshotSize());
+        TEST_ASSERT_EQUAL(HISTORY_SNAPSHOT_SIZE, snapshotSource.snapshot(buffer, sizeof(buffer)));
+        TEST_ASSERT_TRUE(snapshotTarget.restore(buffer, sizeof(buffer)));
+
+        TEST_ASSERT_TRUE(snapshotTarget.inState(eSTATE_I));
+        TEST_ASSERT_EQUAL(eSTATE_H12, historyStateID(snapshotTarget, eSTATE_H_DEEP_HISTORY));
+        TEST_ASSERT_EQUAL(eSTATE_H1, historyStateID(snapshotTarget, eSTATE_H_SHALLOW_HISTORY));
+
+        // B: I -> H (deep history) uses the restored history
+        TEST_ASSERT_EQUAL(eOK, snapshotTarget.dispatch(eHEVENT_B, nullptr));
+        TEST_ASSERT_TRUE(snapshotTarget.inState(eSTATE_H12));
+    }
+
+    /**
+     * @brief Test that restoring performs no entry or exit behavior
+     */
+    void sntest_no_behavior()
+    {
+        TestCTX ctx = TestCTX();
+        TestHSM hsm = TestHSM();
+        ctx.init();
+        TEST_ASSERT_EQUAL(eOK, hsm.init(static_cast<void*>(&ctx)));
+        const unsigned int initial = hsm.getCurrentState()->ID;
+
+        uint8_t buffer[2u + (2u * sizeof(tStateIndex))];
+        TEST_ASSERT_EQUAL(sizeof(buffer), hsm.snapshot(buffer, sizeof(buffer)));
+        TEST_ASSERT_EQUAL(eOK, hsm.dispatch(eEVENT_C, &ctx));
+        const unsigned int moved = hsm.getCurrentState()->ID;
+        TEST_ASSERT_NOT_EQUAL(initial, moved);
+
+        unsigned int entries[eSTATE_COUNT];
+        unsigned int exits[eSTATE_COUNT];
+        for (unsigned int id = 0; id < eSTATE_COUNT; id++) {
+            entries[id] = static_cast<TestState*>(hsm.getVertex(id))->getEntryCount();
+            exits[id] = static_cast<TestState*>(hsm.getVertex(id))->getExitCount();
+        }
+
+        TEST_ASSERT_TRUE(hsm.restore(buffer, sizeof(buffer)));
+        TEST_ASSERT_EQUAL(initial, hsm.getCurrentState()->ID);
+        for (unsigned int id = 0; id < eSTATE_COUNT; id++) {
+            TEST_ASSERT_EQUAL(entries[id], static_cast<TestState*>(hsm.getVertex(id))->getEntryCount());
+            TEST_ASSERT_EQUAL(exits[id], static_cast<TestState*>(hsm.getVertex(id))->getExitCount());
+        }
+
+        // Restored configuration dispatches like the original
+        TEST_ASSERT_EQUAL(eOK, hsm.dispatch(eEVENT_C, &ctx));
+        TEST_ASSERT_EQUAL(moved, hsm.getCurrentState()->ID);
+    }
+
+    /**
+     * @brief Test that invalid snapshots are rejected without modifying the HSM
+     */
+    void sntest_invalid()
+    {
+        TEST_ASSERT_EQUAL(eOK, snapshotSource.init(nullptr));
+        TEST_ASSERT_EQUAL(eOK, snapshotTarget.init(nullptr));
+        TEST_ASSERT_EQUAL(eOK, snapshotTarget.dispatch(eHEVENT_C, nullptr));
+
+        uint8_t buffer[HISTORY_SNAPSHOT_SIZE];
+        uint8_t corrupt[HISTORY_SNAPSHOT_SIZE];
+        TEST_ASSERT_EQUAL(0, snapshotSource.snapshot(buffer, sizeof(buffer) - 1));
+        TEST_ASSERT_EQUAL(HISTORY_SNAPSHOT_SIZE, snapshotSource.snapshot(buffer, sizeof(buffer)));
+        TEST_ASSERT_FALSE(snapshotTarget.restore(buffer, sizeof(buffer) - 1));
+
+        // Unknown version
+        memcpy(corrupt, buffer, sizeof(buffer));
+        corrupt[0]++;
+        TEST_ASSERT_FALSE(snapshotTarget.restore(corrupt, sizeof(corrupt)));
+
+        // Active state out of range
+        memcpy(corrupt, buffer, sizeof(buffer));
+        memset(&corrupt[2u + sizeof(tStateIndex)], 0x7F, sizeof(tStateIndex));
+        TEST_ASSERT_FALSE(snapshotTarget.restore(corrupt, sizeof(corrupt)));
+
+        // History storing a state outside of its composite state (I)
+        memcpy(corrupt, buffer, sizeof(buffer));
+        memcpy(&corrupt[2u + (2u * sizeof(tStateIndex))], &buffer[2u + sizeof(tStateIndex)], sizeof(tStateIndex));
+        TEST_ASSERT_FALSE(snapshotTarget.restore(corrupt, sizeof(corrupt)));
+
+        TEST_ASSERT_TRUE(snapshotTarget.inState(eSTATE_H11));
+        TEST_ASSERT_EQUAL(eSTATE_H11, historyStateID(snapshotTarget, eSTATE_H_DEEP_HISTORY));
+        TEST_ASSERT_EQUAL(eSTATE_H1, historyStateID(snapshotTarget, eSTATE_H_SHALLOW_HISTORY));
+    }
+
+    /**
+     * @brief Test snapshot and restore of many instances of a static definition
+     */
+    void sntest_static_bulk()
+    {
+        static StaticDefinition<eSSTATE_COUNT, STATIC_HISTORY_EVENT_COUNT, STATIC_HISTORY_TRANSITION_COUNT> definition(
+                staticHistoryVertices, staticHistoryTransitions, eSSTATE_I);
+        TEST_ASSERT_EQUAL(eOK, definition.init());
+
+        static const unsigned int COUNT = 6;
+        static const unsigned int events[] = {eHEVENT_C, eHEVENT_C, eHEVENT_B, eHEVENT_A, eHEVENT_A, eHEVENT_B};
+        StaticTestCTX ctxA = StaticTestCTX();
+        StaticTestCTX ctxB = StaticTestCTX();
+        ctxA.reset();
+        ctxB.reset();
+        StaticInstance<2> a[COUNT], b[COUNT];
+        for (unsigned int i = 0; i < COUNT; i++) {
+            definition.start(a[i], static_cast<TestCTX*>(&ctxA));
+            definition.start(b[i], static_cast<TestCTX*>(&ctxB));
+            // Instance `i` processed the first `i` events
+            for (unsigned int e = 0; e < i; e++) {
+                definition.dispatch(a[i], events[e]);
+            }
+        }
+
+        const unsigned long size = definition.getSnapshotSize(COUNT);
+        TEST_ASSERT_EQUAL(STATIC_SNAPSHOT_HEADER_SIZE + (COUNT * 3u * sizeof(tStaticIndex)), size);
+        uint8_t buffer[STATIC_SNAPSHOT_HEADER_SIZE + (COUNT * 3u * sizeof(tStaticIndex))];
+        TEST_ASSERT_EQUAL(0, definition.snapshot(a, COUNT, buffer, size - 1));
+        TEST_ASSERT_EQUAL(size, definition.snapshot(a, COUNT, buffer, size));
+
+        // Count must match, a corrupt record rejects the complete snapshot
+        TEST_ASSERT_FALSE(definition.restore(b, COUNT - 1, buffer, size));
+        buffer[size - 1] ^= 0x0F;
+        TEST_ASSERT_FALSE(definition.restore(b, COUNT, buffer, size));
+        buffer[size - 1] ^= 0x0F;
+        for (unsigned int i = 0; i < COUNT; i++) {
+            TEST_ASSERT_EQUAL(eSSTATE_I, definition.getCurrentState(b[i]));
+        }
+
+        const StaticTestCTX entered = ctxB;
+        TEST_ASSERT_TRUE(definition.restore(b, COUNT, buffer, size));
+        for (unsigned int i = 0; i < COUNT; i++) {
+            TEST_ASSERT_EQUAL(definition.getCurrentState(a[i]), definition.getCurrentState(b[i]));
+            TEST_ASSERT_EQUAL(definition.getHistoryState(a[i], eSSTATE_H_SHALLOW_HISTORY),
+                    definition.getHistoryState(b[i], eSSTATE_H_SHALLOW_HISTORY));
+            TEST_ASSERT_EQUAL(definition.getHistoryState(a[i], eSSTATE_H_DEEP_HISTORY),
+                    definition.getHistoryState(b[i], eSSTATE_H_DEEP_HISTORY));
+            TEST_ASSERT_EQUAL_PTR(static_cast<TestCTX*>(&ctxB), b[i].ctx);
+        }
+        TEST_ASSERT_EQUAL_UINT_ARRAY(entered.entryCount, ctxB.entryCount, eSSTATE_COUNT);
+        TEST_ASSERT_EQUAL_UINT_ARRAY(entered.exitCount, ctxB.exitCount, eSSTATE_COUNT);
+
+        // Restored instances continue with their own histories
+        TEST_ASSERT_EQUAL(eOK, definition.dispatch(b[3], eHEVENT_B));
+        TEST_ASSERT_EQUAL(eSSTATE_H12, definition.getCurrentState(b[3]));
+    }
+
+    void run_snapshot_tests(void)
+    {
+        RUN_TEST(sntest_round_trip);
+        RUN_TEST(sntest_no_behavior);
+        RUN_TEST(sntest_invalid);
+        RUN_TEST(sntest_static_bulk);
+    }
+}
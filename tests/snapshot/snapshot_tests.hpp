@@ -0,0 +1,9 @@
+#ifndef _H_MICROHSM_TESTS_SNAPSHOT_TESTS
+#define _H_MICROHSM_TESTS_SNAPSHOT_TESTS
+
+namespace microhsm_tests
+{
+    void run_snapshot_tests(void);
+}
+
+#endif
@@ -0,0 +1,92 @@
+/**
+ * @file StaticTestHSM.cpp
+ * @brief Table-driven versions of `TestHSM` and `HistoryHSM` used for testing
+ */
+
+#include <static/StaticTestHSM.hpp>
+
+namespace microhsm_tests
+{
+    void StaticTestCTX::reset()
+    {
+        this->init();
+        for (unsigned int i = 0; i < eSSTATE_COUNT; i++) {
+            entryCount[i] = 0;
+            exitCount[i] = 0;
+        }
+    }
+
+    /// Entry behavior counting entries of state `ID`
+    template <unsigned int ID>
+    static void countEntry(void* ctx)
+    {
+        StaticTestCTX* context = static_cast<StaticTestCTX*>(static_cast<TestCTX*>(ctx));
+        context->entryCount[ID]++;
+    }
+
+    /// Exit behavior counting exits of state `ID`
+    template <unsigned int ID>
+    static void countExit(void* ctx)
+    {
+        StaticTestCTX* context = static_cast<StaticTestCTX*>(static_cast<TestCTX*>(ctx));
+        context->exitCount[ID]++;
+    }
+
+    #define COUNTED_STATE(id, parent, initial) \
+        staticState(parent, initial, countEntry<id>, countExit<id>)
+
+    const sStaticVertex staticTestVertices[eSTATE_COUNT] = {
+        COUNTED_STATE(eSTATE_S, VERTEX_NONE, eSTATE_S1),
+        COUNTED_STATE(eSTATE_S1, eSTATE_S, VERTEX_NONE),
+        COUNTED_STATE(eSTATE_S2, eSTATE_S, eSTATE_S21),
+        COUNTED_STATE(eSTATE_S21, eSTATE_S2, VERTEX_NONE),
+        COUNTED_STATE(eSTATE_S22, eSTATE_S2, VERTEX_NONE),
+        COUNTED_STATE(eSTATE_U, VERTEX_NONE, VERTEX_NONE),
+        COUNTED_STATE(eSTATE_V, VERTEX_NONE, VERTEX_NONE),
+        COUNTED_STATE(eSTATE_X, VERTEX_NONE, VERTEX_NONE),
+    };
+
+    const sStaticTransition staticTestTransitions[STATIC_TEST_TRANSITION_COUNT] = {
+        staticLocal(eSTATE_S, eEVENT_B, eSTATE_S2, TestCTX::setFlag),
+        staticExternal(eSTATE_S, eEVENT_E, eSTATE_S22, TestCTX::setFlag),
+        staticInternal(eSTATE_S, eEVENT_F, TestCTX::setFlag),
+        staticExternal(eSTATE_S, eEVENT_G, eSTATE_U),
+        staticExternal(eSTATE_S1, eEVENT_A, eSTATE_S1),
+        staticExternal(eSTATE_S1, eEVENT_C, eSTATE_S2, TestCTX::setFlag),
+        staticExternal(eSTATE_S1, eEVENT_D, eSTATE_S),
+        staticExternal(eSTATE_S1, eEVENT_F, eSTATE_S22),
+        staticExternal(eSTATE_S2, eEVENT_C, eSTATE_S1, TestCTX::clearFlag),
+        staticExternal(eSTATE_S2, eEVENT_E, eSTATE_U, TestCTX::clearFlag),
+        staticExternal(eSTATE_S21, eEVENT_B, eSTATE_S, TestCTX::clearFlag),
+        staticExternal(eSTATE_S22, eEVENT_F, eSTATE_S21),
+        staticExternal(eSTATE_U, eEVENT_A, eSTATE_V),
+        staticExternal(eSTATE_U, eEVENT_G, eSTATE_S22, TestCTX::setFlag),
+        staticExternal(eSTATE_U, eEVENT_E, eSTATE_S),
+        staticExternal(eSTATE_V, eEVENT_ANONYMOUS, eSTATE_X),
+        staticExternal(eSTATE_X, eEVENT_ANONYMOUS, eSTATE_S),
+    };
+
+    const sStaticVertex staticHistoryVertices[eSSTATE_COUNT] = {
+        COUNTED_STATE(eSSTATE_H, VERTEX_NONE, eSSTATE_H1),
+        staticShallowHistory(eSSTATE_H, eSSTATE_H2),
+        staticDeepHistory(eSSTATE_H),
+        COUNTED_STATE(eSSTATE_H1, eSSTATE_H, eSSTATE_H11),
+        COUNTED_STATE(eSSTATE_H11, eSSTATE_H1, VERTEX_NONE),
+        COUNTED_STATE(eSSTATE_H12, eSSTATE_H1, VERTEX_NONE),
+        COUNTED_STATE(eSSTATE_H2, eSSTATE_H, eSSTATE_H21),
+        COUNTED_STATE(eSSTATE_H21, eSSTATE_H2, VERTEX_NONE),
+        COUNTED_STATE(eSSTATE_H22, eSSTATE_H2, VERTEX_NONE),
+        COUNTED_STATE(eSSTATE_I, VERTEX_NONE, VERTEX_NONE),
+    };
+
+    const sStaticTransition staticHistoryTransitions[STATIC_HISTORY_TRANSITION_COUNT] = {
+        staticExternal(eSSTATE_H, eHEVENT_B, eSSTATE_I),
+        staticExternal(eSSTATE_H1, eHEVENT_A, eSSTATE_H2),
+        staticExternal(eSSTATE_H11, eHEVENT_C, eSSTATE_H12),
+        staticExternal(eSSTATE_H21, eHEVENT_A, eSSTATE_H22),
+        staticExternal(eSSTATE_H22, eHEVENT_A, eSSTATE_I),
+        staticExternal(eSSTATE_I, eHEVENT_A, eSSTATE_H_SHALLOW_HISTORY),
+        staticExternal(eSSTATE_I, eHEVENT_B, eSSTATE_H_DEEP_HISTORY),
+        staticExternal(eSSTATE_I, eHEVENT_C, eSSTATE_H),
+    };
+}
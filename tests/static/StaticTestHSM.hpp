@@ -0,0 +1,63 @@
+/**
+ * @file StaticTestHSM.hpp
+ * @brief Table-driven versions of `TestHSM` and `HistoryHSM` used for testing
+ */
+#ifndef _H_MICROHSM_TESTS_STATICTESTHSM
+#define _H_MICROHSM_TESTS_STATICTESTHSM
+
+#include <microhsm/microhsm.hpp>
+#include <context/TestCTX.hpp>
+#include <basic/TestHSM.hpp>
+#include <history/HistoryHSM.hpp>
+
+using namespace microhsm;
+
+namespace microhsm_tests
+{
+    /// Number of events of `StaticTestHSM` (see `e_events`)
+    #define STATIC_TEST_EVENT_COUNT 8
+    /// Number of transitions of `StaticTestHSM`
+    #define STATIC_TEST_TRANSITION_COUNT 17
+
+    /// Vertex IDs of `StaticHistoryHSM`
+    enum e_shids : unsigned int {
+        eSSTATE_H = 0,
+        eSSTATE_H_SHALLOW_HISTORY,
+        eSSTATE_H_DEEP_HISTORY,
+        eSSTATE_H1,
+        eSSTATE_H11,
+        eSSTATE_H12,
+        eSSTATE_H2,
+        eSSTATE_H21,
+        eSSTATE_H22,
+        eSSTATE_I,
+        eSSTATE_COUNT
+    };
+
+    /// Number of events of `StaticHistoryHSM` (see `e_hevents`)
+    #define STATIC_HISTORY_EVENT_COUNT 4
+    /// Number of transitions of `StaticHistoryHSM`
+    #define STATIC_HISTORY_TRANSITION_COUNT 8
+
+    /// Context which counts state entries and exits
+    class StaticTestCTX : public TestCTX
+    {
+        public:
+            void reset();
+
+            unsigned int entryCount[eSSTATE_COUNT];
+            unsigned int exitCount[eSSTATE_COUNT];
+    };
+
+    /// Same machine as `TestHSM`, with the same state and event IDs
+    typedef StaticHSM<eSTATE_COUNT, STATIC_TEST_EVENT_COUNT, STATIC_TEST_TRANSITION_COUNT> StaticTestHSM;
+    extern const sStaticVertex staticTestVertices[eSTATE_COUNT];
+    extern const sStaticTransition staticTestTransitions[STATIC_TEST_TRANSITION_COUNT];
+
+    /// Same machine as `HistoryHSM`, with vertex IDs of `e_shids`
+    typedef StaticHSM<eSSTATE_COUNT, STATIC_HISTORY_EVENT_COUNT, STATIC_HISTORY_TRANSITION_COUNT> StaticHistoryHSM;
+    extern const sStaticVertex staticHistoryVertices[eSSTATE_COUNT];
+    extern const sStaticTransition staticHistoryTransitions[STATIC_HISTORY_TRANSITION_COUNT];
+}
+
+#endif
@@ -0,0 +1,520 @@
+#include <unity.h>
+
+#include <static/static_tests.hpp>
+#include <static/StaticTestHSM.hpp>
+
+namespace microhsm_tests
+{
+    static StaticTestCTX staticCTX = StaticTestCTX();
+    static StaticTestHSM staticHSM = StaticTestHSM(staticTestVertices, staticTestTransitions, eSTATE_S);
+    static StaticHistoryHSM staticHistoryHSM = StaticHistoryHSM(staticHistoryVertices, staticHistoryTransitions, eSSTATE_I);
+
+    // Reference implementations
+    static TestCTX referenceCTX = TestCTX();
+    static TestHSM referenceHSM = TestHSM();
+    static HistoryHSM referenceHistoryHSM = HistoryHSM();
+
+    /* Private functions */
+    static void setupStaticTest()
+    {
+        MICROHSM_TEST_MESSAGE("Initializing static test HSM")
+        staticCTX.reset();
+        TEST_ASSERT_EQUAL(eOK, staticHSM.init(static_cast<TestCTX*>(&staticCTX)));
+        MICROHSM_TEST_MESSAGE("Initialized")
+    }
+
+    static void setupStaticHistoryTest()
+    {
+        MICROHSM_TEST_MESSAGE("Initializing static history test HSM")
+        staticCTX.reset();
+        TEST_ASSERT_EQUAL(eOK, staticHistoryHSM.init(static_cast<TestCTX*>(&staticCTX)));
+        MICROHSM_TEST_MESSAGE("Initialized")
+    }
+
+    static eStatus dispatchStatic(unsigned int event)
+    {
+        return staticHSM.dispatch(event, static_cast<TestCTX*>(&staticCTX));
+    }
+
+    static eStatus dispatchStaticHistory(unsigned int event)
+    {
+        return staticHistoryHSM.dispatch(event, static_cast<TestCTX*>(&staticCTX));
+    }
+
+    /**
+     * @brief Assert entry and exit counts of states S, S1, S2, S21, S22 and U
+     */
+    static void assertCounts(const unsigned int (&entries)[6], const unsigned int (&exits)[6])
+    {
+        TEST_ASSERT_EQUAL_UINT_ARRAY(entries, staticCTX.entryCount, 6);
+        TEST_ASSERT_EQUAL_UINT_ARRAY(exits, staticCTX.exitCount, 6);
+    }
+
+    /**
+     * @brief Assert configuration of states S, S1, S2, S21, S22 and U
+     */
+    static void assertConfiguration(bool s, bool s1, bool s2, bool s21, bool s22, bool u)
+    {
+        TEST_ASSERT_EQUAL(s, staticHSM.inState(eSTATE_S));
+        TEST_ASSERT_EQUAL(s1, staticHSM.inState(eSTATE_S1));
+        TEST_ASSERT_EQUAL(s2, staticHSM.inState(eSTATE_S2));
+        TEST_ASSERT_EQUAL(s21, staticHSM.inState(eSTATE_S21));
+        TEST_ASSERT_EQUAL(s22, staticHSM.inState(eSTATE_S22));
+        TEST_ASSERT_EQUAL(u, staticHSM.inState(eSTATE_U));
+    }
+
+    /**
+     * @brief Assert configuration of `StaticHistoryHSM`
+     */
+    static void assertHistoryConfiguration(bool h, bool h1, bool h11, bool h12, bool h2, bool h21, bool h22, bool i)
+    {
+        TEST_ASSERT_EQUAL(h, staticHistoryHSM.inState(eSSTATE_H));
+        TEST_ASSERT_EQUAL(h1, staticHistoryHSM.inState(eSSTATE_H1));
+        TEST_ASSERT_EQUAL(h11, staticHistoryHSM.inState(eSSTATE_H11));
+        TEST_ASSERT_EQUAL(h12, staticHistoryHSM.inState(eSSTATE_H12));
+        TEST_ASSERT_EQUAL(h2, staticHistoryHSM.inState(eSSTATE_H2));
+        TEST_ASSERT_EQUAL(h21, staticHistoryHSM.inState(eSSTATE_H21));
+        TEST_ASSERT_EQUAL(h22, staticHistoryHSM.inState(eSSTATE_H22));
+        TEST_ASSERT_EQUAL(i, staticHistoryHSM.inState(eSSTATE_I));
+    }
+
+    /* Ported basic tests */
+    void stest_initial_configuration()
+    {
+        setupStaticTest();
+        TEST_ASSERT_EQUAL(eSTATE_S1, staticHSM.getCurrentState());
+        assertConfiguration(true, true, false, false, false, false);
+        assertCounts({1, 1, 0, 0, 0, 0}, {0, 0, 0, 0, 0, 0});
+        TEST_ASSERT_FALSE(staticCTX.getFlag());
+    }
+
+    void stest_anonymous_transitions()
+    {
+        setupStaticTest();
+        // EVENT_G: S1 -> U (external)
+        TEST_ASSERT_EQUAL(eOK, dispatchStatic(eEVENT_G));
+        assertConfiguration(false, false, false, false, false, true);
+
+        // EVENT_A: U -> V (external)
+        // (anonymous): V -> X (external)
+        // (anonymous): X -> S (external)
+        TEST_ASSERT_EQUAL(eOK, dispatchStatic(eEVENT_A));
+        assertConfiguration(true, true, false, false, false, false);
+        TEST_ASSERT_FALSE(staticHSM.inState(eSTATE_V));
+        TEST_ASSERT_FALSE(staticHSM.inState(eSTATE_X));
+        assertCounts({2, 2, 0, 0, 0, 1}, {1, 1, 0, 0, 0, 1});
+        TEST_ASSERT_EQUAL(1, staticCTX.entryCount[eSTATE_V]);
+        TEST_ASSERT_EQUAL(1, staticCTX.entryCount[eSTATE_X]);
+        TEST_ASSERT_EQUAL(1, staticCTX.exitCount[eSTATE_V]);
+        TEST_ASSERT_EQUAL(1, staticCTX.exitCount[eSTATE_X]);
+    }
+
+    void stest_transition_a()
+    {
+        setupStaticTest();
+        // EVENT_A: S1 -> S1 (external)
+        TEST_ASSERT_EQUAL(eOK, dispatchStatic(eEVENT_A));
+        assertConfiguration(true, true, false, false, false, false);
+        assertCounts({1, 2, 0, 0, 0, 0}, {0, 1, 0, 0, 0, 0});
+        TEST_ASSERT_FALSE(staticCTX.getFlag());
+    }
+
+    void stest_transition_b()
+    {
+        setupStaticTest();
+        // EVENT_B / TestCTX::setFlag: S1 -> S2 (local)
+        TEST_ASSERT_EQUAL(eOK, dispatchStatic(eEVENT_B));
+        assertConfiguration(true, false, true, true, false, false);
+        assertCounts({1, 1, 1, 1, 0, 0}, {0, 1, 0, 0, 0, 0});
+        TEST_ASSERT_TRUE(staticCTX.getFlag());
+
+        // EVENT_B / TestCTX::clearFlag: S21 -> S
+        TEST_ASSERT_EQUAL(eOK, dispatchStatic(eEVENT_B));
+        assertConfiguration(true, true, false, false, false, false);
+        assertCounts({1, 2, 1, 1, 0, 0}, {0, 1, 1, 1, 0, 0});
+        TEST_ASSERT_FALSE(staticCTX.getFlag());
+    }
+
+    void stest_transition_c()
+    {
+        setupStaticTest();
+        // C: S1 -> S2
+        TEST_ASSERT_EQUAL(eOK, dispatchStatic(eEVENT_C));
+        assertConfiguration(true, false, true, true, false, false);
+        assertCounts({1, 1, 1, 1, 0, 0}, {0, 1, 0, 0, 0, 0});
+        TEST_ASSERT_TRUE(staticCTX.getFlag());
+
+        // C: S2 -> S1
+        TEST_ASSERT_EQUAL(eOK, dispatchStatic(eEVENT_C));
+        assertConfiguration(true, true, false, false, false, false);
+        assertCounts({1, 2, 1, 1, 0, 0}, {0, 1, 1, 1, 0, 0});
+        TEST_ASSERT_FALSE(staticCTX.getFlag());
+    }
+
+    void stest_transition_d()
+    {
+        setupStaticTest();
+        // D: S1 -> S
+        TEST_ASSERT_EQUAL(eOK, dispatchStatic(eEVENT_D));
+        assertConfiguration(true, true, false, false, false, false);
+        assertCounts({1, 2, 0, 0, 0, 0}, {0, 1, 0, 0, 0, 0});
+        TEST_ASSERT_FALSE(staticCTX.getFlag());
+    }
+
+    void stest_transition_e()
+    {
+        setupStaticTest();
+        // E: S -> S22
+        TEST_ASSERT_EQUAL(eOK, dispatchStatic(eEVENT_E));
+        assertConfiguration(true, false, true, false, true, false);
+        assertCounts({2, 1, 1, 0, 1, 0}, {1, 1, 0, 0, 0, 0});
+        TEST_ASSERT_TRUE(staticCTX.getFlag());
+
+        // F: S22 -> S21
+        TEST_ASSERT_EQUAL(eOK, dispatchStatic(eEVENT_F));
+        assertConfiguration(true, false, true, true, false, false);
+        assertCounts({2, 1, 1, 1, 1, 0}, {1, 1, 0, 0, 1, 0});
+        TEST_ASSERT_TRUE(staticCTX.getFlag());
+
+        // E: S2 -> U
+        TEST_ASSERT_EQUAL(eOK, dispatchStatic(eEVENT_E));
+        assertConfiguration(false, false, false, false, false, true);
+        assertCounts({2, 1, 1, 1, 1, 1}, {2, 1, 1, 1, 1, 0});
+        TEST_ASSERT_FALSE(staticCTX.getFlag());
+
+        // E: U -> S
+        TEST_ASSERT_EQUAL(eOK, dispatchStatic(eEVENT_E));
+        assertConfiguration(true, true, false, false, false, false);
+        assertCounts({3, 2, 1, 1, 1, 1}, {2, 1, 1, 1, 1, 1});
+    }
+
+    void stest_transition_f()
+    {
+        setupStaticTest();
+        // F: S1 -> S22
+        TEST_ASSERT_EQUAL(eOK, dispatchStatic(eEVENT_F));
+        assertConfiguration(true, false, true, false, true, false);
+        assertCounts({1, 1, 1, 0, 1, 0}, {0, 1, 0, 0, 0, 0});
+        TEST_ASSERT_FALSE(staticCTX.getFlag());
+
+        // F: S22 -> S21
+        TEST_ASSERT_EQUAL(eOK, dispatchStatic(eEVENT_F));
+        assertConfiguration(true, false, true, true, false, false);
+        assertCounts({1, 1, 1, 1, 1, 0}, {0, 1, 0, 0, 1, 0});
+        TEST_ASSERT_FALSE(staticCTX.getFlag());
+
+        // F / TestCTX::setFlag: S (internal)
+        TEST_ASSERT_EQUAL(eOK, dispatchStatic(eEVENT_F));
+        assertConfiguration(true, false, true, true, false, false);
+        assertCounts({1, 1, 1, 1, 1, 0}, {0, 1, 0, 0, 1, 0});
+        TEST_ASSERT_TRUE(staticCTX.getFlag());
+    }
+
+    void stest_transition_g()
+    {
+        setupStaticTest();
+        // G: S -> U
+        TEST_ASSERT_EQUAL(eOK, dispatchStatic(eEVENT_G));
+        assertConfiguration(false, false, false, false, false, true);
+        assertCounts({1, 1, 0, 0, 0, 1}, {1, 1, 0, 0, 0, 0});
+        TEST_ASSERT_FALSE(staticCTX.getFlag());
+
+        // G / TestCTX::setFlag: U -> S22
+        TEST_ASSERT_EQUAL(eOK, dispatchStatic(eEVENT_G));
+        assertConfiguration(true, false, true, false, true, false);
+        assertCounts({2, 1, 1, 0, 1, 1}, {1, 1, 0, 0, 0, 1});
+        TEST_ASSERT_TRUE(staticCTX.getFlag());
+    }
+
+    /* Ported history tests */
+    void stest_history_initial_configuration()
+    {
+        setupStaticHistoryTest();
+        TEST_ASSERT_TRUE(staticHistoryHSM.inState(eSSTATE_I));
+        // Deep history has no default state, thus must be set to parent initial state
+        TEST_ASSERT_EQUAL(eSSTATE_H11, staticHistoryHSM.getHistoryState(eSSTATE_H_DEEP_HISTORY));
+        // Shallow has default state set and therefore must correspond to its default state
+        TEST_ASSERT_EQUAL(eSSTATE_H2, staticHistoryHSM.getHistoryState(eSSTATE_H_SHALLOW_HISTORY));
+    }
+
+    void stest_history_default_shallow()
+    {
+        setupStaticHistoryTest();
+        TEST_ASSERT_EQUAL(eOK, dispatchStaticHistory(eHEVENT_A));
+        assertHistoryConfiguration(true, false, false, false, true, true, false, false);
+    }
+
+    void stest_history_default_deep()
+    {
+        setupStaticHistoryTest();
+        TEST_ASSERT_EQUAL(eOK, dispatchStaticHistory(eHEVENT_B));
+        assertHistoryConfiguration(true, true, true, false, false, false, false, false);
+    }
+
+    void stest_history_h12_shallow()
+    {
+        setupStaticHistoryTest();
+        // C: I -> H(H1(H11)), C: H11 -> H12, B: H -> I
+        TEST_ASSERT_EQUAL(eOK, dispatchStaticHistory(eHEVENT_C));
+        TEST_ASSERT_EQUAL(eOK, dispatchStaticHistory(eHEVENT_C));
+        assertHistoryConfiguration(true, true, false, true, false, false, false, false);
+        TEST_ASSERT_EQUAL(eOK, dispatchStaticHistory(eHEVENT_B));
+        assertHistoryConfiguration(false, false, false, false, false, false, false, true);
+
+        // A: I -> H (shallow history)
+        TEST_ASSERT_EQUAL(eOK, dispatchStaticHistory(eHEVENT_A));
+        TEST_ASSERT_EQUAL(eSSTATE_H11, staticHistoryHSM.getCurrentState());
+        assertHistoryConfiguration(true, true, true, false, false, false, false, false);
+    }
+
+    void stest_history_h12_deep()
+    {
+        setupStaticHistoryTest();
+        // C: I -> H(H1(H11)), C: H11 -> H12, B: H -> I
+        TEST_ASSERT_EQUAL(eOK, dispatchStaticHistory(eHEVENT_C));
+        TEST_ASSERT_EQUAL(eOK, dispatchStaticHistory(eHEVENT_C));
+        TEST_ASSERT_EQUAL(eOK, dispatchStaticHistory(eHEVENT_B));
+        assertHistoryConfiguration(false, false, false, false, false, false, false, true);
+
+        // B: I -> H (deep history)
+        TEST_ASSERT_EQUAL(eOK, dispatchStaticHistory(eHEVENT_B));
+        TEST_ASSERT_EQUAL(eSSTATE_H12, staticHistoryHSM.getCurrentState());
+        assertHistoryConfiguration(true, true, false, true, false, false, false, false);
+    }
+
+    void stest_history_h22_shallow()
+    {
+        setupStaticHistoryTest();
+        // C: I -> H(H1(H11)), A: H1 -> H2(H21), A: H21 -> H22
+        TEST_ASSERT_EQUAL(eOK, dispatchStaticHistory(eHEVENT_C));
+        TEST_ASSERT_EQUAL(eOK, dispatchStaticHistory(eHEVENT_A));
+        TEST_ASSERT_EQUAL(eOK, dispatchStaticHistory(eHEVENT_A));
+        assertHistoryConfiguration(true, false, false, false, true, false, true, false);
+
+        // A: H22 -> I
+        TEST_ASSERT_EQUAL(eOK, dispatchStaticHistory(eHEVENT_A));
+        assertHistoryConfiguration(false, false, false, false, false, false, false, true);
+
+        // A: I -> H (shallow history)
+        TEST_ASSERT_EQUAL(eOK, dispatchStaticHistory(eHEVENT_A));
+        assertHistoryConfiguration(true, false, false, false, true, true, false, false);
+    }
+
+    void stest_history_h22_deep()
+    {
+        setupStaticHistoryTest();
+        // C: I -> H(H1(H11)), A: H1 -> H2(H21), A: H21 -> H22, A: H22 -> I
+        TEST_ASSERT_EQUAL(eOK, dispatchStaticHistory(eHEVENT_C));
+        TEST_ASSERT_EQUAL(eOK, dispatchStaticHistory(eHEVENT_A));
+        TEST_ASSERT_EQUAL(eOK, dispatchStaticHistory(eHEVENT_A));
+        TEST_ASSERT_EQUAL(eOK, dispatchStaticHistory(eHEVENT_A));
+        assertHistoryConfiguration(false, false, false, false, false, false, false, true);
+
+        // B: I -> H (deep history)
+        TEST_ASSERT_EQUAL(eOK, dispatchStaticHistory(eHEVENT_B));
+        assertHistoryConfiguration(true, false, false, false, true, false, true, false);
+    }
+
+    /* Equivalence with `BaseHSM` */
+
+    /**
+     * @brief Dispatch a pseudo-random event sequence to `TestHSM` and `StaticTestHSM`
+     */
+    void stest_equivalence_basic()
+    {
+        setupStaticTest();
+        referenceCTX.init();
+        TEST_ASSERT_EQUAL(eOK, referenceHSM.init(&referenceCTX));
+
+        unsigned int seed = 12345u;
+        for (unsigned int i = 0; i < 200; i++) {
+            seed = (seed * 1103515245u) + 12345u;
+            unsigned int event = 1u + ((seed >> 16) % (STATIC_TEST_EVENT_COUNT - 1u));
+
+            eStatus expected = referenceHSM.dispatch(event, &referenceCTX);
+            eStatus actual = dispatchStatic(event);
+            TEST_ASSERT_EQUAL(expected, actual);
+            TEST_ASSERT_EQUAL(referenceHSM.getCurrentState()->ID, staticHSM.getCurrentState());
+            TEST_ASSERT_EQUAL(referenceCTX.getFlag(), staticCTX.getFlag());
+            for (unsigned int id = 0; id < eSTATE_COUNT; id++) {
+                TestState* s = static_cast<TestState*>(referenceHSM.getVertex(id));
+                TEST_ASSERT_EQUAL(s->getEntryCount(), staticCTX.entryCount[id]);
+                TEST_ASSERT_EQUAL(s->getExitCount(), staticCTX.exitCount[id]);
+            }
+        }
+    }
+
+    /**
+     * @brief Dispatch a pseudo-random event sequence to `HistoryHSM` and `StaticHistoryHSM`
+     */
+    void stest_equivalence_history()
+    {
+        setupStaticHistoryTest();
+        TEST_ASSERT_EQUAL(eOK, referenceHistoryHSM.init(nullptr));
+
+        unsigned int seed = 54321u;
+        for (unsigned int i = 0; i < 200; i++) {
+            seed = (seed * 1103515245u) + 12345u;
+            unsigned int event = 1u + ((seed >> 16) % (STATIC_HISTORY_EVENT_COUNT - 1u));
+
+            eStatus expected = referenceHistoryHSM.dispatch(event, nullptr);
+            eStatus actual = dispatchStaticHistory(event);
+            TEST_ASSERT_EQUAL(expected, actual);
+            // Vertex IDs of `HistoryHSM` are offset by `eSTATE_H`
+            TEST_ASSERT_EQUAL(referenceHistoryHSM.getCurrentState()->ID - eSTATE_H, staticHistoryHSM.getCurrentState());
+        }
+    }
+
+    /* Guards */
+    enum e_gstates : unsigned int {
+        eGSTATE_P = 0,
+        eGSTATE_Q,
+        eGSTATE_R,
+        eGSTATE_COUNT
+    };
+
+    static bool guardFalse(void* ctx) {(void)ctx; return false;}
+    static bool guardFlag(void* ctx) {return static_cast<TestCTX*>(ctx)->getFlag();}
+
+    static const sStaticVertex guardVertices[eGSTATE_COUNT] = {
+        staticState(VERTEX_NONE, eGSTATE_Q),
+        staticState(eGSTATE_P, VERTEX_NONE),
+        staticState(eGSTATE_P, VERTEX_NONE),
+    };
+
+    static const sStaticTransition guardTransitions[5] = {
+        staticExternal(eGSTATE_Q, eEVENT_A, eGSTATE_P, nullptr, guardFalse),
+        staticExternal(eGSTATE_Q, eEVENT_A, eGSTATE_R, nullptr, guardFlag),
+        staticInternal(eGSTATE_P, eEVENT_A, TestCTX::setFlag),
+        staticExternal(eGSTATE_R, eEVENT_B, eGSTATE_Q, TestCTX::clearFlag, guardFalse),
+        staticExternal(eGSTATE_P, eEVENT_B, eGSTATE_Q, nullptr, guardFlag),
+    };
+
+    /**
+     * @brief Test that guards are evaluated in order, falling back to ancestors
+     */
+    void stest_guards()
+    {
+        StaticHSM<eGSTATE_COUNT, 3, 5> guardHSM(guardVertices, guardTransitions, eGSTATE_P);
+        TestCTX ctx = TestCTX();
+        TEST_ASSERT_EQUAL(eOK, guardHSM.init(&ctx));
+        TEST_ASSERT_EQUAL(eGSTATE_Q, guardHSM.getCurrentState());
+
+        // A: Q guards fail, internal transition of P sets flag
+        TEST_ASSERT_EQUAL(eOK, guardHSM.dispatch(eEVENT_A, &ctx));
+        TEST_ASSERT_EQUAL(eGSTATE_Q, guardHSM.getCurrentState());
+        TEST_ASSERT_TRUE(ctx.getFlag());
+
+        // A: Second guard of Q succeeds
+        TEST_ASSERT_EQUAL(eOK, guardHSM.dispatch(eEVENT_A, &ctx));
+        TEST_ASSERT_EQUAL(eGSTATE_R, guardHSM.getCurrentState());
+
+        // B: Guard of R fails, guard of P succeeds
+        TEST_ASSERT_EQUAL(eOK, guardHSM.dispatch(eEVENT_B, &ctx));
+        TEST_ASSERT_EQUAL(eGSTATE_Q, guardHSM.getCurrentState());
+        TEST_ASSERT_TRUE(ctx.getFlag());
+
+        // C: Not handled by any state
+        TEST_ASSERT_EQUAL(eEVENT_IGNORED, guardHSM.dispatch(eEVENT_C, &ctx));
+        // Events outside of the event range are ignored
+        TEST_ASSERT_EQUAL(eEVENT_IGNORED, guardHSM.dispatch(100, &ctx));
+    }
+
+    void stest_flyweight_instances()
+    {
+        static StaticDefinition<eSSTATE_COUNT, STATIC_HISTORY_EVENT_COUNT, STATIC_HISTORY_TRANSITION_COUNT> definition(
+                staticHistoryVertices, staticHistoryTransitions, eSSTATE_I);
+        TEST_ASSERT_EQUAL(eOK, definition.init());
+        TEST_ASSERT_EQUAL(2, definition.getHistoryCount());
+
+        // Instance is a leaf index, two history slots and the context object
+        StaticInstance<2> a, b;
+        if (sizeof(void*) == 8) TEST_ASSERT_EQUAL(16, sizeof(a));
+
+        StaticTestCTX ctxA = StaticTestCTX();
+        StaticTestCTX ctxB = StaticTestCTX();
+        ctxA.reset();
+        ctxB.reset();
+        definition.start(a, static_cast<TestCTX*>(&ctxA));
+        definition.start(b, static_cast<TestCTX*>(&ctxB));
+        TEST_ASSERT_TRUE(definition.inState(a, eSSTATE_I));
+        TEST_ASSERT_EQUAL(eSSTATE_H11, definition.getHistoryState(a, eSSTATE_H_DEEP_HISTORY));
+
+        // C: I -> H(H1(H11)), C: H11 -> H12, B: H -> I on `a` only
+        TEST_ASSERT_EQUAL(eOK, definition.dispatch(a, eHEVENT_C));
+        TEST_ASSERT_EQUAL(eOK, definition.dispatch(a, eHEVENT_C));
+        TEST_ASSERT_EQUAL(eOK, definition.dispatch(a, eHEVENT_B));
+        TEST_ASSERT_EQUAL(eSSTATE_H12, definition.getHistoryState(a, eSSTATE_H_DEEP_HISTORY));
+        TEST_ASSERT_EQUAL(eSSTATE_H11, definition.getHistoryState(b, eSSTATE_H_DEEP_HISTORY));
+        TEST_ASSERT_EQUAL(1, ctxA.entryCount[eSSTATE_H12]);
+        TEST_ASSERT_EQUAL(0, ctxB.entryCount[eSSTATE_H12]);
+
+        // B: I -> H (deep history) restores each instance's own history
+        TEST_ASSERT_EQUAL(eOK, definition.dispatch(a, eHEVENT_B));
+        TEST_ASSERT_EQUAL(eOK, definition.dispatch(b, eHEVENT_B));
+        TEST_ASSERT_EQUAL(eSSTATE_H12, definition.getCurrentState(a));
+        TEST_ASSERT_EQUAL(eSSTATE_H11, definition.getCurrentState(b));
+    }
+
+    /// Chain of nested states, the last state is a leaf at depth `COUNT - 1`
+    template <unsigned int COUNT>
+    static void buildChain(sStaticVertex (&vertices)[COUNT])
+    {
+        for (unsigned int i = 0; i < COUNT; i++) {
+            vertices[i] = staticState((i == 0) ? VERTEX_NONE : i - 1, (i + 1 < COUNT) ? i + 1 : VERTEX_NONE);
+        }
+    }
+
+    void stest_depth_limit()
+    {
+        static const sStaticTransition transitions[] = {staticExternal(0, eEVENT_A, 0)};
+
+        // Deepest hierarchy fitting the entry path
+        static sStaticVertex fitting[MICROHSM_MAX_DEPTH];
+        buildChain(fitting);
+        static StaticDefinition<MICROHSM_MAX_DEPTH, 2, 1> fittingDefinition(fitting, transitions, 0);
+        TEST_ASSERT_EQUAL(eOK, fittingDefinition.init());
+        StaticInstance<0> a;
+        fittingDefinition.start(a, nullptr);
+        TEST_ASSERT_EQUAL(MICROHSM_MAX_DEPTH - 1, fittingDefinition.getCurrentState(a));
+        TEST_ASSERT_EQUAL(eOK, fittingDefinition.dispatch(a, eEVENT_A));
+        TEST_ASSERT_EQUAL(MICROHSM_MAX_DEPTH - 1, fittingDefinition.getCurrentState(a));
+
+        // Deeper hierarchies are rejected, their instances stay inactive
+        static sStaticVertex deep[MICROHSM_MAX_DEPTH + 1];
+        buildChain(deep);
+        static StaticDefinition<MICROHSM_MAX_DEPTH + 1, 2, 1> deepDefinition(deep, transitions, 0);
+        TEST_ASSERT_EQUAL(eTRANSITION_ERROR, deepDefinition.init());
+        StaticInstance<0> b;
+        deepDefinition.start(b, nullptr);
+        TEST_ASSERT_EQUAL(VERTEX_NONE, deepDefinition.getCurrentState(b));
+        TEST_ASSERT_FALSE(deepDefinition.inState(b, 0));
+        TEST_ASSERT_EQUAL(eEVENT_IGNORED, deepDefinition.dispatch(b, eEVENT_A));
+    }
+
+    // Test functions
+    void run_static_tests(void)
+    {
+        RUN_TEST(stest_initial_configuration);
+        RUN_TEST(stest_anonymous_transitions);
+        RUN_TEST(stest_transition_a);
+        RUN_TEST(stest_transition_b);
+        RUN_TEST(stest_transition_c);
+        RUN_TEST(stest_transition_d);
+        RUN_TEST(stest_transition_e);
+        RUN_TEST(stest_transition_f);
+        RUN_TEST(stest_transition_g);
+        RUN_TEST(stest_history_initial_configuration);
+        RUN_TEST(stest_history_default_shallow);
+        RUN_TEST(stest_history_default_deep);
+        RUN_TEST(stest_history_h12_shallow);
+        RUN_TEST(stest_history_h12_deep);
+        RUN_TEST(stest_history_h22_shallow);
+        RUN_TEST(stest_history_h22_deep);
+        RUN_TEST(stest_equivalence_basic);
+        RUN_TEST(stest_equivalence_history);
+        RUN_TEST(stest_guards);
+        RUN_TEST(stest_flyweight_instances);
+        RUN_TEST(stest_depth_limit);
+    }
+}
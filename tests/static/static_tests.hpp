@@ -0,0 +1,9 @@
+#ifndef _H_MICROHSM_TESTS_STATIC_TESTS
+#define _H_MICROHSM_TESTS_STATIC_TESTS
+
+namespace microhsm_tests
+{
+    void run_static_tests(void);
+}
+
+#endif
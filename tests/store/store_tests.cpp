@@ -0,0 +1,158 @@
+#include <string.h>
+#include <unity.h>
+
+#include <store/store_tests.hpp>
+#include <static/StaticTestHSM.hpp>
+
+namespace microhsm_tests
+{
+    static const unsigned int STORE_COUNT = 4;
+
+    typedef InstanceStore<2, StaticTestCTX> HistoryStore;
+
+    static StaticDefinition<eSSTATE_COUNT, STATIC_HISTORY_EVENT_COUNT, STATIC_HISTORY_TRANSITION_COUNT> storeDefinition(
+            staticHistoryVertices, staticHistoryTransitions, eSSTATE_I);
+
+    /// Memory of the store before and after a "restart"
+    alignas(8) static uint8_t storeMemory[STORE_HEADER_SIZE + (STORE_COUNT * sizeof(HistoryStore::sRecord))];
+    alignas(8) static uint8_t restartMemory[sizeof(storeMemory)];
+
+    /// Format store and move instance `1` to I with deep history H12
+    static void setupStore(HistoryStore& store)
+    {
+        TEST_ASSERT_EQUAL(eOK, storeDefinition.init());
+        TEST_ASSERT_EQUAL(sizeof(storeMemory), store.getRequiredSize(STORE_COUNT));
+        TEST_ASSERT_EQUAL(eSTORE_OK, store.format(storeMemory, sizeof(storeMemory), STORE_COUNT));
+        TEST_ASSERT_EQUAL(eOK, store.dispatch(1, eHEVENT_C));
+        TEST_ASSERT_EQUAL(eOK, store.dispatch(1, eHEVENT_C));
+        TEST_ASSERT_EQUAL(eOK, store.dispatch(1, eHEVENT_B));
+    }
+
+    /**
+     * @brief Test reopening a closed store in other memory
+     */
+    void sttest_reopen()
+    {
+        HistoryStore store(storeDefinition);
+        setupStore(store);
+        for (unsigned int i = 0; i < STORE_COUNT; i++) {
+            TEST_ASSERT_TRUE(store.inState(i, eSSTATE_I));
+            TEST_ASSERT_EQUAL((i == 1) ? 2 : 1, store.getUserData(i).entryCount[eSSTATE_I]);
+        }
+        store.close();
+        TEST_ASSERT_FALSE(store.isOpen());
+
+        // Restarted process finds the instances as they were left
+        memcpy(restartMemory, storeMemory, sizeof(storeMemory));
+        HistoryStore restarted(storeDefinition);
+        TEST_ASSERT_EQUAL(eSTORE_OK, restarted.open(restartMemory, sizeof(restartMemory)));
+        TEST_ASSERT_EQUAL(STORE_COUNT, restarted.getCount());
+        TEST_ASSERT_EQUAL(eSSTATE_I, restarted.getCurrentState(1));
+        TEST_ASSERT_EQUAL(eSSTATE_H12, restarted.getHistoryState(1, eSSTATE_H_DEEP_HISTORY));
+        TEST_ASSERT_EQUAL(eSSTATE_H1, restarted.getHistoryState(1, eSSTATE_H_SHALLOW_HISTORY));
+        TEST_ASSERT_EQUAL(eSSTATE_H11, restarted.getHistoryState(0, eSSTATE_H_DEEP_HISTORY));
+
+        // Opening performs no behavior, user data is kept
+        const StaticTestCTX before = restarted.getUserData(1);
+        TEST_ASSERT_EQUAL(1, before.entryCount[eSSTATE_H12]);
+        TEST_ASSERT_EQUAL(2, before.entryCount[eSSTATE_I]);
+
+        // B: I -> H (deep history) continues from the stored history
+        TEST_ASSERT_EQUAL(eOK, restarted.dispatch(1, eHEVENT_B));
+        TEST_ASSERT_EQUAL(eSSTATE_H12, restarted.getCurrentState(1));
+        TEST_ASSERT_EQUAL(2, restarted.getUserData(1).entryCount[eSSTATE_H12]);
+        restarted.close();
+    }
+
+    /**
+     * @brief Test that a store which was not closed is detected
+     */
+    void sttest_dirty()
+    {
+        HistoryStore store(storeDefinition);
+        setupStore(store);
+
+        // Process ended without `close`
+        HistoryStore restarted(storeDefinition);
+        TEST_ASSERT_EQUAL(eSTORE_DIRTY, restarted.open(storeMemory, sizeof(storeMemory)));
+        TEST_ASSERT_FALSE(restarted.isOpen());
+
+        // Recovery validates every record instead of the checksum
+        TEST_ASSERT_EQUAL(eSTORE_OK, restarted.open(storeMemory, sizeof(storeMemory), true));
+        TEST_ASSERT_EQUAL(eSSTATE_H12, restarted.getHistoryState(1, eSSTATE_H_DEEP_HISTORY));
+
+        // Torn record holding a composite state as active state
+        HistoryStore::sRecord* records = reinterpret_cast<HistoryStore::sRecord*>(storeMemory + STORE_HEADER_SIZE);
+        records[2].indices[0] = eSSTATE_H1;
+        TEST_ASSERT_EQUAL(eSTORE_CORRUPT, restarted.open(storeMemory, sizeof(storeMemory), true));
+        records[2].indices[0] = eSSTATE_I;
+        records[3].indices[1] = eSSTATE_I;
+        TEST_ASSERT_EQUAL(eSTORE_CORRUPT, restarted.open(storeMemory, sizeof(storeMemory), true));
+    }
+
+    /**
+     * @brief Test that a close interrupted between its stores can be recovered
+     */
+    void sttest_torn_close()
+    {
+        HistoryStore store(storeDefinition);
+        setupStore(store);
+        sStoreHeader* header = reinterpret_cast<sStoreHeader*>(storeMemory);
+        const uint32_t check = header->headerCheck;
+        store.close();
+
+        // Clearing the dirty flag leaves the header check as written by `format`
+        TEST_ASSERT_EQUAL(0, header->dirty);
+        TEST_ASSERT_EQUAL(check, header->headerCheck);
+
+        // Checksum written, dirty flag not cleared
+        header->dirty = 1;
+        HistoryStore restarted(storeDefinition);
+        TEST_ASSERT_EQUAL(eSTORE_DIRTY, restarted.open(storeMemory, sizeof(storeMemory)));
+        TEST_ASSERT_EQUAL(eSTORE_OK, restarted.open(storeMemory, sizeof(storeMemory), true));
+        TEST_ASSERT_EQUAL(eSSTATE_H12, restarted.getHistoryState(1, eSSTATE_H_DEEP_HISTORY));
+        restarted.close();
+        TEST_ASSERT_EQUAL(eSTORE_OK, restarted.open(storeMemory, sizeof(storeMemory)));
+        restarted.close();
+    }
+
+    /**
+     * @brief Test that stores of other layouts or with modified records are rejected
+     */
+    void sttest_invalid()
+    {
+        HistoryStore store(storeDefinition);
+        setupStore(store);
+        store.close();
+
+        HistoryStore restarted(storeDefinition);
+        TEST_ASSERT_EQUAL(eSTORE_TOO_SMALL, restarted.open(storeMemory, sizeof(storeMemory) - 1));
+        TEST_ASSERT_EQUAL(eSTORE_TOO_SMALL, restarted.format(storeMemory, sizeof(storeMemory) - 1, STORE_COUNT));
+
+        // Record type with other user data
+        InstanceStore<2, uint32_t> other(storeDefinition);
+        TEST_ASSERT_EQUAL(eSTORE_LAYOUT, other.open(storeMemory, sizeof(storeMemory)));
+
+        // Header modified without updating its check
+        sStoreHeader* header = reinterpret_cast<sStoreHeader*>(storeMemory);
+        header->count--;
+        TEST_ASSERT_EQUAL(eSTORE_LAYOUT, restarted.open(storeMemory, sizeof(storeMemory)));
+        header->count++;
+
+        // Record modified after `close`
+        HistoryStore::sRecord* records = reinterpret_cast<HistoryStore::sRecord*>(storeMemory + STORE_HEADER_SIZE);
+        records[0].user.entryCount[eSSTATE_H]++;
+        TEST_ASSERT_EQUAL(eSTORE_CHECKSUM, restarted.open(storeMemory, sizeof(storeMemory)));
+        records[0].user.entryCount[eSSTATE_H]--;
+        TEST_ASSERT_EQUAL(eSTORE_OK, restarted.open(storeMemory, sizeof(storeMemory)));
+        restarted.close();
+    }
+
+    void run_store_tests(void)
+    {
+        RUN_TEST(sttest_reopen);
+        RUN_TEST(sttest_dirty);
+        RUN_TEST(sttest_torn_close);
+        RUN_TEST(sttest_invalid);
+    }
+}
@@ -0,0 +1,9 @@
+#ifndef _H_MICROHSM_TESTS_STORE_TESTS
+#define _H_MICROHSM_TESTS_STORE_TESTS
+
+namespace microhsm_tests
+{
+    void run_store_tests(void);
+}
+
+#endif
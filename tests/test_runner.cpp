@@ -1,6 +1,24 @@
 #include "basic/basic_tests.hpp"
 #include "macros/macro_tests.hpp"
 #include "history/history_tests.hpp"
+#include "cache/cache_tests.hpp"
+#include "static/static_tests.hpp"
+#include "masks/mask_tests.hpp"
+#include "lca/lca_tests.hpp"
+#include "registry/registry_tests.hpp"
+#include "queue/queue_tests.hpp"
+#include "defer/defer_tests.hpp"
+#include "event/event_tests.hpp"
+#include "pool/pool_tests.hpp"
+#include "bus/bus_tests.hpp"
+#include "active/active_tests.hpp"
+#include "scheduler/scheduler_tests.hpp"
+#include "timer/timer_tests.hpp"
+#include "orthogonal/orthogonal_tests.hpp"
+#include "branch/branch_tests.hpp"
+#include "snapshot/snapshot_tests.hpp"
+#include "store/store_tests.hpp"
+#include "journal/journal_tests.hpp"
 #include <unity.h>
 
 namespace microhsm_tests
@@ -16,6 +34,24 @@ namespace microhsm_tests
         run_basic_tests();
         run_macro_tests();
         run_history_tests();
+        run_cache_tests();
+        run_static_tests();
+        run_mask_tests();
+        run_lca_tests();
+        run_registry_tests();
+        run_queue_tests();
+        run_defer_tests();
+        run_event_tests();
+        run_pool_tests();
+        run_bus_tests();
+        run_active_tests();
+        run_scheduler_tests();
+        run_timer_tests();
+        run_orthogonal_tests();
+        run_branch_tests();
+        run_snapshot_tests();
+        run_store_tests();
+        run_journal_tests();
 
         return UNITY_END();
     }
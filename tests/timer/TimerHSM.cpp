@@ -0,0 +1,64 @@
+/**
+ * @file TimerHSM.cpp
+ * @brief Test HSM using state-scoped timers
+ */
+
+#include <timer/TimerHSM.hpp>
+
+namespace microhsm_tests
+{
+    HSMDefinition TimerHSM::definition;
+
+    static void blink(void* ctx)
+    {
+        static_cast<sTimerCTX*>(ctx)->blinks++;
+    }
+
+    HSM_DEFINE_STATE_MATCH(TStateClosed)
+    {
+        (void)ctx;
+        if (event == eTEVENT_OPEN) return transitionExternal(eTSTATE_OPEN, t, nullptr);
+        return noTransition();
+    }
+
+    HSM_DEFINE_STATE_ENTRY(TStateOpen)
+    {
+        (void)ctx;
+        startTimer(TIMER_OPEN_TIMEOUT, eTEVENT_TIMEOUT);
+    }
+
+    HSM_DEFINE_STATE_MATCH(TStateOpen)
+    {
+        (void)ctx;
+        if (event == eTEVENT_TIMEOUT) return transitionExternal(eTSTATE_CLOSED, t, nullptr);
+        return noTransition();
+    }
+
+    HSM_DEFINE_STATE_ENTRY(TStateMoving)
+    {
+        (void)ctx;
+        startTimer(TIMER_BLINK_PERIOD, eTEVENT_BLINK, TIMER_BLINK_PERIOD);
+    }
+
+    HSM_DEFINE_STATE_MATCH(TStateMoving)
+    {
+        (void)ctx;
+        switch(event) {
+            case eTEVENT_BLINK:
+                return transitionInternal(t, blink);
+            case eTEVENT_STOP:
+                return transitionExternal(eTSTATE_STOPPED, t, nullptr);
+            default:
+                break;
+        }
+        return noTransition();
+    }
+
+    HSM_DEFINE_STATE_MATCH(TStateStopped)
+    {
+        (void)ctx;
+        (void)event;
+        (void)t;
+        return noTransition();
+    }
+}
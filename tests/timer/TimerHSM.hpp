@@ -0,0 +1,72 @@
+/**
+ * @file TimerHSM.hpp
+ * @brief Test HSM using state-scoped timers
+ */
+#ifndef _H_MICROHSM_TESTS_TIMERHSM
+#define _H_MICROHSM_TESTS_TIMERHSM
+
+#include <microhsm/microhsm.hpp>
+#include <microhsm/macros.hpp>
+
+using namespace microhsm;
+
+namespace microhsm_tests
+{
+    /// Ticks until an open door closes
+    static const uint32_t TIMER_OPEN_TIMEOUT = 10;
+    /// Ticks between blinks while the door moves
+    static const uint32_t TIMER_BLINK_PERIOD = 3;
+
+    /// @brief Event enumerations
+    HSM_CREATE_EVENT_LIST(e_tevents,
+            eTEVENT_OPEN,
+            eTEVENT_STOP,
+            eTEVENT_TIMEOUT,
+            eTEVENT_BLINK
+    )
+
+    HSM_CREATE_VERTEX_LIST(e_tstates,
+            eTSTATE_CLOSED = 80,
+            eTSTATE_OPEN,
+            eTSTATE_MOVING,
+            eTSTATE_STOPPED
+    )
+
+    /// @brief Context counting blinks
+    typedef struct {
+        unsigned int blinks;
+    } sTimerCTX;
+
+    /* State Declarations */
+    HSM_DECLARE_STATE_TOP_LEVEL(TStateClosed, eTSTATE_CLOSED)
+    // Closes after `TIMER_OPEN_TIMEOUT` ticks
+    HSM_DECLARE_STATE_TOP_LEVEL(TStateOpen, eTSTATE_OPEN,
+        HSM_DECLARE_STATE_ENTRY()
+    )
+    // Blinks every `TIMER_BLINK_PERIOD` ticks
+    HSM_DECLARE_STATE(TStateMoving, eTSTATE_MOVING, TStateOpen,
+        HSM_DECLARE_STATE_ENTRY()
+    )
+    HSM_DECLARE_STATE(TStateStopped, eTSTATE_STOPPED, TStateOpen)
+
+    /* HSM Declaration */
+    class TimerHSM : public BaseHSM
+    {
+    public:
+
+        /// Structure shared by all instances
+        static HSMDefinition definition;
+
+        TimerHSM() : BaseHSM(state_closed, definition)
+        {
+            this->registerVertices({&state_closed, &state_open, &state_moving, &state_stopped});
+        };
+
+        TStateClosed state_closed = TStateClosed(nullptr);
+        TStateOpen state_open = TStateOpen(&state_moving);
+        TStateMoving state_moving = TStateMoving(&state_open, nullptr);
+        TStateStopped state_stopped = TStateStopped(&state_open, nullptr);
+    };
+}
+
+#endif
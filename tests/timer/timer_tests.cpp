@@ -0,0 +1,213 @@
+#include <unity.h>
+
+#include <timer/timer_tests.hpp>
+#include <timer/TimerHSM.hpp>
+
+namespace microhsm_tests
+{
+    static TimerHSM timerHSM;
+    static EventQueue<64> timerQueue;
+    static sTimerCTX timerCTX;
+
+    static void setupTimer(BaseTimerService& service)
+    {
+        timerCTX.blinks = 0;
+        unsigned int event;
+        while (timerQueue.pop(event)) {}
+        timerHSM.attachQueue(&timerQueue);
+        timerHSM.attachTimerService(&service);
+        TEST_ASSERT_EQUAL(eOK, timerHSM.init(&timerCTX));
+    }
+
+    /// Receiver of timeout events outside of an HSM
+    class TimeoutRecorder : public TimerTarget
+    {
+    public:
+
+        bool deliverTimeout(unsigned int event) override
+        {
+            this->last = event;
+            this->count++;
+            if (this->service != nullptr && this->disarm != TIMER_HANDLE_NONE) {
+                this->service->disarm(this->disarm);
+                this->disarm = TIMER_HANDLE_NONE;
+            }
+            return this->accept;
+        }
+
+        unsigned int last = 0;
+        unsigned int count = 0;
+        bool accept = true;
+        /// Service of timer disarmed on the next delivery
+        BaseTimerService* service = nullptr;
+        /// Timer disarmed on the next delivery (`TIMER_HANDLE_NONE` if none)
+        tTimerHandle disarm = TIMER_HANDLE_NONE;
+    };
+
+    /// Number of ticks until the next event is posted, `0` if none within `limit` ticks
+    static uint32_t ticksUntilEvent(BaseTimerService& service, unsigned int& event, uint32_t limit)
+    {
+        for (uint32_t i = 1; i <= limit; i++) {
+            service.tick();
+            if (timerQueue.pop(event)) return i;
+        }
+        return 0;
+    }
+
+    void ttest_arm_disarm()
+    {
+        TimerService<4> service;
+        setupTimer(service);
+        unsigned int event = 0;
+
+        tTimerHandle a = service.arm(timerHSM, eTEVENT_OPEN, 5);
+        tTimerHandle b = service.arm(timerHSM, eTEVENT_STOP, 3);
+        TEST_ASSERT_EQUAL(2, service.getArmedCount());
+        TEST_ASSERT_TRUE(service.disarm(b));
+        TEST_ASSERT_FALSE(service.disarm(b));
+        TEST_ASSERT_FALSE(service.isArmed(b));
+
+        // Released timer is reused, the stale handle must not disarm it
+        tTimerHandle c = service.arm(timerHSM, eTEVENT_BLINK, 20);
+        TEST_ASSERT_NOT_EQUAL(b, c);
+        TEST_ASSERT_FALSE(service.disarm(b));
+        TEST_ASSERT_TRUE(service.isArmed(c));
+
+        TEST_ASSERT_EQUAL(5, ticksUntilEvent(service, event, 100));
+        TEST_ASSERT_EQUAL(eTEVENT_OPEN, event);
+        TEST_ASSERT_FALSE(service.isArmed(a));
+        TEST_ASSERT_EQUAL(15, ticksUntilEvent(service, event, 100));
+        TEST_ASSERT_EQUAL(eTEVENT_BLINK, event);
+        TEST_ASSERT_EQUAL(0, service.getArmedCount());
+
+        // Exhaustion
+        for (unsigned int i = 0; i < 4; i++) {
+            TEST_ASSERT_NOT_EQUAL(TIMER_HANDLE_NONE, service.arm(timerHSM, eTEVENT_STOP, 1000));
+        }
+        TEST_ASSERT_EQUAL(TIMER_HANDLE_NONE, service.arm(timerHSM, eTEVENT_STOP, 1000));
+    }
+
+    void ttest_wheel_levels()
+    {
+        // Delays within every level of the wheel and beyond its range
+        static const uint32_t delays[] = {1, 63, 64, 65, 4095, 4096, 100000, 262143, 262144, TIMER_WHEEL_RANGE + 1000};
+        TimerService<2> service;
+        setupTimer(service);
+        unsigned int event = 0;
+
+        for (unsigned int i = 0; i < sizeof(delays) / sizeof(delays[0]); i++) {
+            // Arm at a tick that is not aligned to any level
+            service.advance(i * 7);
+            service.arm(timerHSM, eTEVENT_STOP, delays[i]);
+            TEST_ASSERT_EQUAL(delays[i], ticksUntilEvent(service, event, TIMER_WHEEL_RANGE + 2000));
+        }
+
+        // Periodic timer crossing level boundaries
+        tTimerHandle p = service.arm(timerHSM, eTEVENT_BLINK, 100, 100);
+        for (unsigned int i = 0; i < 50; i++) {
+            TEST_ASSERT_EQUAL(100, ticksUntilEvent(service, event, 200));
+        }
+        TEST_ASSERT_TRUE(service.disarm(p));
+        TEST_ASSERT_EQUAL(0, ticksUntilEvent(service, event, 200));
+    }
+
+    void ttest_state_scoped()
+    {
+        TimerService<8> service;
+        setupTimer(service);
+
+        // Open: timeout of open state and blink of moving state
+        timerHSM.dispatch(eTEVENT_OPEN, &timerCTX);
+        TEST_ASSERT_TRUE(timerHSM.inState(eTSTATE_MOVING));
+        TEST_ASSERT_EQUAL(2, service.getArmedCount());
+        service.advance(7);
+        timerHSM.runUntilEmpty(&timerCTX);
+        TEST_ASSERT_EQUAL(2, timerCTX.blinks);
+
+        // Leaving moving disarms the blink only
+        timerHSM.dispatch(eTEVENT_STOP, &timerCTX);
+        TEST_ASSERT_EQUAL(1, service.getArmedCount());
+        service.advance(2);
+        TEST_ASSERT_EQUAL(0, timerHSM.runUntilEmpty(&timerCTX));
+
+        // Timeout of open state after 10 ticks closes the door
+        service.advance(1);
+        TEST_ASSERT_EQUAL(1, timerHSM.runUntilEmpty(&timerCTX));
+        TEST_ASSERT_TRUE(timerHSM.inState(eTSTATE_CLOSED));
+        TEST_ASSERT_EQUAL(0, service.getArmedCount());
+
+        // Reopen, re-initialization disarms all scoped timers
+        timerHSM.dispatch(eTEVENT_OPEN, &timerCTX);
+        TEST_ASSERT_EQUAL(2, service.getArmedCount());
+        TEST_ASSERT_EQUAL(eOK, timerHSM.init(&timerCTX));
+        TEST_ASSERT_EQUAL(0, service.getArmedCount());
+        service.advance(20);
+        TEST_ASSERT_EQUAL(0, timerHSM.runUntilEmpty(&timerCTX));
+
+        timerHSM.attachTimerService(nullptr);
+        timerHSM.dispatch(eTEVENT_OPEN, &timerCTX);
+        TEST_ASSERT_EQUAL(0, service.getArmedCount());
+    }
+
+    void ttest_target()
+    {
+        TimerService<2> service;
+        TimeoutRecorder recorder;
+
+        // Timeout events are delivered to the target of the timer
+        TEST_ASSERT_NOT_EQUAL(TIMER_HANDLE_NONE, service.arm(recorder, 7, 3, 3));
+        TEST_ASSERT_EQUAL(0, service.advance(2));
+        TEST_ASSERT_EQUAL(1, service.tick());
+        TEST_ASSERT_EQUAL(1, recorder.count);
+        TEST_ASSERT_EQUAL(7, recorder.last);
+
+        // Rejected deliveries are counted as failed
+        recorder.accept = false;
+        TEST_ASSERT_EQUAL(1, service.advance(3));
+        TEST_ASSERT_EQUAL(2, recorder.count);
+        TEST_ASSERT_EQUAL(1, service.getFailed());
+    }
+
+    void ttest_disarm_on_delivery()
+    {
+        TimerService<4> service;
+        TimeoutRecorder recorder;
+        recorder.service = &service;
+
+        // Timers of one slot expire newest first, `c` disarms `b` which expires in the same tick
+        const tTimerHandle a = service.arm(recorder, 1, 2, 2);
+        const tTimerHandle b = service.arm(recorder, 2, 2);
+        const tTimerHandle c = service.arm(recorder, 3, 2);
+        TEST_ASSERT_NOT_EQUAL(TIMER_HANDLE_NONE, c);
+        recorder.disarm = b;
+        TEST_ASSERT_EQUAL(2, service.advance(2));
+        TEST_ASSERT_EQUAL(1, recorder.last);
+        TEST_ASSERT_FALSE(service.isArmed(b));
+        TEST_ASSERT_FALSE(service.isArmed(c));
+        TEST_ASSERT_TRUE(service.isArmed(a));
+        TEST_ASSERT_EQUAL(1, service.getArmedCount());
+
+        // Periodic timer disarming itself is not placed again
+        recorder.disarm = a;
+        TEST_ASSERT_EQUAL(1, service.advance(2));
+        TEST_ASSERT_FALSE(service.isArmed(a));
+        TEST_ASSERT_EQUAL(0, service.getArmedCount());
+        TEST_ASSERT_EQUAL(0, service.advance(8));
+        TEST_ASSERT_EQUAL(3, recorder.count);
+
+        // All timers are free again
+        for (unsigned int i = 0; i < 4; i++) TEST_ASSERT_NOT_EQUAL(TIMER_HANDLE_NONE, service.arm(recorder, i, 1));
+        TEST_ASSERT_EQUAL(TIMER_HANDLE_NONE, service.arm(recorder, 4, 1));
+        TEST_ASSERT_EQUAL(4, service.tick());
+        TEST_ASSERT_EQUAL(0, service.getArmedCount());
+    }
+
+    void run_timer_tests(void)
+    {
+        RUN_TEST(ttest_arm_disarm);
+        RUN_TEST(ttest_wheel_levels);
+        RUN_TEST(ttest_state_scoped);
+        RUN_TEST(ttest_target);
+        RUN_TEST(ttest_disarm_on_delivery);
+    }
+}
@@ -0,0 +1,9 @@
+#ifndef _H_MICROHSM_TESTS_TIMER_TESTS
+#define _H_MICROHSM_TESTS_TIMER_TESTS
+
+namespace microhsm_tests
+{
+    void run_timer_tests(void);
+}
+
+#endif